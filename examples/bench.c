@@ -0,0 +1,1313 @@
+#include "hsv.h"
+#include "hsv_engine.h"
+#include "hsv_batch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include <math.h>
+#include <inttypes.h>
+
+#include <time.h>
+#include <sys/time.h>
+
+#define DEFAULT_SAMPLE_RATE 16000
+#define DEFAULT_CHANNELS    1
+#define DEFAULT_SECONDS     60
+#define BS                  16
+#define DEFAULT_STREAMS     64
+#define VERIFY_THREADS      4
+
+#define BUF_LEN_IN  8192
+#define BUF_LEN_OUT 8192
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif	/* M_PI */
+
+static char buf_in[BUF_LEN_IN];
+static char buf_out[BUF_LEN_OUT];
+
+/**
+ * Тип синтетического входного сигнала.
+ */
+enum SIGNAL_TYPE
+{
+	SIGNAL_TYPE_NOISE,   /**< Тон с белым шумом на всём протяжении.                */
+	SIGNAL_TYPE_SILENCE, /**< Цифровая тишина.                                     */
+	SIGNAL_TYPE_SPARSE,  /**< 90% цифровой тишины, 10% тона с белым шумом.         */
+	SIGNAL_TYPE_FADE,    /**< Тон с белым шумом, затухающий до цифровой тишины.    */
+	SIGNAL_TYPE_QUIET,   /**< Тон с белым шумом на уровне нескольких младших битов. */
+};
+
+/**
+ * Выход потока данных для --verify: ожидаемый выход отдельного контекста и полученный.
+ */
+struct VERIFY_STREAM
+{
+	char*expected;         /**< Ожидаемый выход.                                                  */
+	char*out;              /**< Полученный выход (первые cap байт).                               */
+	unsigned cap;          /**< Вместимость обоих буферов: размер входа потока данных в байтах.   */
+	unsigned expected_len; /**< Размер ожидаемого выхода в байтах.                                */
+	unsigned out_len;      /**< Размер полученного выхода в байтах (в том числе после cap байт). */
+};
+
+/**
+ * Результаты прогона.
+ */
+struct BENCH_RESULT
+{
+	double proc_ms; /**< Процессорное время обработки. */
+	double real_ms; /**< Реальное время обработки.     */
+
+	/* Стоимость обработки каждой секунды входа: на тишине она не должна расти. */
+	double sec_min_ms;
+	double sec_max_ms;
+	double sec_last_ms;
+};
+
+static const unsigned sweep_chs[] = {1, 2, 8, 16}; /**< Числа каналов для --ch-sweep. */
+
+static const unsigned sweep_threads[] = {1, 2, 4, 8, 16, 32, 64}; /**< Числа рабочих потоков для --engine-sweep. */
+
+static void LOG(const char*format, ...)
+{
+	va_list var_args;
+
+	va_start(var_args, format);
+	vfprintf(stderr, format, var_args);
+	va_end(var_args);
+}
+
+static void print_usage(const char*prog_name)
+{
+	LOG("Usage: %s [options]\n", prog_name);
+	LOG("Example: %s --tsnr --signal sparse --bypass-spp\n", prog_name);
+	LOG("Modes (default --tsnr):\n");
+	LOG("      --specsub, --wiener, --tsnr, --tsnrg, --rtsnr, --rtsnrg, --bark\n");
+	LOG("Options:\n");
+	LOG("      --signal S                    - noise|silence|sparse|fade|quiet: synthetic input signal (default noise);\n");
+	LOG("                                      fade: 1 s of signal decaying by 40 dB/s into digital silence, quiet: a few LSB.\n");
+	LOG("      --seconds N                   - input duration in seconds (default %d).\n", DEFAULT_SECONDS);
+	LOG("      --sr N                        - sample rate (default %d).\n", DEFAULT_SAMPLE_RATE);
+	LOG("      --ch N                        - channels (default %d).\n", DEFAULT_CHANNELS);
+	LOG("      --ch-sweep                    - measure throughput at 1, 2, 8 and 16 channels.\n");
+	LOG("      --bypass-silence              - copy silent frames without processing.\n");
+	LOG("      --bypass-spp                  - also attenuate frames without speech without suppression.\n");
+	LOG("      --ctrl-period N               - update noise estimate (and gains) every N-th frame.\n");
+	LOG("      --ctrl-mode M                 - hold|interp|estimator|stagger (default hold).\n");
+	LOG("      --link M                      - mid|max: one noise estimate and gain for all channels.\n");
+	LOG("      --split M                     - fixed|tracked: process only the decimated low band at high sample rates.\n");
+	LOG("      --bands N                     - number of critical bands for --bark (default %d).\n", HSV_DEFAULT_BANDS);
+	LOG("      --wola                        - weighted overlap-add filterbank instead of zero-padded STFT.\n");
+	LOG("      --window W                    - sqrt-hann|vorbis|kbd: power-complementary analysis/synthesis window pair,\n");
+	LOG("                                      low-delay: asymmetric windows with 2 * step delay.\n");
+	LOG("      --overlap N                   - frame overlap in percent.\n");
+	LOG("      --frame N                     - frame size in samples (default 20 ms).\n");
+	LOG("      --dft N                       - DFT size in samples (default 2 * frame).\n");
+	LOG("      --fir                         - apply gains with a short linear-phase FIR (side-chain analysis).\n");
+	LOG("      --fir-delay N                 - FIR group delay in samples (default 8 ms, at most (frame - 1) / 2).\n");
+	LOG("      --precision P                 - float|double|long-double|fixed: numeric precision of processing.\n");
+	LOG("      --fast-math                   - polynomial approximations instead of libm (phase, sin/cos, pow, log10).\n");
+	LOG("      --protect-denormals           - flush denormals to zero and floor recursive spectra on silence.\n");
+	LOG("      --storage S                   - native|fp16|bf16: storage format of recursive noise and speech spectra between frames.\n");
+	LOG("      --threads N                   - process the channels of the context in N threads (including the calling one).\n");
+	LOG("      --engine-sweep                - measure engine throughput at 1, 2, 4, 8, 16, 32 and 64 worker threads.\n");
+	LOG("      --streams N                   - number of engine streams for --engine-sweep (default: 64).\n");
+	LOG("      --batch-density               - compare N separate contexts with one batch of N lanes.\n");
+	LOG("      --lanes N                     - number of batch lanes for --batch-density (default: 8).\n");
+	LOG("      --verify                      - check that engine and batch output match separate contexts bit for bit\n");
+	LOG("                                      (--streams engine streams, --lanes batch lanes, --seconds of input).\n");
+}
+
+static unsigned long long now_us()
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return ((unsigned long long) tv.tv_sec) * 1000 * 1000 + ((unsigned long long) tv.tv_usec);
+}
+
+static int16_t gen_sample(enum SIGNAL_TYPE signal, unsigned long long i, unsigned sr, uint32_t*seed)
+{
+	double v;
+	double t = ((double) i) / ((double) sr);
+
+	if (signal == SIGNAL_TYPE_SILENCE) {
+		return 0;
+	} else if ((signal == SIGNAL_TYPE_SPARSE) && ((i % (10 * sr)) >= sr)) {
+		return 0;
+	}
+
+	/* Линейный конгруэнтный генератор, чтобы результаты не зависели от libc. */
+	*seed = (*seed) * 1664525U + 1013904223U;
+	v = 0.03 * ((double) (*seed >> 8) / (double) (1U << 24) - 0.5);
+	v += 0.1 * sin(2.0 * M_PI * 440.0 * t);
+
+	if ((signal == SIGNAL_TYPE_FADE) && (t > 1.0)) {
+		v *= pow(10.0, -2.0 * (t - 1.0));
+	} else if (signal == SIGNAL_TYPE_QUIET) {
+		v *= 1e-4;
+	}
+
+	return (int16_t) (v * INT16_MAX);
+}
+
+/**
+ * Обработка seconds секунд синтетического сигнала, одинакового во всех каналах, сконфигурированным контекстом.
+ * \return 0 или код ошибки контекста.
+ */
+static int run_bench(hsvc_t hsvc, const struct HSV_CONFIG*conf, enum SIGNAL_TYPE signal, unsigned seconds, struct BENCH_RESULT*res)
+{
+	unsigned long long smpl, n_smpls;
+	unsigned ch;
+	unsigned data_len;
+	uint32_t seed = 1;
+
+	int processed;
+
+	clock_t proc_start_time;
+
+	clock_t sec_start_time;
+	unsigned long long sec_end_smpl;
+	double sec_ms;
+
+	unsigned long long start_time;
+
+	res->sec_min_ms = -1.0;
+	res->sec_max_ms = 0.0;
+	res->sec_last_ms = 0.0;
+
+	n_smpls = ((unsigned long long) seconds) * conf->sr;
+
+	proc_start_time = clock();
+	start_time = now_us();
+
+	sec_start_time = proc_start_time;
+	sec_end_smpl = conf->sr;
+
+	for (smpl = 0; smpl < n_smpls; ) {
+		/* Буфер заполняется целым числом многоканальных сэмплов. */
+		for (data_len = 0; (data_len + 2 * conf->ch <= BUF_LEN_IN) && (smpl < n_smpls); smpl++) {
+			int16_t v = gen_sample(signal, smpl, conf->sr, &seed);
+			for (ch = 0; ch < conf->ch; ch++) {
+				memcpy(buf_in + data_len, &v, sizeof(v));
+				data_len += sizeof(v);
+			}
+		}
+
+		processed = hsvc_push(hsvc, buf_in, data_len);
+		if (processed < 0) {
+			return processed;
+		}
+		while (hsvc_get(hsvc, buf_out, BUF_LEN_OUT) != 0) {
+		}
+
+		if (smpl >= sec_end_smpl) {
+			clock_t now = clock();
+			sec_ms = ((double) (now - sec_start_time)) / CLOCKS_PER_SEC * 1000.0 * conf->sr / (smpl - sec_end_smpl + conf->sr);
+			res->sec_min_ms = ((res->sec_min_ms < 0.0) || (sec_ms < res->sec_min_ms)) ? sec_ms : res->sec_min_ms;
+			res->sec_max_ms = (sec_ms > res->sec_max_ms) ? sec_ms : res->sec_max_ms;
+			res->sec_last_ms = sec_ms;
+			sec_start_time = now;
+			sec_end_smpl = smpl + conf->sr;
+		}
+	}
+
+	hsvc_flush(hsvc);
+	while (hsvc_get(hsvc, buf_out, BUF_LEN_OUT) != 0) {
+	}
+
+	res->real_ms = ((double) (now_us() - start_time)) / 1000.0;
+	res->proc_ms = ((double) (clock() - proc_start_time)) / CLOCKS_PER_SEC * 1000.0;
+
+	return 0;
+}
+
+/**
+ * Пропускная способность при 1, 2, 8 и 16 каналах: секунды входа всех каналов, обработанные за секунду.
+ */
+static int run_sweep(struct HSV_CONFIG*conf, enum SIGNAL_TYPE signal, unsigned seconds)
+{
+	struct BENCH_RESULT res;
+
+	hsvc_t hsvc;
+
+	enum HSV_CODE hsv_r;
+
+	unsigned i;
+
+	int r;
+
+	for (i = 0; i < sizeof(sweep_chs) / sizeof(sweep_chs[0]); i++) {
+		conf->ch = sweep_chs[i];
+
+		r = hsvc_validate_config(conf);
+		if ((enum HSV_CODE) r != HSV_CODE_OK) {
+			LOG("Invalid configuration in parameter (%d)\n", r);
+			return 2;
+		}
+
+		hsvc = create_hsvc();
+		if (hsvc == NULL) {
+			LOG("Unable to create \"hsv\" context!\n");
+			return 3;
+		}
+
+		hsv_r = hsvc_config(hsvc, conf);
+		if (hsv_r != HSV_CODE_OK) {
+			LOG("Unable to configure \"hsv\" context (%d)!\n", (int) hsv_r);
+			hsvc_free(hsvc);
+			return 4;
+		}
+
+		r = run_bench(hsvc, conf, signal, seconds, &res);
+
+		hsvc_deconfig(hsvc);
+		hsvc_free(hsvc);
+
+		if (r != 0) {
+			LOG("\"hsv\" context error (%d)!\n", r);
+			return 5;
+		}
+
+		LOG("Channels %2u: real-time factor %.1lfx, %.1lf channel-seconds per second\n", conf->ch,
+			((double) seconds) * 1000.0 / res.real_ms, ((double) seconds) * conf->ch * 1000.0 / res.real_ms);
+	}
+
+	return 0;
+}
+
+/**
+ * Заполнение buf_in следующими 10 мс синтетического сигнала, одинакового во всех каналах.
+ * \return размер данных в байтах (0 - сигнал закончился).
+ */
+static unsigned gen_chunk(const struct HSV_CONFIG*conf, enum SIGNAL_TYPE signal, unsigned long long*smpl, unsigned long long n_smpls, uint32_t*seed)
+{
+	unsigned ch;
+	unsigned data_len;
+	unsigned chunk_smpls;
+
+	chunk_smpls = conf->sr / 100;
+	if (chunk_smpls * 2 * conf->ch > BUF_LEN_IN) {
+		chunk_smpls = BUF_LEN_IN / (2 * conf->ch);
+	}
+
+	for (data_len = 0; (data_len < chunk_smpls * 2 * conf->ch) && (*smpl < n_smpls); (*smpl)++) {
+		int16_t v = gen_sample(signal, *smpl, conf->sr, seed);
+		for (ch = 0; ch < conf->ch; ch++) {
+			memcpy(buf_in + data_len, &v, sizeof(v));
+			data_len += sizeof(v);
+		}
+	}
+
+	return data_len;
+}
+
+/**
+ * Прогон движка: seconds секунд синтетического сигнала в каждом из n_streams контекстов,
+ * поданные по кругу порциями по 10 мс.
+ * \return 0 или код ошибки.
+ */
+static int run_engine(hsve_t hsve, const struct HSV_CONFIG*conf, enum SIGNAL_TYPE signal, unsigned seconds, unsigned n_streams)
+{
+	unsigned long long smpl = 0, n_smpls;
+	unsigned s;
+	unsigned data_len;
+	uint32_t seed = 1;
+
+	int r;
+
+	int pending;
+
+	n_smpls = ((unsigned long long) seconds) * conf->sr;
+
+	while ((data_len = gen_chunk(conf, signal, &smpl, n_smpls, &seed)) != 0) {
+		for (s = 0; s < n_streams; s++) {
+			/* Очередь входа заполнена: рабочие потоки не успевают, поэтому нужно дождаться их. */
+			while ((r = hsve_push(hsve, s, buf_in, data_len)) == HSV_CODE_OVERFLOW_ERR) {
+				while (hsve_get(hsve, s, buf_out, BUF_LEN_OUT) != 0) {
+				}
+				hsve_wait(hsve);
+			}
+			if (r < 0) {
+				return r;
+			}
+			while (hsve_get(hsve, s, buf_out, BUF_LEN_OUT) != 0) {
+			}
+		}
+	}
+
+	for (s = 0; s < n_streams; s++) {
+		hsve_flush(hsve, s);
+	}
+	do {
+		hsve_wait(hsve);
+		pending = 0;
+		for (s = 0; s < n_streams; s++) {
+			while (hsve_get(hsve, s, buf_out, BUF_LEN_OUT) != 0) {
+				pending = 1;
+			}
+		}
+	} while (pending);
+
+	return 0;
+}
+
+/**
+ * Пропускная способность движка при 1, 2, 4, 8, 16, 32 и 64 рабочих потоках: секунды входа всех потоков данных,
+ * обработанные за секунду.
+ */
+static int run_engine_sweep(const struct HSV_CONFIG*conf, enum SIGNAL_TYPE signal, unsigned seconds, unsigned n_streams)
+{
+	struct HSV_ENGINE_CONFIG engine_conf;
+
+	hsvc_t*hsvcs;
+	hsve_t hsve;
+
+	enum HSV_CODE hsv_r;
+
+	unsigned long long start_time;
+	double real_ms;
+
+	unsigned i, s;
+
+	int r;
+
+	r = hsvc_validate_config(conf);
+	if ((enum HSV_CODE) r != HSV_CODE_OK) {
+		LOG("Invalid configuration in parameter (%d)\n", r);
+		return 2;
+	}
+
+	hsvcs = (hsvc_t*) calloc(n_streams, sizeof(hsvc_t));
+	if (hsvcs == NULL) {
+		LOG("Unable to create \"hsv\" contexts!\n");
+		return 3;
+	}
+
+	for (i = 0; i < sizeof(sweep_threads) / sizeof(sweep_threads[0]); i++) {
+		memset(&engine_conf, '\0', sizeof(engine_conf));
+		engine_conf.threads = sweep_threads[i];
+		engine_conf.max_streams = n_streams;
+
+		hsve = create_hsve();
+		if (hsve == NULL) {
+			LOG("Unable to create \"hsv\" engine!\n");
+			r = 3;
+			goto err0;
+		}
+		hsv_r = hsve_config(hsve, &engine_conf);
+		if (hsv_r != HSV_CODE_OK) {
+			LOG("Unable to configure \"hsv\" engine (%d)!\n", (int) hsv_r);
+			hsve_free(hsve);
+			r = 4;
+			goto err0;
+		}
+
+		for (s = 0; s < n_streams; s++) {
+			hsvcs[s] = create_hsvc();
+			if (hsvcs[s] == NULL) {
+				LOG("Unable to create \"hsv\" context!\n");
+				r = 3;
+				goto err1;
+			}
+			hsv_r = hsvc_config(hsvcs[s], conf);
+			if (hsv_r != HSV_CODE_OK) {
+				LOG("Unable to configure \"hsv\" context (%d)!\n", (int) hsv_r);
+				hsvc_free(hsvcs[s]);
+				r = 4;
+				goto err1;
+			}
+			hsve_add(hsve, hsvcs[s]);
+		}
+
+		start_time = now_us();
+		r = run_engine(hsve, conf, signal, seconds, n_streams);
+		real_ms = ((double) (now_us() - start_time)) / 1000.0;
+		if (r != 0) {
+			LOG("\"hsv\" context error (%d)!\n", r);
+			r = 5;
+			goto err1;
+		}
+
+		hsve_deconfig(hsve);
+		hsve_free(hsve);
+		while (s-- > 0) {
+			hsvc_deconfig(hsvcs[s]);
+			hsvc_free(hsvcs[s]);
+		}
+
+		LOG("Threads %2u: %.1lf stream-seconds per second\n", sweep_threads[i], ((double) seconds) * n_streams * 1000.0 / real_ms);
+	}
+
+	free(hsvcs);
+
+	return 0;
+
+ err1:
+	hsve_wait(hsve);
+	hsve_deconfig(hsve);
+	hsve_free(hsve);
+	while (s-- > 0) {
+		hsvc_deconfig(hsvcs[s]);
+		hsvc_free(hsvcs[s]);
+	}
+ err0:
+	free(hsvcs);
+	return r;
+}
+
+/**
+ * Плотность: lanes отдельных контекстов против пакета из lanes дорожек на одном и том же сигнале,
+ * поданном порциями по 10 мс (секунды входа всех потоков данных, обработанные за секунду, и память на поток данных).
+ */
+static int run_batch_density(const struct HSV_CONFIG*conf, enum SIGNAL_TYPE signal, unsigned seconds, unsigned lanes)
+{
+	struct HSV_BATCH_CONFIG batch_conf;
+
+	hsvc_t*hsvcs;
+	hsvb_t hsvb;
+
+	enum HSV_CODE hsv_r;
+
+	unsigned long long smpl, n_smpls;
+	unsigned long long start_time;
+	double real_ms;
+	uint32_t seed;
+
+	unsigned data_len;
+	unsigned l, n_hsvcs;
+
+	int r;
+
+	memset(&batch_conf, '\0', sizeof(batch_conf));
+	batch_conf.stream = *conf;
+	batch_conf.lanes = lanes;
+
+	r = hsvb_validate_config(&batch_conf);
+	if ((enum HSV_CODE) r != HSV_CODE_OK) {
+		LOG("Invalid configuration in parameter (%d)\n", r);
+		return 2;
+	}
+
+	hsvcs = (hsvc_t*) calloc(lanes, sizeof(hsvc_t));
+	if (hsvcs == NULL) {
+		LOG("Unable to create \"hsv\" contexts!\n");
+		return 3;
+	}
+
+	for (n_hsvcs = 0; n_hsvcs < lanes; n_hsvcs++) {
+		hsvcs[n_hsvcs] = create_hsvc();
+		if (hsvcs[n_hsvcs] == NULL) {
+			LOG("Unable to create \"hsv\" context!\n");
+			r = 3;
+			goto err0;
+		}
+		hsv_r = hsvc_config(hsvcs[n_hsvcs], conf);
+		if (hsv_r != HSV_CODE_OK) {
+			LOG("Unable to configure \"hsv\" context (%d)!\n", (int) hsv_r);
+			hsvc_free(hsvcs[n_hsvcs]);
+			r = 4;
+			goto err0;
+		}
+	}
+
+	n_smpls = ((unsigned long long) seconds) * conf->sr;
+
+	smpl = 0;
+	seed = 1;
+	start_time = now_us();
+	while ((data_len = gen_chunk(conf, signal, &smpl, n_smpls, &seed)) != 0) {
+		for (l = 0; l < lanes; l++) {
+			r = hsvc_push(hsvcs[l], buf_in, data_len);
+			if (r < 0) {
+				LOG("\"hsv\" context error (%d)!\n", r);
+				r = 5;
+				goto err0;
+			}
+			while (hsvc_get(hsvcs[l], buf_out, BUF_LEN_OUT) != 0) {
+			}
+		}
+	}
+	for (l = 0; l < lanes; l++) {
+		hsvc_flush(hsvcs[l]);
+		while (hsvc_get(hsvcs[l], buf_out, BUF_LEN_OUT) != 0) {
+		}
+	}
+	real_ms = ((double) (now_us() - start_time)) / 1000.0;
+
+	LOG("Separate contexts: %.1lf stream-seconds per second, %lu bytes per stream\n",
+		((double) seconds) * lanes * 1000.0 / real_ms, (unsigned long) hsvc_get_arena_size(conf));
+
+	hsvb = create_hsvb();
+	if (hsvb == NULL) {
+		LOG("Unable to create \"hsv\" batch!\n");
+		r = 3;
+		goto err0;
+	}
+	hsv_r = hsvb_config(hsvb, &batch_conf);
+	if (hsv_r != HSV_CODE_OK) {
+		LOG("Unable to configure \"hsv\" batch (%d)!\n", (int) hsv_r);
+		r = 4;
+		goto err1;
+	}
+
+	smpl = 0;
+	seed = 1;
+	start_time = now_us();
+	while ((data_len = gen_chunk(conf, signal, &smpl, n_smpls, &seed)) != 0) {
+		for (l = 0; l < lanes; l++) {
+			r = hsvb_push(hsvb, l, buf_in, data_len);
+			if (r < 0) {
+				LOG("\"hsv\" batch error (%d)!\n", r);
+				r = 5;
+				goto err2;
+			}
+			while (hsvb_get(hsvb, l, buf_out, BUF_LEN_OUT) != 0) {
+			}
+		}
+	}
+	hsvb_flush(hsvb);
+	for (l = 0; l < lanes; l++) {
+		while (hsvb_get(hsvb, l, buf_out, BUF_LEN_OUT) != 0) {
+		}
+	}
+	real_ms = ((double) (now_us() - start_time)) / 1000.0;
+
+	LOG("Batch of %2u lanes: %.1lf stream-seconds per second, %lu bytes per stream\n", lanes,
+		((double) seconds) * lanes * 1000.0 / real_ms, (unsigned long) (hsvb_get_mem_size(hsvb) / lanes));
+
+	r = 0;
+
+ err2:
+	hsvb_deconfig(hsvb);
+ err1:
+	hsvb_free(hsvb);
+ err0:
+	while (n_hsvcs-- > 0) {
+		hsvc_deconfig(hsvcs[n_hsvcs]);
+		hsvc_free(hsvcs[n_hsvcs]);
+	}
+	free(hsvcs);
+	return r;
+}
+
+/**
+ * Место для выхода потока данных: после cap байт выход только учитывается, а данные отбрасываются в buf_out.
+ * \param cap вместимость места в байтах.
+ */
+static char*verify_tail(struct VERIFY_STREAM*vs, unsigned*cap)
+{
+	if (vs->out_len < vs->cap) {
+		*cap = vs->cap - vs->out_len;
+		return vs->out + vs->out_len;
+	}
+
+	*cap = BUF_LEN_OUT;
+	return buf_out;
+}
+
+/**
+ * Чтение выхода потока данных движка.
+ */
+static void verify_get_hsve(hsve_t hsve, unsigned s, struct VERIFY_STREAM*vs)
+{
+	unsigned n, cap;
+	char*data;
+
+	do {
+		data = verify_tail(vs, &cap);
+		n = hsve_get(hsve, s, data, cap);
+		vs->out_len += n;
+	} while (n != 0);
+}
+
+/**
+ * Чтение выхода дорожки пакета.
+ */
+static void verify_get_hsvb(hsvb_t hsvb, unsigned l, struct VERIFY_STREAM*vs)
+{
+	unsigned n, cap;
+	char*data;
+
+	do {
+		data = verify_tail(vs, &cap);
+		n = hsvb_get(hsvb, l, data, cap);
+		vs->out_len += n;
+	} while (n != 0);
+}
+
+/**
+ * Чтение выхода отдельного контекста в ожидаемый выход (не дальше limit байт).
+ */
+static void verify_get_hsvc(hsvc_t hsvc, struct VERIFY_STREAM*vs, unsigned limit)
+{
+	unsigned n;
+
+	while ((n = hsvc_get(hsvc, buf_out, BUF_LEN_OUT)) != 0) {
+		n = (n < limit - vs->expected_len) ? n : limit - vs->expected_len;
+		memcpy(vs->expected + vs->expected_len, buf_out, n);
+		vs->expected_len += n;
+	}
+}
+
+/**
+ * Ожидаемый выход: n_smpls сэмплов сигнала с зерном seed, поданных в отдельный контекст порциями по 10 мс,
+ * а при pad - еще hsvc_get_latency нулевых сэмплов. Дописывается не больше n_smpls сэмплов выхода.
+ * \return 0 или код ошибки.
+ */
+static int verify_reference(const struct HSV_CONFIG*conf, enum SIGNAL_TYPE signal, unsigned long long n_smpls,
+	uint32_t seed, int pad, struct VERIFY_STREAM*vs)
+{
+	hsvc_t hsvc;
+
+	unsigned long long smpl = 0, pad_smpls;
+	unsigned data_len;
+	unsigned limit;
+
+	int r;
+
+	hsvc = create_hsvc();
+	if (hsvc == NULL) {
+		return HSV_CODE_ALLOC_ERR;
+	}
+	r = hsvc_config(hsvc, conf);
+	if (r != HSV_CODE_OK) {
+		goto err0;
+	}
+
+	limit = vs->expected_len + (unsigned) n_smpls * 2 * conf->ch;
+	pad_smpls = pad ? hsvc_get_latency(hsvc) : 0;
+	while ((data_len = gen_chunk(conf, signal, &smpl, n_smpls, &seed)) != 0 || (pad_smpls > 0)) {
+		if (data_len == 0) {
+			data_len = (unsigned) ((pad_smpls > BUF_LEN_IN / (2 * conf->ch)) ? BUF_LEN_IN / (2 * conf->ch) : pad_smpls);
+			pad_smpls -= data_len;
+			data_len *= 2 * conf->ch;
+			memset(buf_in, '\0', data_len);
+		}
+		r = hsvc_push(hsvc, buf_in, data_len);
+		if (r < 0) {
+			goto err1;
+		}
+		verify_get_hsvc(hsvc, vs, limit);
+	}
+	hsvc_flush(hsvc);
+	verify_get_hsvc(hsvc, vs, limit);
+
+	r = 0;
+
+ err1:
+	hsvc_deconfig(hsvc);
+ err0:
+	hsvc_free(hsvc);
+	return r;
+}
+
+/**
+ * Сравнение полученного выхода потока данных с ожидаемым.
+ * \return 0 при совпадении, иначе 1.
+ */
+static int verify_compare(const char*name, unsigned s, const struct VERIFY_STREAM*vs)
+{
+	unsigned i;
+
+	if ((vs->out_len == vs->expected_len) && (memcmp(vs->out, vs->expected, vs->expected_len) == 0)) {
+		return 0;
+	}
+
+	for (i = 0; (i < vs->out_len) && (i < vs->expected_len) && (vs->out[i] == vs->expected[i]); i++) {
+	}
+	LOG("%s %u: output differs from a separate context at byte %u (%u bytes, expected %u)\n", name, s, i, vs->out_len, vs->expected_len);
+
+	return 1;
+}
+
+/**
+ * Проверка движка: n_streams потоков данных (сигналы с разными зернами), обработанных VERIFY_THREADS рабочими потоками,
+ * против отдельных контекстов.
+ * \return 0 при совпадении, 1 при отличии, иначе код ошибки.
+ */
+static int verify_engine(const struct HSV_CONFIG*conf, enum SIGNAL_TYPE signal, unsigned seconds, unsigned n_streams, struct VERIFY_STREAM*vss)
+{
+	struct HSV_ENGINE_CONFIG engine_conf;
+
+	hsvc_t*hsvcs;
+	hsve_t hsve;
+
+	enum HSV_CODE hsv_r;
+
+	unsigned long long*smpls, n_smpls;
+	uint32_t*seeds;
+
+	unsigned data_len;
+	unsigned s, n_hsvcs = 0;
+
+	int r, bad, active;
+
+	n_smpls = ((unsigned long long) seconds) * conf->sr;
+
+	hsvcs = (hsvc_t*) calloc(n_streams, sizeof(hsvc_t));
+	smpls = (unsigned long long*) calloc(n_streams, sizeof(unsigned long long));
+	seeds = (uint32_t*) calloc(n_streams, sizeof(uint32_t));
+	if ((hsvcs == NULL) || (smpls == NULL) || (seeds == NULL)) {
+		r = 3;
+		goto err0;
+	}
+
+	for (s = 0; s < n_streams; s++) {
+		vss[s].expected_len = 0;
+		vss[s].out_len = 0;
+		r = verify_reference(conf, signal, n_smpls, s + 1, 0, vss + s);
+		if (r != 0) {
+			LOG("\"hsv\" context error (%d)!\n", r);
+			r = 5;
+			goto err0;
+		}
+		seeds[s] = s + 1;
+	}
+
+	memset(&engine_conf, '\0', sizeof(engine_conf));
+	engine_conf.threads = VERIFY_THREADS;
+	engine_conf.max_streams = n_streams;
+
+	hsve = create_hsve();
+	if (hsve == NULL) {
+		r = 3;
+		goto err0;
+	}
+	hsv_r = hsve_config(hsve, &engine_conf);
+	if (hsv_r != HSV_CODE_OK) {
+		LOG("Unable to configure \"hsv\" engine (%d)!\n", (int) hsv_r);
+		r = 4;
+		goto err1;
+	}
+
+	for (n_hsvcs = 0; n_hsvcs < n_streams; n_hsvcs++) {
+		hsvcs[n_hsvcs] = create_hsvc();
+		if (hsvcs[n_hsvcs] == NULL) {
+			r = 3;
+			goto err2;
+		}
+		hsv_r = hsvc_config(hsvcs[n_hsvcs], conf);
+		if (hsv_r != HSV_CODE_OK) {
+			LOG("Unable to configure \"hsv\" context (%d)!\n", (int) hsv_r);
+			hsvc_free(hsvcs[n_hsvcs]);
+			r = 4;
+			goto err2;
+		}
+		hsve_add(hsve, hsvcs[n_hsvcs]);
+	}
+
+	do {
+		active = 0;
+		for (s = 0; s < n_streams; s++) {
+			data_len = gen_chunk(conf, signal, smpls + s, n_smpls, seeds + s);
+			if (data_len == 0) {
+				continue;
+			}
+			active = 1;
+			while ((r = hsve_push(hsve, s, buf_in, data_len)) == HSV_CODE_OVERFLOW_ERR) {
+				verify_get_hsve(hsve, s, vss + s);
+				hsve_wait(hsve);
+			}
+			if (r < 0) {
+				LOG("\"hsv\" engine error (%d)!\n", r);
+				r = 5;
+				goto err2;
+			}
+			verify_get_hsve(hsve, s, vss + s);
+		}
+	} while (active);
+
+	for (s = 0; s < n_streams; s++) {
+		hsve_flush(hsve, s);
+	}
+	do {
+		hsve_wait(hsve);
+		active = 0;
+		for (s = 0; s < n_streams; s++) {
+			unsigned out_len = vss[s].out_len;
+			verify_get_hsve(hsve, s, vss + s);
+			active |= (vss[s].out_len != out_len);
+		}
+	} while (active);
+
+	bad = 0;
+	for (s = 0; s < n_streams; s++) {
+		bad |= verify_compare("Engine stream", s, vss + s);
+	}
+	r = bad;
+
+ err2:
+	hsve_wait(hsve);
+	hsve_deconfig(hsve);
+ err1:
+	hsve_free(hsve);
+ err0:
+	while (n_hsvcs-- > 0) {
+		hsvc_deconfig(hsvcs[n_hsvcs]);
+		hsvc_free(hsvcs[n_hsvcs]);
+	}
+	free(seeds);
+	free(smpls);
+	free(hsvcs);
+	return r;
+}
+
+/**
+ * Проверка пакета: lanes дорожек (сигналы с разными зернами) против отдельных контекстов. Последняя дорожка
+ * отсоединяется посередине и начинает новый поток (кроме синтеза КИХ-фильтром, см. hsvb_attach), а остальные
+ * отсоединяются по окончании своих потоков.
+ * \return 0 при совпадении, 1 при отличии, иначе код ошибки.
+ */
+static int verify_batch(const struct HSV_CONFIG*conf, enum SIGNAL_TYPE signal, unsigned seconds, unsigned lanes, struct VERIFY_STREAM*vss)
+{
+	struct HSV_BATCH_CONFIG batch_conf;
+
+	hsvb_t hsvb;
+
+	enum HSV_CODE hsv_r;
+
+	unsigned long long*smpls, *limits, n_smpls, half;
+	uint32_t*seeds;
+	int*attached;
+
+	unsigned data_len;
+	unsigned l, last;
+
+	int r, bad, progress, reattach;
+
+	memset(&batch_conf, '\0', sizeof(batch_conf));
+	batch_conf.stream = *conf;
+	batch_conf.lanes = lanes;
+
+	n_smpls = ((unsigned long long) seconds) * conf->sr;
+	half = n_smpls / 2;
+	last = lanes - 1;
+	reattach = (conf->synthesis != HSV_SYNTHESIS_MODE_FIR);
+
+	smpls = (unsigned long long*) calloc(lanes, sizeof(unsigned long long));
+	limits = (unsigned long long*) calloc(lanes, sizeof(unsigned long long));
+	seeds = (uint32_t*) calloc(lanes, sizeof(uint32_t));
+	attached = (int*) calloc(lanes, sizeof(int));
+	if ((smpls == NULL) || (limits == NULL) || (seeds == NULL) || (attached == NULL)) {
+		r = 3;
+		goto err0;
+	}
+
+	for (l = 0; l < lanes; l++) {
+		vss[l].expected_len = 0;
+		vss[l].out_len = 0;
+		seeds[l] = l + 1;
+		limits[l] = (reattach && (l == last)) ? half : n_smpls;
+		attached[l] = 1;
+		r = verify_reference(conf, signal, limits[l], seeds[l], 1, vss + l);
+		if (r != 0) {
+			LOG("\"hsv\" context error (%d)!\n", r);
+			r = 5;
+			goto err0;
+		}
+	}
+	if (reattach) {
+		r = verify_reference(conf, signal, n_smpls - half, lanes + 1, 1, vss + last);
+		if (r != 0) {
+			LOG("\"hsv\" context error (%d)!\n", r);
+			r = 5;
+			goto err0;
+		}
+	}
+
+	hsvb = create_hsvb();
+	if (hsvb == NULL) {
+		r = 3;
+		goto err0;
+	}
+	hsv_r = hsvb_config(hsvb, &batch_conf);
+	if (hsv_r != HSV_CODE_OK) {
+		LOG("Unable to configure \"hsv\" batch (%d)!\n", (int) hsv_r);
+		r = 4;
+		goto err1;
+	}
+
+	do {
+		progress = 0;
+		for (l = 0; l < lanes; l++) {
+			if (attached[l]) {
+				data_len = gen_chunk(conf, signal, smpls + l, limits[l], seeds + l);
+				if (data_len != 0) {
+					r = hsvb_push(hsvb, l, buf_in, data_len);
+					if (r < 0) {
+						LOG("\"hsv\" batch error (%d)!\n", r);
+						r = 5;
+						goto err2;
+					}
+				} else {
+					hsvb_detach(hsvb, l);
+					attached[l] = 0;
+				}
+				progress = 1;
+			} else if (reattach && (l == last)) {
+				/* Новый поток начинается, когда выход прошлого обработан. */
+				hsv_r = hsvb_attach(hsvb, l);
+				if (hsv_r == HSV_CODE_OK) {
+					smpls[l] = 0;
+					limits[l] = n_smpls - half;
+					seeds[l] = lanes + 1;
+					attached[l] = 1;
+					reattach = 0;
+				} else if (hsv_r != HSV_CODE_OVERFLOW_ERR) {
+					LOG("\"hsv\" batch error (%d)!\n", (int) hsv_r);
+					r = 5;
+					goto err2;
+				}
+				progress = 1;
+			}
+			verify_get_hsvb(hsvb, l, vss + l);
+		}
+	} while (progress);
+
+	hsvb_flush(hsvb);
+	for (l = 0; l < lanes; l++) {
+		verify_get_hsvb(hsvb, l, vss + l);
+	}
+
+	bad = 0;
+	for (l = 0; l < lanes; l++) {
+		bad |= verify_compare("Batch lane", l, vss + l);
+	}
+	r = bad;
+
+ err2:
+	hsvb_deconfig(hsvb);
+ err1:
+	hsvb_free(hsvb);
+ err0:
+	free(attached);
+	free(seeds);
+	free(limits);
+	free(smpls);
+	return r;
+}
+
+/**
+ * Проверка совпадения выхода движка и пакета с отдельными контекстами бит в бит. Не проверяется HSV_SPLIT_MODE_TRACKED,
+ * выход которого зависит от размеров подач, а пакет - и для ctrl_period больше 1 (см. hsvb_config).
+ * \return 0 при совпадении, 1 при отличии, иначе код ошибки.
+ */
+static int run_verify(const struct HSV_CONFIG*conf, enum SIGNAL_TYPE signal, unsigned seconds, unsigned n_streams, unsigned lanes)
+{
+	struct HSV_BATCH_CONFIG batch_conf;
+
+	struct VERIFY_STREAM*vss;
+
+	unsigned n_vss, cap, i;
+
+	int r, bad;
+
+	r = hsvc_validate_config(conf);
+	if ((enum HSV_CODE) r != HSV_CODE_OK) {
+		LOG("Invalid configuration in parameter (%d)\n", r);
+		return 2;
+	}
+	if (conf->split == HSV_SPLIT_MODE_TRACKED) {
+		LOG("Output of --split tracked depends on the sizes of pushes: not checked\n");
+		return 0;
+	}
+
+	n_vss = (n_streams > lanes) ? n_streams : lanes;
+	cap = seconds * conf->sr * 2 * conf->ch;
+
+	vss = (struct VERIFY_STREAM*) calloc(n_vss, sizeof(struct VERIFY_STREAM));
+	if (vss == NULL) {
+		return 3;
+	}
+	for (i = 0; i < n_vss; i++) {
+		vss[i].cap = cap;
+		vss[i].expected = (char*) malloc(cap);
+		vss[i].out = (char*) malloc(cap);
+		if ((vss[i].expected == NULL) || (vss[i].out == NULL)) {
+			r = 3;
+			goto err0;
+		}
+	}
+
+	r = verify_engine(conf, signal, seconds, n_streams, vss);
+	if (r > 1) {
+		goto err0;
+	}
+	LOG("Engine: %u streams %s\n", n_streams, (r == 0) ? "match separate contexts" : "DIFFER");
+	bad = r;
+
+	memset(&batch_conf, '\0', sizeof(batch_conf));
+	batch_conf.stream = *conf;
+	batch_conf.lanes = lanes;
+	if ((conf->ctrl_period > 1) || (hsvb_validate_config(&batch_conf) != 0)) {
+		LOG("Batch:  not checked for this configuration\n");
+	} else {
+		r = verify_batch(conf, signal, seconds, lanes, vss);
+		if (r > 1) {
+			goto err0;
+		}
+		LOG("Batch:  %u lanes %s\n", lanes, (r == 0) ? "match separate contexts" : "DIFFER");
+		bad |= r;
+	}
+
+	r = bad;
+
+ err0:
+	for (i = 0; i < n_vss; i++) {
+		free(vss[i].expected);
+		free(vss[i].out);
+	}
+	free(vss);
+	return r;
+}
+
+int main(int argc, char**argv)
+{
+	int i;
+
+	int r;
+
+	enum HSV_CODE hsv_r;
+
+	struct HSV_CONFIG conf;
+
+	struct HSV_MEMORY_USAGE usage;
+
+	struct BENCH_RESULT res;
+
+	hsvc_t hsvc;
+
+	enum SIGNAL_TYPE signal = SIGNAL_TYPE_NOISE;
+	unsigned seconds = DEFAULT_SECONDS;
+	int ch_sweep = 0;
+	int engine_sweep = 0;
+	unsigned n_streams = DEFAULT_STREAMS;
+	int batch_density = 0;
+	unsigned lanes = HSV_DEFAULT_BATCH_LANES;
+	int verify = 0;
+
+	memset(&conf, '\0', sizeof(conf));
+	conf.sr = DEFAULT_SAMPLE_RATE;
+	conf.ch = DEFAULT_CHANNELS;
+	conf.bs = BS;
+	conf.mode = HSV_SUPPRESSOR_MODE_TSNR;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--specsub") == 0) {
+			conf.mode = HSV_SUPPRESSOR_MODE_SPECSUB;
+		} else if (strcmp(argv[i], "--wiener") == 0) {
+			conf.mode = HSV_SUPPRESSOR_MODE_WIENER;
+		} else if (strcmp(argv[i], "--tsnr") == 0) {
+			conf.mode = HSV_SUPPRESSOR_MODE_TSNR;
+		} else if (strcmp(argv[i], "--tsnrg") == 0) {
+			conf.mode = HSV_SUPPRESSOR_MODE_TSNR_G;
+		} else if (strcmp(argv[i], "--rtsnr") == 0) {
+			conf.mode = HSV_SUPPRESSOR_MODE_RTSNR;
+		} else if (strcmp(argv[i], "--rtsnrg") == 0) {
+			conf.mode = HSV_SUPPRESSOR_MODE_RTSNR_G;
+		} else if (strcmp(argv[i], "--bark") == 0) {
+			conf.mode = HSV_SUPPRESSOR_MODE_BARK;
+		} else if ((strcmp(argv[i], "--signal") == 0) && (i + 1 < argc)) {
+			i++;
+			if (strcmp(argv[i], "noise") == 0) {
+				signal = SIGNAL_TYPE_NOISE;
+			} else if (strcmp(argv[i], "silence") == 0) {
+				signal = SIGNAL_TYPE_SILENCE;
+			} else if (strcmp(argv[i], "sparse") == 0) {
+				signal = SIGNAL_TYPE_SPARSE;
+			} else if (strcmp(argv[i], "fade") == 0) {
+				signal = SIGNAL_TYPE_FADE;
+			} else if (strcmp(argv[i], "quiet") == 0) {
+				signal = SIGNAL_TYPE_QUIET;
+			} else {
+				print_usage(argv[0]);
+				return 1;
+			}
+		} else if ((strcmp(argv[i], "--seconds") == 0) && (i + 1 < argc)) {
+			seconds = (unsigned) atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "--sr") == 0) && (i + 1 < argc)) {
+			conf.sr = (unsigned) atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "--ch") == 0) && (i + 1 < argc)) {
+			conf.ch = (unsigned) atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--ch-sweep") == 0) {
+			ch_sweep = 1;
+		} else if (strcmp(argv[i], "--bypass-silence") == 0) {
+			conf.bypass = HSV_BYPASS_MODE_SILENCE;
+		} else if (strcmp(argv[i], "--bypass-spp") == 0) {
+			conf.bypass = HSV_BYPASS_MODE_SPP;
+		} else if ((strcmp(argv[i], "--ctrl-period") == 0) && (i + 1 < argc)) {
+			conf.ctrl_period = (unsigned) atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "--ctrl-mode") == 0) && (i + 1 < argc)) {
+			i++;
+			if (strcmp(argv[i], "hold") == 0) {
+				conf.ctrl_mode = HSV_CTRL_MODE_HOLD;
+			} else if (strcmp(argv[i], "interp") == 0) {
+				conf.ctrl_mode = HSV_CTRL_MODE_INTERP;
+			} else if (strcmp(argv[i], "estimator") == 0) {
+				conf.ctrl_mode = HSV_CTRL_MODE_ESTIMATOR;
+			} else if (strcmp(argv[i], "stagger") == 0) {
+				conf.ctrl_mode = HSV_CTRL_MODE_STAGGER;
+			} else {
+				print_usage(argv[0]);
+				return 1;
+			}
+		} else if ((strcmp(argv[i], "--link") == 0) && (i + 1 < argc)) {
+			i++;
+			if (strcmp(argv[i], "mid") == 0) {
+				conf.link = HSV_LINK_MODE_MID;
+			} else if (strcmp(argv[i], "max") == 0) {
+				conf.link = HSV_LINK_MODE_MAX;
+			} else {
+				print_usage(argv[0]);
+				return 1;
+			}
+		} else if ((strcmp(argv[i], "--split") == 0) && (i + 1 < argc)) {
+			i++;
+			if (strcmp(argv[i], "fixed") == 0) {
+				conf.split = HSV_SPLIT_MODE_FIXED;
+			} else if (strcmp(argv[i], "tracked") == 0) {
+				conf.split = HSV_SPLIT_MODE_TRACKED;
+			} else {
+				print_usage(argv[0]);
+				return 1;
+			}
+		} else if ((strcmp(argv[i], "--bands") == 0) && (i + 1 < argc)) {
+			conf.n_bands = (unsigned) atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--wola") == 0) {
+			conf.filterbank = HSV_FILTERBANK_MODE_WOLA;
+		} else if ((strcmp(argv[i], "--window") == 0) && (i + 1 < argc)) {
+			i++;
+			if (strcmp(argv[i], "sqrt-hann") == 0) {
+				conf.window = HSV_WINDOW_MODE_SQRT_HANNING;
+			} else if (strcmp(argv[i], "vorbis") == 0) {
+				conf.window = HSV_WINDOW_MODE_VORBIS;
+			} else if (strcmp(argv[i], "kbd") == 0) {
+				conf.window = HSV_WINDOW_MODE_KBD;
+			} else if (strcmp(argv[i], "low-delay") == 0) {
+				conf.window = HSV_WINDOW_MODE_LOW_DELAY;
+			} else {
+				print_usage(argv[0]);
+				return 1;
+			}
+		} else if ((strcmp(argv[i], "--overlap") == 0) && (i + 1 < argc)) {
+			conf.overlap_perc = (unsigned) atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "--frame") == 0) && (i + 1 < argc)) {
+			conf.frame_size_smpls = (unsigned) atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "--dft") == 0) && (i + 1 < argc)) {
+			conf.dft_size_smpls = (unsigned) atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--fir") == 0) {
+			conf.synthesis = HSV_SYNTHESIS_MODE_FIR;
+		} else if ((strcmp(argv[i], "--fir-delay") == 0) && (i + 1 < argc)) {
+			conf.fir_delay_smpls = (unsigned) atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "--precision") == 0) && (i + 1 < argc)) {
+			i++;
+			if (strcmp(argv[i], "float") == 0) {
+				conf.precision = HSV_PRECISION_MODE_FLOAT;
+			} else if (strcmp(argv[i], "double") == 0) {
+				conf.precision = HSV_PRECISION_MODE_DOUBLE;
+			} else if (strcmp(argv[i], "long-double") == 0) {
+				conf.precision = HSV_PRECISION_MODE_LONG_DOUBLE;
+			} else if (strcmp(argv[i], "fixed") == 0) {
+				conf.precision = HSV_PRECISION_MODE_FIXED;
+			} else {
+				print_usage(argv[0]);
+				return 2;
+			}
+		} else if (strcmp(argv[i], "--fast-math") == 0) {
+			conf.math = HSV_MATH_MODE_FAST;
+		} else if (strcmp(argv[i], "--protect-denormals") == 0) {
+			conf.denormal = HSV_DENORMAL_MODE_PROTECT;
+		} else if ((strcmp(argv[i], "--storage") == 0) && (i + 1 < argc)) {
+			i++;
+			if (strcmp(argv[i], "native") == 0) {
+				conf.storage = HSV_STORAGE_MODE_NATIVE;
+			} else if (strcmp(argv[i], "fp16") == 0) {
+				conf.storage = HSV_STORAGE_MODE_FP16;
+			} else if (strcmp(argv[i], "bf16") == 0) {
+				conf.storage = HSV_STORAGE_MODE_BF16;
+			} else {
+				print_usage(argv[0]);
+				return 2;
+			}
+		} else if ((strcmp(argv[i], "--threads") == 0) && (i + 1 < argc)) {
+			conf.threads = (unsigned) atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--engine-sweep") == 0) {
+			engine_sweep = 1;
+		} else if ((strcmp(argv[i], "--streams") == 0) && (i + 1 < argc)) {
+			n_streams = (unsigned) atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--batch-density") == 0) {
+			batch_density = 1;
+		} else if ((strcmp(argv[i], "--lanes") == 0) && (i + 1 < argc)) {
+			lanes = (unsigned) atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--verify") == 0) {
+			verify = 1;
+		} else {
+			print_usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (ch_sweep) {
+		return run_sweep(&conf, signal, seconds);
+	}
+	if (engine_sweep) {
+		return run_engine_sweep(&conf, signal, seconds, n_streams);
+	}
+	if (batch_density) {
+		return run_batch_density(&conf, signal, seconds, lanes);
+	}
+	if (verify) {
+		return run_verify(&conf, signal, seconds, n_streams, lanes);
+	}
+
+	r = hsvc_validate_config(&conf);
+	if ((enum HSV_CODE) r != HSV_CODE_OK) {
+		LOG("Invalid configuration in parameter (%d)\n", r);
+		return 2;
+	}
+
+	hsvc = create_hsvc();
+	if (hsvc == NULL) {
+		LOG("Unable to create \"hsv\" context!\n");
+		return 3;
+	}
+
+	hsv_r = hsvc_config(hsvc, &conf);
+	if (hsv_r != HSV_CODE_OK) {
+		LOG("Unable to configure \"hsv\" context (%d)!\n", (int) hsv_r);
+		hsvc_free(hsvc);
+		return 4;
+	}
+
+	r = run_bench(hsvc, &conf, signal, seconds, &res);
+	if (r != 0) {
+		LOG("\"hsv\" context error (%d)!\n", r);
+		r = 5;
+		goto err0;
+	}
+
+	LOG("Proc time elapsed: %.2lf ms\n", res.proc_ms);
+	LOG("Real time elapsed: %.2lf ms\n", res.real_ms);
+	LOG("Real-time factor:  %.1lfx\n", ((double) seconds) * 1000.0 / res.real_ms);
+	LOG("Latency:           %u smpls (%.2lf ms)\n", hsvc_get_latency(hsvc), hsvc_get_latency(hsvc) * 1000.0 / conf.sr);
+	LOG("Cost per second:   min %.2lf ms, max %.2lf ms, last %.2lf ms\n", res.sec_min_ms, res.sec_max_ms, res.sec_last_ms);
+	LOG("CPU level:         %s\n", hsvc_get_cpu_level(hsvc));
+	LOG("Arena size:        %lu bytes\n", (unsigned long) hsvc_get_arena_size(&conf));
+	if (hsvc_get_memory_usage(&conf, &usage) == HSV_CODE_OK) {
+		LOG("Memory per stream: %lu bytes, %lu bytes with shared scratch (%lu bytes per thread)\n",
+			(unsigned long) (usage.state + usage.scratch), (unsigned long) usage.state, (unsigned long) usage.scratch);
+	}
+
+	r = 0;
+
+ err0:
+	hsvc_deconfig(hsvc);
+	hsvc_free(hsvc);
+
+	return r;
+}
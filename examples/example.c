@@ -1,4 +1,5 @@
 #include "hsv.h"
+#include "hsv_offline.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -35,7 +36,7 @@ static void LOG(const char*format, ...)
 
 static void print_usage(const char*prog_name)
 {
-	LOG("Usage: %s --mode input_file.wav output_file.wav\n", prog_name);
+	LOG("Usage: %s --mode [options] input_file.wav output_file.wav\n", prog_name);
 	LOG("Example: %s --wiener data/in/car_ns.wav data/out/car_ns.wav\n", prog_name);
 	LOG("Modes:\n");
 	LOG("      --specsub - Berouti-Schwartz spectral subtraction.\n");
@@ -44,6 +45,35 @@ static void print_usage(const char*prog_name)
 	LOG("      --tsnrg   - Scalart's two-steps noise reduction with gain.\n");
 	LOG("      --rtsnr   - Shifeng's two-steps noise reduction.\n");
 	LOG("      --rtsnrg  - Shifeng's two-steps noise reduction with gain.\n");
+	LOG("      --bark    - Scalart's wiener filtering in critical bands.\n");
+	LOG("Options:\n");
+	LOG("      --sr N           - sample rate of input file (default %d).\n", SAMPLE_RATE);
+	LOG("      --ch N           - channels in input file (default %d).\n", CHANNELS);
+	LOG("      --bypass-silence - copy silent frames without processing.\n");
+	LOG("      --bypass-spp     - also attenuate frames without speech without suppression.\n");
+	LOG("      --bypass-gain N  - attenuation of frames without speech for --bypass-spp in percent (default %d, 0 - mute).\n", HSV_DEFAULT_BYPASS_GAIN_PERC);
+	LOG("      --ctrl-period N  - update noise estimate (and gains) every N-th frame.\n");
+	LOG("      --ctrl-mode M    - hold|interp|estimator|stagger (default hold).\n");
+	LOG("      --link M         - mid|max: one noise estimate and gain for all channels.\n");
+	LOG("      --split M        - fixed|tracked: process only the decimated low band at high sample rates.\n");
+	LOG("      --bands N        - number of critical bands for --bark (default %d).\n", HSV_DEFAULT_BANDS);
+	LOG("      --wola           - weighted overlap-add filterbank instead of zero-padded STFT.\n");
+	LOG("      --window W       - sqrt-hann|vorbis|kbd: power-complementary analysis/synthesis window pair,\n");
+	LOG("                         low-delay: asymmetric windows with 2 * step delay.\n");
+	LOG("      --overlap N      - frame overlap in percent.\n");
+	LOG("      --frame N        - frame size in samples (default 20 ms).\n");
+	LOG("      --dft N          - DFT size in samples (default 2 * frame).\n");
+	LOG("      --fir            - apply gains with a short linear-phase FIR (side-chain analysis).\n");
+	LOG("      --fir-delay N    - FIR group delay in samples (default 8 ms, at most (frame - 1) / 2).\n");
+	LOG("      --precision P    - float|double|long-double|fixed: numeric precision of processing.\n");
+	LOG("      --fast-math      - polynomial approximations instead of libm (phase, sin/cos, pow, log10).\n");
+	LOG("      --protect-denormals - flush denormals to zero and floor recursive spectra on silence.\n");
+	LOG("      --storage S         - native|fp16|bf16: storage format of recursive noise and speech spectra between frames.\n");
+	LOG("      --threads N         - process the channels of the context in N threads (including the calling one).\n");
+	LOG("      --arena          - allocate all context buffers in one caller-supplied memory block.\n");
+	LOG("      --scratch        - allocate per-stream state and reusable scratch in separate caller-supplied blocks.\n");
+	LOG("      --offline N      - read the whole file and process N parts of it in N threads, crossfading the seams.\n");
+	LOG("      --warmup N       - warm-up of each --offline part on the preceding audio in ms (default %d).\n", HSV_DEFAULT_OFFLINE_WARMUP_MS);
 }
 
 #define SWITCH_HSVC_CODE(hsv_r, r_str)									\
@@ -71,17 +101,131 @@ static void print_usage(const char*prog_name)
 		}																\
 	} while (0)
 
+static void log_elapsed(clock_t proc_start_time, const struct timeval*unix_start_time)
+{
+	clock_t proc_end_time;
+	clock_t proc_elapsed_time;
+
+	struct timeval unix_end_time;
+	unsigned long long unix_elapsed_time;
+
+	proc_end_time = clock();
+	gettimeofday(&unix_end_time, NULL);
+
+	proc_elapsed_time = proc_end_time - proc_start_time;
+	LOG("Proc time elapsed: %.2lf ms\n",
+		((double) proc_elapsed_time) / CLOCKS_PER_SEC * 1000.0);
+
+	unix_elapsed_time = ((unsigned long long)(unix_end_time.tv_sec) * 1000 * 1000 +
+						 (unsigned long long)(unix_end_time.tv_usec)) -
+		((unsigned long long)(unix_start_time->tv_sec) * 1000 * 1000 +
+		 (unsigned long long)(unix_start_time->tv_usec));
+	LOG("Real time elapsed: %.2lf ms\n",
+		((double) unix_elapsed_time) / 1000.0);
+}
+
+/**
+ * Обработка файла целиком в памяти (hsvo_process).
+ */
+static int run_offline(const struct HSV_CONFIG*conf, const struct HSV_OFFLINE_CONFIG*offline_conf,
+					   const char*fname_in, const char*fname_out, const char**r_str)
+{
+	int r;
+
+	enum HSV_CODE hsv_r;
+
+	FILE*f_in;
+	FILE*f_out;
+
+	long file_len;
+	size_t data_len;
+	char*data;
+	char*out;
+
+	f_in = fopen(fname_in, "rb");
+	if (f_in == NULL) {
+		*r_str = "Unable to open input \"wav\" file!";
+		r = 6;
+		goto err0;
+	}
+	f_out = fopen(fname_out, "wb");
+	if (f_out == NULL) {
+		*r_str = "Unable to open input \"wav\" file!";
+		r = 7;
+		goto err1;
+	}
+
+	if (fread(wav_header_buf, sizeof(char), WAV_HEADER_LEN, f_in) < WAV_HEADER_LEN) {
+		*r_str = "Unable to read \"wav\" header!";
+		r = 8;
+		goto err2;
+	}
+	fseek(f_in, 0, SEEK_END);
+	file_len = ftell(f_in);
+	fseek(f_in, WAV_HEADER_LEN, SEEK_SET);
+	data_len = (size_t) file_len - WAV_HEADER_LEN;
+
+	data = (char*) malloc(data_len + 1);
+	out = (char*) malloc(data_len + 1);
+	if ((data == NULL) || (out == NULL)) {
+		*r_str = "Unable to allocate file buffers!";
+		r = 5;
+		goto err3;
+	}
+	data_len = fread(data, sizeof(char), data_len, f_in);
+
+	hsv_r = hsvo_process(conf, offline_conf, data, data_len, out);
+	if (hsv_r != HSV_CODE_OK) {
+		SWITCH_HSVC_CODE(hsv_r, *r_str);
+		r = 8;
+		goto err3;
+	}
+
+	fwrite(wav_header_buf, sizeof(char), WAV_HEADER_LEN, f_out);
+	fwrite(out, sizeof(char), data_len, f_out);
+
+	free(out);
+	free(data);
+	fclose(f_out);
+	fclose(f_in);
+
+	return 0;
+
+ err3:
+	free(out);
+	free(data);
+ err2:
+	fclose(f_out);
+ err1:
+	fclose(f_in);
+ err0:
+	return r;
+}
+
 int main(int argc, char**argv)
 {
 	int r;
 	const char*r_str = NULL;
 
+	int i;
+
 	enum HSV_CODE hsv_r;
 
 	struct HSV_CONFIG conf;
+	struct HSV_OFFLINE_CONFIG offline_conf;
 	
 	hsvc_t hsvc;
 
+	int bypass_mute = 0;
+
+	int user_arena = 0;
+	size_t arena_size;
+	void*arena_mem = NULL;
+
+	int user_scratch = 0;
+	struct HSV_MEMORY_USAGE usage;
+	void*scratch_mem = NULL;
+
 	const char*mode;
 
 	const char*fname_in;
@@ -95,12 +239,7 @@ int main(int argc, char**argv)
 	int processed;
 
 	clock_t proc_start_time;
-	clock_t proc_end_time;
-	clock_t proc_elapsed_time;
-
 	struct timeval unix_start_time;
-	struct timeval unix_end_time;
-	unsigned long long unix_elapsed_time;
 	
 	if (argc < 4) {
 		print_usage(argv[0]);
@@ -109,14 +248,16 @@ int main(int argc, char**argv)
 
 	mode = argv[1];
 	
-	fname_in = argv[2];
-	fname_out = argv[3];
+	fname_in = argv[argc - 2];
+	fname_out = argv[argc - 1];
 
 	memset(&conf, '\0', sizeof(conf));
 	conf.sr = SAMPLE_RATE;
 	conf.ch = CHANNELS;
 	conf.bs = BS;
 
+	memset(&offline_conf, '\0', sizeof(offline_conf));
+
 	if (strcmp(mode, "--specsub") == 0) {
 		conf.mode = HSV_SUPPRESSOR_MODE_SPECSUB;
 	} else if (strcmp(mode, "--wiener") == 0) {
@@ -129,11 +270,140 @@ int main(int argc, char**argv)
 		conf.mode = HSV_SUPPRESSOR_MODE_RTSNR;
 	} else if (strcmp(mode, "--rtsnrg") == 0) {
 		conf.mode = HSV_SUPPRESSOR_MODE_RTSNR_G;
+	} else if (strcmp(mode, "--bark") == 0) {
+		conf.mode = HSV_SUPPRESSOR_MODE_BARK;
 	} else {
 		print_usage(argv[0]);
 		return 2;
 	}
 
+	for (i = 2; i < argc - 2; i++) {
+		if ((strcmp(argv[i], "--sr") == 0) && (i + 1 < argc - 2)) {
+			conf.sr = (unsigned) atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "--ch") == 0) && (i + 1 < argc - 2)) {
+			conf.ch = (unsigned) atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--bypass-silence") == 0) {
+			conf.bypass = HSV_BYPASS_MODE_SILENCE;
+		} else if (strcmp(argv[i], "--bypass-spp") == 0) {
+			conf.bypass = HSV_BYPASS_MODE_SPP;
+		} else if ((strcmp(argv[i], "--bypass-gain") == 0) && (i + 1 < argc - 2)) {
+			conf.bypass_gain_perc = (unsigned) atoi(argv[++i]);
+			bypass_mute = (conf.bypass_gain_perc == 0);
+		} else if ((strcmp(argv[i], "--ctrl-period") == 0) && (i + 1 < argc - 2)) {
+			conf.ctrl_period = (unsigned) atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "--ctrl-mode") == 0) && (i + 1 < argc - 2)) {
+			i++;
+			if (strcmp(argv[i], "hold") == 0) {
+				conf.ctrl_mode = HSV_CTRL_MODE_HOLD;
+			} else if (strcmp(argv[i], "interp") == 0) {
+				conf.ctrl_mode = HSV_CTRL_MODE_INTERP;
+			} else if (strcmp(argv[i], "estimator") == 0) {
+				conf.ctrl_mode = HSV_CTRL_MODE_ESTIMATOR;
+			} else if (strcmp(argv[i], "stagger") == 0) {
+				conf.ctrl_mode = HSV_CTRL_MODE_STAGGER;
+			} else {
+				print_usage(argv[0]);
+				return 2;
+			}
+		} else if ((strcmp(argv[i], "--link") == 0) && (i + 1 < argc - 2)) {
+			i++;
+			if (strcmp(argv[i], "mid") == 0) {
+				conf.link = HSV_LINK_MODE_MID;
+			} else if (strcmp(argv[i], "max") == 0) {
+				conf.link = HSV_LINK_MODE_MAX;
+			} else {
+				print_usage(argv[0]);
+				return 2;
+			}
+		} else if ((strcmp(argv[i], "--split") == 0) && (i + 1 < argc - 2)) {
+			i++;
+			if (strcmp(argv[i], "fixed") == 0) {
+				conf.split = HSV_SPLIT_MODE_FIXED;
+			} else if (strcmp(argv[i], "tracked") == 0) {
+				conf.split = HSV_SPLIT_MODE_TRACKED;
+			} else {
+				print_usage(argv[0]);
+				return 2;
+			}
+		} else if ((strcmp(argv[i], "--bands") == 0) && (i + 1 < argc - 2)) {
+			conf.n_bands = (unsigned) atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--wola") == 0) {
+			conf.filterbank = HSV_FILTERBANK_MODE_WOLA;
+		} else if ((strcmp(argv[i], "--window") == 0) && (i + 1 < argc - 2)) {
+			i++;
+			if (strcmp(argv[i], "sqrt-hann") == 0) {
+				conf.window = HSV_WINDOW_MODE_SQRT_HANNING;
+			} else if (strcmp(argv[i], "vorbis") == 0) {
+				conf.window = HSV_WINDOW_MODE_VORBIS;
+			} else if (strcmp(argv[i], "kbd") == 0) {
+				conf.window = HSV_WINDOW_MODE_KBD;
+			} else if (strcmp(argv[i], "low-delay") == 0) {
+				conf.window = HSV_WINDOW_MODE_LOW_DELAY;
+			} else {
+				print_usage(argv[0]);
+				return 2;
+			}
+		} else if ((strcmp(argv[i], "--overlap") == 0) && (i + 1 < argc - 2)) {
+			conf.overlap_perc = (unsigned) atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "--frame") == 0) && (i + 1 < argc - 2)) {
+			conf.frame_size_smpls = (unsigned) atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "--dft") == 0) && (i + 1 < argc - 2)) {
+			conf.dft_size_smpls = (unsigned) atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--fir") == 0) {
+			conf.synthesis = HSV_SYNTHESIS_MODE_FIR;
+		} else if ((strcmp(argv[i], "--fir-delay") == 0) && (i + 1 < argc - 2)) {
+			conf.fir_delay_smpls = (unsigned) atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "--precision") == 0) && (i + 1 < argc - 2)) {
+			i++;
+			if (strcmp(argv[i], "float") == 0) {
+				conf.precision = HSV_PRECISION_MODE_FLOAT;
+			} else if (strcmp(argv[i], "double") == 0) {
+				conf.precision = HSV_PRECISION_MODE_DOUBLE;
+			} else if (strcmp(argv[i], "long-double") == 0) {
+				conf.precision = HSV_PRECISION_MODE_LONG_DOUBLE;
+			} else if (strcmp(argv[i], "fixed") == 0) {
+				conf.precision = HSV_PRECISION_MODE_FIXED;
+			} else {
+				print_usage(argv[0]);
+				return 2;
+			}
+		} else if (strcmp(argv[i], "--fast-math") == 0) {
+			conf.math = HSV_MATH_MODE_FAST;
+		} else if (strcmp(argv[i], "--protect-denormals") == 0) {
+			conf.denormal = HSV_DENORMAL_MODE_PROTECT;
+		} else if ((strcmp(argv[i], "--storage") == 0) && (i + 1 < argc - 2)) {
+			i++;
+			if (strcmp(argv[i], "native") == 0) {
+				conf.storage = HSV_STORAGE_MODE_NATIVE;
+			} else if (strcmp(argv[i], "fp16") == 0) {
+				conf.storage = HSV_STORAGE_MODE_FP16;
+			} else if (strcmp(argv[i], "bf16") == 0) {
+				conf.storage = HSV_STORAGE_MODE_BF16;
+			} else {
+				print_usage(argv[0]);
+				return 2;
+			}
+		} else if ((strcmp(argv[i], "--threads") == 0) && (i + 1 < argc - 2)) {
+			conf.threads = (unsigned) atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--arena") == 0) {
+			user_arena = 1;
+		} else if (strcmp(argv[i], "--scratch") == 0) {
+			user_scratch = 1;
+		} else if ((strcmp(argv[i], "--offline") == 0) && (i + 1 < argc - 2)) {
+			offline_conf.threads = (unsigned) atoi(argv[++i]);
+		} else if ((strcmp(argv[i], "--warmup") == 0) && (i + 1 < argc - 2)) {
+			offline_conf.warmup_ms = (unsigned) atoi(argv[++i]);
+		} else {
+			print_usage(argv[0]);
+			return 2;
+		}
+	}
+
+	/* Нулевое bypass_gain_perc означает значение по умолчанию, поэтому заглушение задается режимом. */
+	if (bypass_mute && (conf.bypass == HSV_BYPASS_MODE_SPP)) {
+		conf.bypass = HSV_BYPASS_MODE_MUTE;
+	}
+
 	r = hsvc_validate_config(&conf);
 	if ((enum HSV_CODE) r != HSV_CODE_OK) {
 		LOG("Invalid configuration in parameter (%d)\n", r);
@@ -143,6 +413,16 @@ int main(int argc, char**argv)
 	proc_start_time = clock();
 	gettimeofday(&unix_start_time, NULL);
 
+	if (offline_conf.threads != HSV_DEFAULT) {
+		r = run_offline(&conf, &offline_conf, fname_in, fname_out, &r_str);
+		if (r != 0) {
+			LOG("%s\n", r_str);
+			return r;
+		}
+		log_elapsed(proc_start_time, &unix_start_time);
+		return 0;
+	}
+
 	hsvc = create_hsvc();
 	if (hsvc == NULL) {
 		r_str = "Unable to create \"hsv\" context!";
@@ -150,7 +430,32 @@ int main(int argc, char**argv)
 		goto err0;
 	}
 
-	hsv_r = hsvc_config(hsvc, &conf);
+	if (user_arena) {
+		arena_size = hsvc_get_arena_size(&conf);
+		arena_mem = malloc(arena_size);
+		if ((arena_size == 0) || (arena_mem == NULL)) {
+			r_str = "Unable to allocate \"hsv\" arena!";
+			r = 5;
+			goto err1;
+		}
+		LOG("Arena size: %lu bytes\n", (unsigned long) arena_size);
+		hsv_r = hsvc_config_arena(hsvc, &conf, arena_mem, arena_size);
+	} else if (user_scratch) {
+		hsv_r = hsvc_get_memory_usage(&conf, &usage);
+		if (hsv_r == HSV_CODE_OK) {
+			arena_mem = malloc(usage.state);
+			scratch_mem = malloc(usage.scratch);
+			if ((arena_mem == NULL) || (scratch_mem == NULL)) {
+				r_str = "Unable to allocate \"hsv\" arena!";
+				r = 5;
+				goto err1;
+			}
+			LOG("State size: %lu bytes, scratch size: %lu bytes\n", (unsigned long) usage.state, (unsigned long) usage.scratch);
+			hsv_r = hsvc_config_shared(hsvc, &conf, arena_mem, usage.state, scratch_mem, usage.scratch);
+		}
+	} else {
+		hsv_r = hsvc_config(hsvc, &conf);
+	}
 	if (hsv_r != HSV_CODE_OK) {
 		SWITCH_HSVC_CODE(hsv_r, r_str);
 		r = 5;
@@ -205,21 +510,11 @@ int main(int argc, char**argv)
 	fclose(f_in);
 
 	hsvc_deconfig(hsvc);
+	free(scratch_mem);
+	free(arena_mem);
 	hsvc_free(hsvc);
 
-	proc_end_time = clock();
-	gettimeofday(&unix_end_time, NULL);
-
-	proc_elapsed_time = proc_end_time - proc_start_time;
-	LOG("Proc time elapsed: %.2lf ms\n",
-		((double) proc_elapsed_time) / CLOCKS_PER_SEC * 1000.0);
-
-	unix_elapsed_time = ((unsigned long long)(unix_end_time.tv_sec) * 1000 * 1000 +
-						 (unsigned long long)(unix_end_time.tv_usec)) -
-		((unsigned long long)(unix_start_time.tv_sec) * 1000 * 1000 +
-		 (unsigned long long)(unix_start_time.tv_usec));
-	LOG("Real time elapsed: %.2lf ms\n",
-		((double) unix_elapsed_time) / 1000.0);
+	log_elapsed(proc_start_time, &unix_start_time);
 
 	return 0;
 
@@ -230,6 +525,8 @@ int main(int argc, char**argv)
  err2:
 	hsvc_deconfig(hsvc);
  err1:
+	free(scratch_mem);
+	free(arena_mem);
 	hsvc_free(hsvc);
  err0:
 	LOG("%s\n", r_str);
@@ -0,0 +1,291 @@
+#include "fastmath.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#define N_POINTS 1048576
+#define N_REPEATS 64
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif	/* M_PI */
+
+static hsv_numeric_t x[N_POINTS];
+static hsv_numeric_t y[N_POINTS];
+static hsv_numeric_t out0[N_POINTS];
+static hsv_numeric_t out1[N_POINTS];
+static hsv_numeric_t cos0[N_POINTS];
+static hsv_numeric_t cos1[N_POINTS];
+
+static volatile hsv_numeric_t sink;
+
+/* Вызовы через указатели не векторизуются (libmvec): скалярная libm, как при сборке без -Ofast или для long double. */
+static float (*volatile scalar_atan2f)(float, float) = atan2f;
+static float (*volatile scalar_sinf)(float) = sinf;
+static float (*volatile scalar_cosf)(float) = cosf;
+static float (*volatile scalar_log10f)(float) = log10f;
+static float (*volatile scalar_powf)(float, float) = powf;
+
+static void LOG(const char*format, ...)
+{
+	va_list var_args;
+
+	va_start(var_args, format);
+	vfprintf(stderr, format, var_args);
+	va_end(var_args);
+}
+
+static double cpu_ns()
+{
+	return (double) clock() * 1e9 / CLOCKS_PER_SEC;
+}
+
+/**
+ * Максимальная погрешность out1 относительно эталона out0: абсолютная и относительная.
+ */
+static void max_err(const hsv_numeric_t*ref, const hsv_numeric_t*val, unsigned n, double*abs_err, double*rel_err)
+{
+	unsigned i;
+
+	*abs_err = 0.0;
+	*rel_err = 0.0;
+	for (i = 0; i < n; i++) {
+		double d = fabs((double) val[i] - (double) ref[i]);
+		if (d > *abs_err) {
+			*abs_err = d;
+		}
+		if ((ref[i] != 0.0) && (d / fabs((double) ref[i]) > *rel_err)) {
+			*rel_err = d / fabs((double) ref[i]);
+		}
+	}
+}
+
+static void report(const char*name, const char*range, double abs_err, double rel_err, double ns_scalar, double ns_libm, double ns_fast)
+{
+	LOG("%-8s %-15s %9.2e %9.2e %8.2f %8.2f %8.2f %7.2fx %7.2fx\n", name, range, abs_err, rel_err,
+		ns_scalar, ns_libm, ns_fast, ns_scalar / ns_fast, ns_libm / ns_fast);
+}
+
+static void libm_atan2(void)
+{
+	unsigned i;
+
+	for (i = 0; i < N_POINTS; i++) {
+		out0[i] = atan2f(y[i], x[i]);
+	}
+}
+
+static void scalar_atan2(void)
+{
+	unsigned i;
+
+	for (i = 0; i < N_POINTS; i++) {
+		out0[i] = scalar_atan2f(y[i], x[i]);
+	}
+}
+
+static void scalar_sincos(void)
+{
+	unsigned i;
+
+	for (i = 0; i < N_POINTS; i++) {
+		out0[i] = scalar_sinf(x[i]);
+		cos0[i] = scalar_cosf(x[i]);
+	}
+}
+
+static void scalar_log10(void)
+{
+	unsigned i;
+
+	for (i = 0; i < N_POINTS; i++) {
+		out0[i] = scalar_log10f(x[i]);
+	}
+}
+
+static void scalar_pow2(void)
+{
+	unsigned i;
+
+	for (i = 0; i < N_POINTS; i++) {
+		out0[i] = scalar_powf(x[i], 2.0);
+	}
+}
+
+static void scalar_pow05(void)
+{
+	unsigned i;
+
+	for (i = 0; i < N_POINTS; i++) {
+		out0[i] = scalar_powf(x[i], 0.5);
+	}
+}
+
+static void libm_sincos(void)
+{
+	unsigned i;
+
+	for (i = 0; i < N_POINTS; i++) {
+		out0[i] = sinf(x[i]);
+		cos0[i] = cosf(x[i]);
+	}
+}
+
+static void libm_log10(void)
+{
+	unsigned i;
+
+	for (i = 0; i < N_POINTS; i++) {
+		out0[i] = log10f(x[i]);
+	}
+}
+
+static void fast_log10(void)
+{
+	unsigned i;
+
+	for (i = 0; i < N_POINTS; i++) {
+		out1[i] = fastmath_log10(x[i]);
+	}
+}
+
+static void libm_pow2(void)
+{
+	unsigned i;
+
+	for (i = 0; i < N_POINTS; i++) {
+		out0[i] = powf(x[i], 2.0);
+	}
+}
+
+static void libm_pow05(void)
+{
+	unsigned i;
+
+	for (i = 0; i < N_POINTS; i++) {
+		out0[i] = powf(x[i], 0.5);
+	}
+}
+
+/**
+ * Время одного элемента в наносекундах (лучшее из N_REPEATS запусков).
+ */
+static double time_ns(void (*f)(void))
+{
+	unsigned r;
+
+	double best = 1e30;
+
+	for (r = 0; r < N_REPEATS; r++) {
+		double start = cpu_ns();
+		f();
+		double dur = cpu_ns() - start;
+		if (dur < best) {
+			best = dur;
+		}
+	}
+	sink = out0[N_POINTS / 2] + out1[N_POINTS / 2];
+
+	return best / N_POINTS;
+}
+
+static void fast_atan2(void)
+{
+	fastmath_atan2(y, x, out1, N_POINTS);
+}
+
+static void fast_sincos(void)
+{
+	fastmath_sincos(x, out1, cos1, N_POINTS);
+}
+
+static void fast_pow2(void)
+{
+	fastmath_pow(x, 2.0, out1, N_POINTS);
+}
+
+static void fast_pow05(void)
+{
+	fastmath_pow(x, 0.5, out1, N_POINTS);
+}
+
+int main()
+{
+	unsigned i;
+
+	double abs_err, abs_err_cos, rel_err;
+	double ns_scalar, ns_libm, ns_fast;
+
+	LOG("Accuracy against libm (float) and throughput, ns per element\n");
+	LOG("(scalar - libm calls, libm - loops as compiled, vectorized with libmvec if available):\n");
+	LOG("%-8s %-15s %9s %9s %8s %8s %8s %8s %8s\n", "func", "range", "max abs", "max rel", "scalar", "libm", "fast", "/scalar", "/libm");
+
+	/* atan2: углы по всей окружности, радиусы от 1e-6 до 1e6. */
+	for (i = 0; i < N_POINTS; i++) {
+		double a = 2.0 * M_PI * i / N_POINTS - M_PI;
+		double r = pow(10.0, 12.0 * ((i * 7919u) % N_POINTS) / N_POINTS - 6.0);
+		x[i] = r * cos(a);
+		y[i] = r * sin(a);
+	}
+	libm_atan2();
+	fast_atan2();
+	max_err(out0, out1, N_POINTS, &abs_err, &rel_err);
+	ns_scalar = time_ns(scalar_atan2);
+	ns_libm = time_ns(libm_atan2);
+	ns_fast = time_ns(fast_atan2);
+	report("atan2", "[-pi, pi]", abs_err, rel_err, ns_scalar, ns_libm, ns_fast);
+
+	/* sin и cos: фазы из calculate_phase_spec, с запасом. */
+	for (i = 0; i < N_POINTS; i++) {
+		x[i] = 4.0 * M_PI * i / N_POINTS - 2.0 * M_PI;
+	}
+	libm_sincos();
+	fast_sincos();
+	max_err(out0, out1, N_POINTS, &abs_err, &rel_err);
+	max_err(cos0, cos1, N_POINTS, &abs_err_cos, &rel_err);
+	abs_err = (abs_err_cos > abs_err) ? abs_err_cos : abs_err;
+	ns_scalar = time_ns(scalar_sincos);
+	ns_libm = time_ns(libm_sincos);
+	ns_fast = time_ns(fast_sincos);
+	report("sincos", "[-2 pi, 2 pi]", abs_err, NAN, ns_scalar, ns_libm, ns_fast);
+
+	/* log10: отношения мощностей спектрального вычитания. */
+	for (i = 0; i < N_POINTS; i++) {
+		x[i] = pow(10.0, 16.0 * i / N_POINTS - 8.0);
+	}
+	libm_log10();
+	fast_log10();
+	max_err(out0, out1, N_POINTS, &abs_err, &rel_err);
+	ns_scalar = time_ns(scalar_log10);
+	ns_libm = time_ns(libm_log10);
+	ns_fast = time_ns(fast_log10);
+	report("log10", "[1e-8, 1e8]", abs_err, NAN, ns_scalar, ns_libm, ns_fast);
+
+	/* Степени спектров амплитуд. */
+	for (i = 0; i < N_POINTS; i++) {
+		x[i] = pow(10.0, 12.0 * i / N_POINTS - 6.0);
+	}
+	libm_pow2();
+	fast_pow2();
+	max_err(out0, out1, N_POINTS, &abs_err, &rel_err);
+	ns_scalar = time_ns(scalar_pow2);
+	ns_libm = time_ns(libm_pow2);
+	ns_fast = time_ns(fast_pow2);
+	report("pow 2", "[1e-6, 1e6]", abs_err, rel_err, ns_scalar, ns_libm, ns_fast);
+
+	libm_pow05();
+	fast_pow05();
+	max_err(out0, out1, N_POINTS, &abs_err, &rel_err);
+	ns_scalar = time_ns(scalar_pow05);
+	ns_libm = time_ns(libm_pow05);
+	ns_fast = time_ns(fast_pow05);
+	report("pow 0.5", "[1e-6, 1e6]", abs_err, rel_err, ns_scalar, ns_libm, ns_fast);
+
+	return EXIT_SUCCESS;
+}
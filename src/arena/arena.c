@@ -0,0 +1,105 @@
+/**
+ * \file arena.c
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Реализация API арены памяти.
+ */
+/**
+ * \ingroup arena
+ * \{
+ */
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <inttypes.h>
+
+/**
+ * Округление размера вверх до кратного ARENA_ALIGN.
+ */
+static size_t arena_align(size_t size)
+{
+	return (size + ARENA_ALIGN - 1) & ~((size_t) ARENA_ALIGN - 1);
+}
+
+void arena_init(arena_t arena, void*mem, size_t mem_size)
+{
+	size_t shift;
+
+	arena->data = NULL;
+	arena->len = 0;
+	arena->peak = 0;
+	arena->cap = 0;
+
+	if (mem == NULL) {
+		return;
+	}
+
+	/* Начало арены выравнивается внутри переданной памяти. */
+	shift = arena_align((uintptr_t) mem) - (uintptr_t) mem;
+	if (shift > mem_size) {
+		return;
+	}
+
+	arena->data = (char*) mem + shift;
+	arena->cap = mem_size - shift;
+}
+
+size_t arena_mem_size(size_t len)
+{
+	return len + ARENA_ALIGN - 1;
+}
+
+void*arena_calloc(arena_t arena, size_t n, size_t size)
+{
+	size_t len = arena_align(n * size);
+
+	void*ptr;
+
+	if (arena->data == NULL) {
+		/* Измерение: буфер нужен только на время конфигурации. */
+		ptr = calloc(n, size);
+		if (ptr != NULL) {
+			arena_reserve(arena, n, size);
+		}
+		return ptr;
+	}
+
+	if (len > arena->cap - arena->len) {
+		return NULL;
+	}
+
+	ptr = arena->data + arena->len;
+	arena_reserve(arena, n, size);
+
+	/* Память арены может быть передана пользователем и не обнулена. */
+	memset(ptr, '\0', n * size);
+
+	return ptr;
+}
+
+void arena_reserve(arena_t arena, size_t n, size_t size)
+{
+	arena->len += arena_align(n * size);
+	arena->peak = (arena->len > arena->peak) ? arena->len : arena->peak;
+}
+
+size_t arena_mark(arena_t arena)
+{
+	return arena->len;
+}
+
+void arena_rewind(arena_t arena, size_t mark)
+{
+	arena->len = mark;
+}
+
+void arena_free(arena_t arena, void*ptr)
+{
+	if (arena->data == NULL) {
+		free(ptr);
+	}
+}
+/**
+ * /}
+ */
@@ -0,0 +1,88 @@
+/**
+ * \file arena.h
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief API арены памяти.
+ */
+/**
+ * \defgroup arena Модуль арены памяти.
+ * \{
+ */
+#ifndef ARENA_H_INCLUDED
+#define ARENA_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+#include <stddef.h>
+
+#define ARENA_ALIGN 64 /**< Выравнивание буферов арены (строка кэша и вектор AVX-512). */
+
+/**
+ * Структура арены: буферы выделяются последовательно из одного блока памяти с выравниванием ARENA_ALIGN
+ * и освобождаются все вместе вместе с блоком.
+ * Арена без памяти работает в режиме измерения: буферы выделяются в куче и освобождаются arena_free,
+ * а len накапливает размер, который они заняли бы в арене. Размер, не выделяя и не заполняя буферы,
+ * можно рассчитать и вызовами arena_reserve с теми же размерами, что и у arena_calloc.
+ * Возврат к отметке (arena_rewind) позволяет следующим буферам занять ту же память, что и предыдущие:
+ * так размещаются рабочие буферы, которые не используются одновременно.
+ */
+struct ARENA
+{
+	char*data; /**< Память арены, выровненная по ARENA_ALIGN (NULL - режим измерения). */
+
+	size_t len;  /**< Занятый объем (в режиме измерения - требуемый). */
+	size_t peak; /**< Наибольший занятый объем с момента инициализации. */
+	size_t cap;  /**< Вместимость арены.                                */
+};
+
+typedef struct ARENA* arena_t;
+
+/**
+ * Инициализация арены.
+ * \param mem память арены с любым выравниванием (NULL - режим измерения).
+ * \param mem_size размер памяти.
+ */
+void arena_init(arena_t arena, void*mem, size_t mem_size);
+
+/**
+ * \return размер памяти с любым выравниванием, в котором поместятся len байт буферов арены.
+ */
+size_t arena_mem_size(size_t len);
+
+/**
+ * Выделение обнуленного буфера из n элементов размера size.
+ * \return указатель на буфер, выровненный по ARENA_ALIGN (при нехватке памяти - NULL).
+ */
+void*arena_calloc(arena_t arena, size_t n, size_t size);
+
+/**
+ * Учет буфера из n элементов размера size без выделения памяти: len и peak изменяются так же,
+ * как при arena_calloc. Используется для расчета размеров арен без конфигурации.
+ */
+void arena_reserve(arena_t arena, size_t n, size_t size);
+
+/**
+ * \return отметка текущего занятого объема для arena_rewind.
+ */
+size_t arena_mark(arena_t arena);
+
+/**
+ * Возврат к отметке: буферы, выделенные после нее, остаются действительными, но их память
+ * будет выдана следующим выделениям. Требуемый размер арены - peak, а не len.
+ */
+void arena_rewind(arena_t arena, size_t mark);
+
+/**
+ * Освобождение буфера: в режиме измерения - возврат в кучу, иначе буфер освобождается вместе с памятью арены.
+ */
+void arena_free(arena_t arena, void*ptr);
+
+#ifdef __cplusplus
+}
+#endif  /* __cplusplus */
+
+#endif  /* ARENA_H_INCLUDED */
+/**
+ * /}
+ */
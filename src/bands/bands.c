@@ -0,0 +1,208 @@
+/**
+ * \file bands.c
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Реализация API разбиения спектра на критические полосы.
+ */
+/**
+ * \ingroup bands
+ * \{
+ */
+#include "bands.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <math.h>
+
+bands_t create_bands()
+{
+	bands_t bands;
+
+	bands = (bands_t) calloc(1, sizeof(struct BANDS));
+	return bands;
+}
+
+static double hz_to_bark(double f)
+{
+	return 26.81 * f / (1960.0 + f) - 0.53;
+}
+
+static double bark_to_hz(double z)
+{
+	return 1960.0 * (z + 0.53) / (26.28 - z);
+}
+
+/**
+ * Расчет центров полос в единицах частот ДПФ.
+ * \param centers массив из n_bands центров (NULL - только число полос).
+ * \return число полос, не большее n_bands.
+ */
+static unsigned bands_centers(unsigned sr, unsigned size, unsigned n_bands, double*centers)
+{
+	double z_max = hz_to_bark(sr / 2.0);
+	double bin_hz = ((double) sr) / ((double) size);
+
+	double center;
+	double prev = 0.0;
+
+	unsigned b;
+
+	/* На низких частотах полосы Барков уже шага ДПФ, поэтому центры раздвигаются хотя бы на одну частоту,
+	   а лишние верхние полосы отбрасываются. */
+	for (b = 0; b < n_bands; b++) {
+		center = bark_to_hz(hz_to_bark(0.0) + (z_max - hz_to_bark(0.0)) * b / (n_bands - 1)) / bin_hz;
+		if ((b > 0) && (center < prev + 1.0)) {
+			center = prev + 1.0;
+		}
+		if (center >= size / 2) {
+			center = size / 2;
+		}
+		if (centers != NULL) {
+			centers[b] = center;
+		}
+		if (center >= size / 2) {
+			b++;
+			break;
+		}
+		prev = center;
+	}
+
+	return b;
+}
+
+enum BANDS_CODE bands_config(bands_t bands, unsigned sr, unsigned size, unsigned n_bands, arena_t arena)
+{
+	enum BANDS_CODE r;
+
+	double bin_hz = ((double) sr) / ((double) size);
+
+	double*centers;
+
+	unsigned b, k;
+
+	bands->sr = sr;
+	bands->size = size;
+	bands->arena = arena;
+
+	centers = (double*) calloc(n_bands, sizeof(double));
+	if (centers == NULL) {
+		r = BANDS_CODE_ALLOC_ERR;
+		goto err0;
+	}
+
+	bands->n_bands = bands_centers(sr, size, n_bands, centers);
+	centers[0] = 0.0;
+
+	bands->freqs = (hsv_numeric_t*) arena_calloc(bands->arena, bands->n_bands, sizeof(hsv_numeric_t));
+	if (bands->freqs == NULL) {
+		r = BANDS_CODE_ALLOC_ERR;
+		goto err1;
+	}
+	for (b = 0; b < bands->n_bands; b++) {
+		bands->freqs[b] = centers[b] * bin_hz;
+	}
+
+	bands->idx = (unsigned*) arena_calloc(bands->arena, size / 2 + 1, sizeof(unsigned));
+	if (bands->idx == NULL) {
+		r = BANDS_CODE_ALLOC_ERR;
+		goto err2;
+	}
+	bands->weight = (hsv_numeric_t*) arena_calloc(bands->arena, size / 2 + 1, sizeof(hsv_numeric_t));
+	if (bands->weight == NULL) {
+		r = BANDS_CODE_ALLOC_ERR;
+		goto err3;
+	}
+
+	for (k = 0, b = 0; k <= size / 2; k++) {
+		while ((b + 2 < bands->n_bands) && (centers[b + 1] <= k)) {
+			b++;
+		}
+		bands->idx[k] = b;
+		bands->weight[k] = HSV_MAX((centers[b + 1] - k) / (centers[b + 1] - centers[b]), 0.0);
+	}
+
+	free(centers);
+
+	return BANDS_CODE_OK;
+
+ err3:
+	arena_free(bands->arena, bands->idx);
+ err2:
+	arena_free(bands->arena, bands->freqs);
+ err1:
+	free(centers);
+ err0:
+	return r;
+}
+
+unsigned bands_reserve(unsigned sr, unsigned size, unsigned n_bands, arena_t arena)
+{
+	unsigned count = bands_centers(sr, size, n_bands, NULL);
+
+	arena_reserve(arena, count, sizeof(hsv_numeric_t));
+	arena_reserve(arena, size / 2 + 1, sizeof(unsigned));
+	arena_reserve(arena, size / 2 + 1, sizeof(hsv_numeric_t));
+
+	return count;
+}
+
+void bands_aggregate(const struct BANDS*bands, const hsv_numeric_t*power_spec, hsv_numeric_t*band_power_spec)
+{
+	unsigned k;
+
+	memset(band_power_spec, '\0', bands->n_bands * sizeof(hsv_numeric_t));
+
+	for (k = 0; k <= bands->size / 2; k++) {
+		band_power_spec[bands->idx[k]] += bands->weight[k] * power_spec[k];
+		band_power_spec[bands->idx[k] + 1] += (1.0 - bands->weight[k]) * power_spec[k];
+	}
+}
+
+void bands_aggregate_amp(const struct BANDS*bands, const hsv_numeric_t*amp_spec, hsv_numeric_t*band_amp_spec)
+{
+	unsigned k, b;
+
+	memset(band_amp_spec, '\0', bands->n_bands * sizeof(hsv_numeric_t));
+
+	for (k = 0; k <= bands->size / 2; k++) {
+		hsv_numeric_t power = amp_spec[k] * amp_spec[k];
+		band_amp_spec[bands->idx[k]] += bands->weight[k] * power;
+		band_amp_spec[bands->idx[k] + 1] += (1.0 - bands->weight[k]) * power;
+	}
+
+	for (b = 0; b < bands->n_bands; b++) {
+		band_amp_spec[b] = HSV_SQRT(band_amp_spec[b]);
+	}
+}
+
+void bands_expand(const struct BANDS*bands, const hsv_numeric_t*band_values, hsv_numeric_t*values)
+{
+	unsigned k;
+
+	for (k = 0; k <= bands->size / 2; k++) {
+		values[k] = bands->weight[k] * band_values[bands->idx[k]] + (1.0 - bands->weight[k]) * band_values[bands->idx[k] + 1];
+	}
+	for (k = bands->size / 2 + 1; k < bands->size; k++) {
+		values[k] = values[bands->size - k];
+	}
+}
+
+void bands_deconfig(bands_t bands)
+{
+	arena_free(bands->arena, bands->weight);
+	arena_free(bands->arena, bands->idx);
+	arena_free(bands->arena, bands->freqs);
+}
+
+void bands_clean(bands_t bands)
+{
+	memset(bands, '\0', sizeof(*bands));
+}
+
+void bands_free(bands_t bands)
+{
+	free(bands);
+}
+/**
+ * /}
+ */
@@ -0,0 +1,119 @@
+/**
+ * \file bands.h
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief API разбиения спектра на критические полосы.
+ */
+/**
+ * \defgroup bands Модуль критических полос.
+ * \{
+ */
+#ifndef BANDS_H_INCLUDED
+#define BANDS_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+#include "hsv_types.h"
+
+#include "arena.h"
+
+/**
+ * Коды, возвращаемые методами bands_...
+ */
+enum BANDS_CODE
+{
+	BANDS_CODE_OK = 0,         /**< Метод успешно отработал. */
+	BANDS_CODE_ALLOC_ERR = -1, /**< Ошибка выделения памяти. */
+};
+
+/**
+ * Структура разбиения спектра на критические полосы.
+ * Центры полос равномерно распределены по шкале Барков от 0 до sr / 2 (но не ближе одной частоты ДПФ друг к другу),
+ * веса полос треугольные и в сумме по полосам для каждой частоты дают 1. Поэтому каждая частота ДПФ
+ * относится не более чем к двум соседним полосам, а агрегирование и интерполяция стоят O(size / 2).
+ *
+ * Traunmuller H. Analytical expressions for the tonotopic sensory scale, 1990 г.
+ */
+struct BANDS
+{
+	unsigned sr;      /**< Частота дискретизации.                         */
+	unsigned size;    /**< Размер ДПФ.                                    */
+	unsigned n_bands; /**< Число полос (может быть меньше запрошенного). */
+
+	hsv_numeric_t*freqs; /**< Центральные частоты полос в Гц. */
+
+	unsigned*idx;          /**< Для частот 0..size/2: номер нижней из двух полос, к которым относится частота. */
+	hsv_numeric_t*weight;  /**< Для частот 0..size/2: вес нижней полосы (вес верхней - 1 - weight).            */
+
+	arena_t arena; /**< Арена, из которой выделены буферы. */
+};
+
+typedef struct BANDS* bands_t;
+
+/**
+ * Создание структуры критических полос.
+ * \return указатель на структуру критических полос (при ошибке - NULL).
+ */
+bands_t create_bands();
+
+/**
+ * Конфигурация критических полос.
+ * \param sr частота дискретизации.
+ * \param size размер ДПФ.
+ * \param n_bands желаемое число полос (не меньше 2).
+ * \param arena арена, из которой выделяются буферы.
+ * \return результат конфигурирования.
+ */
+enum BANDS_CODE bands_config(bands_t bands, unsigned sr, unsigned size, unsigned n_bands, arena_t arena);
+
+/**
+ * Учет памяти bands_config в арене без конфигурации (см. arena_reserve).
+ * \return число полос, которое получит bands_config.
+ */
+unsigned bands_reserve(unsigned sr, unsigned size, unsigned n_bands, arena_t arena);
+
+/**
+ * Агрегирование спектра мощности по полосам.
+ * \param power_spec спектр мощности (size частот, используются 0..size/2).
+ * \param band_power_spec спектр мощности полос (n_bands).
+ */
+void bands_aggregate(const struct BANDS*bands, const hsv_numeric_t*power_spec, hsv_numeric_t*band_power_spec);
+
+/**
+ * Агрегирование спектра амплитуд по полосам: амплитуда полосы - корень из суммарной мощности.
+ * \param amp_spec спектр амплитуд (size частот, используются 0..size/2).
+ * \param band_amp_spec спектр амплитуд полос (n_bands).
+ */
+void bands_aggregate_amp(const struct BANDS*bands, const hsv_numeric_t*amp_spec, hsv_numeric_t*band_amp_spec);
+
+/**
+ * Интерполяция значений полос (например, коэффициентов усиления) на все частоты ДПФ (с симметричным отражением).
+ * \param band_values значения полос (n_bands).
+ * \param values значения частот (size).
+ */
+void bands_expand(const struct BANDS*bands, const hsv_numeric_t*band_values, hsv_numeric_t*values);
+
+/**
+ * Удаление всех внутренних динамических структур.
+ */
+void bands_deconfig(bands_t bands);
+
+/**
+ * Зануление структуры критических полос.
+ */
+void bands_clean(bands_t bands);
+
+/**
+ * Удаление структуры критических полос.
+ */
+void bands_free(bands_t bands);
+
+#ifdef __cplusplus
+}
+#endif  /* __cplusplus */
+
+#endif  /* BANDS_H_INCLUDED */
+/**
+ * /}
+ */
@@ -9,6 +9,8 @@
  */
 #include "dft.h"
 
+#include "kernels.h"
+
 #include <stdlib.h>
 #include <string.h>
 
@@ -25,57 +27,75 @@ dft_t create_dft()
 static int is_pow_2(unsigned n);
 static unsigned next_pow_2(unsigned n);
 static void dft_inner(dft_t dft, hsv_numeric_t*real, hsv_numeric_t*imag, unsigned n);
+static unsigned inverse(unsigned val, int w);
 
-static enum DFT_CODE config_cooley_tukey(struct COOLEY_TUKEY*ct, unsigned dft_size)
+static enum DFT_CODE config_cooley_tukey(struct COOLEY_TUKEY*ct, unsigned dft_size, arena_t arena)
 {
 	enum DFT_CODE r;
 
 	unsigned i;
 
+	int lvls = 0;
+
 	if (is_pow_2(dft_size)) {
 		ct->tab_size = dft_size / 2;
 	} else {
 		ct->tab_size = next_pow_2(dft_size) / 2;
 	}
-	ct->sin_tab = (hsv_numeric_t*) calloc(ct->tab_size, sizeof(hsv_numeric_t));
+	ct->sin_tab = (hsv_numeric_t*) arena_calloc(arena, ct->tab_size, sizeof(hsv_numeric_t));
 	if (ct->sin_tab == NULL) {
 		r = DFT_CODE_ALLOC_ERR;
 		goto err0;
 	}
-	ct->cos_tab = (hsv_numeric_t*) calloc(ct->tab_size, sizeof(hsv_numeric_t));
+	ct->cos_tab = (hsv_numeric_t*) arena_calloc(arena, ct->tab_size, sizeof(hsv_numeric_t));
 	if (ct->cos_tab == NULL) {
 		r = DFT_CODE_ALLOC_ERR;
 		goto err1;
 	}
+	ct->rev_tab = (unsigned*) arena_calloc(arena, ct->tab_size * 2, sizeof(unsigned));
+	if (ct->rev_tab == NULL) {
+		r = DFT_CODE_ALLOC_ERR;
+		goto err2;
+	}
 
 	ct->tab_size *= 2;
 	for (i = 0; i < ct->tab_size / 2; i++) {
 		ct->cos_tab[i] = HSV_COS(2 * M_PI * i / ct->tab_size);
 		ct->sin_tab[i] = HSV_SIN(2 * M_PI * i / ct->tab_size);
 	}
+	/* Преобразование Кули-Тьюки всегда выполняется для размера tab_size, поэтому перестановка вычисляется один раз. */
+	for (i = ct->tab_size; i > ((unsigned) 1); i >>= 1) {
+		lvls++;
+	}
+	for (i = 0; i < ct->tab_size; i++) {
+		ct->rev_tab[i] = inverse(i, lvls);
+	}
 	ct->tab_size /= 2;
 	
 	ct->initialized = 1;
 
 	return DFT_CODE_OK;
 
+ err2:
+	arena_free(arena, ct->cos_tab);
  err1:
-	free(ct->sin_tab);
+	arena_free(arena, ct->sin_tab);
  err0:
 	return r;
 }
 
-static void deconfig_cooley_tukey(struct COOLEY_TUKEY*ct)
+static void deconfig_cooley_tukey(struct COOLEY_TUKEY*ct, arena_t arena)
 {
 	if (! ct->initialized) {
 		return;
 	}
 
-	free(ct->cos_tab);
-	free(ct->sin_tab);
+	arena_free(arena, ct->rev_tab);
+	arena_free(arena, ct->cos_tab);
+	arena_free(arena, ct->sin_tab);
 }
 
-static enum DFT_CODE config_bluestein(struct BLUESTEIN*bl, unsigned dft_size)
+static enum DFT_CODE config_bluestein(struct BLUESTEIN*bl, unsigned dft_size, arena_t arena, arena_t scratch)
 {
 	enum DFT_CODE r;
 	
@@ -86,43 +106,44 @@ static enum DFT_CODE config_bluestein(struct BLUESTEIN*bl, unsigned dft_size)
 	}
 
 	bl->tab_size = dft_size;
-	bl->sin_tab = (hsv_numeric_t*) calloc(dft_size, sizeof(hsv_numeric_t));
+	bl->sin_tab = (hsv_numeric_t*) arena_calloc(arena, dft_size, sizeof(hsv_numeric_t));
 	if (bl->sin_tab == NULL) {
 		r = DFT_CODE_ALLOC_ERR;
 		goto err0;
 	}
-	bl->cos_tab = (hsv_numeric_t*) calloc(dft_size, sizeof(hsv_numeric_t));
+	bl->cos_tab = (hsv_numeric_t*) arena_calloc(arena, dft_size, sizeof(hsv_numeric_t));
 	if (bl->cos_tab == NULL) {
 		r = DFT_CODE_ALLOC_ERR;
 		goto err1;
 	}
 	bl->nb = next_pow_2(dft_size);
-	bl->a_real = (hsv_numeric_t*) calloc(sizeof(hsv_numeric_t), bl->nb);
+	/* Свертка a и ее результат c нужны только внутри одного преобразования. */
+	bl->a_real = (hsv_numeric_t*) arena_calloc(scratch, sizeof(hsv_numeric_t), bl->nb);
 	if (bl->a_real == NULL) {
 		r = DFT_CODE_ALLOC_ERR;
 		goto err2;
 	}
-	bl->a_imag = (hsv_numeric_t*) calloc(sizeof(hsv_numeric_t), bl->nb);
+	bl->a_imag = (hsv_numeric_t*) arena_calloc(scratch, sizeof(hsv_numeric_t), bl->nb);
 	if (bl->a_imag == NULL) {
 		r = DFT_CODE_ALLOC_ERR;
 		goto err3;
 	}
-	bl->b_real = (hsv_numeric_t*) calloc(sizeof(hsv_numeric_t), bl->nb);
+	bl->b_real = (hsv_numeric_t*) arena_calloc(arena, sizeof(hsv_numeric_t), bl->nb);
 	if (bl->b_real == NULL) {
 		r = DFT_CODE_ALLOC_ERR;
 		goto err4;
 	}
-	bl->b_imag = (hsv_numeric_t*) calloc(sizeof(hsv_numeric_t), bl->nb);
+	bl->b_imag = (hsv_numeric_t*) arena_calloc(arena, sizeof(hsv_numeric_t), bl->nb);
 	if (bl->b_imag == NULL) {
 		r = DFT_CODE_ALLOC_ERR;
 		goto err5;
 	}
-	bl->c_real = (hsv_numeric_t*) calloc(sizeof(hsv_numeric_t), bl->nb);
+	bl->c_real = (hsv_numeric_t*) arena_calloc(scratch, sizeof(hsv_numeric_t), bl->nb);
 	if (bl->c_real == NULL) {
 		r = DFT_CODE_ALLOC_ERR;
 		goto err6;
 	}
-	bl->c_imag = (hsv_numeric_t*) calloc(sizeof(hsv_numeric_t), bl->nb);
+	bl->c_imag = (hsv_numeric_t*) arena_calloc(scratch, sizeof(hsv_numeric_t), bl->nb);
 	if (bl->c_imag == NULL) {
 		r = DFT_CODE_ALLOC_ERR;
 		goto err7;
@@ -148,61 +169,64 @@ static enum DFT_CODE config_bluestein(struct BLUESTEIN*bl, unsigned dft_size)
 	return DFT_CODE_OK;
 
  err7:
-	free(bl->c_real);
+	arena_free(scratch, bl->c_real);
  err6:
-	free(bl->b_imag);
+	arena_free(arena, bl->b_imag);
  err5:
-	free(bl->b_real);
+	arena_free(arena, bl->b_real);
  err4:
-	free(bl->a_imag);
+	arena_free(scratch, bl->a_imag);
  err3:
-	free(bl->a_real);
+	arena_free(scratch, bl->a_real);
  err2:
-	free(bl->cos_tab);
+	arena_free(arena, bl->cos_tab);
  err1:
-	free(bl->sin_tab);
+	arena_free(arena, bl->sin_tab);
  err0:
 	return r;
 }
 
-static void deconfig_bluestein(struct BLUESTEIN*bl)
+static void deconfig_bluestein(struct BLUESTEIN*bl, arena_t arena, arena_t scratch)
 {
 	if (! bl->initialized) {
 		return;
 	}
 
-	free(bl->c_imag);
-	free(bl->c_real);
-	free(bl->b_imag);
-	free(bl->b_real);
-	free(bl->a_imag);
-	free(bl->a_real);
-	free(bl->cos_tab);
-	free(bl->sin_tab);
+	arena_free(scratch, bl->c_imag);
+	arena_free(scratch, bl->c_real);
+	arena_free(arena, bl->b_imag);
+	arena_free(arena, bl->b_real);
+	arena_free(scratch, bl->a_imag);
+	arena_free(scratch, bl->a_real);
+	arena_free(arena, bl->cos_tab);
+	arena_free(arena, bl->sin_tab);
 }
 
-enum DFT_CODE dft_config(dft_t dft, unsigned dft_size)
+enum DFT_CODE dft_config(dft_t dft, unsigned dft_size, arena_t arena, arena_t scratch)
 {
 	enum DFT_CODE r;
 
 	dft->dft_size = dft_size;
-	dft->real = (hsv_numeric_t*) calloc(dft_size, sizeof(hsv_numeric_t));
+	dft->arena = arena;
+	dft->scratch = scratch;
+	dft->shared = 0;
+	dft->real = (hsv_numeric_t*) arena_calloc(dft->scratch, dft_size, sizeof(hsv_numeric_t));
 	if (dft->real == NULL) {
 		r = DFT_CODE_ALLOC_ERR;
 		goto err0;
 	}
-	dft->imag = (hsv_numeric_t*) calloc(dft_size, sizeof(hsv_numeric_t));
+	dft->imag = (hsv_numeric_t*) arena_calloc(dft->scratch, dft_size, sizeof(hsv_numeric_t));
 	if (dft->imag == NULL) {
 		r = DFT_CODE_ALLOC_ERR;
 		goto err1;
 	}
 
-	r = config_cooley_tukey(&(dft->ct), dft_size);
+	r = config_cooley_tukey(&(dft->ct), dft_size, dft->arena);
 	if (r != DFT_CODE_OK) {
 		goto err2;
 	}
 
-	r = config_bluestein(&(dft->bl), dft_size);
+	r = config_bluestein(&(dft->bl), dft_size, dft->arena, dft->scratch);
 	if (r != DFT_CODE_OK) {
 		goto err3;
 	}
@@ -212,15 +236,122 @@ enum DFT_CODE dft_config(dft_t dft, unsigned dft_size)
 	return DFT_CODE_OK;
 
  err3:
-	deconfig_cooley_tukey(&(dft->ct));
+	deconfig_cooley_tukey(&(dft->ct), dft->arena);
  err2:
-	free(dft->imag);
+	arena_free(dft->scratch, dft->imag);
  err1:
-	free(dft->real);
+	arena_free(dft->scratch, dft->real);
  err0:
 	return r;
 }
 
+enum DFT_CODE dft_config_shared(dft_t dft, const struct DISCRETE_FOURIER_TRANSFORM*src, arena_t scratch)
+{
+	enum DFT_CODE r;
+
+	*dft = *src;
+	dft->scratch = scratch;
+	dft->shared = 1;
+
+	dft->real = (hsv_numeric_t*) arena_calloc(dft->scratch, dft->dft_size, sizeof(hsv_numeric_t));
+	if (dft->real == NULL) {
+		r = DFT_CODE_ALLOC_ERR;
+		goto err0;
+	}
+	dft->imag = (hsv_numeric_t*) arena_calloc(dft->scratch, dft->dft_size, sizeof(hsv_numeric_t));
+	if (dft->imag == NULL) {
+		r = DFT_CODE_ALLOC_ERR;
+		goto err1;
+	}
+
+	if (! dft->bl.initialized) {
+		return DFT_CODE_OK;
+	}
+
+	/* Свертка Блюштейна - единственное, что преобразование изменяет, кроме входа. */
+	dft->bl.a_real = (hsv_numeric_t*) arena_calloc(dft->scratch, dft->bl.nb, sizeof(hsv_numeric_t));
+	if (dft->bl.a_real == NULL) {
+		r = DFT_CODE_ALLOC_ERR;
+		goto err2;
+	}
+	dft->bl.a_imag = (hsv_numeric_t*) arena_calloc(dft->scratch, dft->bl.nb, sizeof(hsv_numeric_t));
+	if (dft->bl.a_imag == NULL) {
+		r = DFT_CODE_ALLOC_ERR;
+		goto err3;
+	}
+	dft->bl.c_real = (hsv_numeric_t*) arena_calloc(dft->scratch, dft->bl.nb, sizeof(hsv_numeric_t));
+	if (dft->bl.c_real == NULL) {
+		r = DFT_CODE_ALLOC_ERR;
+		goto err4;
+	}
+	dft->bl.c_imag = (hsv_numeric_t*) arena_calloc(dft->scratch, dft->bl.nb, sizeof(hsv_numeric_t));
+	if (dft->bl.c_imag == NULL) {
+		r = DFT_CODE_ALLOC_ERR;
+		goto err5;
+	}
+
+	return DFT_CODE_OK;
+
+ err5:
+	arena_free(dft->scratch, dft->bl.c_real);
+ err4:
+	arena_free(dft->scratch, dft->bl.a_imag);
+ err3:
+	arena_free(dft->scratch, dft->bl.a_real);
+ err2:
+	arena_free(dft->scratch, dft->imag);
+ err1:
+	arena_free(dft->scratch, dft->real);
+ err0:
+	return r;
+}
+
+void dft_reserve(unsigned dft_size, arena_t arena, arena_t scratch)
+{
+	unsigned tab_size = (is_pow_2(dft_size) ? dft_size : next_pow_2(dft_size)) / 2;
+	unsigned nb = next_pow_2(dft_size);
+
+	arena_reserve(scratch, dft_size, sizeof(hsv_numeric_t));
+	arena_reserve(scratch, dft_size, sizeof(hsv_numeric_t));
+
+	/* Таблицы Кули-Тьюки (config_cooley_tukey). */
+	arena_reserve(arena, tab_size, sizeof(hsv_numeric_t));
+	arena_reserve(arena, tab_size, sizeof(hsv_numeric_t));
+	arena_reserve(arena, tab_size * 2, sizeof(unsigned));
+
+	if (is_pow_2(dft_size)) {
+		return;
+	}
+
+	/* Таблицы и свертка Блюштейна (config_bluestein). */
+	arena_reserve(arena, dft_size, sizeof(hsv_numeric_t));
+	arena_reserve(arena, dft_size, sizeof(hsv_numeric_t));
+	arena_reserve(scratch, nb, sizeof(hsv_numeric_t));
+	arena_reserve(scratch, nb, sizeof(hsv_numeric_t));
+	arena_reserve(arena, nb, sizeof(hsv_numeric_t));
+	arena_reserve(arena, nb, sizeof(hsv_numeric_t));
+	arena_reserve(scratch, nb, sizeof(hsv_numeric_t));
+	arena_reserve(scratch, nb, sizeof(hsv_numeric_t));
+}
+
+void dft_reserve_shared(unsigned dft_size, arena_t scratch)
+{
+	unsigned nb = next_pow_2(dft_size);
+
+	arena_reserve(scratch, dft_size, sizeof(hsv_numeric_t));
+	arena_reserve(scratch, dft_size, sizeof(hsv_numeric_t));
+
+	if (is_pow_2(dft_size)) {
+		return;
+	}
+
+	/* Свертка Блюштейна. */
+	arena_reserve(scratch, nb, sizeof(hsv_numeric_t));
+	arena_reserve(scratch, nb, sizeof(hsv_numeric_t));
+	arena_reserve(scratch, nb, sizeof(hsv_numeric_t));
+	arena_reserve(scratch, nb, sizeof(hsv_numeric_t));
+}
+
 static void cooley_tukey(dft_t dft, hsv_numeric_t*real, hsv_numeric_t*imag, unsigned n);
 static void bluestein(dft_t dft, hsv_numeric_t*real, hsv_numeric_t*imag, unsigned n);
 
@@ -247,61 +378,10 @@ static unsigned inverse(unsigned val, int w)
 	return res;
 }
 
-static void swap_complex(hsv_numeric_t*real_a, hsv_numeric_t*imag_a, hsv_numeric_t*real_b, hsv_numeric_t*imag_b)
-{
-	hsv_numeric_t tmp;
-
-	tmp = *real_a;
-	*real_a = *real_b;
-	*real_b = tmp;
-
-	tmp = *imag_a;
-	*imag_a = *imag_b;
-	*imag_b = tmp;
-}
-
 static void cooley_tukey(dft_t dft, hsv_numeric_t*real, hsv_numeric_t*imag, unsigned n)
 {
-	unsigned i, j, k;
-
-	unsigned n2;
-	
-	int lvls = 0;
-	for (i = n; i > ((unsigned) 1); i >>= 1) {
-		lvls++;
-	}
-
-	for (i = 0; i < n; i++) {
-		j = inverse(i, lvls);
-		if (j > i) {
-			swap_complex(real + i, imag + i, real + j, imag + j);
-		}
-	}
-
-	for (n2 = 2; n2 <= n; n2 *= 2) {
-		unsigned half = n2 / 2;
-		unsigned tab_step = n / n2;
-
-		for (i = 0; i < n; i += n2) {
-			for (j = i, k = 0; j < i + half; j++, k += tab_step) {
-				unsigned ind = j + half;
-				hsv_numeric_t tmp_real = real[ind] * dft->ct.cos_tab[k] +
-					imag[ind] * dft->ct.sin_tab[k];
-				hsv_numeric_t tmp_imag = -real[ind] * dft->ct.sin_tab[k] +
-					imag[ind] * dft->ct.cos_tab[k];
-
-				real[ind] = real[j] - tmp_real;
-				imag[ind] = imag[j] - tmp_imag;
-
-				real[j] += tmp_real;
-				imag[j] += tmp_imag;
-			}
-		}
-
-		if (n2 == n) {
-			return;
-		}
-	}
+	hsv_kernels->ct_permute(real, imag, dft->ct.rev_tab, n);
+	hsv_kernels->ct_butterflies(real, imag, dft->ct.cos_tab, dft->ct.sin_tab, n);
 }
 
 static void convolve(
@@ -312,18 +392,12 @@ static void convolve(
 
 static void bluestein(dft_t dft, hsv_numeric_t*real, hsv_numeric_t*imag, unsigned n)
 {
-	unsigned i;
 	unsigned m = next_pow_2(n);
 
 	memset(dft->bl.a_real, '\0', dft->bl.nb * sizeof(hsv_numeric_t));
 	memset(dft->bl.a_imag, '\0', dft->bl.nb * sizeof(hsv_numeric_t));
 
-	for (i = 0; i < n; i++) {
-		dft->bl.a_real[i] =	real[i] * dft->bl.cos_tab[i] +
-			imag[i] * dft->bl.sin_tab[i];
-		dft->bl.a_imag[i] = -real[i] * dft->bl.sin_tab[i] +
-			imag[i] * dft->bl.cos_tab[i];
-	}
+	hsv_kernels->chirp(real, imag, dft->bl.cos_tab, dft->bl.sin_tab, dft->bl.a_real, dft->bl.a_imag, n);
 
 	/*
 	// Вычисляется лишь один раз на старте в строках 138-144.
@@ -343,12 +417,7 @@ static void bluestein(dft_t dft, hsv_numeric_t*real, hsv_numeric_t*imag, unsigne
 			 dft->bl.b_real, dft->bl.b_imag,
 			 dft->bl.c_real, dft->bl.c_imag, m);
 	
-	for (i = 0; i < n; i++) {
-		real[i] =  dft->bl.c_real[i] * dft->bl.cos_tab[i] +
-			dft->bl.c_imag[i] * dft->bl.sin_tab[i];
-		imag[i] = -dft->bl.c_real[i] * dft->bl.sin_tab[i] +
-			dft->bl.c_imag[i] * dft->bl.cos_tab[i];
-	}
+	hsv_kernels->chirp(dft->bl.c_real, dft->bl.c_imag, dft->bl.cos_tab, dft->bl.sin_tab, real, imag, n);
 }
 
 static void convolve(
@@ -357,29 +426,19 @@ static void convolve(
 		hsv_numeric_t*b_real, hsv_numeric_t*b_imag,
 		hsv_numeric_t*c_real, hsv_numeric_t*c_imag, unsigned n)
 {
-	unsigned i;
-
 	dft_inner(dft, a_real, a_imag, n);
 	/*
 	// Вычисляется лишь один раз на старте в строках 209-210
 	dft_inner(dft, b_real, b_imag, n);
 	*/
 	
-	for (i = 0; i < n; i++) {
-		hsv_numeric_t tmp = a_real[i] * b_real[i] -
-			a_imag[i] * b_imag[i];
-		a_imag[i] = a_imag[i] * b_real[i] +
-			a_real[i] * b_imag[i];
-		a_real[i] = tmp;
-	}
+	hsv_kernels->complex_mul(a_real, a_imag, b_real, b_imag, n);
 
 	/* Обратное быстрое преобразование Фурье. */
 	dft_inner(dft, a_imag, a_real, n);
 	
-	for (i = 0; i < n; i++) {
-		c_real[i] = a_real[i] / n;
-		c_imag[i] = a_imag[i] / n;
-	}
+	hsv_kernels->scale_div(a_real, n, c_real, n);
+	hsv_kernels->scale_div(a_imag, n, c_imag, n);
 }
 
 static int is_pow_2(unsigned n)
@@ -404,24 +463,54 @@ void dft_run_dft(dft_t dft)
 
 void dft_run_i_dft(dft_t dft)
 {
-	unsigned i;
-
 	dft_inner(dft, dft->imag, dft->real, dft->dft_size);
 
-	for (i = 0; i < dft->dft_size; i++) {
-		dft->real[i] = dft->real[i] / ((hsv_numeric_t) dft->dft_size);
-		dft->imag[i] = dft->imag[i] / ((hsv_numeric_t) dft->dft_size);
+	hsv_kernels->scale_div(dft->real, dft->dft_size, dft->real, dft->dft_size);
+	hsv_kernels->scale_div(dft->imag, dft->dft_size, dft->imag, dft->dft_size);
+}
+
+void dft_run_dft_batch(dft_t dft, hsv_numeric_t*real, hsv_numeric_t*imag, unsigned n)
+{
+	unsigned b;
+
+	/* Таблицы sin и cos остаются в кэше на протяжении всего пакета. */
+	for (b = 0; b < n; b++) {
+		dft_inner(dft, real + b * dft->dft_size, imag + b * dft->dft_size, dft->dft_size);
+	}
+}
+
+void dft_run_i_dft_batch(dft_t dft, hsv_numeric_t*real, hsv_numeric_t*imag, unsigned n)
+{
+	unsigned b;
+
+	for (b = 0; b < n; b++) {
+		dft_inner(dft, imag + b * dft->dft_size, real + b * dft->dft_size, dft->dft_size);
 	}
+
+	hsv_kernels->scale_div(real, dft->dft_size, real, n * dft->dft_size);
+	hsv_kernels->scale_div(imag, dft->dft_size, imag, n * dft->dft_size);
 }
 
 void dft_deconfig(dft_t dft)
 {
-	deconfig_bluestein(&(dft->bl));
+	if (dft->shared) {
+		if (dft->bl.initialized) {
+			arena_free(dft->scratch, dft->bl.c_imag);
+			arena_free(dft->scratch, dft->bl.c_real);
+			arena_free(dft->scratch, dft->bl.a_imag);
+			arena_free(dft->scratch, dft->bl.a_real);
+		}
+		arena_free(dft->scratch, dft->imag);
+		arena_free(dft->scratch, dft->real);
+		return;
+	}
+
+	deconfig_bluestein(&(dft->bl), dft->arena, dft->scratch);
 
-	deconfig_cooley_tukey(&(dft->ct));
+	deconfig_cooley_tukey(&(dft->ct), dft->arena);
 
-	free(dft->imag);
-	free(dft->real);
+	arena_free(dft->scratch, dft->imag);
+	arena_free(dft->scratch, dft->real);
 }
 
 void dft_clean(dft_t dft)
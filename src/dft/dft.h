@@ -16,6 +16,8 @@ extern "C" {
 
 #include "hsv_types.h"
 
+#include "arena.h"
+
 /**
  * Коды, возвращаемые методами dft_...
  */
@@ -36,6 +38,8 @@ struct COOLEY_TUKEY
 	hsv_numeric_t*cos_tab;
 	unsigned tab_size;
 
+	unsigned*rev_tab; /**< Бит-реверсивные индексы перестановки (2 * tab_size). */
+
 	int initialized;
 };
 
@@ -76,6 +80,11 @@ struct DISCRETE_FOURIER_TRANSFORM
 
 	struct COOLEY_TUKEY ct; /**< Вспомогательная структура алгоритма Кули-Тьюки, ускоряющая его работу. */
 	struct BLUESTEIN bl;    /**< Вспомогательная структура алгоритма Блюштейна, ускоряющая его работу.  */
+
+	arena_t arena;   /**< Арена, из которой выделены таблицы.                       */
+	arena_t scratch; /**< Арена рабочих буферов (real, imag и свертка Блюштейна). */
+
+	int shared; /**< Таблицы принадлежат другой структуре ДПФ (dft_config_shared). */
 };
 
 typedef struct DISCRETE_FOURIER_TRANSFORM* dft_t;
@@ -89,9 +98,30 @@ dft_t create_dft();
 /**
  * Конфигурация ДПФ.
  * \param dft_size размер ДПФ.
+ * \param arena арена, из которой выделяются таблицы.
+ * \param scratch арена рабочих буферов, содержимое которых не сохраняется между вызовами.
+ * \return результат конфигурирования.
+ */
+enum DFT_CODE dft_config(dft_t dft, unsigned dft_size, arena_t arena, arena_t scratch);
+
+/**
+ * Конфигурация ДПФ с таблицами уже сконфигурированной структуры src и собственными рабочими буферами:
+ * структуры с общими таблицами могут выполнять преобразования одновременно в разных потоках.
+ * src должна быть удалена после всех структур, разделяющих ее таблицы.
+ * \param scratch арена рабочих буферов.
  * \return результат конфигурирования.
  */
-enum DFT_CODE dft_config(dft_t dft, unsigned dft_size);
+enum DFT_CODE dft_config_shared(dft_t dft, const struct DISCRETE_FOURIER_TRANSFORM*src, arena_t scratch);
+
+/**
+ * Учет памяти dft_config в аренах без конфигурации и расчета таблиц (см. arena_reserve).
+ */
+void dft_reserve(unsigned dft_size, arena_t arena, arena_t scratch);
+
+/**
+ * Учет памяти dft_config_shared для ДПФ размера dft_size (см. arena_reserve).
+ */
+void dft_reserve_shared(unsigned dft_size, arena_t scratch);
 
 /**
  * Выполнение прямого ДПФ над массивами real и imag.
@@ -103,6 +133,20 @@ void dft_run_dft(dft_t dft);
  */
 void dft_run_i_dft(dft_t dft);
 
+/**
+ * Выполнение пакета прямых ДПФ над внешними массивами real и imag.
+ * Преобразования лежат в массивах подряд с шагом dft_size.
+ * \param n число преобразований в пакете.
+ */
+void dft_run_dft_batch(dft_t dft, hsv_numeric_t*real, hsv_numeric_t*imag, unsigned n);
+
+/**
+ * Выполнение пакета обратных ДПФ над внешними массивами real и imag.
+ * Преобразования лежат в массивах подряд с шагом dft_size.
+ * \param n число преобразований в пакете.
+ */
+void dft_run_i_dft_batch(dft_t dft, hsv_numeric_t*real, hsv_numeric_t*imag, unsigned n);
+
 /**
  * Удаление всех внутренних динамических структур.
  */
@@ -14,6 +14,9 @@
 
 #include <math.h>
 
+#include "fastmath.h"
+#include "kernels.h"
+
 estimator_t create_estimator()
 {
 	estimator_t est;
@@ -56,7 +59,31 @@ static void init_delta_k(hsv_numeric_t*delta_k, unsigned sr, unsigned size)
 	}
 }
 
-enum ESTIMATOR_CODE estimator_config(estimator_t est, unsigned sr, unsigned size)
+/**
+ * Арена рекурсивных спектров: при 16-битном хранении они нужны только на время обработки фрейма.
+ */
+static arena_t estimator_spec_arena(const estimator_t est)
+{
+	return (est->storage == KERNELS_STORAGE_NATIVE) ? est->arena : est->scratch;
+}
+
+/**
+ * Повторение порогов присутствия голоса для каждого из lanes потоков (см. ESTIMATOR::lanes).
+ */
+static void replicate_delta_k(hsv_numeric_t*delta_k, unsigned size, unsigned lanes)
+{
+	unsigned k, l;
+
+	/* Индексы записи не меньше индексов еще не прочитанных порогов. */
+	for (k = size; k-- > 0;) {
+		for (l = lanes; l-- > 0;) {
+			delta_k[k * lanes + l] = delta_k[k];
+		}
+	}
+}
+
+static enum ESTIMATOR_CODE estimator_config_impl(estimator_t est, unsigned sr, unsigned size, unsigned lanes, enum KERNELS_STORAGE storage,
+	arena_t arena, arena_t scratch)
 {
 	static const hsv_numeric_t alpha_smooth = 0.7;
 
@@ -70,22 +97,37 @@ enum ESTIMATOR_CODE estimator_config(estimator_t est, unsigned sr, unsigned size
 	
 	enum ESTIMATOR_CODE r;
 
+	arena_t spec_arena;
+
+	unsigned n = size * lanes;
+
 	est->size = size;
+	est->lanes = lanes;
+	est->arena = arena;
+	est->scratch = scratch;
+	est->storage = storage;
+	spec_arena = estimator_spec_arena(est);
+
+	est->eps = 0.0;
+
+	est->bands = NULL;
+	est->P_bands = NULL;
 
-	est->delta_k = (hsv_numeric_t*) calloc(size, sizeof(hsv_numeric_t));
+	est->delta_k = (hsv_numeric_t*) arena_calloc(est->arena, n, sizeof(hsv_numeric_t));
 	if (est->delta_k == NULL) {
 		r = ESTIMATOR_CODE_ALLOC_ERR;
 		goto err0;
 	}
 	init_delta_k(est->delta_k, sr, size);
+	replicate_delta_k(est->delta_k, size, lanes);
 
 	est->alpha_smooth = alpha_smooth;
-	est->P = (hsv_numeric_t*) calloc(size, sizeof(hsv_numeric_t));
+	est->P = (hsv_numeric_t*) arena_calloc(spec_arena, n, sizeof(hsv_numeric_t));
 	if (est->P == NULL) {
 		r = ESTIMATOR_CODE_ALLOC_ERR;
 		goto err1;
 	}
-	est->P_prev = (hsv_numeric_t*) calloc(size, sizeof(hsv_numeric_t));
+	est->P_prev = (hsv_numeric_t*) arena_calloc(spec_arena, n, sizeof(hsv_numeric_t));
 	if (est->P_prev == NULL) {
 		r = ESTIMATOR_CODE_ALLOC_ERR;
 		goto err2;
@@ -93,19 +135,19 @@ enum ESTIMATOR_CODE estimator_config(estimator_t est, unsigned sr, unsigned size
 
 	est->beta = beta;
 	est->gamma = gamma;
-	est->P_min = (hsv_numeric_t*) calloc(size, sizeof(hsv_numeric_t));
+	est->P_min = (hsv_numeric_t*) arena_calloc(spec_arena, n, sizeof(hsv_numeric_t));
 	if (est->P_min == NULL) {
 		r = ESTIMATOR_CODE_ALLOC_ERR;
 		goto err3;
 	}
-	est->P_min_prev = (hsv_numeric_t*) calloc(size, sizeof(hsv_numeric_t));
+	est->P_min_prev = (hsv_numeric_t*) arena_calloc(spec_arena, n, sizeof(hsv_numeric_t));
 	if (est->P_min_prev == NULL) {
 		r = ESTIMATOR_CODE_ALLOC_ERR;
 		goto err4;
 	}
 
 	est->alpha_spp = alpha_spp;
-	est->spp_k = (hsv_numeric_t*) calloc(size, sizeof(hsv_numeric_t));
+	est->spp_k = (hsv_numeric_t*) arena_calloc(spec_arena, n, sizeof(hsv_numeric_t));
 	if (est->spp_k == NULL) {
 		r = ESTIMATOR_CODE_ALLOC_ERR;
 		goto err5;
@@ -113,84 +155,320 @@ enum ESTIMATOR_CODE estimator_config(estimator_t est, unsigned sr, unsigned size
 
 	est->alpha = alpha;
 
-	est->noise_power_spec = (hsv_numeric_t*) calloc(size, sizeof(hsv_numeric_t));
+	est->noise_power_spec = (hsv_numeric_t*) arena_calloc(spec_arena, n, sizeof(hsv_numeric_t));
 	if (est->noise_power_spec == NULL) {
 		r = ESTIMATOR_CODE_ALLOC_ERR;
 		goto err6;
 	}
-	est->noise_amp_spec = (hsv_numeric_t*) calloc(size, sizeof(hsv_numeric_t));
+	est->noise_amp_spec = (hsv_numeric_t*) arena_calloc(est->arena, n, sizeof(hsv_numeric_t));
 	if (est->noise_amp_spec == NULL) {
 		r = ESTIMATOR_CODE_ALLOC_ERR;
 		goto err7;
 	}
 
+	est->P_half = NULL;
+	est->P_min_half = NULL;
+	est->spp_k_half = NULL;
+	est->noise_power_spec_half = NULL;
+	est->P_exp = 0;
+	est->P_min_exp = 0;
+	est->spp_k_exp = 0;
+	est->noise_power_spec_exp = 0;
+	est->mean_spp = 1.0;
+
+	if (storage != KERNELS_STORAGE_NATIVE) {
+		est->P_half = (uint16_t*) arena_calloc(est->arena, 4 * n, sizeof(uint16_t));
+		if (est->P_half == NULL) {
+			r = ESTIMATOR_CODE_ALLOC_ERR;
+			goto err8;
+		}
+		est->P_min_half = est->P_half + n;
+		est->spp_k_half = est->P_half + 2 * n;
+		est->noise_power_spec_half = est->P_half + 3 * n;
+	}
+
+	est->lane_first = NULL;
+	if (lanes > 1) {
+		est->lane_first = (unsigned char*) arena_calloc(est->arena, lanes, sizeof(unsigned char));
+		if (est->lane_first == NULL) {
+			r = ESTIMATOR_CODE_ALLOC_ERR;
+			goto err9;
+		}
+	}
+
 	return ESTIMATOR_CODE_OK;
 
+ err9:
+	arena_free(est->arena, est->P_half);
+ err8:
+	arena_free(est->arena, est->noise_amp_spec);
  err7:
-	free(est->noise_power_spec);
+	arena_free(spec_arena, est->noise_power_spec);
  err6:
-	free(est->spp_k);
+	arena_free(spec_arena, est->spp_k);
  err5:
-	free(est->P_min_prev);
+	arena_free(spec_arena, est->P_min_prev);
  err4:
-	free(est->P_min);
+	arena_free(spec_arena, est->P_min);
  err3:
-	free(est->P_prev);
+	arena_free(spec_arena, est->P_prev);
  err2:
-	free(est->P);
+	arena_free(spec_arena, est->P);
  err1:
-	free(est->delta_k);
+	arena_free(est->arena, est->delta_k);
  err0:
 	return r;
 }
 
-static void estimator_calculate_noise_amp_spec(estimator_t est)
+enum ESTIMATOR_CODE estimator_config(estimator_t est, unsigned sr, unsigned size, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch)
+{
+	return estimator_config_impl(est, sr, size, 1, storage, arena, scratch);
+}
+
+enum ESTIMATOR_CODE estimator_config_lanes(estimator_t est, unsigned sr, unsigned size, unsigned lanes, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch)
+{
+	return estimator_config_impl(est, sr, size, lanes, storage, arena, scratch);
+}
+
+enum ESTIMATOR_CODE estimator_config_bands(estimator_t est, unsigned sr, const struct BANDS*bands, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch)
+{
+	enum ESTIMATOR_CODE r;
+
+	unsigned b;
+
+	r = estimator_config(est, sr, bands->n_bands, storage, arena, scratch);
+	if (r != ESTIMATOR_CODE_OK) {
+		goto err0;
+	}
+
+	/* Те же пороги присутствия голоса, что и по частотам ДПФ, но по центральным частотам полос. */
+	for (b = 0; b < bands->n_bands; b++) {
+		est->delta_k[b] = (bands->freqs[b] < 3000.0) ? 2.0 : 5.0;
+	}
+
+	est->P_bands = (hsv_numeric_t*) arena_calloc(est->arena, bands->n_bands, sizeof(hsv_numeric_t));
+	if (est->P_bands == NULL) {
+		r = ESTIMATOR_CODE_ALLOC_ERR;
+		goto err1;
+	}
+
+	est->bands = bands;
+
+	return ESTIMATOR_CODE_OK;
+
+ err1:
+	estimator_deconfig(est);
+ err0:
+	return r;
+}
+
+void estimator_reserve(unsigned size, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch)
+{
+	arena_t spec_arena = (storage == KERNELS_STORAGE_NATIVE) ? arena : scratch;
+
+	arena_reserve(arena, size, sizeof(hsv_numeric_t));
+
+	/* P, P_prev, P_min, P_min_prev, spp_k, noise_power_spec. */
+	arena_reserve(spec_arena, size, sizeof(hsv_numeric_t));
+	arena_reserve(spec_arena, size, sizeof(hsv_numeric_t));
+	arena_reserve(spec_arena, size, sizeof(hsv_numeric_t));
+	arena_reserve(spec_arena, size, sizeof(hsv_numeric_t));
+	arena_reserve(spec_arena, size, sizeof(hsv_numeric_t));
+	arena_reserve(spec_arena, size, sizeof(hsv_numeric_t));
+
+	arena_reserve(arena, size, sizeof(hsv_numeric_t));
+
+	if (storage != KERNELS_STORAGE_NATIVE) {
+		arena_reserve(arena, 4 * size, sizeof(uint16_t));
+	}
+}
+
+void estimator_reserve_bands(unsigned n_bands, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch)
+{
+	estimator_reserve(n_bands, storage, arena, scratch);
+	arena_reserve(arena, n_bands, sizeof(hsv_numeric_t));
+}
+
+void estimator_reserve_lanes(unsigned size, unsigned lanes, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch)
+{
+	estimator_reserve(size * lanes, storage, arena, scratch);
+	if (lanes > 1) {
+		arena_reserve(arena, lanes, sizeof(unsigned char));
+	}
+}
+
+static void estimator_calculate_noise_amp_spec(estimator_t est, unsigned first, unsigned step)
 {
 	unsigned k;
 
-	for (k = 0; k < est->size; k++) {
+	/* Без прореживания цикл не имеет шага и векторизуется (результат тот же). */
+	if (step == 1) {
+		fastmath_sqrt(est->noise_power_spec + first, est->noise_amp_spec + first, est->size * est->lanes - first);
+		return;
+	}
+
+	for (k = first; k < est->size; k += step) {
 		est->noise_amp_spec[k] = HSV_SQRT(est->noise_power_spec[k]);
 	}
 }
 
+/**
+ * Ограничение спектра снизу значением est->eps на частотах first, first + step, ...
+ */
+static void estimator_floor(const estimator_t est, hsv_numeric_t*spec, unsigned first, unsigned step)
+{
+	unsigned k;
+
+	for (k = first; k < est->size * est->lanes; k += step) {
+		spec[k] = HSV_MAX(spec[k], est->eps);
+	}
+}
+
+/**
+ * Обнуление значений меньше est->eps на частотах first, first + step, ...
+ */
+static void estimator_flush(const estimator_t est, hsv_numeric_t*spec, unsigned first, unsigned step)
+{
+	unsigned k;
+
+	for (k = first; k < est->size * est->lanes; k += step) {
+		spec[k] = (spec[k] < est->eps) ? 0.0 : spec[k];
+	}
+}
+
 static void estimator_get_first(estimator_t est, hsv_numeric_t*P)
 {
-	memcpy(est->P, P, est->size * sizeof(hsv_numeric_t));
-	memcpy(est->P_prev, P, est->size * sizeof(hsv_numeric_t));
+	unsigned n = est->size * est->lanes;
 
-	memcpy(est->P_min, P, est->size * sizeof(hsv_numeric_t));
-	memcpy(est->P_min_prev, P, est->size * sizeof(hsv_numeric_t));
+	memcpy(est->P, P, n * sizeof(hsv_numeric_t));
+	memcpy(est->P_prev, P, n * sizeof(hsv_numeric_t));
+
+	memcpy(est->P_min, P, n * sizeof(hsv_numeric_t));
+	memcpy(est->P_min_prev, P, n * sizeof(hsv_numeric_t));
+
+	/* При 16-битном хранении рабочий спектр не был прочитан, а после сброса содержит прошлую оценку. */
+	memset(est->spp_k, '\0', n * sizeof(hsv_numeric_t));
+
+	memcpy(est->noise_power_spec, P, n * sizeof(hsv_numeric_t));
+
+	if (est->eps > 0.0) {
+		estimator_floor(est, est->P, 0, 1);
+		estimator_floor(est, est->P_prev, 0, 1);
+		estimator_floor(est, est->P_min, 0, 1);
+		estimator_floor(est, est->P_min_prev, 0, 1);
+		estimator_floor(est, est->noise_power_spec, 0, 1);
+	}
 
-	memcpy(est->noise_power_spec, P, est->size * sizeof(hsv_numeric_t));
-	estimator_calculate_noise_amp_spec(est);
+	estimator_calculate_noise_amp_spec(est, 0, 1);
 	
 	est->got_first = 1;
+	if (est->lane_first != NULL) {
+		memset(est->lane_first, '\0', est->lanes * sizeof(unsigned char));
+	}
+}
+
+/**
+ * Первый фрейм потоков, оценка которых была сброшена (estimator_reset_lane): после обновления всех потоков
+ * их состояние заменяется так же, как в estimator_get_first.
+ */
+static void estimator_get_first_lanes(estimator_t est, const hsv_numeric_t*P)
+{
+	unsigned lanes = est->lanes;
+
+	unsigned k, l, i;
+
+	int reset = 0;
+
+	for (l = 0; l < lanes; l++) {
+		if (! est->lane_first[l]) {
+			continue;
+		}
+
+		for (k = 0; k < est->size; k++) {
+			i = k * lanes + l;
+			est->P[i] = P[i];
+			est->P_min[i] = P[i];
+			if (est->eps > 0.0) {
+				est->P[i] = HSV_MAX(est->P[i], est->eps);
+				est->P_min[i] = HSV_MAX(est->P_min[i], est->eps);
+			}
+			est->P_prev[i] = est->P[i];
+			est->P_min_prev[i] = est->P_min[i];
+			est->spp_k[i] = 0.0;
+			est->noise_power_spec[i] = est->P[i];
+		}
+
+		est->lane_first[l] = 0;
+		reset = 1;
+	}
+
+	/* Корни пересчитываются тем же проходом, что и в estimator_get_first: у остальных потоков они не изменятся. */
+	if (reset) {
+		estimator_calculate_noise_amp_spec(est, 0, 1);
+	}
 }
 
-static void estimator_process(estimator_t est, hsv_numeric_t*P)
+/**
+ * Обновление оценки шума на частотах first, first + step, first + 2 * step, ...
+ * Рекурсии по разным частотам независимы, поэтому их можно обновлять в разных фреймах.
+ */
+static void estimator_process(estimator_t est, hsv_numeric_t*P, unsigned first, unsigned step)
 {
 	unsigned k;
 
+	struct KERNELS_MCRA mcra;
+
+	/* Обновление всех частот сразу выполняется векторизованным ядром. */
+	if (step == 1) {
+		mcra.alpha_smooth = est->alpha_smooth;
+		mcra.beta = est->beta;
+		mcra.gamma = est->gamma;
+		mcra.alpha_spp = est->alpha_spp;
+		mcra.alpha = est->alpha;
+		mcra.eps = est->eps;
+		mcra.delta_k = est->delta_k;
+		mcra.P = est->P;
+		mcra.P_prev = est->P_prev;
+		mcra.P_min = est->P_min;
+		mcra.P_min_prev = est->P_min_prev;
+		mcra.spp_k = est->spp_k;
+		mcra.noise_power_spec = est->noise_power_spec;
+		hsv_kernels->mcra_update(&mcra, P, est->size * est->lanes);
+
+		estimator_calculate_noise_amp_spec(est, first, step);
+		return;
+	}
+
 	/* Сглаживание спектра входного зашумленного сигнала. */
-	for (k = 0; k < est->size; k++) {
+	for (k = first; k < est->size; k += step) {
 		est->P[k] = est->alpha_smooth * est->P_prev[k] + (1.0 - est->alpha_smooth) * P[k];
 	}
+	if (est->eps > 0.0) {
+		estimator_floor(est, est->P, first, step);
+	}
 
-	memcpy(est->P_prev, est->P, est->size * sizeof(hsv_numeric_t));
+	for (k = first; k < est->size; k += step) {
+		est->P_prev[k] = est->P[k];
+	}
 
 	/* Непрерывное отслеживание спектральных минимумов по Доблингеру. */
-	for (k = 0; k < est->size; k++) {
+	for (k = first; k < est->size; k += step) {
 		if (est->P_min_prev[k] < est->P[k]) {
 			est->P_min[k] = est->gamma * est->P_min_prev[k] + ((1.0 - est->gamma) / (1.0 - est->beta)) * (est->P[k] - est->beta * est->P_prev[k]);
 		} else {
 			est->P_min[k] = est->P[k];
 		}
 	}
+	if (est->eps > 0.0) {
+		estimator_floor(est, est->P_min, first, step);
+	}
 
-	memcpy(est->P_min_prev, est->P_min, est->size * sizeof(hsv_numeric_t));
+	for (k = first; k < est->size; k += step) {
+		est->P_min_prev[k] = est->P_min[k];
+	}
 
 	/* Оценка спектра шума методом MCRA-2. */
-	for (k = 0; k < est->size; k++) {
+	for (k = first; k < est->size; k += step) {
 		hsv_numeric_t ak;
 		/* Апостериорный SNR сглаженного зашумленного голоса. */
 		hsv_numeric_t Sr_k = est->P[k] / est->P_min[k];
@@ -206,29 +484,157 @@ static void estimator_process(estimator_t est, hsv_numeric_t*P)
 		/* Итоговая оценка спектра шума. */
 		est->noise_power_spec[k] = ak * est->noise_power_spec[k] + (1.0 - ak) * est->P[k];
 	}
+	if (est->eps > 0.0) {
+		estimator_floor(est, est->noise_power_spec, first, step);
+		estimator_flush(est, est->spp_k, first, step);
+	}
+
+	estimator_calculate_noise_amp_spec(est, first, step);
+}
+
+/**
+ * Приведение входного спектра мощности к частотам оценки (по полосам, если они заданы).
+ */
+static hsv_numeric_t*estimator_input(estimator_t est, hsv_numeric_t*P)
+{
+	if (est->bands == NULL) {
+		return P;
+	}
+
+	bands_aggregate(est->bands, P, est->P_bands);
+	return est->P_bands;
+}
+
+void estimator_set_eps(estimator_t est, hsv_numeric_t eps)
+{
+	est->eps = eps;
+}
+
+/**
+ * Чтение состояния прошлого фрейма из 16-битного формата в рабочие спектры.
+ */
+static void estimator_load(estimator_t est)
+{
+	unsigned n = est->size * est->lanes;
+
+	if (est->storage == KERNELS_STORAGE_NATIVE) {
+		return;
+	}
+
+	kernels_load(est->storage, est->P_half, est->P_prev, n, est->P_exp);
+	kernels_load(est->storage, est->P_min_half, est->P_min_prev, n, est->P_min_exp);
+	kernels_load(est->storage, est->spp_k_half, est->spp_k, n, est->spp_k_exp);
+	kernels_load(est->storage, est->noise_power_spec_half, est->noise_power_spec, n, est->noise_power_spec_exp);
+}
+
+/**
+ * Средняя по частотам вероятность наличия голоса по рабочему спектру spp_k.
+ */
+static hsv_numeric_t estimator_calculate_mean_spp(const estimator_t est)
+{
+	unsigned k;
+
+	/* Спектр симметричен, поэтому достаточно половины частот (полосы покрывают только половину). */
+	unsigned n = ((est->bands != NULL) ? est->size : est->size / 2 + 1) * est->lanes;
+
+	hsv_numeric_t sum = 0.0;
+
+	for (k = 0; k < n; k++) {
+		sum += est->spp_k[k];
+	}
+
+	return sum / ((hsv_numeric_t) n);
+}
+
+/**
+ * Запись состояния в 16-битный формат. P_prev и P_min_prev совпадают с P и P_min на обновленных частотах,
+ * а на остальных (estimator_run_part) содержат прочитанное состояние.
+ */
+static void estimator_store(estimator_t est)
+{
+	unsigned n = est->size * est->lanes;
+
+	if (est->storage == KERNELS_STORAGE_NATIVE) {
+		return;
+	}
+
+	est->P_exp = kernels_store(est->storage, est->P_prev, est->P_half, n);
+	est->P_min_exp = kernels_store(est->storage, est->P_min_prev, est->P_min_half, n);
+	est->spp_k_exp = kernels_store(est->storage, est->spp_k, est->spp_k_half, n);
+	est->noise_power_spec_exp = kernels_store(est->storage, est->noise_power_spec, est->noise_power_spec_half, n);
 
-	estimator_calculate_noise_amp_spec(est);
+	/* Рабочие спектры не сохраняются до следующего фрейма, а среднее может понадобиться и без оценки шума. */
+	est->mean_spp = estimator_calculate_mean_spp(est);
 }
 
 void estimator_run(estimator_t est, hsv_numeric_t*P)
 {
+	P = estimator_input(est, P);
+
+	if (! est->got_first) {
+		estimator_get_first(est, P);
+	} else {
+		estimator_load(est);
+		estimator_process(est, P, 0, 1);
+		if (est->lane_first != NULL) {
+			estimator_get_first_lanes(est, P);
+		}
+	}
+
+	estimator_store(est);
+}
+
+void estimator_run_part(estimator_t est, hsv_numeric_t*P, unsigned part, unsigned n_parts)
+{
+	P = estimator_input(est, P);
+
 	if (! est->got_first) {
 		estimator_get_first(est, P);
 	} else {
-		estimator_process(est, P);
+		estimator_load(est);
+		estimator_process(est, P, part, n_parts);
+	}
+
+	estimator_store(est);
+}
+
+void estimator_reset_lane(estimator_t est, unsigned lane)
+{
+	if (est->lane_first == NULL) {
+		est->got_first = 0;
+	} else {
+		est->lane_first[lane] = 1;
 	}
 }
 
+hsv_numeric_t estimator_mean_spp(const estimator_t est)
+{
+	if (! est->got_first) {
+		return 1.0;
+	}
+
+	if (est->storage != KERNELS_STORAGE_NATIVE) {
+		return est->mean_spp;
+	}
+
+	return estimator_calculate_mean_spp(est);
+}
+
 void estimator_deconfig(estimator_t est)
 {
-	free(est->noise_amp_spec);
-	free(est->noise_power_spec);
-	free(est->spp_k);
-	free(est->P_min_prev);
-	free(est->P_min);
-	free(est->P_prev);
-	free(est->P);
-	free(est->delta_k);
+	arena_t spec_arena = estimator_spec_arena(est);
+
+	arena_free(est->arena, est->P_bands);
+	arena_free(est->arena, est->lane_first);
+	arena_free(est->arena, est->P_half);
+	arena_free(est->arena, est->noise_amp_spec);
+	arena_free(spec_arena, est->noise_power_spec);
+	arena_free(spec_arena, est->spp_k);
+	arena_free(spec_arena, est->P_min_prev);
+	arena_free(spec_arena, est->P_min);
+	arena_free(spec_arena, est->P_prev);
+	arena_free(spec_arena, est->P);
+	arena_free(est->arena, est->delta_k);
 }
 
 void estimator_clean(estimator_t est)
@@ -16,6 +16,11 @@ extern "C" {
 
 #include "hsv_types.h"
 
+#include "arena.h"
+
+#include "bands.h"
+#include "kernels.h"
+
 /**
  * Коды, возвращаемые методами estimator_...
  */
@@ -39,6 +44,12 @@ struct ESTIMATOR
 	unsigned sr;   /**< Частота дискретизации. */
 	unsigned size; /**< Размер фрейма.         */
 
+	/**
+	 * Число независимых потоков (см. estimator_config_lanes). Спектры потоков чередуются по частотам:
+	 * значение частоты k потока l хранится по индексу k * lanes + l.
+	 */
+	unsigned lanes;
+
 	hsv_numeric_t*delta_k; /**< Частотно-зависимые пороги присутствия голоса. */
 
 	hsv_numeric_t alpha_smooth; /**< Коэффициент сглаживания зашумленного сигнала во времени. */
@@ -58,7 +69,36 @@ struct ESTIMATOR
 	hsv_numeric_t*noise_power_spec; /**< Спектр мощности шума. */
 	hsv_numeric_t*noise_amp_spec;   /**< Спектр амплитуд шума. */
 
-	int got_first; /**< Был ли получен первый фрейм. */
+	int got_first;             /**< Был ли получен первый фрейм.                                          */
+	unsigned char*lane_first;  /**< Признаки потоков, следующий фрейм которых - первый (только при lanes > 1). */
+
+	/**
+	 * Минимальное значение рекурсивных спектров мощности (0 - без ограничения, см. estimator_set_eps).
+	 * Ограничение исключает деление 0 / 0 на цифровой тишине и денормализованные числа при ее приближении.
+	 */
+	hsv_numeric_t eps;
+
+	const struct BANDS*bands; /**< Критические полосы (NULL - оценка по частотам ДПФ). */
+	hsv_numeric_t*P_bands;    /**< Спектр мощности зашумленного сигнала по полосам.    */
+
+	/**
+	 * Формат хранения рекурсивных спектров между фреймами. При 16-битном формате P, P_prev, P_min, P_min_prev,
+	 * spp_k и noise_power_spec выделяются из рабочей арены и действительны только во время estimator_run,
+	 * а между фреймами состояние хранится в P_half, P_min_half, spp_k_half и noise_power_spec_half.
+	 */
+	enum KERNELS_STORAGE storage;
+	uint16_t*P_half;                /**< Сглаженный спектр мощности зашумленного сигнала. */
+	uint16_t*P_min_half;            /**< Оценка шума методом Доблингера.                  */
+	uint16_t*spp_k_half;            /**< Вероятность наличия голоса.                      */
+	uint16_t*noise_power_spec_half; /**< Спектр мощности шума.                            */
+	int P_exp;                      /**< Порядки массивов (см. kernels_store).            */
+	int P_min_exp;
+	int spp_k_exp;
+	int noise_power_spec_exp;
+	hsv_numeric_t mean_spp;         /**< Средняя вероятность наличия голоса после последнего фрейма. */
+
+	arena_t arena;   /**< Арена, из которой выделены буферы.               */
+	arena_t scratch; /**< Арена рабочих спектров при 16-битном хранении. */
 };
 
 typedef struct ESTIMATOR* estimator_t;
@@ -73,15 +113,84 @@ estimator_t create_estimator();
  * Конфигурация оценки шума.
  * \param sr частота дискретизации.
  * \param size размер анализируемого фрейма.
+ * \param storage формат хранения рекурсивных спектров между фреймами.
+ * \param arena арена, из которой выделяются буферы.
+ * \param scratch арена рабочих спектров при 16-битном хранении (содержимое не сохраняется между вызовами estimator_run).
+ * \return результат конфигурирования.
+ */
+enum ESTIMATOR_CODE estimator_config(estimator_t est, unsigned sr, unsigned size, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch);
+
+/**
+ * Конфигурация оценки шума по критическим полосам.
+ * Состояние и вычисления не зависят от размера ДПФ: на вход подается спектр мощности по частотам ДПФ,
+ * а спектры шума (noise_power_spec, noise_amp_spec) получаются по полосам.
+ * \param sr частота дискретизации.
+ * \param bands критические полосы (должны существовать, пока существует оценка шума).
+ * \param storage формат хранения рекурсивных спектров между фреймами.
+ * \param arena арена, из которой выделяются буферы.
+ * \param scratch арена рабочих спектров (см. estimator_config).
+ * \return результат конфигурирования.
+ */
+enum ESTIMATOR_CODE estimator_config_bands(estimator_t est, unsigned sr, const struct BANDS*bands, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch);
+
+/**
+ * Конфигурация оценки шума lanes независимых потоков с чередующимися по частотам спектрами.
+ * Рекурсии всех потоков обновляются одним проходом векторизованных ядер по size * lanes значениям,
+ * а результат каждого потока совпадает с оценкой шума, сконфигурированной estimator_config, бит в бит.
+ * \param sr частота дискретизации.
+ * \param size размер анализируемого фрейма.
+ * \param lanes число потоков.
+ * \param storage формат хранения рекурсивных спектров между фреймами.
+ * \param arena арена, из которой выделяются буферы.
+ * \param scratch арена рабочих спектров (см. estimator_config).
  * \return результат конфигурирования.
  */
-enum ESTIMATOR_CODE estimator_config(estimator_t est, unsigned sr, unsigned size);
+enum ESTIMATOR_CODE estimator_config_lanes(estimator_t est, unsigned sr, unsigned size, unsigned lanes, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch);
+
+/**
+ * Учет памяти estimator_config в аренах без конфигурации (см. arena_reserve).
+ */
+void estimator_reserve(unsigned size, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch);
+
+/**
+ * Учет памяти estimator_config_bands для n_bands полос (см. bands_reserve).
+ */
+void estimator_reserve_bands(unsigned n_bands, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch);
+
+/**
+ * Учет памяти estimator_config_lanes.
+ */
+void estimator_reserve_lanes(unsigned size, unsigned lanes, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch);
+
+/**
+ * Ограничение рекурсивных спектров мощности снизу значением eps, а вероятности наличия голоса - обнулением ниже eps.
+ * \param eps минимальное значение (0 - без ограничения, по умолчанию).
+ */
+void estimator_set_eps(estimator_t est, hsv_numeric_t eps);
 
 /**
  * Выполнение оценки шума.
  */
 void estimator_run(estimator_t est, hsv_numeric_t*P);
 
+/**
+ * Выполнение оценки шума только на частотах k, для которых k % n_parts == part.
+ * Позволяет распределить обновление оценки по n_parts фреймам.
+ * Первый фрейм всегда обрабатывается целиком. Только для одного потока (lanes = 1).
+ */
+void estimator_run_part(estimator_t est, hsv_numeric_t*P, unsigned part, unsigned n_parts);
+
+/**
+ * Сброс оценки шума потока lane: следующий фрейм потока обрабатывается как первый.
+ * \param lane номер потока (0 при estimator_config).
+ */
+void estimator_reset_lane(estimator_t est, unsigned lane);
+
+/**
+ * \return средняя по частотам сглаженная вероятность наличия голоса (1.0, если фреймов ещё не было).
+ */
+hsv_numeric_t estimator_mean_spp(const estimator_t est);
+
 /**
  * Удаление всех внутренних динамических структур.
  */
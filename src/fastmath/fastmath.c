@@ -0,0 +1,183 @@
+/**
+ * \file fastmath.c
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Реализация API быстрых приближений элементарных функций над массивами.
+ */
+/**
+ * \ingroup fastmath
+ * \{
+ */
+#include "fastmath.h"
+
+#include <string.h>
+#include <inttypes.h>
+
+#include <math.h>
+
+/**
+ * Разложение положительного нормализованного числа x = m * 2^e, m из [0.5, 1), как frexp.
+ * Для float и double порядок и мантисса выделяются из битового представления без вызова libm.
+ */
+static hsv_numeric_t fastmath_frexp(hsv_numeric_t x, int*e)
+{
+#if defined(LOW_ACC)
+	uint32_t u;
+
+	memcpy(&u, &x, sizeof(u));
+	*e = (int) ((u >> 23) & 0xff) - 126;
+	u = (u & 0x807fffffu) | 0x3f000000u;
+	memcpy(&x, &u, sizeof(x));
+
+	return x;
+#elif defined(MED_ACC)
+	uint64_t u;
+
+	memcpy(&u, &x, sizeof(u));
+	*e = (int) ((u >> 52) & 0x7ff) - 1022;
+	u = (u & 0x800fffffffffffffull) | 0x3fe0000000000000ull;
+	memcpy(&x, &u, sizeof(x));
+
+	return x;
+#else
+	return HSV_FREXP(x, e);
+#endif
+}
+
+void fastmath_atan2(const hsv_numeric_t*y, const hsv_numeric_t*x, hsv_numeric_t*out, unsigned n)
+{
+	static const hsv_numeric_t pi_2 = 1.570796326794897;
+	static const hsv_numeric_t pi = 3.141592653589793;
+
+	/* Минимаксный нечетный полином 11-й степени для atan(t), t из [0, 1]: погрешность 2e-6 рад без приведения аргумента. */
+	static const hsv_numeric_t c1 = 0.99997726;
+	static const hsv_numeric_t c3 = -0.33262347;
+	static const hsv_numeric_t c5 = 0.19354346;
+	static const hsv_numeric_t c7 = -0.11643287;
+	static const hsv_numeric_t c9 = 0.05265332;
+	static const hsv_numeric_t c11 = -0.01172120;
+
+	/* Константы типа hsv_numeric_t, чтобы для float вычисления не переходили в double. */
+	static const hsv_numeric_t zero = 0.0;
+	static const hsv_numeric_t one = 1.0;
+
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		hsv_numeric_t ax = HSV_ABS(x[i]);
+		hsv_numeric_t ay = HSV_ABS(y[i]);
+		hsv_numeric_t mx = HSV_MAX(ax, ay);
+		hsv_numeric_t mn = HSV_MIN(ax, ay);
+
+		hsv_numeric_t t = mn / ((mx > zero) ? mx : one);
+		hsv_numeric_t z = t * t;
+		hsv_numeric_t r = t * (c1 + z * (c3 + z * (c5 + z * (c7 + z * (c9 + z * c11)))));
+
+		r = (ay > ax) ? pi_2 - r : r;
+		r = (x[i] < zero) ? pi - r : r;
+		out[i] = (y[i] < zero) ? -r : r;
+	}
+}
+
+void fastmath_sincos(const hsv_numeric_t*a, hsv_numeric_t*s, hsv_numeric_t*c, unsigned n)
+{
+	static const hsv_numeric_t two_over_pi = 0.636619772367581;
+
+	/* pi / 2 = dp1 + dp2 + dp3: dp1 и dp2 точны в нескольких битах, поэтому k * dp1 и k * dp2 вычисляются без ошибки. */
+	static const hsv_numeric_t dp1 = 1.5703125;
+	static const hsv_numeric_t dp2 = 4.83751296997070312e-4;
+	static const hsv_numeric_t dp3 = 7.54978995489188216e-8;
+
+	/* Cephes sinf и cosf на [-pi / 4, pi / 4]. */
+	static const hsv_numeric_t s0 = -1.9515295891e-4;
+	static const hsv_numeric_t s1 = 8.3321608736e-3;
+	static const hsv_numeric_t s2 = -1.6666654611e-1;
+	static const hsv_numeric_t c0 = 2.443315711809948e-5;
+	static const hsv_numeric_t c1 = -1.388731625493765e-3;
+	static const hsv_numeric_t c2 = 4.166664568298827e-2;
+
+	static const hsv_numeric_t zero = 0.0;
+	static const hsv_numeric_t half = 0.5;
+	static const hsv_numeric_t one = 1.0;
+
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		hsv_numeric_t t = a[i] * two_over_pi;
+		int k = (int) (t + ((t >= zero) ? half : -half));
+		hsv_numeric_t r = ((a[i] - k * dp1) - k * dp2) - k * dp3;
+		hsv_numeric_t z = r * r;
+
+		hsv_numeric_t sn = r + r * z * ((s0 * z + s1) * z + s2);
+		hsv_numeric_t cs = one - half * z + z * z * ((c0 * z + c1) * z + c2);
+
+		/* Четверть периода k & 3: sin(r + k * pi / 2) и cos(r + k * pi / 2) через sin(r) и cos(r). */
+		hsv_numeric_t sv = (k & 1) ? cs : sn;
+		hsv_numeric_t cv = (k & 1) ? sn : cs;
+
+		s[i] = (k & 2) ? -sv : sv;
+		c[i] = ((k + 1) & 2) ? -cv : cv;
+	}
+}
+
+hsv_numeric_t fastmath_log10(hsv_numeric_t x)
+{
+	static const hsv_numeric_t sqrt_1_2 = 0.707106781186548;
+	static const hsv_numeric_t ln_2 = 0.693147180559945;
+	static const hsv_numeric_t log10_e = 0.434294481903252;
+
+	/* Коэффициенты ряда 2 * atanh(z) = 2 * z * (1 + z^2 / 3 + z^4 / 5 + ...). */
+	static const hsv_numeric_t one = 1.0;
+	static const hsv_numeric_t two = 2.0;
+	static const hsv_numeric_t a3 = 1.0 / 3.0;
+	static const hsv_numeric_t a5 = 1.0 / 5.0;
+	static const hsv_numeric_t a7 = 1.0 / 7.0;
+	static const hsv_numeric_t a9 = 1.0 / 9.0;
+
+	int e;
+
+	hsv_numeric_t m = fastmath_frexp(x, &e);
+	hsv_numeric_t z, z2;
+
+	/* m из [sqrt(1 / 2), sqrt(2)), ln(m) = 2 * atanh(z), z = (m - 1) / (m + 1), |z| <= 0.172. */
+	if (m < sqrt_1_2) {
+		m *= two;
+		e--;
+	}
+	z = (m - one) / (m + one);
+	z2 = z * z;
+
+	return (two * z * (one + z2 * (a3 + z2 * (a5 + z2 * (a7 + z2 * a9)))) + e * ln_2) * log10_e;
+}
+
+void fastmath_pow(const hsv_numeric_t*x, hsv_numeric_t e, hsv_numeric_t*out, unsigned n)
+{
+	unsigned i;
+
+	if (e == 2.0) {
+		for (i = 0; i < n; i++) {
+			out[i] = x[i] * x[i];
+		}
+	} else if (e == 1.0) {
+		for (i = 0; i < n; i++) {
+			out[i] = x[i];
+		}
+	} else if (e == 0.5) {
+		fastmath_sqrt(x, out, n);
+	} else {
+		for (i = 0; i < n; i++) {
+			out[i] = HSV_POW(x[i], e);
+		}
+	}
+}
+
+void fastmath_sqrt(const hsv_numeric_t*x, hsv_numeric_t*out, unsigned n)
+{
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		out[i] = HSV_SQRT(x[i]);
+	}
+}
+/**
+ * /}
+ */
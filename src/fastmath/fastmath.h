@@ -0,0 +1,63 @@
+/**
+ * \file fastmath.h
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief API быстрых приближений элементарных функций над массивами.
+ */
+/**
+ * \defgroup fastmath Модуль быстрых приближений элементарных функций.
+ * \{
+ */
+#ifndef FASTMATH_H_INCLUDED
+#define FASTMATH_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+#include "hsv_types.h"
+
+/**
+ * Функции обрабатывают массивы без вызовов libm и ветвлений в теле цикла, поэтому компилятор векторизует их
+ * (кроме fastmath_log10, которая вычисляется для фрейма один раз). Приближения полиномиальные и не зависят
+ * от hsv_numeric_t: для float их точность близка к libm, для double и long double - ограничена приведенной.
+ * Максимальные абсолютные погрешности относительно libm для float (см. bin/fastmath):
+ * fastmath_atan2  - 2e-6 рад;
+ * fastmath_sincos - 2e-7 (для |a| <= 2 * pi);
+ * fastmath_log10  - 1e-6;
+ * fastmath_pow    - 0 для показателей 1, 2 и 0.5 (libm для остальных);
+ * fastmath_sqrt   - 0 (аппаратный корень, цикл без шага).
+ */
+
+/**
+ * Арктангенс y / x с учетом квадранта: out[i] = atan2(y[i], x[i]).
+ */
+void fastmath_atan2(const hsv_numeric_t*y, const hsv_numeric_t*x, hsv_numeric_t*out, unsigned n);
+
+/**
+ * Синус и косинус: s[i] = sin(a[i]), c[i] = cos(a[i]). Массив a может совпадать с s или c.
+ */
+void fastmath_sincos(const hsv_numeric_t*a, hsv_numeric_t*s, hsv_numeric_t*c, unsigned n);
+
+/**
+ * Десятичный логарифм положительного нормализованного числа.
+ */
+hsv_numeric_t fastmath_log10(hsv_numeric_t x);
+
+/**
+ * Степень неотрицательных чисел: out[i] = x[i]^e.
+ */
+void fastmath_pow(const hsv_numeric_t*x, hsv_numeric_t e, hsv_numeric_t*out, unsigned n);
+
+/**
+ * Квадратный корень: out[i] = sqrt(x[i]).
+ */
+void fastmath_sqrt(const hsv_numeric_t*x, hsv_numeric_t*out, unsigned n);
+
+#ifdef __cplusplus
+}
+#endif  /* __cplusplus */
+
+#endif  /* FASTMATH_H_INCLUDED */
+/**
+ * /}
+ */
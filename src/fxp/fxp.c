@@ -0,0 +1,535 @@
+/**
+ * \file fxp.c
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Реализация API вычислений с фиксированной точкой.
+ */
+/**
+ * \ingroup fxp
+ * \{
+ */
+#include "fxp.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif	/* M_PI */
+
+/**
+ * Начальные приближения 2^62 / d для d из [2^31, 2^32): 2^37 / (65 + 2 * i) для середины i-го из 32 отрезков.
+ */
+static const uint32_t recip_tab[32] = {
+	0x7E07E07E, 0x7A44C6B0, 0x76B981DB, 0x73615A24,
+	0x70381C0E, 0x6D3A06D4, 0x6A63BD82, 0x67B23A54,
+	0x6522C3F3, 0x62B2E43E, 0x60606060, 0x5E293206,
+	0x5C0B8170, 0x5A05A05A, 0x58160581, 0x563B48C2,
+	0x54741FAC, 0x52BF5A81, 0x511BE196, 0x4F88B2F4,
+	0x4E04E04E, 0x4C8F8D29, 0x4B27ED36, 0x49CD42E2,
+	0x487EDE05, 0x473C1AB7, 0x46046046, 0x44D72045,
+	0x43B3D5B0, 0x429A042A, 0x4189374C, 0x40810204,
+};
+
+/**
+ * Число старших нулевых битов (x != 0).
+ */
+static unsigned clz64(uint64_t x)
+{
+	unsigned n = 0;
+
+	if ((x >> 32) == 0) { n += 32; x <<= 32; }
+	if ((x >> 48) == 0) { n += 16; x <<= 16; }
+	if ((x >> 56) == 0) { n += 8;  x <<= 8;  }
+	if ((x >> 60) == 0) { n += 4;  x <<= 4;  }
+	if ((x >> 62) == 0) { n += 2;  x <<= 2;  }
+	if ((x >> 63) == 0) { n += 1; }
+
+	return n;
+}
+
+/**
+ * Умножение неотрицательного 64-битного значения на коэффициент в Q15 (c <= FXP_Q15_ONE) без переполнения.
+ */
+static uint64_t mul_q15(uint64_t p, uint32_t c)
+{
+	return (p >> 15) * c + (((p & 0x7FFF) * c) >> 15);
+}
+
+/**
+ * Деление со сдвигом и округлением.
+ */
+static int32_t shr_round(int64_t v, unsigned s)
+{
+	return (int32_t) ((v + (((int64_t) 1) << (s - 1))) >> s);
+}
+
+uint32_t fxp_recip(uint32_t d)
+{
+	uint32_t r = recip_tab[(d >> 26) & 31];
+	uint64_t e;
+
+	unsigned i;
+
+	/* r = r * (2 - d * r): d - Q32, r - Q30. */
+	for (i = 0; i < 2; i++) {
+		e = (((uint64_t) d) * r) >> 32;
+		r = (uint32_t) ((((uint64_t) r) * ((((uint64_t) 1) << 31) - e)) >> 30);
+	}
+
+	return r;
+}
+
+uint32_t fxp_div_q16(uint64_t num, uint64_t den)
+{
+	unsigned n, m;
+	int sh;
+
+	uint64_t q;
+
+	if (num == 0) {
+		return 0;
+	}
+	if (den == 0) {
+		return UINT32_MAX;
+	}
+
+	/* num = n32 * 2^(32 - m), den = d32 * 2^(32 - n), 1 / d32 = r / 2^62. */
+	n = clz64(den);
+	m = clz64(num);
+	q = ((num << m) >> 32) * fxp_recip((uint32_t) ((den << n) >> 32));
+
+	sh = 46 - (int) n + (int) m;
+	if (sh <= 0) {
+		return UINT32_MAX;
+	} else if (sh >= 64) {
+		return 0;
+	}
+
+	q >>= sh;
+	return (q > UINT32_MAX) ? UINT32_MAX : (uint32_t) q;
+}
+
+fxp_dft_t create_fxp_dft()
+{
+	fxp_dft_t dft;
+
+	dft = (fxp_dft_t) calloc(1, sizeof(struct FXP_DFT));
+	return dft;
+}
+
+enum FXP_CODE fxp_dft_config(fxp_dft_t dft, unsigned size, arena_t arena)
+{
+	enum FXP_CODE r;
+
+	unsigned k, b, rev;
+
+	dft->size = size;
+	dft->arena = arena;
+	for (dft->log2 = 0; (1U << dft->log2) < size; dft->log2++);
+
+	dft->cos_tab = (int16_t*) arena_calloc(dft->arena, size / 2, sizeof(int16_t));
+	if (dft->cos_tab == NULL) {
+		r = FXP_CODE_ALLOC_ERR;
+		goto err0;
+	}
+	dft->sin_tab = (int16_t*) arena_calloc(dft->arena, size / 2, sizeof(int16_t));
+	if (dft->sin_tab == NULL) {
+		r = FXP_CODE_ALLOC_ERR;
+		goto err1;
+	}
+	dft->rev_tab = (unsigned*) arena_calloc(dft->arena, size, sizeof(unsigned));
+	if (dft->rev_tab == NULL) {
+		r = FXP_CODE_ALLOC_ERR;
+		goto err2;
+	}
+
+	/* Таблицы рассчитываются один раз при конфигурации, поэтому плавающая точка здесь допустима. */
+	for (k = 0; k < size / 2; k++) {
+		double c = floor(cos(2.0 * M_PI * k / size) * FXP_Q15_ONE + 0.5);
+		double s = floor(sin(2.0 * M_PI * k / size) * FXP_Q15_ONE + 0.5);
+		dft->cos_tab[k] = (int16_t) ((c > INT16_MAX) ? INT16_MAX : c);
+		dft->sin_tab[k] = (int16_t) ((s > INT16_MAX) ? INT16_MAX : s);
+	}
+
+	for (k = 0; k < size; k++) {
+		rev = 0;
+		for (b = 0; b < dft->log2; b++) {
+			rev |= ((k >> b) & 1) << (dft->log2 - 1 - b);
+		}
+		dft->rev_tab[k] = rev;
+	}
+
+	return FXP_CODE_OK;
+
+ err2:
+	arena_free(dft->arena, dft->sin_tab);
+ err1:
+	arena_free(dft->arena, dft->cos_tab);
+ err0:
+	return r;
+}
+
+void fxp_dft_reserve(unsigned size, arena_t arena)
+{
+	arena_reserve(arena, size / 2, sizeof(int16_t));
+	arena_reserve(arena, size / 2, sizeof(int16_t));
+	arena_reserve(arena, size, sizeof(unsigned));
+}
+
+unsigned fxp_dft_normalize(const struct FXP_DFT*dft, int32_t*real)
+{
+	int32_t limit = ((int32_t) 1) << (30 - dft->log2);
+	int32_t m = 0;
+
+	unsigned k, shift = 0;
+
+	for (k = 0; k < dft->size; k++) {
+		int32_t a = (real[k] >= 0) ? real[k] : -real[k];
+		if (a > m) {
+			m = a;
+		}
+	}
+
+	if (m == 0) {
+		return 0;
+	}
+	while ((m << (shift + 1)) <= limit) {
+		shift++;
+	}
+
+	for (k = 0; k < dft->size; k++) {
+		real[k] = (int32_t) ((uint32_t) real[k] << shift);
+	}
+
+	return shift;
+}
+
+/**
+ * Алгоритм Кули-Тьюки с прореживанием по времени.
+ * \param sign знак синуса в поворачивающем множителе (-1 - прямое ДПФ, 1 - обратное).
+ * \param scale делить ли результат каждой ступени на 2.
+ */
+static void fxp_dft_run(const struct FXP_DFT*dft, int32_t*real, int32_t*imag, int sign, int scale)
+{
+	unsigned k, j, len, half, step;
+
+	for (k = 0; k < dft->size; k++) {
+		unsigned r = dft->rev_tab[k];
+		if (r > k) {
+			int32_t t;
+			t = real[k]; real[k] = real[r]; real[r] = t;
+			t = imag[k]; imag[k] = imag[r]; imag[r] = t;
+		}
+	}
+
+	for (len = 2; len <= dft->size; len <<= 1) {
+		half = len / 2;
+		step = dft->size / len;
+		for (k = 0; k < dft->size; k += len) {
+			for (j = 0; j < half; j++) {
+				int32_t wr = dft->cos_tab[j * step];
+				int32_t wi = sign * dft->sin_tab[j * step];
+
+				int32_t*ar = real + k + j;
+				int32_t*ai = imag + k + j;
+				int32_t*br = ar + half;
+				int32_t*bi = ai + half;
+
+				int32_t tr = shr_round(((int64_t) *br) * wr - ((int64_t) *bi) * wi, 15);
+				int32_t ti = shr_round(((int64_t) *br) * wi + ((int64_t) *bi) * wr, 15);
+
+				if (scale) {
+					*br = shr_round(((int64_t) *ar) - tr, 1);
+					*bi = shr_round(((int64_t) *ai) - ti, 1);
+					*ar = shr_round(((int64_t) *ar) + tr, 1);
+					*ai = shr_round(((int64_t) *ai) + ti, 1);
+				} else {
+					*br = *ar - tr;
+					*bi = *ai - ti;
+					*ar = *ar + tr;
+					*ai = *ai + ti;
+				}
+			}
+		}
+	}
+}
+
+void fxp_dft_run_dft(const struct FXP_DFT*dft, int32_t*real, int32_t*imag)
+{
+	fxp_dft_run(dft, real, imag, -1, 0);
+}
+
+void fxp_dft_run_i_dft(const struct FXP_DFT*dft, int32_t*real, int32_t*imag)
+{
+	fxp_dft_run(dft, real, imag, 1, 1);
+}
+
+void fxp_dft_power_spec(const struct FXP_DFT*dft, const int32_t*real, const int32_t*imag, unsigned shift, uint64_t*power_spec)
+{
+	unsigned k;
+
+	/* Порядок блока 2^shift в мощности дает 2^(2 * shift). */
+	int sh = 2 * (int) shift - FXP_POWER_Q;
+
+	for (k = 0; k <= dft->size / 2; k++) {
+		uint64_t p = (uint64_t) (((int64_t) real[k]) * real[k]) + (uint64_t) (((int64_t) imag[k]) * imag[k]);
+		power_spec[k] = (sh >= 0) ? (p >> sh) : (p << -sh);
+	}
+}
+
+void fxp_dft_deconfig(fxp_dft_t dft)
+{
+	arena_free(dft->arena, dft->rev_tab);
+	arena_free(dft->arena, dft->sin_tab);
+	arena_free(dft->arena, dft->cos_tab);
+}
+
+void fxp_dft_clean(fxp_dft_t dft)
+{
+	memset(dft, '\0', sizeof(*dft));
+}
+
+void fxp_dft_free(fxp_dft_t dft)
+{
+	free(dft);
+}
+
+fxp_estimator_t create_fxp_estimator()
+{
+	fxp_estimator_t est;
+
+	est = (fxp_estimator_t) calloc(1, sizeof(struct FXP_ESTIMATOR));
+	return est;
+}
+
+enum FXP_CODE fxp_estimator_config(fxp_estimator_t est, unsigned sr, unsigned size, arena_t arena)
+{
+	enum FXP_CODE r;
+
+	unsigned k;
+
+	/* Пороги те же, что и в estimator.c: 2 до 3000 Гц, 5 выше. */
+	unsigned MF = (unsigned) (3000.0 * size / sr);
+
+	est->size = size / 2 + 1;
+	est->arena = arena;
+
+	est->delta_k = (uint8_t*) arena_calloc(est->arena, est->size, sizeof(uint8_t));
+	if (est->delta_k == NULL) {
+		r = FXP_CODE_ALLOC_ERR;
+		goto err0;
+	}
+	for (k = 0; k < est->size; k++) {
+		est->delta_k[k] = ((k < MF) && (k < size / 2)) ? 2 : 5;
+	}
+
+	est->P = (uint64_t*) arena_calloc(est->arena, est->size, sizeof(uint64_t));
+	if (est->P == NULL) {
+		r = FXP_CODE_ALLOC_ERR;
+		goto err1;
+	}
+	est->P_min = (uint64_t*) arena_calloc(est->arena, est->size, sizeof(uint64_t));
+	if (est->P_min == NULL) {
+		r = FXP_CODE_ALLOC_ERR;
+		goto err2;
+	}
+	est->spp_k = (int32_t*) arena_calloc(est->arena, est->size, sizeof(int32_t));
+	if (est->spp_k == NULL) {
+		r = FXP_CODE_ALLOC_ERR;
+		goto err3;
+	}
+	est->noise_spec = (uint64_t*) arena_calloc(est->arena, est->size, sizeof(uint64_t));
+	if (est->noise_spec == NULL) {
+		r = FXP_CODE_ALLOC_ERR;
+		goto err4;
+	}
+
+	est->got_first = 0;
+
+	return FXP_CODE_OK;
+
+ err4:
+	arena_free(est->arena, est->spp_k);
+ err3:
+	arena_free(est->arena, est->P_min);
+ err2:
+	arena_free(est->arena, est->P);
+ err1:
+	arena_free(est->arena, est->delta_k);
+ err0:
+	return r;
+}
+
+void fxp_estimator_reserve(unsigned size, arena_t arena)
+{
+	arena_reserve(arena, size / 2 + 1, sizeof(uint8_t));
+	arena_reserve(arena, size / 2 + 1, sizeof(uint64_t));
+	arena_reserve(arena, size / 2 + 1, sizeof(uint64_t));
+	arena_reserve(arena, size / 2 + 1, sizeof(int32_t));
+	arena_reserve(arena, size / 2 + 1, sizeof(uint64_t));
+}
+
+void fxp_estimator_run(fxp_estimator_t est, const uint64_t*power_spec)
+{
+	/* Коэффициенты estimator.c в Q15. */
+	static const uint32_t alpha_smooth = 22938; /* 0.7   */
+	static const uint32_t gamma = 32702;        /* 0.998 */
+	static const uint32_t alpha_spp = 6554;     /* 0.2   */
+	static const uint32_t alpha = 31130;        /* 0.95  */
+
+	unsigned k;
+
+	if (! est->got_first) {
+		memcpy(est->P, power_spec, est->size * sizeof(uint64_t));
+		memcpy(est->P_min, power_spec, est->size * sizeof(uint64_t));
+		memcpy(est->noise_spec, power_spec, est->size * sizeof(uint64_t));
+		est->got_first = 1;
+		return;
+	}
+
+	for (k = 0; k < est->size; k++) {
+		uint32_t ak;
+
+		/* Сглаживание спектра входного зашумленного сигнала. */
+		est->P[k] = mul_q15(est->P[k], alpha_smooth) + mul_q15(power_spec[k], FXP_Q15_ONE - alpha_smooth);
+
+		/* Отслеживание минимумов по Доблингеру. В estimator.c прогноз вычисляется по уже обновленному P_prev,
+		   поэтому слагаемое (1 - gamma) / (1 - beta) * (P - beta * P_prev) равно (1 - gamma) * P. */
+		if (est->P_min[k] < est->P[k]) {
+			est->P_min[k] = mul_q15(est->P_min[k], gamma) + mul_q15(est->P[k], FXP_Q15_ONE - gamma);
+		} else {
+			est->P_min[k] = est->P[k];
+		}
+
+		/* Бинарная оценка наличия голоса P / P_min > delta без деления и ее сглаживание во времени. */
+		est->spp_k[k] = (int32_t) ((alpha_spp * (uint32_t) est->spp_k[k] +
+									((est->P[k] > est->delta_k[k] * est->P_min[k]) ? (FXP_Q15_ONE - alpha_spp) * FXP_Q15_ONE : 0)) >> 15);
+
+		/* Коэффициент сглаживания шума и итоговая оценка спектра шума. */
+		ak = alpha + (((FXP_Q15_ONE - alpha) * (uint32_t) est->spp_k[k]) >> 15);
+		est->noise_spec[k] = mul_q15(est->noise_spec[k], ak) + mul_q15(est->P[k], FXP_Q15_ONE - ak);
+	}
+}
+
+void fxp_estimator_deconfig(fxp_estimator_t est)
+{
+	arena_free(est->arena, est->noise_spec);
+	arena_free(est->arena, est->spp_k);
+	arena_free(est->arena, est->P_min);
+	arena_free(est->arena, est->P);
+	arena_free(est->arena, est->delta_k);
+}
+
+void fxp_estimator_clean(fxp_estimator_t est)
+{
+	memset(est, '\0', sizeof(*est));
+}
+
+void fxp_estimator_free(fxp_estimator_t est)
+{
+	free(est);
+}
+
+fxp_wiener_t create_fxp_wiener()
+{
+	fxp_wiener_t wiener;
+
+	wiener = (fxp_wiener_t) calloc(1, sizeof(struct FXP_WIENER));
+	return wiener;
+}
+
+enum FXP_CODE fxp_wiener_config(fxp_wiener_t wiener, unsigned size, arena_t arena)
+{
+	enum FXP_CODE r;
+
+	wiener->dft_size = size;
+	wiener->size = size / 2 + 1;
+	wiener->arena = arena;
+
+	wiener->speech_spec_prev = (uint64_t*) arena_calloc(wiener->arena, wiener->size, sizeof(uint64_t));
+	if (wiener->speech_spec_prev == NULL) {
+		r = FXP_CODE_ALLOC_ERR;
+		goto err0;
+	}
+	wiener->gain = (int32_t*) arena_calloc(wiener->arena, wiener->size, sizeof(int32_t));
+	if (wiener->gain == NULL) {
+		r = FXP_CODE_ALLOC_ERR;
+		goto err1;
+	}
+
+	return FXP_CODE_OK;
+
+ err1:
+	arena_free(wiener->arena, wiener->speech_spec_prev);
+ err0:
+	return r;
+}
+
+void fxp_wiener_reserve(unsigned size, arena_t arena)
+{
+	arena_reserve(arena, size / 2 + 1, sizeof(uint64_t));
+	arena_reserve(arena, size / 2 + 1, sizeof(int32_t));
+}
+
+void fxp_wiener_run(fxp_wiener_t wiener, const uint64_t*power_spec, const uint64_t*noise_spec)
+{
+	/* Коэффициенты suppressor.c: beta = 0.98 в Q15, floor = 0.01 в Q16 (snr_floor). */
+	static const uint32_t beta = 32113;
+	static const uint32_t snr_floor = 655;
+
+	unsigned k;
+
+	for (k = 0; k < wiener->size; k++) {
+		uint32_t SNR_post, SNR_inst, SNR_prio;
+		uint32_t G;
+
+		/* Мгновенный SNR = апостериорный SNR - 1, не меньше floor. */
+		SNR_post = fxp_div_q16(power_spec[k], noise_spec[k]);
+		SNR_inst = (SNR_post > FXP_Q16_ONE + snr_floor) ? SNR_post - FXP_Q16_ONE : snr_floor;
+
+		/* Априорный SNR по методу принятия решений Эфраима-Малаха. */
+		SNR_prio = (uint32_t) ((((uint64_t) fxp_div_q16(wiener->speech_spec_prev[k], noise_spec[k])) * beta +
+								((uint64_t) SNR_inst) * (FXP_Q15_ONE - beta)) >> 15);
+
+		/* G = SNR_prio / (SNR_prio + 1) в Q15. */
+		G = fxp_div_q16(SNR_prio, ((uint64_t) SNR_prio) + FXP_Q16_ONE) >> 1;
+
+		wiener->gain[k] = (int32_t) G;
+		wiener->speech_spec_prev[k] = mul_q15(mul_q15(power_spec[k], G), G);
+	}
+}
+
+void fxp_wiener_apply(const struct FXP_WIENER*wiener, int32_t*real, int32_t*imag)
+{
+	unsigned k;
+
+	for (k = 0; k < wiener->size; k++) {
+		real[k] = shr_round(((int64_t) real[k]) * wiener->gain[k], 15);
+		imag[k] = shr_round(((int64_t) imag[k]) * wiener->gain[k], 15);
+	}
+	for (k = wiener->size; k < wiener->dft_size; k++) {
+		real[k] = shr_round(((int64_t) real[k]) * wiener->gain[wiener->dft_size - k], 15);
+		imag[k] = shr_round(((int64_t) imag[k]) * wiener->gain[wiener->dft_size - k], 15);
+	}
+}
+
+void fxp_wiener_deconfig(fxp_wiener_t wiener)
+{
+	arena_free(wiener->arena, wiener->gain);
+	arena_free(wiener->arena, wiener->speech_spec_prev);
+}
+
+void fxp_wiener_clean(fxp_wiener_t wiener)
+{
+	memset(wiener, '\0', sizeof(*wiener));
+}
+
+void fxp_wiener_free(fxp_wiener_t wiener)
+{
+	free(wiener);
+}
+/**
+ * /}
+ */
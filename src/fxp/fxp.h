@@ -0,0 +1,259 @@
+/**
+ * \file fxp.h
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief API вычислений с фиксированной точкой: ДПФ с блочной плавающей точкой, оценка шума и винеровская фильтрация.
+ */
+/**
+ * \defgroup fxp Модуль вычислений с фиксированной точкой.
+ * \{
+ */
+#ifndef FXP_H_INCLUDED
+#define FXP_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+#include <inttypes.h>
+
+#include "arena.h"
+
+#define FXP_Q15_ONE   32768 /**< 1.0 в формате Q15.                                  */
+#define FXP_Q16_ONE   65536 /**< 1.0 в формате Q16.                                  */
+#define FXP_POWER_Q   4     /**< Число дробных битов спектров мощности.              */
+#define FXP_MAX_LOG2  13    /**< Максимальный логарифм размера ДПФ (8192 отсчета). */
+
+/**
+ * Коды, возвращаемые методами fxp_...
+ */
+enum FXP_CODE
+{
+	FXP_CODE_OK = 0,         /**< Метод успешно отработал. */
+	FXP_CODE_ALLOC_ERR = -1, /**< Ошибка выделения памяти. */
+};
+
+/**
+ * Структура ДПФ с фиксированной точкой (алгоритм Кули-Тьюки по основанию 2, размер - степень двойки).
+ * Отсчеты хранятся в int32_t, поворачивающие множители - в Q15. Перед прямым ДПФ блок отсчетов сдвигается влево
+ * так, чтобы рост амплитуды на log2(size) ступенях не переполнил 31 бит; величина сдвига - общий порядок блока.
+ * Обратное ДПФ делит результат каждой ступени на 2 (всего на size), поэтому переполнение в нем невозможно.
+ */
+struct FXP_DFT
+{
+	unsigned size; /**< Размер ДПФ.                */
+	unsigned log2; /**< Логарифм размера ДПФ.      */
+
+	int16_t*cos_tab;  /**< cos(2 * pi * k / size), k < size / 2, Q15. */
+	int16_t*sin_tab;  /**< sin(2 * pi * k / size), k < size / 2, Q15. */
+	unsigned*rev_tab; /**< Перестановка с обращением битов.           */
+
+	arena_t arena; /**< Арена, из которой выделены буферы. */
+};
+
+typedef struct FXP_DFT* fxp_dft_t;
+
+/**
+ * Структура оценки шума MCRA-2 с фиксированной точкой (см. estimator.h).
+ * Спектры мощности хранятся в uint64_t с FXP_POWER_Q дробными битами в масштабе входных отсчетов,
+ * коэффициенты сглаживания и вероятность наличия голоса - в Q15. Апостериорный SNR не вычисляется:
+ * его сравнение с порогом заменено сравнением P > delta * P_min.
+ */
+struct FXP_ESTIMATOR
+{
+	unsigned size; /**< Число частот (size / 2 + 1 частот ДПФ). */
+
+	uint8_t*delta_k; /**< Целые пороги присутствия голоса. */
+
+	uint64_t*P;          /**< Сглаженный спектр мощности зашумленного сигнала. */
+	uint64_t*P_min;      /**< Оценка шума методом Доблингера.                   */
+	int32_t*spp_k;       /**< Вероятность наличия голоса, Q15.                  */
+	uint64_t*noise_spec; /**< Спектр мощности шума.                             */
+
+	int got_first; /**< Был ли получен первый фрейм. */
+
+	arena_t arena; /**< Арена, из которой выделены буферы. */
+};
+
+typedef struct FXP_ESTIMATOR* fxp_estimator_t;
+
+/**
+ * Структура винеровской фильтрации с фиксированной точкой (см. HSV_SUPPRESSOR_MODE_WIENER).
+ * Априорный и апостериорный SNR хранятся в Q16 с насыщением, коэффициенты усиления - в Q15.
+ * Все деления выполняются через приближенное обратное значение (таблица и итерации Ньютона).
+ */
+struct FXP_WIENER
+{
+	unsigned dft_size; /**< Размер ДПФ.                              */
+	unsigned size;     /**< Число частот (dft_size / 2 + 1).        */
+
+	uint64_t*speech_spec_prev; /**< Спектр мощности голоса прошлого фрейма. */
+	int32_t*gain;              /**< Коэффициенты усиления, Q15.             */
+
+	arena_t arena; /**< Арена, из которой выделены буферы. */
+};
+
+typedef struct FXP_WIENER* fxp_wiener_t;
+
+/**
+ * Приближенное обратное значение.
+ * \param d делитель из [2^31, 2^32).
+ * \return 2^62 / d (относительная погрешность порядка 2^-24).
+ */
+uint32_t fxp_recip(uint32_t d);
+
+/**
+ * Частное num / den в Q16 с насыщением до UINT32_MAX (при den = 0 - UINT32_MAX или 0 для num = 0).
+ */
+uint32_t fxp_div_q16(uint64_t num, uint64_t den);
+
+/**
+ * Создание структуры ДПФ с фиксированной точкой.
+ * \return указатель на структуру ДПФ (при ошибке - NULL).
+ */
+fxp_dft_t create_fxp_dft();
+
+/**
+ * Конфигурация ДПФ с фиксированной точкой.
+ * \param size размер ДПФ (степень двойки, не больше 2^FXP_MAX_LOG2).
+ * \param arena арена, из которой выделяются буферы.
+ * \return результат конфигурирования.
+ */
+enum FXP_CODE fxp_dft_config(fxp_dft_t dft, unsigned size, arena_t arena);
+
+/**
+ * Учет памяти fxp_dft_config в арене без конфигурации (см. arena_reserve).
+ */
+void fxp_dft_reserve(unsigned size, arena_t arena);
+
+/**
+ * Нормализация блока перед прямым ДПФ: сдвиг влево на наибольшее число битов, при котором амплитуда
+ * после ДПФ помещается в 31 бит.
+ * \param real отсчеты (size), модуль не больше 2^15.
+ * \return сдвиг (порядок блока).
+ */
+unsigned fxp_dft_normalize(const struct FXP_DFT*dft, int32_t*real);
+
+/**
+ * Прямое ДПФ над массивами real и imag без масштабирования.
+ */
+void fxp_dft_run_dft(const struct FXP_DFT*dft, int32_t*real, int32_t*imag);
+
+/**
+ * Обратное ДПФ над массивами real и imag с делением на size.
+ */
+void fxp_dft_run_i_dft(const struct FXP_DFT*dft, int32_t*real, int32_t*imag);
+
+/**
+ * Спектр мощности частот 0..size/2 нормализованного блока в масштабе входных отсчетов (FXP_POWER_Q дробных битов).
+ * \param shift порядок блока (см. fxp_dft_normalize).
+ */
+void fxp_dft_power_spec(const struct FXP_DFT*dft, const int32_t*real, const int32_t*imag, unsigned shift, uint64_t*power_spec);
+
+/**
+ * Удаление всех внутренних динамических структур.
+ */
+void fxp_dft_deconfig(fxp_dft_t dft);
+
+/**
+ * Зануление структуры ДПФ с фиксированной точкой.
+ */
+void fxp_dft_clean(fxp_dft_t dft);
+
+/**
+ * Удаление структуры ДПФ с фиксированной точкой.
+ */
+void fxp_dft_free(fxp_dft_t dft);
+
+/**
+ * Создание структуры оценки шума с фиксированной точкой.
+ * \return указатель на структуру оценки шума (при ошибке - NULL).
+ */
+fxp_estimator_t create_fxp_estimator();
+
+/**
+ * Конфигурация оценки шума с фиксированной точкой.
+ * \param sr частота дискретизации.
+ * \param size размер ДПФ.
+ * \param arena арена, из которой выделяются буферы.
+ * \return результат конфигурирования.
+ */
+enum FXP_CODE fxp_estimator_config(fxp_estimator_t est, unsigned sr, unsigned size, arena_t arena);
+
+/**
+ * Учет памяти fxp_estimator_config в арене без конфигурации (см. arena_reserve).
+ */
+void fxp_estimator_reserve(unsigned size, arena_t arena);
+
+/**
+ * Выполнение оценки шума.
+ * \param power_spec спектр мощности (size / 2 + 1 частот).
+ */
+void fxp_estimator_run(fxp_estimator_t est, const uint64_t*power_spec);
+
+/**
+ * Удаление всех внутренних динамических структур.
+ */
+void fxp_estimator_deconfig(fxp_estimator_t est);
+
+/**
+ * Зануление структуры оценки шума с фиксированной точкой.
+ */
+void fxp_estimator_clean(fxp_estimator_t est);
+
+/**
+ * Удаление структуры оценки шума с фиксированной точкой.
+ */
+void fxp_estimator_free(fxp_estimator_t est);
+
+/**
+ * Создание структуры винеровской фильтрации с фиксированной точкой.
+ * \return указатель на структуру винеровской фильтрации (при ошибке - NULL).
+ */
+fxp_wiener_t create_fxp_wiener();
+
+/**
+ * Конфигурация винеровской фильтрации с фиксированной точкой.
+ * \param size размер ДПФ.
+ * \param arena арена, из которой выделяются буферы.
+ * \return результат конфигурирования.
+ */
+enum FXP_CODE fxp_wiener_config(fxp_wiener_t wiener, unsigned size, arena_t arena);
+
+/**
+ * Учет памяти fxp_wiener_config в арене без конфигурации (см. arena_reserve).
+ */
+void fxp_wiener_reserve(unsigned size, arena_t arena);
+
+/**
+ * Расчет коэффициентов усиления (gain) по спектрам мощности зашумленного голоса и шума (size / 2 + 1 частот).
+ */
+void fxp_wiener_run(fxp_wiener_t wiener, const uint64_t*power_spec, const uint64_t*noise_spec);
+
+/**
+ * Применение коэффициентов усиления к спектру (с симметричным отражением на частоты size/2+1..size-1).
+ */
+void fxp_wiener_apply(const struct FXP_WIENER*wiener, int32_t*real, int32_t*imag);
+
+/**
+ * Удаление всех внутренних динамических структур.
+ */
+void fxp_wiener_deconfig(fxp_wiener_t wiener);
+
+/**
+ * Зануление структуры винеровской фильтрации с фиксированной точкой.
+ */
+void fxp_wiener_clean(fxp_wiener_t wiener);
+
+/**
+ * Удаление структуры винеровской фильтрации с фиксированной точкой.
+ */
+void fxp_wiener_free(fxp_wiener_t wiener);
+
+#ifdef __cplusplus
+}
+#endif  /* __cplusplus */
+
+#endif  /* FXP_H_INCLUDED */
+/**
+ * /}
+ */
@@ -0,0 +1,167 @@
+/**
+ * \file halfband.c
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Реализация API полуполосных фильтров для децимации и интерполяции в 2 раза.
+ */
+/**
+ * \ingroup halfband
+ * \{
+ */
+#include "halfband.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <math.h>
+
+#include "utils.h"
+
+halfband_t create_halfband()
+{
+	halfband_t hb;
+
+	hb = (halfband_t) calloc(1, sizeof(struct HALFBAND));
+	return hb;
+}
+
+static void init_coefs(hsv_numeric_t*coefs, unsigned half)
+{
+	/* Коэффициент окна Кайзера, соответствующий подавлению в полосе задерживания около 60 dB. */
+	static const double beta = 5.65;
+
+	unsigned c = 2 * half - 1;
+
+	double sum = 0.0;
+	double t, w;
+
+	unsigned j;
+
+	for (j = 0; j < half; j++) {
+		t = (double) (2 * j + 1);
+		w = bessel_i0(beta * sqrt(1.0 - (t / c) * (t / c))) / bessel_i0(beta);
+		coefs[j] = (hsv_numeric_t) (((j % 2 == 0) ? 1.0 : -1.0) / (M_PI * t) * w);
+		sum += coefs[j];
+	}
+
+	/* Нормируем коэффициент передачи на нулевой частоте: 0.5 + 2 * sum = 1. */
+	for (j = 0; j < half; j++) {
+		coefs[j] = (hsv_numeric_t) (coefs[j] * 0.25 / sum);
+	}
+}
+
+enum HALFBAND_CODE halfband_config(halfband_t hb, unsigned half, int interp, arena_t arena)
+{
+	enum HALFBAND_CODE r;
+
+	hb->half = half;
+	hb->size = 4 * half - 1;
+	hb->arena = arena;
+
+	hb->coefs = (hsv_numeric_t*) arena_calloc(hb->arena, half, sizeof(hsv_numeric_t));
+	if (hb->coefs == NULL) {
+		r = HALFBAND_CODE_ALLOC_ERR;
+		goto err0;
+	}
+	init_coefs(hb->coefs, half);
+
+	/* При интерполяции нечетные отсчеты входа фильтра нулевые, поэтому хранится только история на входной частоте. */
+	hb->hist_len = interp ? 2 * half : hb->size;
+	hb->hist = (hsv_numeric_t*) arena_calloc(hb->arena, 2 * hb->hist_len, sizeof(hsv_numeric_t));
+	if (hb->hist == NULL) {
+		r = HALFBAND_CODE_ALLOC_ERR;
+		goto err1;
+	}
+
+	halfband_reset(hb);
+
+	return HALFBAND_CODE_OK;
+
+ err1:
+	arena_free(hb->arena, hb->coefs);
+ err0:
+	return r;
+}
+
+void halfband_reserve(unsigned half, int interp, arena_t arena)
+{
+	arena_reserve(arena, half, sizeof(hsv_numeric_t));
+	arena_reserve(arena, 2 * (interp ? 2 * half : 4 * half - 1), sizeof(hsv_numeric_t));
+}
+
+void halfband_reset(halfband_t hb)
+{
+	memset(hb->hist, '\0', 2 * hb->hist_len * sizeof(hsv_numeric_t));
+	hb->pos = 0;
+	hb->phase = 0;
+}
+
+static const hsv_numeric_t*halfband_push(halfband_t hb, hsv_numeric_t in)
+{
+	hb->pos = (hb->pos == 0) ? (hb->hist_len - 1) : (hb->pos - 1);
+	hb->hist[hb->pos] = in;
+	hb->hist[hb->pos + hb->hist_len] = in;
+
+	return hb->hist + hb->pos;
+}
+
+int halfband_decimate(halfband_t hb, hsv_numeric_t in, hsv_numeric_t*out)
+{
+	const hsv_numeric_t*w = halfband_push(hb, in);
+
+	unsigned c = 2 * hb->half - 1;
+	hsv_numeric_t acc;
+
+	unsigned j;
+
+	hb->phase ^= 1;
+	if (hb->phase == 0) {
+		return 0;
+	}
+
+	/* w[i] = x[n - i]. */
+	acc = 0.5 * w[c];
+	for (j = 0; j < hb->half; j++) {
+		acc += hb->coefs[j] * (w[c - 2 * j - 1] + w[c + 2 * j + 1]);
+	}
+	*out = acc;
+
+	return 1;
+}
+
+void halfband_interpolate(halfband_t hb, hsv_numeric_t in, hsv_numeric_t*out)
+{
+	const hsv_numeric_t*w = halfband_push(hb, in);
+
+	unsigned K = hb->half;
+	hsv_numeric_t acc;
+
+	unsigned j;
+
+	/* Четный выходной отсчет получается из ненулевых коэффициентов, нечетный - из центрального.
+	   Множитель 2 компенсирует вставку нулей. */
+	acc = 0.0;
+	for (j = 0; j < K; j++) {
+		acc += hb->coefs[j] * (w[K - 1 - j] + w[K + j]);
+	}
+	out[0] = 2.0 * acc;
+	out[1] = w[K - 1];
+}
+
+void halfband_deconfig(halfband_t hb)
+{
+	arena_free(hb->arena, hb->hist);
+	arena_free(hb->arena, hb->coefs);
+}
+
+void halfband_clean(halfband_t hb)
+{
+	memset(hb, '\0', sizeof(*hb));
+}
+
+void halfband_free(halfband_t hb)
+{
+	free(hb);
+}
+/**
+ * /}
+ */
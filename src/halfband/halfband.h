@@ -0,0 +1,120 @@
+/**
+ * \file halfband.h
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief API полуполосных фильтров для децимации и интерполяции в 2 раза.
+ */
+/**
+ * \defgroup halfband Модуль полуполосных фильтров.
+ * \{
+ */
+#ifndef HALFBAND_H_INCLUDED
+#define HALFBAND_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+#include "hsv_types.h"
+
+#include "arena.h"
+
+/**
+ * Коды, возвращаемые методами halfband_...
+ */
+enum HALFBAND_CODE
+{
+	HALFBAND_CODE_OK = 0,         /**< Метод успешно отработал. */
+	HALFBAND_CODE_ALLOC_ERR = -1, /**< Ошибка выделения памяти. */
+};
+
+/**
+ * Структура полуполосного КИХ-фильтра длины 4 * half - 1 в полифазной форме.
+ * У полуполосного фильтра все коэффициенты на четном расстоянии от центра (кроме центрального, равного 0.5) нулевые,
+ * а остальные симметричны, поэтому на один выходной отсчет децимации нужно half умножений.
+ * Фильтр строится методом окон (окно Кайзера) и вносит задержку 2 * half - 1 отсчетов на входной частоте
+ * (на выходной частоте при интерполяции).
+ *
+ * Vaidyanathan P.P., Nguyen T.Q. A "trick" for the design of FIR half-band filters, 1987 г.
+ */
+struct HALFBAND
+{
+	unsigned half; /**< Число ненулевых нецентральных коэффициентов с одной стороны. */
+	unsigned size; /**< Длина фильтра (4 * half - 1).                               */
+
+	hsv_numeric_t*coefs; /**< Ненулевые коэффициенты h[c + 1], h[c + 3], ... (c - центр фильтра). */
+
+	/**
+	 * История входных отсчетов (новые в начале), хранится дважды подряд,
+	 * чтобы окно фильтра всегда было непрерывным.
+	 */
+	hsv_numeric_t*hist;
+	unsigned hist_len; /**< Длина истории.                       */
+	unsigned pos;      /**< Начало окна фильтра в истории.       */
+	unsigned phase;    /**< Фаза децимации (0 - выдается отсчет). */
+
+	arena_t arena; /**< Арена, из которой выделены буферы. */
+};
+
+typedef struct HALFBAND* halfband_t;
+
+/**
+ * Создание структуры полуполосного фильтра.
+ * \return указатель на структуру полуполосного фильтра (при ошибке - NULL).
+ */
+halfband_t create_halfband();
+
+/**
+ * Конфигурация полуполосного фильтра.
+ * \param half число ненулевых нецентральных коэффициентов с одной стороны (длина фильтра 4 * half - 1).
+ * \param interp 1 - фильтр для интерполяции, 0 - для децимации.
+ * \param arena арена, из которой выделяются буферы.
+ * \return результат конфигурирования.
+ */
+enum HALFBAND_CODE halfband_config(halfband_t hb, unsigned half, int interp, arena_t arena);
+
+/**
+ * Учет памяти halfband_config в арене без конфигурации (см. arena_reserve).
+ */
+void halfband_reserve(unsigned half, int interp, arena_t arena);
+
+/**
+ * Сброс истории фильтра.
+ */
+void halfband_reset(halfband_t hb);
+
+/**
+ * Децимация в 2 раза: подача одного входного отсчета.
+ * \param out выходной отсчет.
+ * \return 1, если выходной отсчет готов, иначе 0.
+ */
+int halfband_decimate(halfband_t hb, hsv_numeric_t in, hsv_numeric_t*out);
+
+/**
+ * Интерполяция в 2 раза: один входной отсчет дает два выходных.
+ * \param out массив из двух выходных отсчетов.
+ */
+void halfband_interpolate(halfband_t hb, hsv_numeric_t in, hsv_numeric_t*out);
+
+/**
+ * Удаление всех внутренних динамических структур.
+ */
+void halfband_deconfig(halfband_t hb);
+
+/**
+ * Зануление структуры полуполосного фильтра.
+ */
+void halfband_clean(halfband_t hb);
+
+/**
+ * Удаление структуры полуполосного фильтра.
+ */
+void halfband_free(halfband_t hb);
+
+#ifdef __cplusplus
+}
+#endif  /* __cplusplus */
+
+#endif  /* HALFBAND_H_INCLUDED */
+/**
+ * /}
+ */
@@ -7,6 +7,9 @@
  * \ingroup hsv
  * \{
  */
+/* Переименование символов этой точности должно предшествовать объявлениям hsv.h. */
+#include "hsv_types.h"
+
 #include "hsv.h"
 #include "hsv_priv.h"
 
@@ -25,6 +28,64 @@ hsvc_t create_hsvc()
 	return hsvc;
 }
 
+hsvc_t create_hsvc_arena(arena_t arena)
+{
+	return (hsvc_t) arena_calloc(arena, 1, sizeof(struct HSV_CONTEXT));
+}
+
+static enum WINDOW_TYPE hsvc_window_type(enum HSV_WINDOW_MODE window)
+{
+	switch (window) {
+	case HSV_WINDOW_MODE_SQRT_HANNING:
+		return WINDOW_TYPE_SQRT_HANNING;
+	case HSV_WINDOW_MODE_VORBIS:
+		return WINDOW_TYPE_VORBIS;
+	case HSV_WINDOW_MODE_KBD:
+		return WINDOW_TYPE_KBD;
+	default:
+		return WINDOW_TYPE_HANNING;
+	}
+}
+
+/**
+ * Размер ДПФ банка фильтров WOLA по умолчанию: ближайшая к размеру фрейма степень двойки.
+ */
+static unsigned hsvc_wola_dft_size(unsigned frame_size_smpls)
+{
+	unsigned size = 2;
+
+	while (size + size / 2 < frame_size_smpls) {
+		size *= 2;
+	}
+
+	return size;
+}
+
+/**
+ * Задержка КИХ-фильтра по умолчанию: HSV_DEFAULT_FIR_DELAY_MS, но не больше допустимой для размеров фрейма и ДПФ.
+ */
+static unsigned hsvc_fir_default_delay(unsigned sr, unsigned frame_size_smpls, unsigned dft_size_smpls)
+{
+	unsigned delay = HSV_MIN(sr * HSV_DEFAULT_FIR_DELAY_MS / 1000, (HSV_MIN(frame_size_smpls, dft_size_smpls) - 1) / 2);
+
+	return HSV_MAX(delay, 1);
+}
+
+/**
+ * Шаг банка фильтров WOLA: размер ДПФ, деленный на ближайшую к 100 / (100 - overlap_perc) степень двойки
+ * (не меньше 2 и делящую размер ДПФ).
+ */
+static unsigned hsvc_wola_hop(unsigned dft_size_smpls, unsigned overlap_perc)
+{
+	unsigned os = 2;
+
+	while (((os + os / 2) * (100 - overlap_perc) < 100) && (dft_size_smpls % (2 * os) == 0)) {
+		os *= 2;
+	}
+
+	return dft_size_smpls / os;
+}
+
 int hsvc_validate_config(const struct HSV_CONFIG*conf)
 {
 	struct HSV_CONFIG tmp = *conf;
@@ -37,7 +98,7 @@ int hsvc_validate_config(const struct HSV_CONFIG*conf)
 		return 3;
 	}
 
-	if ((tmp.mode < HSV_SUPPRESSOR_MODE_SPECSUB) || (tmp.mode > HSV_SUPPRESSOR_MODE_RTSNR_G)) {
+	if ((tmp.mode < HSV_SUPPRESSOR_MODE_SPECSUB) || (tmp.mode > HSV_SUPPRESSOR_MODE_BARK)) {
 		return 4;
 	}
 
@@ -51,7 +112,14 @@ int hsvc_validate_config(const struct HSV_CONFIG*conf)
 		return 6;
 	}
 
-	if (tmp.dft_size_smpls == HSV_DEFAULT) {
+	if (tmp.filterbank == HSV_FILTERBANK_MODE_WOLA) {
+		if (tmp.dft_size_smpls == HSV_DEFAULT) {
+			tmp.dft_size_smpls = hsvc_wola_dft_size(tmp.frame_size_smpls);
+		} else if ((tmp.dft_size_smpls < 2) || (tmp.dft_size_smpls % 2 != 0)) {
+			return 7;
+		}
+		tmp.frame_size_smpls = HSV_WOLA_TAPS * tmp.dft_size_smpls;
+	} else if (tmp.dft_size_smpls == HSV_DEFAULT) {
 		tmp.dft_size_smpls = 2 * tmp.frame_size_smpls;
 	} else if (tmp.dft_size_smpls < tmp.frame_size_smpls) {
 		return 7;
@@ -63,6 +131,183 @@ int hsvc_validate_config(const struct HSV_CONFIG*conf)
 		}
 	}
 
+	if ((tmp.bypass < HSV_BYPASS_MODE_OFF) || (tmp.bypass > HSV_BYPASS_MODE_MUTE)) {
+		return 10;
+	}
+
+	if (tmp.bypass_spp_perc > 100) {
+		return 12;
+	}
+
+	if (tmp.bypass_gain_perc > 100) {
+		return 13;
+	}
+
+	if ((tmp.ctrl_mode < HSV_CTRL_MODE_HOLD) || (tmp.ctrl_mode > HSV_CTRL_MODE_STAGGER)) {
+		return 15;
+	}
+
+	if ((tmp.link < HSV_LINK_MODE_OFF) || (tmp.link > HSV_LINK_MODE_LANES)) {
+		return 16;
+	}
+
+	if ((tmp.split < HSV_SPLIT_MODE_OFF) || (tmp.split > HSV_SPLIT_MODE_TRACKED)) {
+		return 17;
+	}
+
+	if (tmp.split_gain_perc > 100) {
+		return 18;
+	}
+
+	if (tmp.n_bands == 1) {
+		return 19;
+	}
+
+	if ((tmp.filterbank < HSV_FILTERBANK_MODE_STFT) || (tmp.filterbank > HSV_FILTERBANK_MODE_WOLA)) {
+		return 20;
+	}
+
+	if ((tmp.window < HSV_WINDOW_MODE_HANNING) || (tmp.window > HSV_WINDOW_MODE_LOW_DELAY)) {
+		return 21;
+	}
+
+	if ((tmp.synthesis < HSV_SYNTHESIS_MODE_OLA) || (tmp.synthesis > HSV_SYNTHESIS_MODE_FIR)) {
+		return 22;
+	}
+
+	if (tmp.synthesis == HSV_SYNTHESIS_MODE_FIR) {
+		if (tmp.fir_delay_smpls == HSV_DEFAULT) {
+			tmp.fir_delay_smpls = hsvc_fir_default_delay(tmp.sr, tmp.frame_size_smpls, tmp.dft_size_smpls);
+		}
+		if ((2 * tmp.fir_delay_smpls >= tmp.frame_size_smpls) || (2 * tmp.fir_delay_smpls >= tmp.dft_size_smpls)) {
+			return 23;
+		}
+	}
+
+	if ((tmp.precision < HSV_PRECISION_MODE_FLOAT) || (tmp.precision > HSV_PRECISION_MODE_FIXED)) {
+		return 24;
+	}
+
+	if ((tmp.math < HSV_MATH_MODE_LIBM) || (tmp.math > HSV_MATH_MODE_FAST)) {
+		return 25;
+	}
+
+	if ((tmp.denormal < HSV_DENORMAL_MODE_OFF) || (tmp.denormal > HSV_DENORMAL_MODE_PROTECT)) {
+		return 26;
+	}
+
+	if ((tmp.storage < HSV_STORAGE_MODE_NATIVE) || (tmp.storage > HSV_STORAGE_MODE_BF16)) {
+		return 27;
+	}
+
+	/* Целочисленная обработка поддерживает только подмножество режимов. */
+	if (tmp.precision == HSV_PRECISION_MODE_FIXED) {
+		if (tmp.mode != HSV_SUPPRESSOR_MODE_WIENER) {
+			return 4;
+		}
+
+		if (conf->dft_size_smpls == HSV_DEFAULT) {
+			if (2 * (tmp.frame_size_smpls + tmp.frame_size_smpls % 2) > HSV_FIXED_MAX_DFT_SIZE) {
+				return 5;
+			}
+		} else if ((tmp.dft_size_smpls > HSV_FIXED_MAX_DFT_SIZE) || ((tmp.dft_size_smpls & (tmp.dft_size_smpls - 1)) != 0)) {
+			return 7;
+		}
+
+		if (tmp.bypass != HSV_BYPASS_MODE_OFF) {
+			return 10;
+		} else if (tmp.ctrl_period > 1) {
+			return 14;
+		} else if (tmp.link != HSV_LINK_MODE_OFF) {
+			return 16;
+		} else if (tmp.split != HSV_SPLIT_MODE_OFF) {
+			return 17;
+		} else if (tmp.filterbank != HSV_FILTERBANK_MODE_STFT) {
+			return 20;
+		} else if (tmp.window != HSV_WINDOW_MODE_HANNING) {
+			return 21;
+		} else if (tmp.synthesis != HSV_SYNTHESIS_MODE_OLA) {
+			return 22;
+		} else if (tmp.storage != HSV_STORAGE_MODE_NATIVE) {
+			return 27;
+		} else if (tmp.threads > 1) {
+			return 28;
+		}
+	}
+
+	/* Состояния потоков с чередованием обновляются только поэлементными рекурсиями в каждом фрейме. */
+	if (tmp.link == HSV_LINK_MODE_LANES) {
+		if (tmp.mode == HSV_SUPPRESSOR_MODE_BARK) {
+			return 4;
+		} else if (tmp.bypass != HSV_BYPASS_MODE_OFF) {
+			return 10;
+		} else if (tmp.ctrl_period > 1) {
+			return 14;
+		} else if (tmp.split != HSV_SPLIT_MODE_OFF) {
+			return 17;
+		} else if (tmp.synthesis != HSV_SYNTHESIS_MODE_OLA) {
+			return 22;
+		} else if (tmp.storage == HSV_STORAGE_MODE_FP16) {
+			return 27;
+		}
+	}
+
+	/* Окно синтеза с малой задержкой занимает два шага в конце фрейма. */
+	if ((tmp.window == HSV_WINDOW_MODE_LOW_DELAY) && (tmp.filterbank == HSV_FILTERBANK_MODE_STFT)) {
+		if ((conf->overlap_perc != HSV_DEFAULT) && (tmp.overlap_perc < 50)) {
+			return 6;
+		}
+	}
+
+#ifdef HSV_STATIC_CONFIG
+	/* Статическая конфигурация (см. hsv_types.h): размеры фрейма и ДПФ сравниваются после округления, как в hsvc_config. */
+	{
+		unsigned frame_size_smpls = tmp.frame_size_smpls + tmp.frame_size_smpls % 2;
+		unsigned dft_size_smpls = conf->dft_size_smpls;
+
+		if (tmp.filterbank == HSV_FILTERBANK_MODE_WOLA) {
+			if (dft_size_smpls == HSV_DEFAULT) {
+				dft_size_smpls = hsvc_wola_dft_size(frame_size_smpls);
+			}
+			frame_size_smpls = HSV_WOLA_TAPS * dft_size_smpls;
+		} else if (dft_size_smpls == HSV_DEFAULT) {
+			dft_size_smpls = 2 * frame_size_smpls;
+		}
+		PREFIX_UNUSED(frame_size_smpls);
+		PREFIX_UNUSED(dft_size_smpls);
+
+#ifdef HSV_STATIC_SR
+		if (tmp.sr != HSV_STATIC_SR) {
+			return 1;
+		}
+#endif  /* HSV_STATIC_SR */
+#ifdef HSV_STATIC_CH
+		if (tmp.ch != HSV_STATIC_CH) {
+			return 2;
+		}
+#endif  /* HSV_STATIC_CH */
+#ifdef HSV_STATIC_MODE
+		if (tmp.mode != HSV_SYM_CAT(HSV_SUPPRESSOR_MODE_, HSV_STATIC_MODE)) {
+			return 4;
+		}
+#endif  /* HSV_STATIC_MODE */
+#ifdef HSV_STATIC_FRAME_SIZE
+		if (frame_size_smpls != HSV_STATIC_FRAME_SIZE) {
+			return 5;
+		}
+#endif  /* HSV_STATIC_FRAME_SIZE */
+#ifdef HSV_STATIC_DFT_SIZE
+		if (dft_size_smpls != HSV_STATIC_DFT_SIZE) {
+			return 7;
+		}
+#endif  /* HSV_STATIC_DFT_SIZE */
+		/* Размеры полос split отличаются от конфигурации, поэтому разделение на полосы не поддерживается. */
+		if (tmp.split != HSV_SPLIT_MODE_OFF) {
+			return 17;
+		}
+	}
+#endif  /* HSV_STATIC_CONFIG */
+
 	return HSV_CODE_OK;
 }
 
@@ -80,7 +325,7 @@ static enum HSV_CODE switch_rb_code(enum RB_CODE r)
 	}
 }
 
-static enum HSV_CODE switch_dft_code(enum RB_CODE r)
+static enum HSV_CODE switch_dft_code(enum DFT_CODE r)
 {
 	switch (r) {
 	case DFT_CODE_OK:
@@ -116,249 +361,2059 @@ static enum HSV_CODE switch_suppressor_code(enum SUPPRESSOR_CODE r)
 	}
 }
 
-static enum HSV_CODE hsvc_config_chan(struct HSV_CHAN*chan, unsigned sr, unsigned dft_size_smpls, enum HSV_SUPPRESSOR_MODE mode)
+/**
+ * Число потоков оценки и подавления шума "канала" связанного режима (см. HSV_LINK_MODE_LANES).
+ */
+static unsigned hsvc_lanes(hsvc_t hsvc)
+{
+	return (hsvc->conf.link == HSV_LINK_MODE_LANES) ? hsvc->conf.ch : 1;
+}
+
+/**
+ * Конфигурация оценки и подавления шума канала.
+ */
+static enum HSV_CODE hsvc_config_ctrl(hsvc_t hsvc, struct HSV_CHAN*chan)
 {
 	enum HSV_CODE r;
 
-	enum DFT_CODE dft_r;
+	unsigned sr = hsvc->conf.sr;
+	unsigned dft_size_smpls = hsvc->dft_size_smpls;
+	enum HSV_SUPPRESSOR_MODE mode = hsvc->conf.mode;
+	enum KERNELS_STORAGE storage = (enum KERNELS_STORAGE) hsvc->conf.storage;
+
 	enum ESTIMATOR_CODE est_r;
 	enum SUPPRESSOR_CODE sup_r;
 
-	dft_r = dft_config(&(chan->dft), dft_size_smpls);
-	if (dft_r != DFT_CODE_OK) {
-		r = switch_dft_code(dft_r);
-		goto err0;
-	}
-	
-	chan->amp_spec = (hsv_numeric_t*) calloc(dft_size_smpls, sizeof(hsv_numeric_t));
-	if (chan->amp_spec == NULL) {
-		r = HSV_CODE_ALLOC_ERR;
-		goto err1;
-	}
-	chan->power_spec = (hsv_numeric_t*) calloc(dft_size_smpls, sizeof(hsv_numeric_t));
-	if (chan->power_spec == NULL) {
-		r = HSV_CODE_ALLOC_ERR;
-		goto err2;
-	}
-	chan->phase_spec = (hsv_numeric_t*) calloc(dft_size_smpls, sizeof(hsv_numeric_t));
-	if (chan->phase_spec == NULL) {
-		r = HSV_CODE_ALLOC_ERR;
-		goto err3;
+	if (mode == HSV_SUPPRESSOR_MODE_BARK) {
+		est_r = estimator_config_bands(&(chan->est), sr, &(hsvc->bands), storage, hsvc->arena, hsvc->scratch);
+	} else {
+		est_r = estimator_config_lanes(&(chan->est), sr, dft_size_smpls, hsvc_lanes(hsvc), storage, hsvc->arena, hsvc->scratch);
 	}
-	
-	est_r = estimator_config(&(chan->est), sr, dft_size_smpls);
 	if (est_r != ESTIMATOR_CODE_OK) {
 		r = switch_estimator_code(est_r);
-		goto err4;
+		goto err0;
 	}
 
-	sup_r = suppressor_config(&(chan->sup), sr, dft_size_smpls, mode);
+	if (mode == HSV_SUPPRESSOR_MODE_BARK) {
+		sup_r = suppressor_config_bands(&(chan->sup), sr, dft_size_smpls, &(hsvc->bands), storage, hsvc->arena, hsvc->scratch);
+	} else {
+		sup_r = suppressor_config_lanes(&(chan->sup), sr, dft_size_smpls, hsvc_lanes(hsvc), (enum SUPPRESSOR_MODE) mode, storage,
+										hsvc->arena, hsvc->scratch);
+	}
 	if (sup_r != SUPPRESSOR_CODE_OK) {
 		r = switch_suppressor_code(sup_r);
-		goto err5;
+		goto err1;
 	}
-	
-	chan->overlap_buf = (hsv_numeric_t*) calloc(dft_size_smpls, sizeof(hsv_numeric_t));
-	if (chan->overlap_buf == NULL) {
-		r = HSV_CODE_ALLOC_ERR;
-		goto err6;
+	suppressor_set_fast_math(&(chan->sup), hsvc->conf.math == HSV_MATH_MODE_FAST);
+
+	/*
+	 * Частоты, которые в binary16 ниже диапазона массива (см. kernels_store), читаются нулями:
+	 * ограничение спектров снизу защищает деления на спектр шума, как при HSV_DENORMAL_MODE_PROTECT.
+	 */
+	if ((hsvc->conf.denormal == HSV_DENORMAL_MODE_PROTECT) || (hsvc->conf.storage == HSV_STORAGE_MODE_FP16)) {
+		estimator_set_eps(&(chan->est), HSV_DENORMAL_EPS);
+		suppressor_set_eps(&(chan->sup), HSV_DENORMAL_EPS);
+	}
+
+	/* Буферы интерполяции коэффициентов усиления нужны только при пониженной частоте их пересчета. */
+	if ((hsvc->conf.ctrl_mode == HSV_CTRL_MODE_INTERP) && (hsvc->ctrl_period > 1)) {
+		chan->gain = (hsv_numeric_t*) arena_calloc(hsvc->arena, 3 * dft_size_smpls, sizeof(hsv_numeric_t));
+		if (chan->gain == NULL) {
+			r = HSV_CODE_ALLOC_ERR;
+			goto err2;
+		}
+		chan->gain_prev = chan->gain + dft_size_smpls;
+		chan->gain_next = chan->gain + 2 * dft_size_smpls;
 	}
 
 	return HSV_CODE_OK;
 
- err6:
-	suppressor_deconfig(&(chan->sup));
- err5:
-	estimator_deconfig(&(chan->est));
- err4:
-	free(chan->phase_spec);
- err3:
-	free(chan->power_spec);
  err2:
-	free(chan->amp_spec);
+	suppressor_deconfig(&(chan->sup));
  err1:
-	dft_deconfig(&(chan->dft));
+	estimator_deconfig(&(chan->est));
  err0:
 	return r;
 }
 
-static void hsvc_deconfig_chan(struct HSV_CHAN*chan)
+static void hsvc_deconfig_ctrl(hsvc_t hsvc, struct HSV_CHAN*chan)
 {
-	free(chan->overlap_buf);
+	arena_free(hsvc->arena, chan->gain);
 
 	suppressor_deconfig(&(chan->sup));
 	estimator_deconfig(&(chan->est));
+}
+
+/**
+ * Учет памяти hsvc_config_ctrl без конфигурации (см. hsvc_reserve_impl).
+ */
+static enum HSV_CODE hsvc_reserve_ctrl(hsvc_t hsvc)
+{
+	unsigned dft_size_smpls = hsvc->dft_size_smpls;
+	enum HSV_SUPPRESSOR_MODE mode = hsvc->conf.mode;
+	enum KERNELS_STORAGE storage = (enum KERNELS_STORAGE) hsvc->conf.storage;
+
+	enum SUPPRESSOR_CODE sup_r;
+
+	if (mode == HSV_SUPPRESSOR_MODE_BARK) {
+		estimator_reserve_bands(hsvc->bands.n_bands, storage, hsvc->arena, hsvc->scratch);
+		suppressor_reserve_bands(dft_size_smpls, hsvc->bands.n_bands, storage, hsvc->arena, hsvc->scratch);
+	} else {
+		estimator_reserve_lanes(dft_size_smpls, hsvc_lanes(hsvc), storage, hsvc->arena, hsvc->scratch);
+		sup_r = suppressor_reserve_lanes(dft_size_smpls, hsvc_lanes(hsvc), (enum SUPPRESSOR_MODE) mode, storage,
+										 hsvc->arena, hsvc->scratch);
+		if (sup_r != SUPPRESSOR_CODE_OK) {
+			return switch_suppressor_code(sup_r);
+		}
+	}
 
-	free(chan->phase_spec);
-	free(chan->power_spec);
-	free(chan->amp_spec);
+	if ((hsvc->conf.ctrl_mode == HSV_CTRL_MODE_INTERP) && (hsvc->ctrl_period > 1)) {
+		arena_reserve(hsvc->arena, 3 * dft_size_smpls, sizeof(hsv_numeric_t));
+	}
 
-	dft_deconfig(&(chan->dft));
+	return HSV_CODE_OK;
 }
 
-enum HSV_CODE hsvc_config(hsvc_t hsvc, const struct HSV_CONFIG*conf)
+/**
+ * Конфигурация состояния канала: буфер перекрытия, КИХ-фильтры, оценка и подавление шума.
+ */
+static enum HSV_CODE hsvc_config_chan(hsvc_t hsvc, struct HSV_CHAN*chan)
 {
 	enum HSV_CODE r;
 
-	enum RB_CODE rb_r;
+	unsigned batch_hops = hsvc->batch_hops;
 
-	unsigned ch, k;
+	chan->overlap_buf = (hsv_numeric_t*) arena_calloc(hsvc->arena, hsvc->synth_size_smpls, sizeof(hsv_numeric_t));
+	if (chan->overlap_buf == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err0;
+	}
 
-	hsvc->conf = *conf;
+	chan->raw = NULL;
+	if (hsvc->raw_cap > 0) {
+		chan->raw = (hsv_numeric_t*) arena_calloc(hsvc->arena, hsvc->raw_cap, sizeof(hsv_numeric_t));
+		if (chan->raw == NULL) {
+			r = HSV_CODE_ALLOC_ERR;
+			goto err1;
+		}
+	}
 
-	if (hsvc->conf.cap == HSV_DEFAULT) {
-		hsvc->conf.cap = HSV_DEFAULT_CAP;
+	chan->fir_taps = NULL;
+	if (hsvc->conf.synthesis == HSV_SYNTHESIS_MODE_FIR) {
+		chan->fir_taps = (hsv_numeric_t*) arena_calloc(hsvc->arena, (batch_hops + 1) * hsvc->fir_len, sizeof(hsv_numeric_t));
+		if (chan->fir_taps == NULL) {
+			r = HSV_CODE_ALLOC_ERR;
+			goto err2;
+		}
+		/* До первого шага вход проходит без изменений. */
+		chan->fir_taps[hsvc->fir_half] = 1.0;
 	}
-	rb_r = rb_config(&(hsvc->rb), hsvc->conf.cap);
-	if (rb_r != RB_CODE_OK) {
-		r = switch_rb_code(rb_r);
-		goto err0;
+
+	/* В связанном режиме оценка и подавление шума общие для всех каналов. */
+	if (hsvc->conf.link == HSV_LINK_MODE_OFF) {
+		r = hsvc_config_ctrl(hsvc, chan);
+		if (r != HSV_CODE_OK) {
+			goto err3;
+		}
 	}
 
-	if (hsvc->conf.frame_size_smpls == HSV_DEFAULT) {
-		hsvc->conf.frame_size_smpls = (unsigned) HSV_FLOOR(2.0 * hsvc->conf.sr / 100.0);
+	return HSV_CODE_OK;
+
+ err3:
+	arena_free(hsvc->arena, chan->fir_taps);
+ err2:
+	arena_free(hsvc->arena, chan->raw);
+ err1:
+	arena_free(hsvc->arena, chan->overlap_buf);
+ err0:
+	return r;
+}
+
+static void hsvc_deconfig_chan(hsvc_t hsvc, struct HSV_CHAN*chan)
+{
+	if (hsvc->conf.link == HSV_LINK_MODE_OFF) {
+		hsvc_deconfig_ctrl(hsvc, chan);
 	}
-	hsvc->frame_size_smpls = hsvc->conf.frame_size_smpls;
-	if (hsvc->frame_size_smpls % 2 == 1) {
-		hsvc->frame_size_smpls++;
+
+	arena_free(hsvc->arena, chan->fir_taps);
+	arena_free(hsvc->arena, chan->raw);
+
+	arena_free(hsvc->arena, chan->overlap_buf);
+}
+
+static enum HSV_CODE hsvc_reserve_chan(hsvc_t hsvc)
+{
+	arena_reserve(hsvc->arena, hsvc->synth_size_smpls, sizeof(hsv_numeric_t));
+	if (hsvc->raw_cap > 0) {
+		arena_reserve(hsvc->arena, hsvc->raw_cap, sizeof(hsv_numeric_t));
 	}
-	if (hsvc->conf.overlap_perc == HSV_DEFAULT) {
-		hsvc->conf.overlap_perc = HSV_DEFAULT_OVERLAP_PERC;
+	if (hsvc->conf.synthesis == HSV_SYNTHESIS_MODE_FIR) {
+		arena_reserve(hsvc->arena, (hsvc->batch_hops + 1) * hsvc->fir_len, sizeof(hsv_numeric_t));
 	}
-	hsvc->overlap_size_smpls = (unsigned) HSV_FLOOR(hsvc->frame_size_smpls * hsvc->conf.overlap_perc / 100.0);
-	hsvc->step_size_smpls = hsvc->frame_size_smpls - hsvc->overlap_size_smpls;
 
-	hsvc->frame_size_bs = hsvc->frame_size_smpls * 2 * hsvc->conf.ch;
-	hsvc->overlap_size_bs = hsvc->overlap_size_smpls * 2 * hsvc->conf.ch;
-	hsvc->step_size_bs = hsvc->step_size_smpls * 2 * hsvc->conf.ch;
+	if (hsvc->conf.link == HSV_LINK_MODE_OFF) {
+		return hsvc_reserve_ctrl(hsvc);
+	}
 
-	hsvc->norm_factor = 1.0 / ((100.0 - hsvc->conf.overlap_perc) / 100.0);
+	return HSV_CODE_OK;
+}
 
-	if (hsvc->conf.dft_size_smpls == HSV_DEFAULT) {
-		hsvc->conf.dft_size_smpls = hsvc->frame_size_smpls * 2;
+/**
+ * Конфигурация пула потоков и его исполнителей. Таблицы ДПФ принадлежат исполнителю 0, остальные исполнители
+ * используют их совместно, а рабочие буферы ДПФ и WOLA у каждого исполнителя свои.
+ */
+static enum HSV_CODE hsvc_config_workers(hsvc_t hsvc)
+{
+	enum HSV_CODE r;
+	enum DFT_CODE dft_r;
+
+	struct HSV_WORKER*worker;
+
+	unsigned w;
+
+	if (pool_config(&(hsvc->pool), hsvc->n_workers, hsvc->arena) != POOL_CODE_OK) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err0;
 	}
-	hsvc->dft_size_smpls = hsvc->conf.dft_size_smpls;
 
-	hsvc->window = (hsv_numeric_t*) calloc(hsvc->frame_size_smpls, sizeof(hsv_numeric_t));
-	if (hsvc->window == NULL) {
+	hsvc->workers = (struct HSV_WORKER*) arena_calloc(hsvc->arena, hsvc->n_workers, sizeof(struct HSV_WORKER));
+	if (hsvc->workers == NULL) {
 		r = HSV_CODE_ALLOC_ERR;
 		goto err1;
 	}
-	init_window(hsvc->window, hsvc->frame_size_smpls, WINDOW_TYPE_HANNING);
 
-	for (ch = 0; ch < hsvc->conf.ch; ch++) {
-		r = hsvc_config_chan(hsvc->chans + ch, hsvc->conf.sr, hsvc->dft_size_smpls, hsvc->conf.mode);
-		if (r != HSV_CODE_OK) {
+	for (w = 0; w < hsvc->n_workers; w++) {
+		worker = hsvc->workers + w;
+
+		if (w == 0) {
+			dft_r = dft_config(&(worker->dft), hsvc->dft_size_smpls, hsvc->arena, hsvc->scratch);
+		} else {
+			dft_r = dft_config_shared(&(worker->dft), &(hsvc->workers[0].dft), hsvc->scratch);
+		}
+		if (dft_r != DFT_CODE_OK) {
+			r = switch_dft_code(dft_r);
 			goto err2;
 		}
+
+		worker->wola_buf = NULL;
+		if (hsvc->conf.filterbank == HSV_FILTERBANK_MODE_WOLA) {
+			worker->wola_buf = (hsv_numeric_t*) arena_calloc(hsvc->scratch, hsvc->frame_size_smpls, sizeof(hsv_numeric_t));
+			if (worker->wola_buf == NULL) {
+				dft_deconfig(&(worker->dft));
+				r = HSV_CODE_ALLOC_ERR;
+				goto err2;
+			}
+		}
 	}
 
 	return HSV_CODE_OK;
 
  err2:
-	for (k = 0; k < ch; k++) {
-		hsvc_deconfig_chan(hsvc->chans + ch);
+	/* Исполнители с общими таблицами удаляются раньше исполнителя 0. */
+	while (w-- > 0) {
+		arena_free(hsvc->scratch, hsvc->workers[w].wola_buf);
+		dft_deconfig(&(hsvc->workers[w].dft));
 	}
+	arena_free(hsvc->arena, hsvc->workers);
  err1:
-	rb_deconfig(&(hsvc->rb));
+	pool_deconfig(&(hsvc->pool));
  err0:
 	return r;
 }
 
-static hsv_numeric_t int16_to_hsv_numeric_t(int16_t v)
+static void hsvc_deconfig_workers(hsvc_t hsvc)
 {
-	static const hsv_numeric_t one = 1.0;
-    static const hsv_numeric_t max_int16_inv = one / INT16_MAX;
-    static const hsv_numeric_t min_int16_inv = one / INT16_MIN;
+	unsigned w;
 
-    return v * ((v > 0) ? max_int16_inv : -min_int16_inv);
-}
+	/* Потоки останавливаются до удаления буферов, которые они используют. */
+	pool_deconfig(&(hsvc->pool));
 
-static int16_t hsv_numeric_t_to_int16(hsv_numeric_t v)
-{
-	static const hsv_numeric_t half = 0.5;
-	
-    if (v > 0) {
-        return (v >= 1) ? INT16_MAX : ((int16_t) (v * INT16_MAX + half));
-    } else {
-        return (v <= -1) ? INT16_MIN : ((int16_t) (-v * INT16_MIN - half));
-    }
+	for (w = hsvc->n_workers; w-- > 0;) {
+		arena_free(hsvc->scratch, hsvc->workers[w].wola_buf);
+		dft_deconfig(&(hsvc->workers[w].dft));
+	}
+	arena_free(hsvc->arena, hsvc->workers);
 }
 
-static int hsvc_denoise(hsvc_t hsvc)
+static void hsvc_reserve_workers(hsvc_t hsvc)
 {
-	unsigned ch, k;
-
-	unsigned processed = 0;
-
-	/* До тех пор пока кол-во байт, ожидающих обработку,
-	   превышает размер одного фрейма, будем их обрабатывать. */
-	while (hsvc->pending_bytes >= hsvc->frame_size_bs) {
-		/* Структура многоканального WAV-файла подразумевает, что данные каналов лежат через один:
-		   если есть 2 канала A и B, то данные лежат как ABABAB... . Поэтому обрабатываем каналы по очереди. */
-        for (ch = 0; ch < hsvc->conf.ch; ch++) {
-			/* Считываем очередной фрейм одного канала из кольцевого буфера в буфер обработки. */
-			memset(hsvc->chans[ch].dft.real, '\0', sizeof(hsv_numeric_t) * hsvc->chans[ch].dft.dft_size);
-			memset(hsvc->chans[ch].dft.imag, '\0', sizeof(hsv_numeric_t) * hsvc->chans[ch].dft.dft_size);
-            for (k = 0; k < hsvc->frame_size_smpls; k++) {
-				hsvc->chans[ch].dft.real[k] =
-					int16_to_hsv_numeric_t(((int16_t*)hsvc->rb.data)[((hsvc->idx_frame / 2) + k * hsvc->conf.ch + ch) % (rb_cap(&(hsvc->rb)) / 2)]);
-            }
-
-			/* Применяем оконную функцию, для уменьшения эффекта растекания. */
-			calculate_windowing(hsvc->window, hsvc->chans[ch].dft.real, hsvc->chans[ch].dft.real, hsvc->frame_size_smpls);
-			
-			dft_run_dft(&(hsvc->chans[ch].dft));
-
-			calculate_amp_spec(hsvc->chans[ch].dft.real, hsvc->chans[ch].dft.imag,
-							   hsvc->chans[ch].amp_spec, hsvc->chans[ch].dft.dft_size);
-			calculate_power_spec(hsvc->chans[ch].dft.real, hsvc->chans[ch].dft.imag,
-								 hsvc->chans[ch].power_spec, hsvc->chans[ch].dft.dft_size);
-			calculate_phase_spec(hsvc->chans[ch].dft.real, hsvc->chans[ch].dft.imag,
-								 hsvc->chans[ch].phase_spec, hsvc->chans[ch].dft.dft_size);
-
-			estimator_run(&(hsvc->chans[ch].est), hsvc->chans[ch].power_spec);
-
-			suppressor_run(&(hsvc->chans[ch].sup), hsvc->chans[ch].amp_spec, hsvc->chans[ch].est.noise_amp_spec);
-
-			/* Будем считать, что спектры фаз голоса, шума и зашумленного голоса совпадают. */
-			for (k = 0; k < hsvc->chans[ch].dft.dft_size; k++) {
-				hsvc->chans[ch].dft.real[k] = hsvc->chans[ch].sup.speech_amp_spec[k] * HSV_COS(hsvc->chans[ch].phase_spec[k]);
-				hsvc->chans[ch].dft.imag[k] = hsvc->chans[ch].sup.speech_amp_spec[k] * HSV_SIN(hsvc->chans[ch].phase_spec[k]);
-			}
-
-			dft_run_i_dft(&(hsvc->chans[ch].dft));
+	unsigned w;
 
-			/* Записываем результаты обработки очередного фрейма одного канала из буфера обработки обратно в кольцевой буфер с учетом перекрытия. */
-			for (k = 0; k < hsvc->step_size_smpls; k++) {
-				hsvc->pending_bytes -= 2; processed += 2;
-                ((int16_t*)hsvc->rb.data)[((hsvc->idx_frame / 2) + k * hsvc->conf.ch + ch) % (rb_cap(&(hsvc->rb)) / 2)] =
-					hsv_numeric_t_to_int16(hsvc->chans[ch].dft.real[k] / hsvc->norm_factor + hsvc->chans[ch].overlap_buf[k]);
-			}
+	pool_reserve(hsvc->n_workers, hsvc->arena);
+	arena_reserve(hsvc->arena, hsvc->n_workers, sizeof(struct HSV_WORKER));
 
-			/* Так как для уменьшения эффекта блочности используется перекрытие, сохраним данные, полученные при обработке n-го фрейма
-			   для их использования при обработке n+1-го, n+2-го и т.д. фреймов. */
-			for (k = 0; k < hsvc->chans[ch].dft.dft_size; k++) {
-				hsvc->chans[ch].overlap_buf[k] += hsvc->chans[ch].dft.real[k] / hsvc->norm_factor;
-			}
-			memmove(hsvc->chans[ch].overlap_buf, hsvc->chans[ch].overlap_buf + hsvc->step_size_smpls, (hsvc->chans[ch].dft.dft_size - hsvc->step_size_smpls) * sizeof(hsv_numeric_t));
-			memset(hsvc->chans[ch].overlap_buf + (hsvc->chans[ch].dft.dft_size - hsvc->step_size_smpls), '\0', hsvc->step_size_smpls * sizeof(hsv_numeric_t));
+	for (w = 0; w < hsvc->n_workers; w++) {
+		if (w == 0) {
+			dft_reserve(hsvc->dft_size_smpls, hsvc->arena, hsvc->scratch);
+		} else {
+			dft_reserve_shared(hsvc->dft_size_smpls, hsvc->scratch);
+		}
+		if (hsvc->conf.filterbank == HSV_FILTERBANK_MODE_WOLA) {
+			arena_reserve(hsvc->scratch, hsvc->frame_size_smpls, sizeof(hsv_numeric_t));
 		}
-		/* Учтём, что часть фрейма может лежать "в конце" кольцевого буфера, а часть "в начале". */
-		hsvc->idx_frame = (hsvc->idx_frame + hsvc->step_size_bs) % rb_cap(&(hsvc->rb));
 	}
-
-	return processed;
 }
 
-int hsvc_push(hsvc_t hsvc, const char*data, unsigned data_len)
+/**
+ * Выделение спектров пакета фреймов всех каналов из рабочей арены: они нужны только до конца обработки пакета.
+ * Спектры каналов - срезы общих блоков со смещением ch * dft_size внутри каждого фрейма пакета.
+ */
+static enum HSV_CODE hsvc_config_batch_buf(hsvc_t hsvc)
 {
 	enum HSV_CODE r;
 
-	enum RB_CODE rb_r;
+	unsigned n_ch = hsvc->conf.ch;
+	unsigned dft_size_smpls = hsvc->dft_size_smpls;
+	unsigned batch_len = hsvc->batch_hops * hsvc->batch_stride;
 
-	rb_r = rb_push(&(hsvc->rb), data, data_len);
-	if (rb_r != RB_CODE_OK) {
+	unsigned ch;
+
+	hsvc->real = (hsv_numeric_t*) arena_calloc(hsvc->scratch, batch_len, sizeof(hsv_numeric_t));
+	if (hsvc->real == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err0;
+	}
+	hsvc->imag = (hsv_numeric_t*) arena_calloc(hsvc->scratch, batch_len, sizeof(hsv_numeric_t));
+	if (hsvc->imag == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err1;
+	}
+	
+	hsvc->amp_spec = (hsv_numeric_t*) arena_calloc(hsvc->scratch, batch_len, sizeof(hsv_numeric_t));
+	if (hsvc->amp_spec == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err2;
+	}
+	hsvc->power_spec = (hsv_numeric_t*) arena_calloc(hsvc->scratch, batch_len, sizeof(hsv_numeric_t));
+	if (hsvc->power_spec == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err3;
+	}
+	hsvc->phase_spec = (hsv_numeric_t*) arena_calloc(hsvc->scratch, batch_len, sizeof(hsv_numeric_t));
+	if (hsvc->phase_spec == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err4;
+	}
+
+	hsvc->hop_state = (unsigned char*) arena_calloc(hsvc->scratch, hsvc->batch_hops * n_ch, sizeof(unsigned char));
+	if (hsvc->hop_state == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err5;
+	}
+
+	for (ch = 0; ch < n_ch; ch++) {
+		struct HSV_CHAN*chan = hsvc->chans + ch;
+
+		chan->real = hsvc->real + ch * dft_size_smpls;
+		chan->imag = hsvc->imag + ch * dft_size_smpls;
+		chan->amp_spec = hsvc->amp_spec + ch * dft_size_smpls;
+		chan->power_spec = hsvc->power_spec + ch * dft_size_smpls;
+		chan->phase_spec = hsvc->phase_spec + ch * dft_size_smpls;
+		chan->hop_state = hsvc->hop_state + ch * hsvc->batch_hops;
+	}
+
+	return HSV_CODE_OK;
+
+ err5:
+	arena_free(hsvc->scratch, hsvc->phase_spec);
+ err4:
+	arena_free(hsvc->scratch, hsvc->power_spec);
+ err3:
+	arena_free(hsvc->scratch, hsvc->amp_spec);
+ err2:
+	arena_free(hsvc->scratch, hsvc->imag);
+ err1:
+	arena_free(hsvc->scratch, hsvc->real);
+ err0:
+	return r;
+}
+
+static void hsvc_deconfig_batch_buf(hsvc_t hsvc)
+{
+	arena_free(hsvc->scratch, hsvc->hop_state);
+
+	arena_free(hsvc->scratch, hsvc->phase_spec);
+	arena_free(hsvc->scratch, hsvc->power_spec);
+	arena_free(hsvc->scratch, hsvc->amp_spec);
+
+	arena_free(hsvc->scratch, hsvc->imag);
+	arena_free(hsvc->scratch, hsvc->real);
+}
+
+static void hsvc_reserve_batch_buf(hsvc_t hsvc)
+{
+	unsigned batch_len = hsvc->batch_hops * hsvc->batch_stride;
+
+	/* real, imag, amp_spec, power_spec, phase_spec. */
+	arena_reserve(hsvc->scratch, batch_len, sizeof(hsv_numeric_t));
+	arena_reserve(hsvc->scratch, batch_len, sizeof(hsv_numeric_t));
+	arena_reserve(hsvc->scratch, batch_len, sizeof(hsv_numeric_t));
+	arena_reserve(hsvc->scratch, batch_len, sizeof(hsv_numeric_t));
+	arena_reserve(hsvc->scratch, batch_len, sizeof(hsv_numeric_t));
+
+	arena_reserve(hsvc->scratch, hsvc->batch_hops * hsvc->conf.ch, sizeof(unsigned char));
+}
+
+/**
+ * Выделение объединенных спектров одного фрейма общего для всех каналов "канала" связанного режима
+ * (в режиме HSV_LINK_MODE_LANES - чередующихся спектров всех каналов).
+ */
+static enum HSV_CODE hsvc_config_link_buf(hsvc_t hsvc, struct HSV_CHAN*link)
+{
+	enum HSV_CODE r;
+
+	link->amp_spec = (hsv_numeric_t*) arena_calloc(hsvc->scratch, hsvc->dft_size_smpls * hsvc_lanes(hsvc), sizeof(hsv_numeric_t));
+	if (link->amp_spec == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err0;
+	}
+	link->power_spec = (hsv_numeric_t*) arena_calloc(hsvc->scratch, hsvc->dft_size_smpls * hsvc_lanes(hsvc), sizeof(hsv_numeric_t));
+	if (link->power_spec == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err1;
+	}
+
+	return HSV_CODE_OK;
+
+ err1:
+	arena_free(hsvc->scratch, link->amp_spec);
+ err0:
+	return r;
+}
+
+static void hsvc_deconfig_link_buf(hsvc_t hsvc, struct HSV_CHAN*link)
+{
+	arena_free(hsvc->scratch, link->power_spec);
+	arena_free(hsvc->scratch, link->amp_spec);
+}
+
+static void hsvc_reserve_link_buf(hsvc_t hsvc)
+{
+	arena_reserve(hsvc->scratch, hsvc->dft_size_smpls * hsvc_lanes(hsvc), sizeof(hsv_numeric_t));
+	arena_reserve(hsvc->scratch, hsvc->dft_size_smpls * hsvc_lanes(hsvc), sizeof(hsv_numeric_t));
+}
+
+/**
+ * Конфигурация состояния канала для обработки в узкой полосе.
+ */
+static enum HSV_CODE hsvc_config_split_chan(hsvc_t hsvc, struct HSV_SPLIT_CHAN*sc)
+{
+	enum HSV_CODE r;
+
+	unsigned s, k;
+
+	for (s = 0; s < hsvc->split_stages; s++) {
+		if (halfband_config(sc->decim + s, HSV_SPLIT_HALF, 0, hsvc->arena) != HALFBAND_CODE_OK) {
+			r = HSV_CODE_ALLOC_ERR;
+			goto err0;
+		}
+		if (halfband_config(sc->interp + s, HSV_SPLIT_HALF, 1, hsvc->arena) != HALFBAND_CODE_OK) {
+			halfband_deconfig(sc->decim + s);
+			r = HSV_CODE_ALLOC_ERR;
+			goto err0;
+		}
+	}
+
+	sc->fifo = (int16_t*) arena_calloc(hsvc->arena, hsvc->split_fifo_cap, sizeof(int16_t));
+	if (sc->fifo == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err0;
+	}
+	sc->fifo_head = 0;
+	sc->fifo_len = 0;
+
+	if (hsvc->conf.split == HSV_SPLIT_MODE_FIXED) {
+		sc->gain = hsvc->conf.split_gain_perc / 100.0;
+	} else {
+		/* Пока нижняя полоса не обработана, верхняя пропускается без изменений. */
+		sc->gain = 1.0;
+	}
+	sc->gain_target = sc->gain;
+
+	return HSV_CODE_OK;
+
+ err0:
+	for (k = 0; k < s; k++) {
+		halfband_deconfig(sc->interp + k);
+		halfband_deconfig(sc->decim + k);
+	}
+	return r;
+}
+
+static void hsvc_deconfig_split_chan(hsvc_t hsvc, struct HSV_SPLIT_CHAN*sc)
+{
+	unsigned s;
+
+	arena_free(hsvc->arena, sc->fifo);
+
+	for (s = 0; s < hsvc->split_stages; s++) {
+		halfband_deconfig(sc->interp + s);
+		halfband_deconfig(sc->decim + s);
+	}
+}
+
+/**
+ * Число ступеней децимации, размеры очередей и конфигурация conf контекста нижней полосы.
+ * Если частоту дискретизации нельзя понизить, split_stages равно 0, а conf не заполняется.
+ */
+static void hsvc_config_split_params(hsvc_t hsvc, struct HSV_CONFIG*conf)
+{
+	unsigned sr = hsvc->conf.sr;
+
+	hsvc->split_stages = 0;
+	while ((hsvc->split_stages < HSV_SPLIT_MAX_STAGES) && (sr % 2 == 0) && (sr / 2 >= HSV_SPLIT_MIN_SR)) {
+		sr /= 2;
+		hsvc->split_stages++;
+	}
+	if (hsvc->split_stages == 0) {
+		return;
+	}
+
+	/* Задержка каскада "децимация + интерполяция": (size - 1) отсчетов на частоте каждой ступени. */
+	hsvc->split_delay = (4 * HSV_SPLIT_HALF - 2) * ((1U << hsvc->split_stages) - 1);
+
+	/* Фрейм, ДПФ и прочие параметры нижней полосы - те же, но пересчитанные на пониженную частоту. */
+	*conf = hsvc->conf;
+	conf->sr = sr;
+	conf->frame_size_smpls = hsvc->conf.frame_size_smpls >> hsvc->split_stages;
+	conf->dft_size_smpls = hsvc->conf.dft_size_smpls >> hsvc->split_stages;
+	conf->fir_delay_smpls = HSV_MAX(hsvc->conf.fir_delay_smpls >> hsvc->split_stages, 1);
+	conf->split = HSV_SPLIT_MODE_OFF;
+
+	/* В контексте нижней полосы остается не больше фрейма необработанных данных и одной подачи. */
+	hsvc->split_fifo_cap = ((conf->filterbank == HSV_FILTERBANK_MODE_WOLA) ?
+							HSV_WOLA_TAPS * conf->dft_size_smpls : conf->frame_size_smpls) + 1 + HSV_SPLIT_CHUNK;
+	conf->cap = 2 * hsvc->split_fifo_cap * 2 * hsvc->conf.ch;
+
+	hsvc->split_alpha = 1.0 - HSV_POW(0.5, 1.0 / (0.01 * sr));
+}
+
+/**
+ * Конфигурация обработки в узкой полосе: каскады полуполосных фильтров и контекст нижней полосы.
+ * Если частоту дискретизации нельзя понизить, split остается NULL.
+ */
+static enum HSV_CODE hsvc_config_split(hsvc_t hsvc)
+{
+	enum HSV_CODE r;
+
+	struct HSV_CONFIG conf;
+
+	unsigned ch, k;
+
+	hsvc_config_split_params(hsvc, &conf);
+	if (hsvc->split_stages == 0) {
+		return HSV_CODE_OK;
+	}
+
+	/* Буферы обмена заняты во время обработки контекстом нижней полосы, поэтому выделяются в рабочей арене до его буферов. */
+	hsvc->split_buf = (int16_t*) arena_calloc(hsvc->scratch, hsvc->split_fifo_cap * hsvc->conf.ch, sizeof(int16_t));
+	if (hsvc->split_buf == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err0;
+	}
+	hsvc->split_out = (hsv_numeric_t*) arena_calloc(hsvc->scratch, hsvc->conf.ch << hsvc->split_stages, sizeof(hsv_numeric_t));
+	if (hsvc->split_out == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err1;
+	}
+
+	hsvc->split = create_hsvc_arena(hsvc->arena);
+	if (hsvc->split == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err2;
+	}
+	r = hsvc_config_impl(hsvc->split, &conf, hsvc->arena, hsvc->scratch);
+	if (r != HSV_CODE_OK) {
+		goto err3;
+	}
+
+	hsvc->split_chans = (struct HSV_SPLIT_CHAN*) arena_calloc(hsvc->arena, hsvc->conf.ch, sizeof(struct HSV_SPLIT_CHAN));
+	if (hsvc->split_chans == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err4;
+	}
+	for (ch = 0; ch < hsvc->conf.ch; ch++) {
+		r = hsvc_config_split_chan(hsvc, hsvc->split_chans + ch);
+		if (r != HSV_CODE_OK) {
+			goto err5;
+		}
+	}
+
+	hsvc->split_skip = hsvc->split_delay;
+	hsvc->split_ahead_bs = 0;
+
+	return HSV_CODE_OK;
+
+ err5:
+	for (k = 0; k < ch; k++) {
+		hsvc_deconfig_split_chan(hsvc, hsvc->split_chans + k);
+	}
+	arena_free(hsvc->arena, hsvc->split_chans);
+ err4:
+	hsvc_deconfig(hsvc->split);
+ err3:
+	arena_free(hsvc->arena, hsvc->split);
+	hsvc->split = NULL;
+ err2:
+	arena_free(hsvc->scratch, hsvc->split_out);
+ err1:
+	arena_free(hsvc->scratch, hsvc->split_buf);
+ err0:
+	return r;
+}
+
+static void hsvc_deconfig_split(hsvc_t hsvc)
+{
+	unsigned ch;
+
+	for (ch = 0; ch < hsvc->conf.ch; ch++) {
+		hsvc_deconfig_split_chan(hsvc, hsvc->split_chans + ch);
+	}
+	arena_free(hsvc->arena, hsvc->split_chans);
+
+	hsvc_deconfig(hsvc->split);
+	arena_free(hsvc->arena, hsvc->split);
+
+	arena_free(hsvc->scratch, hsvc->split_out);
+	arena_free(hsvc->scratch, hsvc->split_buf);
+}
+
+static enum HSV_CODE hsvc_reserve_split(hsvc_t hsvc)
+{
+	enum HSV_CODE r;
+
+	struct HSV_CONFIG conf;
+
+	unsigned ch, s;
+
+	hsvc_config_split_params(hsvc, &conf);
+	if (hsvc->split_stages == 0) {
+		return HSV_CODE_OK;
+	}
+
+	arena_reserve(hsvc->scratch, hsvc->split_fifo_cap * hsvc->conf.ch, sizeof(int16_t));
+	arena_reserve(hsvc->scratch, hsvc->conf.ch << hsvc->split_stages, sizeof(hsv_numeric_t));
+
+	r = hsvc_reserve_impl(&conf, hsvc->arena, hsvc->scratch);
+	if (r != HSV_CODE_OK) {
+		return r;
+	}
+
+	arena_reserve(hsvc->arena, hsvc->conf.ch, sizeof(struct HSV_SPLIT_CHAN));
+	for (ch = 0; ch < hsvc->conf.ch; ch++) {
+		for (s = 0; s < hsvc->split_stages; s++) {
+			halfband_reserve(HSV_SPLIT_HALF, 0, hsvc->arena);
+			halfband_reserve(HSV_SPLIT_HALF, 1, hsvc->arena);
+		}
+		arena_reserve(hsvc->arena, hsvc->split_fifo_cap, sizeof(int16_t));
+	}
+
+	return HSV_CODE_OK;
+}
+
+/**
+ * Значения параметров по умолчанию и производные от них размеры: все, от чего зависят буферы контекста.
+ */
+static void hsvc_config_params(hsvc_t hsvc, const struct HSV_CONFIG*conf)
+{
+	hsvc->conf = *conf;
+
+	if (hsvc->conf.frame_size_smpls == HSV_DEFAULT) {
+		hsvc->conf.frame_size_smpls = (unsigned) HSV_FLOOR(2.0 * hsvc->conf.sr / 100.0);
+	}
+	hsvc->frame_size_smpls = hsvc->conf.frame_size_smpls;
+	if (hsvc->frame_size_smpls % 2 == 1) {
+		hsvc->frame_size_smpls++;
+	}
+	if (hsvc->conf.overlap_perc == HSV_DEFAULT) {
+		if (hsvc->conf.filterbank == HSV_FILTERBANK_MODE_WOLA) {
+			hsvc->conf.overlap_perc = HSV_DEFAULT_WOLA_OVERLAP_PERC;
+		} else if (hsvc->conf.window == HSV_WINDOW_MODE_LOW_DELAY) {
+			hsvc->conf.overlap_perc = HSV_DEFAULT_LOW_DELAY_OVERLAP_PERC;
+		} else {
+			hsvc->conf.overlap_perc = HSV_DEFAULT_OVERLAP_PERC;
+		}
+	}
+	hsvc->overlap_size_smpls = (unsigned) HSV_FLOOR(hsvc->frame_size_smpls * hsvc->conf.overlap_perc / 100.0);
+	hsvc->step_size_smpls = hsvc->frame_size_smpls - hsvc->overlap_size_smpls;
+
+	hsvc->norm_factor = 1.0 / ((100.0 - hsvc->conf.overlap_perc) / 100.0);
+
+	if (hsvc->conf.dft_size_smpls == HSV_DEFAULT) {
+		hsvc->conf.dft_size_smpls = (hsvc->conf.filterbank == HSV_FILTERBANK_MODE_WOLA) ?
+			hsvc_wola_dft_size(hsvc->frame_size_smpls) : hsvc->frame_size_smpls * 2;
+	}
+	hsvc->dft_size_smpls = hsvc->conf.dft_size_smpls;
+	hsvc->synth_size_smpls = hsvc->dft_size_smpls;
+	hsvc->synth_offset_smpls = 0;
+
+	/* Для банка фильтров WOLA фрейм и шаг определяются размером ДПФ, а окно синтеза
+	   уже обеспечивает полное восстановление, поэтому нормировка не нужна. */
+	if (hsvc->conf.filterbank == HSV_FILTERBANK_MODE_WOLA) {
+		hsvc->frame_size_smpls = HSV_WOLA_TAPS * hsvc->dft_size_smpls;
+		hsvc->step_size_smpls = hsvc_wola_hop(hsvc->dft_size_smpls, hsvc->conf.overlap_perc);
+		hsvc->overlap_size_smpls = hsvc->frame_size_smpls - hsvc->step_size_smpls;
+		hsvc->norm_factor = 1.0;
+		hsvc->synth_size_smpls = hsvc->frame_size_smpls;
+	} else if (hsvc->conf.window == HSV_WINDOW_MODE_LOW_DELAY) {
+		/* Окно синтеза отлично от нуля только на последних двух шагах фрейма, они и перекрываются. */
+		hsvc->norm_factor = 1.0;
+		hsvc->synth_offset_smpls = hsvc->frame_size_smpls - 2 * hsvc->step_size_smpls;
+		hsvc->synth_size_smpls = 2 * hsvc->step_size_smpls;
+	} else if (hsvc->conf.window != HSV_WINDOW_MODE_HANNING) {
+		/* Окно синтеза обнуляет все за пределами фрейма. */
+		hsvc->norm_factor = 1.0;
+		hsvc->synth_size_smpls = hsvc->frame_size_smpls;
+	}
+
+	hsvc->frame_size_bs = hsvc->frame_size_smpls * 2 * hsvc->conf.ch;
+	hsvc->overlap_size_bs = hsvc->overlap_size_smpls * 2 * hsvc->conf.ch;
+	hsvc->step_size_bs = hsvc->step_size_smpls * 2 * hsvc->conf.ch;
+
+	/* Вместимость по умолчанию увеличивается, если в нее не помещаются два фрейма (длинные фреймы WOLA, много каналов). */
+	if (hsvc->conf.cap == HSV_DEFAULT) {
+		hsvc->conf.cap = HSV_DEFAULT_CAP;
+		while (hsvc->conf.cap < 2 * hsvc->frame_size_bs) {
+			hsvc->conf.cap *= 2;
+		}
+	}
+
+	if (hsvc->conf.batch_hops == HSV_DEFAULT) {
+		hsvc->conf.batch_hops = HSV_DEFAULT_BATCH_HOPS;
+	}
+	hsvc->batch_hops = hsvc->conf.batch_hops;
+	hsvc->batch_stride = hsvc->dft_size_smpls * hsvc->conf.ch;
+
+	if (hsvc->conf.bypass_silence_db == HSV_DEFAULT) {
+		hsvc->conf.bypass_silence_db = HSV_DEFAULT_BYPASS_SILENCE_DB;
+	}
+	hsvc->bypass_silence = HSV_POW(10.0, -((hsv_numeric_t) hsvc->conf.bypass_silence_db) / 10.0);
+	if (hsvc->conf.bypass_spp_perc == HSV_DEFAULT) {
+		hsvc->conf.bypass_spp_perc = HSV_DEFAULT_BYPASS_SPP_PERC;
+	}
+	hsvc->bypass_spp = hsvc->conf.bypass_spp_perc / 100.0;
+	if (hsvc->conf.bypass_gain_perc == HSV_DEFAULT) {
+		hsvc->conf.bypass_gain_perc = HSV_DEFAULT_BYPASS_GAIN_PERC;
+	}
+	hsvc->bypass_gain = (hsvc->conf.bypass == HSV_BYPASS_MODE_MUTE) ? 0.0 : hsvc->conf.bypass_gain_perc / 100.0;
+
+	if (hsvc->conf.ctrl_period == HSV_DEFAULT) {
+		hsvc->conf.ctrl_period = HSV_DEFAULT_CTRL_PERIOD;
+	}
+	hsvc->ctrl_period = hsvc->conf.ctrl_period;
+
+	if (hsvc->conf.split_gain_perc == HSV_DEFAULT) {
+		hsvc->conf.split_gain_perc = HSV_DEFAULT_SPLIT_GAIN_PERC;
+	}
+
+	if (hsvc->conf.fir_delay_smpls == HSV_DEFAULT) {
+		hsvc->conf.fir_delay_smpls = hsvc_fir_default_delay(hsvc->conf.sr, hsvc->frame_size_smpls, hsvc->dft_size_smpls);
+	}
+	hsvc->fir_half = hsvc->conf.fir_delay_smpls;
+	hsvc->fir_len = 2 * hsvc->fir_half + 1;
+	hsvc->raw_cap = 0;
+	hsvc->raw_len = 0;
+	if (hsvc->conf.synthesis == HSV_SYNTHESIS_MODE_FIR) {
+		hsvc->raw_cap = hsvc->frame_size_smpls + hsvc->batch_hops * hsvc->step_size_smpls;
+		hsvc->raw_len = hsvc->frame_size_smpls - hsvc->fir_half;
+	} else if (hsvc->synth_offset_smpls > 0) {
+		/* Фрейм окон с малой задержкой начинается за synth_offset_smpls отсчетов до idx_frame. */
+		hsvc->raw_cap = hsvc->frame_size_smpls + (hsvc->batch_hops - 1) * hsvc->step_size_smpls;
+	}
+
+	if (hsvc->conf.n_bands == HSV_DEFAULT) {
+		hsvc->conf.n_bands = HSV_DEFAULT_BANDS;
+	}
+
+	if (hsvc->conf.threads == HSV_DEFAULT) {
+		hsvc->conf.threads = 1;
+	}
+	hsvc->n_workers = HSV_MIN(hsvc->conf.threads, hsvc->conf.ch);
+}
+
+enum HSV_CODE hsvc_config_impl(hsvc_t hsvc, const struct HSV_CONFIG*conf, arena_t arena, arena_t scratch)
+{
+	enum HSV_CODE r;
+
+	enum RB_CODE rb_r;
+
+	size_t mark;
+
+	unsigned ch, k;
+
+#ifdef HSV_STATIC_CONFIG
+	/* Циклы обработки рассчитаны на размеры статической конфигурации. */
+	if (hsvc_validate_config(conf) != 0) {
+		return HSV_CODE_UNKNOWN_ERR;
+	}
+#endif  /* HSV_STATIC_CONFIG */
+
+	hsvc->arena = arena;
+	hsvc->scratch = scratch;
+
+	hsvc_config_params(hsvc, conf);
+
+	rb_r = rb_config(&(hsvc->rb), hsvc->conf.cap, hsvc->arena);
+	if (rb_r != RB_CODE_OK) {
+		r = switch_rb_code(rb_r);
+		goto err0;
+	}
+
+	hsvc->fir_hops = 0;
+	hsvc->fir_hop = 0;
+	hsvc->fir_pos = 0;
+
+	hsvc->split = NULL;
+	if (hsvc->conf.split != HSV_SPLIT_MODE_OFF) {
+		r = hsvc_config_split(hsvc);
+		if (r != HSV_CODE_OK) {
+			goto err1;
+		}
+		if (hsvc->split != NULL) {
+			return HSV_CODE_OK;
+		}
+	}
+
+	hsvc->window = (hsv_numeric_t*) arena_calloc(hsvc->arena, hsvc->frame_size_smpls, sizeof(hsv_numeric_t));
+	if (hsvc->window == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err1;
+	}
+	hsvc->synthesis_window = NULL;
+	if (hsvc->conf.filterbank == HSV_FILTERBANK_MODE_WOLA) {
+		if (wola_config(&(hsvc->wola), hsvc->dft_size_smpls, HSV_WOLA_TAPS, hsvc->step_size_smpls, hsvc->arena) != WOLA_CODE_OK) {
+			r = HSV_CODE_ALLOC_ERR;
+			goto err2;
+		}
+		memcpy(hsvc->window, hsvc->wola.analysis, hsvc->frame_size_smpls * sizeof(hsv_numeric_t));
+	} else if (hsvc->conf.window != HSV_WINDOW_MODE_HANNING) {
+		hsvc->synthesis_window = (hsv_numeric_t*) arena_calloc(hsvc->arena, hsvc->frame_size_smpls, sizeof(hsv_numeric_t));
+		if (hsvc->synthesis_window == NULL) {
+			r = HSV_CODE_ALLOC_ERR;
+			goto err2;
+		}
+		if (hsvc->conf.window == HSV_WINDOW_MODE_LOW_DELAY) {
+			init_window_low_delay(hsvc->window, hsvc->synthesis_window, hsvc->frame_size_smpls, hsvc->step_size_smpls);
+		} else {
+			init_window_taper(hsvc->window, hsvc->frame_size_smpls,
+							  HSV_MIN(hsvc->overlap_size_smpls, hsvc->frame_size_smpls / 2), hsvc_window_type(hsvc->conf.window));
+			init_synthesis_window(hsvc->window, hsvc->synthesis_window, hsvc->frame_size_smpls, hsvc->step_size_smpls);
+		}
+	} else {
+		init_window(hsvc->window, hsvc->frame_size_smpls, WINDOW_TYPE_HANNING);
+	}
+
+	hsvc->fir_window = NULL;
+	if (hsvc->conf.synthesis == HSV_SYNTHESIS_MODE_FIR) {
+		hsvc->fir_window = (hsv_numeric_t*) arena_calloc(hsvc->arena, hsvc->fir_len, sizeof(hsv_numeric_t));
+		if (hsvc->fir_window == NULL) {
+			r = HSV_CODE_ALLOC_ERR;
+			goto err3;
+		}
+		/* Симметричное окно Ханна без нулевых краев, равное 1 в центре. */
+		for (k = 0; k < hsvc->fir_len; k++) {
+			hsvc->fir_window[k] = 0.5 + 0.5 * HSV_COS(M_PI * ((hsv_numeric_t) ((int) k - (int) hsvc->fir_half)) / (hsvc->fir_half + 1));
+		}
+	}
+
+	if (hsvc->conf.mode == HSV_SUPPRESSOR_MODE_BARK) {
+		if (bands_config(&(hsvc->bands), hsvc->conf.sr, hsvc->dft_size_smpls, hsvc->conf.n_bands, hsvc->arena) != BANDS_CODE_OK) {
+			r = HSV_CODE_ALLOC_ERR;
+			goto err4;
+		}
+	}
+
+	r = hsvc_config_workers(hsvc);
+	if (r != HSV_CODE_OK) {
+		goto err5;
+	}
+
+	hsvc->chans = (struct HSV_CHAN*) arena_calloc(hsvc->arena, hsvc->conf.ch, sizeof(struct HSV_CHAN));
+	if (hsvc->chans == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err6;
+	}
+
+	/* Промежуточные буферы подавления шума заняты только во время обработки одного канала,
+	   поэтому без пула у всех каналов они занимают одну и ту же память рабочей арены. */
+	mark = arena_mark(hsvc->scratch);
+	for (ch = 0; ch < hsvc->conf.ch; ch++) {
+		if (hsvc->n_workers == 1) {
+			arena_rewind(hsvc->scratch, mark);
+		}
+		r = hsvc_config_chan(hsvc, hsvc->chans + ch);
+		if (r != HSV_CODE_OK) {
+			goto err7;
+		}
+	}
+
+	if (hsvc->conf.link != HSV_LINK_MODE_OFF) {
+		arena_rewind(hsvc->scratch, mark);
+		r = hsvc_config_ctrl(hsvc, &(hsvc->link));
+		if (r != HSV_CODE_OK) {
+			goto err7;
+		}
+	}
+
+	/* Спектры пакета нужны всем каналам одновременно (связанный режим, синтез после подавления). */
+	arena_rewind(hsvc->scratch, hsvc->scratch->peak);
+	if (hsvc->conf.link != HSV_LINK_MODE_OFF) {
+		r = hsvc_config_link_buf(hsvc, &(hsvc->link));
+		if (r != HSV_CODE_OK) {
+			goto err8;
+		}
+	}
+	r = hsvc_config_batch_buf(hsvc);
+	if (r != HSV_CODE_OK) {
+		goto err9;
+	}
+
+	return HSV_CODE_OK;
+
+ err9:
+	if (hsvc->conf.link != HSV_LINK_MODE_OFF) {
+		hsvc_deconfig_link_buf(hsvc, &(hsvc->link));
+	}
+ err8:
+	if (hsvc->conf.link != HSV_LINK_MODE_OFF) {
+		hsvc_deconfig_ctrl(hsvc, &(hsvc->link));
+	}
+ err7:
+	for (k = 0; k < ch; k++) {
+		hsvc_deconfig_chan(hsvc, hsvc->chans + k);
+	}
+	arena_free(hsvc->arena, hsvc->chans);
+ err6:
+	hsvc_deconfig_workers(hsvc);
+ err5:
+	if (hsvc->conf.mode == HSV_SUPPRESSOR_MODE_BARK) {
+		bands_deconfig(&(hsvc->bands));
+	}
+ err4:
+	arena_free(hsvc->arena, hsvc->fir_window);
+ err3:
+	arena_free(hsvc->arena, hsvc->synthesis_window);
+	if (hsvc->conf.filterbank == HSV_FILTERBANK_MODE_WOLA) {
+		wola_deconfig(&(hsvc->wola));
+	}
+ err2:
+	arena_free(hsvc->arena, hsvc->window);
+ err1:
+	rb_deconfig(&(hsvc->rb));
+ err0:
+	return r;
+}
+
+enum HSV_CODE hsvc_reserve_impl(const struct HSV_CONFIG*conf, arena_t arena, arena_t scratch)
+{
+	enum HSV_CODE r;
+
+	/* Только размеры: буферы не выделяются, поэтому контекст может быть временным. */
+	struct HSV_CONTEXT hsvc;
+
+	size_t mark;
+
+	unsigned ch;
+
+#ifdef HSV_STATIC_CONFIG
+	if (hsvc_validate_config(conf) != 0) {
+		return HSV_CODE_UNKNOWN_ERR;
+	}
+#endif  /* HSV_STATIC_CONFIG */
+
+	hsvc.arena = arena;
+	hsvc.scratch = scratch;
+
+	/* Сам контекст (create_hsvc_arena). */
+	arena_reserve(hsvc.arena, 1, sizeof(struct HSV_CONTEXT));
+
+	hsvc_config_params(&hsvc, conf);
+
+	rb_reserve(hsvc.conf.cap, hsvc.arena);
+
+	if (hsvc.conf.split != HSV_SPLIT_MODE_OFF) {
+		r = hsvc_reserve_split(&hsvc);
+		if ((r != HSV_CODE_OK) || (hsvc.split_stages > 0)) {
+			return r;
+		}
+	}
+
+	arena_reserve(hsvc.arena, hsvc.frame_size_smpls, sizeof(hsv_numeric_t));
+	if (hsvc.conf.filterbank == HSV_FILTERBANK_MODE_WOLA) {
+		wola_reserve(hsvc.dft_size_smpls, HSV_WOLA_TAPS, hsvc.arena);
+	} else if (hsvc.conf.window != HSV_WINDOW_MODE_HANNING) {
+		arena_reserve(hsvc.arena, hsvc.frame_size_smpls, sizeof(hsv_numeric_t));
+	}
+	if (hsvc.conf.synthesis == HSV_SYNTHESIS_MODE_FIR) {
+		arena_reserve(hsvc.arena, hsvc.fir_len, sizeof(hsv_numeric_t));
+	}
+
+	if (hsvc.conf.mode == HSV_SUPPRESSOR_MODE_BARK) {
+		hsvc.bands.n_bands = bands_reserve(hsvc.conf.sr, hsvc.dft_size_smpls, hsvc.conf.n_bands, hsvc.arena);
+	}
+
+	hsvc_reserve_workers(&hsvc);
+
+	arena_reserve(hsvc.arena, hsvc.conf.ch, sizeof(struct HSV_CHAN));
+
+	/* Те же возвраты рабочей арены, что и в hsvc_config_impl. */
+	mark = arena_mark(hsvc.scratch);
+	for (ch = 0; ch < hsvc.conf.ch; ch++) {
+		if (hsvc.n_workers == 1) {
+			arena_rewind(hsvc.scratch, mark);
+		}
+		r = hsvc_reserve_chan(&hsvc);
+		if (r != HSV_CODE_OK) {
+			return r;
+		}
+	}
+
+	if (hsvc.conf.link != HSV_LINK_MODE_OFF) {
+		arena_rewind(hsvc.scratch, mark);
+		r = hsvc_reserve_ctrl(&hsvc);
+		if (r != HSV_CODE_OK) {
+			return r;
+		}
+	}
+
+	arena_rewind(hsvc.scratch, hsvc.scratch->peak);
+	if (hsvc.conf.link != HSV_LINK_MODE_OFF) {
+		hsvc_reserve_link_buf(&hsvc);
+	}
+	hsvc_reserve_batch_buf(&hsvc);
+
+	return HSV_CODE_OK;
+}
+
+static hsv_numeric_t int16_to_hsv_numeric_t(int16_t v)
+{
+	static const hsv_numeric_t one = 1.0;
+    static const hsv_numeric_t max_int16_inv = one / INT16_MAX;
+    static const hsv_numeric_t min_int16_inv = one / INT16_MIN;
+
+    return v * ((v > 0) ? max_int16_inv : -min_int16_inv);
+}
+
+static int16_t hsv_numeric_t_to_int16(hsv_numeric_t v)
+{
+	static const hsv_numeric_t half = 0.5;
+	
+    if (v > 0) {
+        return (v >= 1) ? INT16_MAX : ((int16_t) (v * INT16_MAX + half));
+    } else {
+        return (v <= -1) ? INT16_MIN : ((int16_t) (-v * INT16_MIN - half));
+    }
+}
+
+/**
+ * Индекс k-го сэмпла канала ch во фрейме, начинающемся с байта idx_frame кольцевого буфера.
+ */
+static unsigned hsvc_smpl_idx(hsvc_t hsvc, unsigned idx_frame, unsigned k, unsigned ch)
+{
+	return ((idx_frame / 2) + k * HSV_CONST_CH(hsvc->conf.ch) + ch) % (rb_cap(&(hsvc->rb)) / 2);
+}
+
+/**
+ * Число сэмплов канала, начиная с k-го сэмпла фрейма, лежащих в кольцевом буфере подряд (с шагом числа каналов) до его конца.
+ */
+static unsigned hsvc_smpl_run(hsvc_t hsvc, unsigned idx_frame, unsigned k, unsigned ch, unsigned n)
+{
+	unsigned idx = hsvc_smpl_idx(hsvc, idx_frame, k, ch);
+	unsigned n_ch = HSV_CONST_CH(hsvc->conf.ch);
+	unsigned run = (rb_cap(&(hsvc->rb)) / 2 - idx + n_ch - 1) / n_ch;
+
+	return HSV_MIN(run, n);
+}
+
+/**
+ * Чтение h-го фрейма пакета одного канала из кольцевого буфера в буфер обработки с применением оконной функции.
+ * \return средняя мощность фрейма до применения оконной функции.
+ */
+static hsv_numeric_t hsvc_load_frame(hsvc_t hsvc, unsigned ch, unsigned h, hsv_numeric_t*real)
+{
+	unsigned frame_size = HSV_CONST_FRAME_SIZE(hsvc->frame_size_smpls);
+	unsigned n_ch = HSV_CONST_CH(hsvc->conf.ch);
+
+	unsigned k, run;
+
+	unsigned idx_frame = (hsvc->idx_frame + h * hsvc->step_size_bs) % rb_cap(&(hsvc->rb));
+
+	hsv_numeric_t energy = 0.0;
+
+	if (hsvc->chans[ch].raw != NULL) {
+		/* Начало фрейма в кольцевом буфере уже перезаписано результатами, поэтому читаем копию входа. */
+		memcpy(real, hsvc->chans[ch].raw + h * hsvc->step_size_smpls, frame_size * sizeof(hsv_numeric_t));
+		for (k = 0; k < frame_size; k++) {
+			energy += real[k] * real[k];
+		}
+	} else {
+		/* Считываем очередной фрейм одного канала из кольцевого буфера в буфер обработки: не больше двух
+		   непрерывных участков до и после конца кольцевого буфера. */
+		for (k = 0; k < frame_size; k += run) {
+			run = hsvc_smpl_run(hsvc, idx_frame, k, ch, frame_size - k);
+			hsv_kernels->int16_to_numeric(((int16_t*)hsvc->rb.data) + hsvc_smpl_idx(hsvc, idx_frame, k, ch), n_ch, real + k, run);
+		}
+		for (k = 0; k < frame_size; k++) {
+			energy += real[k] * real[k];
+		}
+	}
+
+	/* Применяем оконную функцию, для уменьшения эффекта растекания. */
+	calculate_windowing(hsvc->window, real, real, frame_size);
+
+	return energy / frame_size;
+}
+
+/**
+ * Чтение h-го фрейма пакета одного канала во вход ДПФ (для банка фильтров WOLA - со сверткой до размера ДПФ).
+ * \return средняя мощность фрейма до применения оконной функции.
+ */
+static hsv_numeric_t hsvc_load_hop(hsvc_t hsvc, struct HSV_WORKER*worker, unsigned ch, unsigned h, hsv_numeric_t*real)
+{
+	hsv_numeric_t energy;
+
+	if (hsvc->conf.filterbank != HSV_FILTERBANK_MODE_WOLA) {
+		return hsvc_load_frame(hsvc, ch, h, real);
+	}
+
+	energy = hsvc_load_frame(hsvc, ch, h, worker->wola_buf);
+	wola_fold(&(hsvc->wola), worker->wola_buf, real);
+
+	return energy;
+}
+
+/**
+ * Чтение пакета фреймов одного канала из кольцевого буфера с применением оконной функции и поиск фреймов тишины.
+ * Для окон с малой задержкой отсчеты пакета начиная с idx_frame сначала дописываются в копию входа после истории.
+ */
+static void hsvc_load(hsvc_t hsvc, struct HSV_WORKER*worker, unsigned ch, unsigned n_hops)
+{
+	struct HSV_CHAN*chan = hsvc->chans + ch;
+
+	unsigned dft_size = HSV_CONST_DFT_SIZE(hsvc->dft_size_smpls);
+	unsigned n_ch = HSV_CONST_CH(hsvc->conf.ch);
+	unsigned stride = hsvc->batch_stride;
+
+	unsigned h, k, n, run;
+
+	if ((chan->raw != NULL) && (hsvc->conf.synthesis == HSV_SYNTHESIS_MODE_OLA)) {
+		n = (n_hops - 1) * hsvc->step_size_smpls + hsvc->frame_size_smpls - hsvc->synth_offset_smpls;
+		for (k = 0; k < n; k += run) {
+			run = hsvc_smpl_run(hsvc, hsvc->idx_frame, k, ch, n - k);
+			hsv_kernels->int16_to_numeric(((int16_t*)hsvc->rb.data) + hsvc_smpl_idx(hsvc, hsvc->idx_frame, k, ch), n_ch,
+										  chan->raw + hsvc->synth_offset_smpls + k, run);
+		}
+	}
+
+	for (h = 0; h < n_hops; h++) {
+		hsv_numeric_t energy;
+
+		memset(chan->real + h * stride, '\0', sizeof(hsv_numeric_t) * dft_size);
+		memset(chan->imag + h * stride, '\0', sizeof(hsv_numeric_t) * dft_size);
+
+		energy = hsvc_load_hop(hsvc, worker, ch, h, chan->real + h * stride);
+
+		chan->hop_state[h] = HSV_HOP_STATE_FULL;
+		if ((hsvc->conf.bypass != HSV_BYPASS_MODE_OFF) && (energy < hsvc->bypass_silence)) {
+			chan->hop_state[h] = HSV_HOP_STATE_SILENCE;
+		}
+	}
+}
+
+/**
+ * ДПФ и спектры преобразований first, ..., first + n - 1 пакета фреймов всех каналов
+ * (преобразование i - фрейм i / ch канала i % ch): без обхода - одним пакетом.
+ */
+static void hsvc_transform(hsvc_t hsvc, struct HSV_WORKER*worker, unsigned first, unsigned n)
+{
+	unsigned dft_size = HSV_CONST_DFT_SIZE(hsvc->dft_size_smpls);
+	unsigned n_ch = HSV_CONST_CH(hsvc->conf.ch);
+	unsigned len = dft_size * n;
+
+	hsv_numeric_t*real = hsvc->real + first * dft_size;
+	hsv_numeric_t*imag = hsvc->imag + first * dft_size;
+
+	unsigned i;
+
+	if (hsvc->conf.bypass == HSV_BYPASS_MODE_OFF) {
+		dft_run_dft_batch(&(worker->dft), real, imag, n);
+
+		calculate_amp_spec(real, imag, hsvc->amp_spec + first * dft_size, len);
+		calculate_power_spec(real, imag, hsvc->power_spec + first * dft_size, len);
+		if (hsvc->conf.math == HSV_MATH_MODE_FAST) {
+			calculate_phase_spec_fast(real, imag, hsvc->phase_spec + first * dft_size, len);
+		} else {
+			calculate_phase_spec(real, imag, hsvc->phase_spec + first * dft_size, len);
+		}
+		return;
+	}
+
+	/* Для фреймов тишины ДПФ и спектры не нужны. */
+	for (i = first; i < first + n; i++) {
+		unsigned offset = i * dft_size;
+
+		if (hsvc->chans[i % n_ch].hop_state[i / n_ch] == HSV_HOP_STATE_SILENCE) {
+			continue;
+		}
+
+		dft_run_dft_batch(&(worker->dft), hsvc->real + offset, hsvc->imag + offset, 1);
+
+		calculate_amp_spec(hsvc->real + offset, hsvc->imag + offset, hsvc->amp_spec + offset, dft_size);
+		calculate_power_spec(hsvc->real + offset, hsvc->imag + offset, hsvc->power_spec + offset, dft_size);
+		if (hsvc->conf.math == HSV_MATH_MODE_FAST) {
+			calculate_phase_spec_fast(hsvc->real + offset, hsvc->imag + offset, hsvc->phase_spec + offset, dft_size);
+		} else {
+			calculate_phase_spec(hsvc->real + offset, hsvc->imag + offset, hsvc->phase_spec + offset, dft_size);
+		}
+	}
+}
+
+/**
+ * Задача пула: чтение пакета фреймов канала task.
+ */
+static void hsvc_load_task(void*arg, unsigned task, unsigned worker)
+{
+	hsvc_t hsvc = (hsvc_t) arg;
+
+	hsvc_load(hsvc, hsvc->workers + worker, task, hsvc->pool_hops);
+}
+
+/**
+ * Задача пула: ДПФ и спектры task-й из n_workers равных частей преобразований пакета.
+ */
+static void hsvc_transform_task(void*arg, unsigned task, unsigned worker)
+{
+	hsvc_t hsvc = (hsvc_t) arg;
+
+	unsigned n = HSV_CONST_CH(hsvc->conf.ch) * hsvc->pool_hops;
+	unsigned first = n * task / hsvc->n_workers;
+	unsigned last = n * (task + 1) / hsvc->n_workers;
+
+	hsvc_transform(hsvc, hsvc->workers + worker, first, last - first);
+}
+
+/**
+ * Анализ пакета фреймов всех каналов.
+ * В связанном режиме фрейм считается тишиной, только если он является тишиной во всех каналах.
+ */
+static void hsvc_analyze(hsvc_t hsvc, unsigned n_hops)
+{
+	unsigned n_ch = HSV_CONST_CH(hsvc->conf.ch);
+
+	unsigned ch, h;
+
+	hsvc->pool_hops = n_hops;
+
+	pool_run(&(hsvc->pool), hsvc_load_task, hsvc, n_ch);
+
+	if ((hsvc->conf.link != HSV_LINK_MODE_OFF) && (hsvc->conf.bypass != HSV_BYPASS_MODE_OFF)) {
+		for (h = 0; h < n_hops; h++) {
+			unsigned char state = HSV_HOP_STATE_SILENCE;
+			for (ch = 0; ch < n_ch; ch++) {
+				if (hsvc->chans[ch].hop_state[h] != HSV_HOP_STATE_SILENCE) {
+					state = HSV_HOP_STATE_FULL;
+				}
+			}
+			for (ch = 0; ch < n_ch; ch++) {
+				hsvc->chans[ch].hop_state[h] = state;
+			}
+		}
+	}
+
+	pool_run(&(hsvc->pool), hsvc_transform_task, hsvc, hsvc->n_workers);
+}
+
+/**
+ * Оценка шума и вычисление спектра голоса одного фрейма с учетом пониженной частоты обновления.
+ * \return 0, если в фрейме нет голоса и подавление шума было пропущено, иначе 1.
+ */
+static int hsvc_suppress_hop(hsvc_t hsvc, struct HSV_CHAN*chan, unsigned ch, hsv_numeric_t*power_spec, const hsv_numeric_t*amp_spec)
+{
+	unsigned period = hsvc->ctrl_period;
+	unsigned phase;
+	int ctrl;
+
+	unsigned k;
+
+	/* Фазы каналов сдвинуты, чтобы пересчеты разных каналов приходились на разные фреймы. */
+	phase = (chan->ctrl_hop + ch * period / hsvc->conf.ch) % period;
+	chan->ctrl_hop++;
+	/* Пока коэффициенты усиления ни разу не вычислены, удерживать нечего. */
+	ctrl = (phase == 0) || (! chan->ctrl_ready);
+
+	if (hsvc->conf.ctrl_mode == HSV_CTRL_MODE_STAGGER) {
+		estimator_run_part(&(chan->est), power_spec, phase, period);
+	} else if (ctrl) {
+		estimator_run(&(chan->est), power_spec);
+	}
+
+	if (((hsvc->conf.bypass == HSV_BYPASS_MODE_SPP) || (hsvc->conf.bypass == HSV_BYPASS_MODE_MUTE)) && (estimator_mean_spp(&(chan->est)) < hsvc->bypass_spp)) {
+		suppressor_bypass(&(chan->sup), amp_spec, hsvc->bypass_gain);
+		return 0;
+	}
+
+	if (ctrl || (hsvc->conf.ctrl_mode == HSV_CTRL_MODE_ESTIMATOR) || (hsvc->conf.ctrl_mode == HSV_CTRL_MODE_STAGGER)) {
+		suppressor_run(&(chan->sup), amp_spec, chan->est.noise_amp_spec);
+		if (chan->gain != NULL) {
+			if (! chan->ctrl_ready) {
+				memcpy(chan->gain_next, chan->sup.gain, chan->sup.size * sizeof(hsv_numeric_t));
+			}
+			memcpy(chan->gain_prev, chan->gain_next, chan->sup.size * sizeof(hsv_numeric_t));
+			memcpy(chan->gain_next, chan->sup.gain, chan->sup.size * sizeof(hsv_numeric_t));
+		}
+		chan->ctrl_ready = 1;
+	}
+
+	if (chan->gain != NULL) {
+		/* Линейная интерполяция между двумя последними расчетами: коэффициенты запаздывают на период, но меняются плавно. */
+		hsv_numeric_t t = ((hsv_numeric_t) (phase + 1)) / ((hsv_numeric_t) period);
+		for (k = 0; k < chan->sup.size; k++) {
+			chan->gain[k] = chan->gain_prev[k] + (chan->gain_next[k] - chan->gain_prev[k]) * t;
+		}
+		suppressor_apply_gain(&(chan->sup), amp_spec, chan->gain);
+	} else if (! ctrl && (hsvc->conf.ctrl_mode == HSV_CTRL_MODE_HOLD)) {
+		suppressor_apply_gain(&(chan->sup), amp_spec, chan->sup.gain);
+	}
+
+	return 1;
+}
+
+/**
+ * Оценка и подавление шума для пакета фреймов одного канала.
+ * Рекуррентные оценки требуют строгого порядка фреймов внутри пакета.
+ */
+static void hsvc_suppress(hsvc_t hsvc, unsigned ch, unsigned n_hops)
+{
+	struct HSV_CHAN*chan = hsvc->chans + ch;
+
+	unsigned dft_size = HSV_CONST_DFT_SIZE(hsvc->dft_size_smpls);
+	unsigned stride = hsvc->batch_stride;
+
+	unsigned h, k;
+
+	for (h = 0; h < n_hops; h++) {
+		hsv_numeric_t*real = chan->real + h * stride;
+		hsv_numeric_t*imag = chan->imag + h * stride;
+		hsv_numeric_t*amp_spec = chan->amp_spec + h * stride;
+		hsv_numeric_t*phase_spec = chan->phase_spec + h * stride;
+
+		/* На тишине оценки шума и голоса не обновляются, чтобы не "обнулить" статистику. */
+		if (chan->hop_state[h] == HSV_HOP_STATE_SILENCE) {
+			continue;
+		}
+
+		if (! hsvc_suppress_hop(hsvc, chan, ch, chan->power_spec + h * stride, amp_spec)) {
+			chan->hop_state[h] = HSV_HOP_STATE_NOISE;
+			continue;
+		}
+
+		/* Для КИХ-фильтра нужны только коэффициенты усиления: их обратное ДПФ - импульсная характеристика. */
+		if (hsvc->conf.synthesis == HSV_SYNTHESIS_MODE_FIR) {
+			memcpy(real, (chan->gain != NULL) ? chan->gain : chan->sup.gain, dft_size * sizeof(hsv_numeric_t));
+			memset(imag, '\0', dft_size * sizeof(hsv_numeric_t));
+			continue;
+		}
+
+		/* Будем считать, что спектры фаз голоса, шума и зашумленного голоса совпадают. */
+		if (hsvc->conf.math == HSV_MATH_MODE_FAST) {
+			calculate_complex_spec_fast(chan->sup.speech_amp_spec, phase_spec, real, imag, dft_size);
+			continue;
+		}
+		for (k = 0; k < dft_size; k++) {
+			real[k] = chan->sup.speech_amp_spec[k] * HSV_COS(phase_spec[k]);
+			imag[k] = chan->sup.speech_amp_spec[k] * HSV_SIN(phase_spec[k]);
+		}
+	}
+}
+
+/**
+ * Задача пула: оценка и подавление шума пакета фреймов канала task.
+ */
+static void hsvc_suppress_task(void*arg, unsigned task, unsigned worker)
+{
+	(void) worker;
+
+	hsvc_suppress((hsvc_t) arg, task, ((hsvc_t) arg)->pool_hops);
+}
+
+/**
+ * Оценка и подавление шума для пакета фреймов в связанном режиме:
+ * оценка и подавление шума выполняются по объединенному спектру,
+ * а полученные коэффициенты усиления применяются к спектрам всех каналов с их собственными фазами.
+ */
+static void hsvc_link_suppress(hsvc_t hsvc, unsigned n_hops)
+{
+	struct HSV_CHAN*link = &(hsvc->link);
+
+	unsigned dft_size = hsvc->dft_size_smpls;
+	hsv_numeric_t n_chans = (hsv_numeric_t) hsvc->conf.ch;
+
+	const hsv_numeric_t*gain;
+
+	unsigned ch, h, k;
+
+	for (h = 0; h < n_hops; h++) {
+		unsigned offset = h * hsvc->batch_stride;
+
+		/* Состояния фреймов тишины во всех каналах совпадают. */
+		if (hsvc->chans[0].hop_state[h] == HSV_HOP_STATE_SILENCE) {
+			continue;
+		}
+
+		if (hsvc->conf.link == HSV_LINK_MODE_MID) {
+			/* Спектр среднего каналов: синфазный голос сохраняется, некоррелированный шум ослабляется. */
+			for (k = 0; k < dft_size; k++) {
+				hsv_numeric_t re = 0.0, im = 0.0;
+				for (ch = 0; ch < hsvc->conf.ch; ch++) {
+					re += hsvc->chans[ch].real[offset + k];
+					im += hsvc->chans[ch].imag[offset + k];
+				}
+				re /= n_chans;
+				im /= n_chans;
+				link->power_spec[k] = re * re + im * im;
+				link->amp_spec[k] = HSV_SQRT(link->power_spec[k]);
+			}
+		} else {
+			for (k = 0; k < dft_size; k++) {
+				link->power_spec[k] = hsvc->chans[0].power_spec[offset + k];
+				link->amp_spec[k] = hsvc->chans[0].amp_spec[offset + k];
+				for (ch = 1; ch < hsvc->conf.ch; ch++) {
+					link->power_spec[k] = HSV_MAX(link->power_spec[k], hsvc->chans[ch].power_spec[offset + k]);
+					link->amp_spec[k] = HSV_MAX(link->amp_spec[k], hsvc->chans[ch].amp_spec[offset + k]);
+				}
+			}
+		}
+
+		if (! hsvc_suppress_hop(hsvc, link, 0, link->power_spec, link->amp_spec)) {
+			for (ch = 0; ch < hsvc->conf.ch; ch++) {
+				hsvc->chans[ch].hop_state[h] = HSV_HOP_STATE_NOISE;
+			}
+			continue;
+		}
+
+		/* Коэффициенты усиления, фактически примененные к объединенному спектру. */
+		gain = (link->gain != NULL) ? link->gain : link->sup.gain;
+
+		for (ch = 0; ch < hsvc->conf.ch; ch++) {
+			struct HSV_CHAN*chan = hsvc->chans + ch;
+			hsv_numeric_t*real = chan->real + offset;
+			hsv_numeric_t*imag = chan->imag + offset;
+			const hsv_numeric_t*amp_spec = chan->amp_spec + offset;
+			const hsv_numeric_t*phase_spec = chan->phase_spec + offset;
+
+			if (hsvc->conf.synthesis == HSV_SYNTHESIS_MODE_FIR) {
+				memcpy(real, gain, dft_size * sizeof(hsv_numeric_t));
+				memset(imag, '\0', dft_size * sizeof(hsv_numeric_t));
+				continue;
+			}
+
+			if (hsvc->conf.math == HSV_MATH_MODE_FAST) {
+				calculate_complex_spec_fast(amp_spec, phase_spec, real, imag, dft_size);
+				for (k = 0; k < dft_size; k++) {
+					real[k] *= gain[k];
+					imag[k] *= gain[k];
+				}
+				continue;
+			}
+
+			for (k = 0; k < dft_size; k++) {
+				real[k] = gain[k] * amp_spec[k] * HSV_COS(phase_spec[k]);
+				imag[k] = gain[k] * amp_spec[k] * HSV_SIN(phase_spec[k]);
+			}
+		}
+	}
+}
+
+/**
+ * Оценка и подавление шума для пакета фреймов в режиме HSV_LINK_MODE_LANES: спектры каналов чередуются
+ * по частотам, и рекурсии всех каналов обновляются одним проходом, после чего спектр голоса каждого канала
+ * восстанавливается по его фазам так же, как в hsvc_suppress.
+ */
+static void hsvc_lanes_suppress(hsvc_t hsvc, unsigned n_hops)
+{
+	struct HSV_CHAN*link = &(hsvc->link);
+
+	unsigned dft_size = hsvc->dft_size_smpls;
+	unsigned n_ch = hsvc->conf.ch;
+
+	unsigned ch, h, k;
+
+	for (h = 0; h < n_hops; h++) {
+		unsigned offset = h * hsvc->batch_stride;
+
+		for (ch = 0; ch < n_ch; ch++) {
+			const hsv_numeric_t*power_spec = hsvc->chans[ch].power_spec + offset;
+			const hsv_numeric_t*amp_spec = hsvc->chans[ch].amp_spec + offset;
+			for (k = 0; k < dft_size; k++) {
+				link->power_spec[k * n_ch + ch] = power_spec[k];
+				link->amp_spec[k * n_ch + ch] = amp_spec[k];
+			}
+		}
+
+		hsvc_suppress_hop(hsvc, link, 0, link->power_spec, link->amp_spec);
+
+		for (ch = 0; ch < n_ch; ch++) {
+			struct HSV_CHAN*chan = hsvc->chans + ch;
+			hsv_numeric_t*real = chan->real + offset;
+			hsv_numeric_t*imag = chan->imag + offset;
+			/* Спектр амплитуд канала больше не нужен: на его месте собирается спектр голоса канала. */
+			hsv_numeric_t*speech_amp_spec = chan->amp_spec + offset;
+			const hsv_numeric_t*phase_spec = chan->phase_spec + offset;
+
+			for (k = 0; k < dft_size; k++) {
+				speech_amp_spec[k] = link->sup.speech_amp_spec[k * n_ch + ch];
+			}
+
+			if (hsvc->conf.math == HSV_MATH_MODE_FAST) {
+				calculate_complex_spec_fast(speech_amp_spec, phase_spec, real, imag, dft_size);
+				continue;
+			}
+			for (k = 0; k < dft_size; k++) {
+				real[k] = speech_amp_spec[k] * HSV_COS(phase_spec[k]);
+				imag[k] = speech_amp_spec[k] * HSV_SIN(phase_spec[k]);
+			}
+		}
+	}
+}
+
+/**
+ * Оценка и подавление шума для пакета фреймов всех каналов в выбранном режиме связанной обработки.
+ */
+static void hsvc_suppress_batch(hsvc_t hsvc, unsigned n_hops)
+{
+	switch (hsvc->conf.link) {
+	case HSV_LINK_MODE_OFF:
+		pool_run(&(hsvc->pool), hsvc_suppress_task, hsvc, HSV_CONST_CH(hsvc->conf.ch));
+		break;
+	case HSV_LINK_MODE_LANES:
+		hsvc_lanes_suppress(hsvc, n_hops);
+		break;
+	default:
+		hsvc_link_suppress(hsvc, n_hops);
+		break;
+	}
+}
+
+/**
+ * Задача пула: обратное ДПФ task-й из n_workers равных частей преобразований пакета (см. hsvc_transform).
+ * С обходом обратное ДПФ выполняется только для полностью обработанных фреймов при синтезе каждого канала.
+ */
+static void hsvc_inverse_task(void*arg, unsigned task, unsigned worker)
+{
+	hsvc_t hsvc = (hsvc_t) arg;
+
+	unsigned dft_size = HSV_CONST_DFT_SIZE(hsvc->dft_size_smpls);
+	unsigned n = HSV_CONST_CH(hsvc->conf.ch) * hsvc->pool_hops;
+	unsigned first = n * task / hsvc->n_workers;
+	unsigned last = n * (task + 1) / hsvc->n_workers;
+
+	dft_run_i_dft_batch(&(hsvc->workers[worker].dft), hsvc->real + first * dft_size, hsvc->imag + first * dft_size, last - first);
+}
+
+/**
+ * Синтез пакета фреймов одного канала: обратное ДПФ и запись в кольцевой буфер с учетом перекрытия.
+ */
+static void hsvc_synthesize(hsvc_t hsvc, struct HSV_WORKER*worker, unsigned ch, unsigned n_hops)
+{
+	struct HSV_CHAN*chan = hsvc->chans + ch;
+
+	unsigned dft_size = HSV_CONST_DFT_SIZE(hsvc->dft_size_smpls);
+	unsigned stride = hsvc->batch_stride;
+	unsigned synth_size = hsvc->synth_size_smpls;
+
+	hsv_numeric_t*frame;
+
+	unsigned h, k, run;
+
+	for (h = 0; h < n_hops; h++) {
+		hsv_numeric_t*real = chan->real + h * stride;
+		unsigned idx_frame = (hsvc->idx_frame + h * hsvc->step_size_bs) % rb_cap(&(hsvc->rb));
+
+		switch (chan->hop_state[h]) {
+		case HSV_HOP_STATE_FULL:
+			if (hsvc->conf.bypass != HSV_BYPASS_MODE_OFF) {
+				dft_run_i_dft_batch(&(worker->dft), real, chan->imag + h * stride, 1);
+			}
+			break;
+		case HSV_HOP_STATE_SILENCE:
+		case HSV_HOP_STATE_NOISE:
+			/* Постоянный коэффициент одинаков для всех частот, поэтому его можно применить во временной области.
+			   Фрейм в кольцевом буфере ещё не перезаписан результатами прошлых фреймов пакета. */
+			memset(real, '\0', sizeof(hsv_numeric_t) * dft_size);
+			hsvc_load_hop(hsvc, worker, ch, h, real);
+			if (chan->hop_state[h] == HSV_HOP_STATE_NOISE) {
+				for (k = 0; k < dft_size; k++) {
+					real[k] *= hsvc->bypass_gain;
+				}
+			}
+			break;
+		}
+
+		/* Для банка фильтров WOLA фрейм для перекрытия-сложения получается разверткой выхода обратного ДПФ,
+		   для пар окон - умножением на окно синтеза (для окон с малой задержкой берется только конец фрейма,
+		   который и начинается с idx_frame). */
+		frame = real + hsvc->synth_offset_smpls;
+		if (hsvc->conf.filterbank == HSV_FILTERBANK_MODE_WOLA) {
+			wola_unfold(&(hsvc->wola), real, worker->wola_buf);
+			frame = worker->wola_buf;
+		} else if (hsvc->synthesis_window != NULL) {
+			calculate_windowing(hsvc->synthesis_window + hsvc->synth_offset_smpls, frame, frame, synth_size);
+		}
+
+		/* Так как для уменьшения эффекта блочности используется перекрытие, сохраним данные, полученные при обработке n-го фрейма
+		   для их использования при обработке n+1-го, n+2-го и т.д. фреймов. */
+		for (k = 0; k < synth_size; k++) {
+			chan->overlap_buf[k] += frame[k] / hsvc->norm_factor;
+		}
+
+		/* Начало буфера перекрытия готово: записываем его в кольцевой буфер непрерывными участками. */
+		for (k = 0; k < hsvc->step_size_smpls; k += run) {
+			run = hsvc_smpl_run(hsvc, idx_frame, k, ch, hsvc->step_size_smpls - k);
+			hsv_kernels->numeric_to_int16(chan->overlap_buf + k, ((int16_t*)hsvc->rb.data) + hsvc_smpl_idx(hsvc, idx_frame, k, ch), HSV_CONST_CH(hsvc->conf.ch), run);
+		}
+		memmove(chan->overlap_buf, chan->overlap_buf + hsvc->step_size_smpls, (synth_size - hsvc->step_size_smpls) * sizeof(hsv_numeric_t));
+		memset(chan->overlap_buf + (synth_size - hsvc->step_size_smpls), '\0', hsvc->step_size_smpls * sizeof(hsv_numeric_t));
+	}
+
+	/* История копии входа для следующего пакета (окна с малой задержкой). */
+	if (chan->raw != NULL) {
+		memmove(chan->raw, chan->raw + n_hops * hsvc->step_size_smpls, hsvc->synth_offset_smpls * sizeof(hsv_numeric_t));
+	}
+}
+
+/**
+ * Задача пула: синтез пакета фреймов канала task. Каналы записывают в кольцевой буфер разные отсчеты,
+ * а барьер pool_run завершает запись всего пакета до сдвига idx_frame.
+ */
+static void hsvc_synthesize_task(void*arg, unsigned task, unsigned worker)
+{
+	hsvc_t hsvc = (hsvc_t) arg;
+
+	hsvc_synthesize(hsvc, hsvc->workers + worker, task, hsvc->pool_hops);
+}
+
+/**
+ * Расчет КИХ-фильтров пакета фреймов одного канала (HSV_SYNTHESIS_MODE_FIR): обратное ДПФ коэффициентов усиления
+ * дает нулефазовую импульсную характеристику, которая усекается до fir_len отсчетов окном Ханна.
+ * Фильтр h-го фрейма пакета записывается в h + 1-й фильтр канала.
+ */
+static void hsvc_fir_design(hsvc_t hsvc, struct HSV_WORKER*worker, unsigned ch, unsigned n_hops)
+{
+	struct HSV_CHAN*chan = hsvc->chans + ch;
+
+	unsigned dft_size = HSV_CONST_DFT_SIZE(hsvc->dft_size_smpls);
+	unsigned stride = hsvc->batch_stride;
+
+	unsigned h, k;
+
+	for (h = 0; h < n_hops; h++) {
+		hsv_numeric_t*real = chan->real + h * stride;
+		hsv_numeric_t*taps = chan->fir_taps + (h + 1) * hsvc->fir_len;
+
+		switch (chan->hop_state[h]) {
+		case HSV_HOP_STATE_FULL:
+			if (hsvc->conf.bypass != HSV_BYPASS_MODE_OFF) {
+				dft_run_i_dft_batch(&(worker->dft), real, chan->imag + h * stride, 1);
+			}
+			for (k = 0; k < hsvc->fir_len; k++) {
+				taps[k] = real[(k + dft_size - hsvc->fir_half) % dft_size] * hsvc->fir_window[k];
+			}
+			break;
+		case HSV_HOP_STATE_SILENCE:
+		case HSV_HOP_STATE_NOISE:
+			memset(taps, '\0', hsvc->fir_len * sizeof(hsv_numeric_t));
+			taps[hsvc->fir_half] = (chan->hop_state[h] == HSV_HOP_STATE_NOISE) ? hsvc->bypass_gain : 1.0;
+			break;
+		}
+	}
+}
+
+/**
+ * Задача пула: расчет КИХ-фильтров пакета фреймов канала task.
+ */
+static void hsvc_fir_design_task(void*arg, unsigned task, unsigned worker)
+{
+	hsvc_t hsvc = (hsvc_t) arg;
+
+	hsvc_fir_design(hsvc, hsvc->workers + worker, task, hsvc->pool_hops);
+}
+
+/**
+ * Фильтрация n отсчетов текущего шага одного канала, начиная с idx_frame,
+ * с линейным переходом от фильтра прошлого шага к фильтру текущего в начале шага.
+ */
+static void hsvc_fir_filter(hsvc_t hsvc, unsigned ch, unsigned n)
+{
+	struct HSV_CHAN*chan = hsvc->chans + ch;
+
+	const hsv_numeric_t*prev = chan->fir_taps + hsvc->fir_hop * hsvc->fir_len;
+	const hsv_numeric_t*cur = prev + hsvc->fir_len;
+	/* raw[frame_size - fir_half] - отсчет idx_frame, фильтр начинается за fir_half отсчетов до него. */
+	const hsv_numeric_t*raw = chan->raw + hsvc->frame_size_smpls - 2 * hsvc->fir_half;
+
+	/* Переход длиной в фильтр: коэффициенты усиления и так запаздывают на шаг относительно конца фрейма анализа. */
+	unsigned fade = HSV_MIN(hsvc->fir_len, hsvc->step_size_smpls);
+
+	hsv_numeric_t y_prev, y_cur, t;
+
+	unsigned i, k;
+
+	for (i = 0; i < n; i++) {
+		y_cur = 0.0;
+		for (k = 0; k < hsvc->fir_len; k++) {
+			y_cur += cur[k] * raw[i + k];
+		}
+
+		/* После перехода фильтр прошлого шага не нужен. */
+		if (hsvc->fir_pos + i + 1 < fade) {
+			y_prev = 0.0;
+			for (k = 0; k < hsvc->fir_len; k++) {
+				y_prev += prev[k] * raw[i + k];
+			}
+			t = ((hsv_numeric_t) (hsvc->fir_pos + i + 1)) / ((hsv_numeric_t) fade);
+			y_cur = y_prev + (y_cur - y_prev) * t;
+		}
+
+		((int16_t*)hsvc->rb.data)[hsvc_smpl_idx(hsvc, hsvc->idx_frame, i, ch)] = hsv_numeric_t_to_int16(y_cur);
+	}
+}
+
+/**
+ * Задача пула: фильтрация pool_smpls отсчетов текущего шага канала task и сдвиг его копии входа.
+ */
+static void hsvc_fir_filter_task(void*arg, unsigned task, unsigned worker)
+{
+	hsvc_t hsvc = (hsvc_t) arg;
+	struct HSV_CHAN*chan = hsvc->chans + task;
+
+	unsigned n = hsvc->pool_smpls;
+
+	(void) worker;
+
+	hsvc_fir_filter(hsvc, task, n);
+	memmove(chan->raw, chan->raw + n, (hsvc->raw_len - n) * sizeof(hsv_numeric_t));
+}
+
+/**
+ * Обработка в режиме HSV_SYNTHESIS_MODE_FIR. Фрейм анализа шага заканчивается через fir_half отсчетов после
+ * начала шага, поэтому каждый отсчет выдается, как только поданы fir_half следующих за ним.
+ * Анализ выполняется пакетом для всех шагов, фреймы которых уже поданы, в начале первого из них.
+ */
+static int hsvc_fir_denoise(hsvc_t hsvc)
+{
+	unsigned n_ch = hsvc->conf.ch;
+	unsigned frame_size = hsvc->frame_size_smpls;
+	unsigned step_size = hsvc->step_size_smpls;
+	unsigned half = hsvc->fir_half;
+
+	unsigned processed = 0;
+
+	unsigned ahead, n, n_hops;
+	unsigned ch, k, run;
+
+	for (;;) {
+		/* Дополняем копии входа поданными отсчетами. Отсчетов после idx_frame в копиях - ahead. */
+		ahead = hsvc->raw_len - (frame_size - half);
+		n = HSV_MIN(hsvc->pending_bytes / (2 * n_ch) - ahead, hsvc->raw_cap - hsvc->raw_len);
+		for (ch = 0; ch < n_ch; ch++) {
+			hsv_numeric_t*raw = hsvc->chans[ch].raw + hsvc->raw_len;
+			for (k = 0; k < n; k += run) {
+				run = hsvc_smpl_run(hsvc, hsvc->idx_frame, ahead + k, ch, n - k);
+				hsv_kernels->int16_to_numeric(((int16_t*)hsvc->rb.data) + hsvc_smpl_idx(hsvc, hsvc->idx_frame, ahead + k, ch), n_ch, raw + k, run);
+			}
+		}
+		hsvc->raw_len += n;
+		ahead += n;
+
+		if (ahead <= half) {
+			break;
+		}
+
+		if (hsvc->fir_hop == hsvc->fir_hops) {
+			/* Фильтр последнего шага прошлого пакета становится фильтром прошлого шага. */
+			if (hsvc->fir_hops > 0) {
+				for (ch = 0; ch < n_ch; ch++) {
+					memcpy(hsvc->chans[ch].fir_taps, hsvc->chans[ch].fir_taps + hsvc->fir_hops * hsvc->fir_len,
+						   hsvc->fir_len * sizeof(hsv_numeric_t));
+				}
+			}
+
+			/* Фрейм h-го шага - raw[h * step, h * step + frame). */
+			n_hops = HSV_MIN(1 + (ahead - half) / step_size, hsvc->batch_hops);
+
+			hsvc_analyze(hsvc, n_hops);
+			hsvc_suppress_batch(hsvc, n_hops);
+			if (hsvc->conf.bypass == HSV_BYPASS_MODE_OFF) {
+				pool_run(&(hsvc->pool), hsvc_inverse_task, hsvc, hsvc->n_workers);
+			}
+			pool_run(&(hsvc->pool), hsvc_fir_design_task, hsvc, n_ch);
+
+			hsvc->fir_hops = n_hops;
+			hsvc->fir_hop = 0;
+		}
+
+		n = HSV_MIN(step_size - hsvc->fir_pos, ahead - half);
+		hsvc->pool_smpls = n;
+		pool_run(&(hsvc->pool), hsvc_fir_filter_task, hsvc, n_ch);
+		hsvc->raw_len -= n;
+
+		hsvc->fir_pos += n;
+		if (hsvc->fir_pos == step_size) {
+			hsvc->fir_pos = 0;
+			hsvc->fir_hop++;
+		}
+
+		hsvc->pending_bytes -= n * 2 * n_ch;
+		processed += n * 2 * n_ch;
+		hsvc->idx_frame = (hsvc->idx_frame + n * 2 * n_ch) % rb_cap(&(hsvc->rb));
+	}
+
+	return processed;
+}
+
+/**
+ * Обновление целевых коэффициентов усиления верхней полосы по коэффициентам усиления,
+ * примененным к верхней четверти частот нижней полосы.
+ */
+static void hsvc_split_track(hsvc_t hsvc)
+{
+	hsvc_t split = hsvc->split;
+
+	unsigned dft_size = split->dft_size_smpls;
+	unsigned first = (3 * dft_size) / 8;
+	unsigned last = dft_size / 2;
+
+	unsigned ch, k;
+
+	for (ch = 0; ch < hsvc->conf.ch; ch++) {
+		struct HSV_CHAN*src = (split->conf.link != HSV_LINK_MODE_OFF) ? &(split->link) : split->chans + ch;
+		const hsv_numeric_t*gain;
+		hsv_numeric_t sum = 0.0;
+
+		if (! src->ctrl_ready) {
+			continue;
+		}
+
+		gain = (src->gain != NULL) ? src->gain : src->sup.gain;
+		for (k = first; k <= last; k++) {
+			sum += gain[k];
+		}
+		hsvc->split_chans[ch].gain_target = sum / ((hsv_numeric_t) (last - first + 1));
+	}
+}
+
+/**
+ * Сборка выходных отсчетов из n обработанных отсчетов нижней полосы (split_buf):
+ * y = g * x + interp(low' - g * low) = interp(low') + g * (x - interp(low)),
+ * то есть обработанная нижняя полоса плюс верхняя полоса, умноженная на g.
+ * \return число байт, обработка которых завершена.
+ */
+static unsigned hsvc_split_synthesize(hsvc_t hsvc, unsigned n)
+{
+	unsigned n_ch = hsvc->conf.ch;
+	unsigned n_out = 1U << hsvc->split_stages;
+
+	unsigned processed = 0;
+
+	unsigned i, ch, s, m, k;
+
+	for (i = 0; i < n; i++) {
+		for (ch = 0; ch < n_ch; ch++) {
+			struct HSV_SPLIT_CHAN*sc = hsvc->split_chans + ch;
+			hsv_numeric_t*a = hsvc->split_out + ch * n_out;
+
+			int16_t low = sc->fifo[sc->fifo_head];
+			sc->fifo_head = (sc->fifo_head + 1) % hsvc->split_fifo_cap;
+			sc->fifo_len--;
+
+			sc->gain += (sc->gain_target - sc->gain) * hsvc->split_alpha;
+
+			/* Интерполируем разность обработанной и исходной (с весом g) нижней полосы от нижней ступени к верхней. */
+			a[0] = int16_to_hsv_numeric_t(hsvc->split_buf[i * n_ch + ch]) - sc->gain * int16_to_hsv_numeric_t(low);
+			for (s = hsvc->split_stages; s-- > 0; ) {
+				unsigned count = 1U << (hsvc->split_stages - 1 - s);
+				for (k = count; k-- > 0; ) {
+					halfband_interpolate(sc->interp + s, a[k], a + 2 * k);
+				}
+			}
+		}
+
+		for (m = 0; m < n_out; m++) {
+			/* Первые split_delay отсчетов интерполятора соответствуют позициям до начала потока. */
+			if (hsvc->split_skip > 0) {
+				hsvc->split_skip--;
+				continue;
+			}
+
+			for (ch = 0; ch < n_ch; ch++) {
+				int16_t*smpl = ((int16_t*)hsvc->rb.data) + hsvc_smpl_idx(hsvc, hsvc->idx_frame, 0, ch);
+				*smpl = hsv_numeric_t_to_int16(hsvc->split_chans[ch].gain * int16_to_hsv_numeric_t(*smpl) + hsvc->split_out[ch * n_out + m]);
+			}
+
+			hsvc->idx_frame = (hsvc->idx_frame + 2 * n_ch) % rb_cap(&(hsvc->rb));
+			hsvc->pending_bytes -= 2 * n_ch;
+			hsvc->split_ahead_bs -= 2 * n_ch;
+			processed += 2 * n_ch;
+		}
+	}
+
+	return processed;
+}
+
+/**
+ * Обработка в узкой полосе: децимация новых данных, обработка нижней полосы отдельным контекстом,
+ * интерполяция и сборка с верхней полосой. Позиции выходных отсчетов совпадают с позициями входных,
+ * но обработка каждого отсчета завершается с задержкой split_delay (и буферизацией контекста нижней полосы).
+ */
+static int hsvc_split_denoise(hsvc_t hsvc)
+{
+	hsvc_t split = hsvc->split;
+
+	unsigned n_ch = hsvc->conf.ch;
+	unsigned cap = rb_cap(&(hsvc->rb));
+
+	unsigned processed = 0;
+
+	unsigned n_low, got;
+	unsigned ch, s;
+
+	int r;
+
+	while (hsvc->pending_bytes - hsvc->split_ahead_bs >= 2 * n_ch) {
+		n_low = 0;
+		while ((hsvc->pending_bytes - hsvc->split_ahead_bs >= 2 * n_ch) && (n_low < HSV_SPLIT_CHUNK)) {
+			unsigned idx = (hsvc->idx_frame + hsvc->split_ahead_bs) % cap;
+			int ready = 0;
+
+			for (ch = 0; ch < n_ch; ch++) {
+				struct HSV_SPLIT_CHAN*sc = hsvc->split_chans + ch;
+				hsv_numeric_t v = int16_to_hsv_numeric_t(((int16_t*)hsvc->rb.data)[hsvc_smpl_idx(hsvc, idx, 0, ch)]);
+				int16_t low;
+
+				/* Все каналы децимируются синхронно, поэтому готовность отсчета у них одинакова. */
+				ready = 1;
+				for (s = 0; (s < hsvc->split_stages) && ready; s++) {
+					ready = halfband_decimate(sc->decim + s, v, &v);
+				}
+				if (! ready) {
+					continue;
+				}
+
+				low = hsv_numeric_t_to_int16(v);
+				hsvc->split_buf[n_low * n_ch + ch] = low;
+				sc->fifo[(sc->fifo_head + sc->fifo_len) % hsvc->split_fifo_cap] = low;
+				sc->fifo_len++;
+			}
+
+			hsvc->split_ahead_bs += 2 * n_ch;
+			if (ready) {
+				n_low++;
+			}
+		}
+
+		if (n_low == 0) {
+			continue;
+		}
+
+		r = hsvc_push(split, (const char*) hsvc->split_buf, n_low * n_ch * sizeof(int16_t));
+		if (r < 0) {
+			return r;
+		}
+		if (hsvc->conf.split == HSV_SPLIT_MODE_TRACKED) {
+			hsvc_split_track(hsvc);
+		}
+
+		while ((got = hsvc_get(split, (char*) hsvc->split_buf, hsvc->split_fifo_cap * n_ch * sizeof(int16_t))) != 0) {
+			processed += hsvc_split_synthesize(hsvc, got / (n_ch * sizeof(int16_t)));
+		}
+	}
+
+	return processed;
+}
+
+/**
+ * Сброс состояния обработки в узкой полосе (после hsvc_flush).
+ */
+static void hsvc_split_reset(hsvc_t hsvc)
+{
+	unsigned ch, s;
+
+	hsvc_flush(hsvc->split);
+	while (hsvc_get(hsvc->split, (char*) hsvc->split_buf, hsvc->split_fifo_cap * hsvc->conf.ch * sizeof(int16_t)) != 0) {
+	}
+
+	for (ch = 0; ch < hsvc->conf.ch; ch++) {
+		struct HSV_SPLIT_CHAN*sc = hsvc->split_chans + ch;
+
+		for (s = 0; s < hsvc->split_stages; s++) {
+			halfband_reset(sc->decim + s);
+			halfband_reset(sc->interp + s);
+		}
+		sc->fifo_head = 0;
+		sc->fifo_len = 0;
+	}
+
+	hsvc->split_skip = hsvc->split_delay;
+	hsvc->split_ahead_bs = 0;
+}
+
+static int hsvc_denoise(hsvc_t hsvc)
+{
+	unsigned n_ch = HSV_CONST_CH(hsvc->conf.ch);
+	unsigned ahead_bs = hsvc->frame_size_bs - hsvc->synth_offset_smpls * 2 * n_ch;
+
+	unsigned n_hops;
+
+	unsigned processed = 0;
+
+	if (hsvc->split != NULL) {
+		return hsvc_split_denoise(hsvc);
+	}
+
+	if (hsvc->conf.synthesis == HSV_SYNTHESIS_MODE_FIR) {
+		return hsvc_fir_denoise(hsvc);
+	}
+
+	/* До тех пор пока кол-во байт, ожидающих обработку,
+	   превышает размер одного фрейма, будем их обрабатывать. Фрейм окон с малой задержкой
+	   начинается за synth_offset_smpls отсчетов до idx_frame (из копии входа). */
+	while (hsvc->pending_bytes >= ahead_bs) {
+		/* Число фреймов, полностью находящихся в кольцевом буфере. Обрабатываем их пакетом,
+		   чтобы таблицы ДПФ и состояния оценки и подавления шума канала не вытеснялись из кэша между фреймами.
+		   Все фреймы пакета читаются до записи результатов, поэтому порядок этапов можно менять. */
+		n_hops = 1 + (hsvc->pending_bytes - ahead_bs) / hsvc->step_size_bs;
+		if (n_hops > hsvc->batch_hops) {
+			n_hops = hsvc->batch_hops;
+		}
+
+		/* Структура многоканального WAV-файла подразумевает, что данные каналов лежат через один:
+		   если есть 2 канала A и B, то данные лежат как ABABAB... . Каналы обрабатываются исполнителями пула
+		   по одному, каждый этап пакета завершается барьером. */
+		hsvc_analyze(hsvc, n_hops);
+
+		hsvc_suppress_batch(hsvc, n_hops);
+
+		if (hsvc->conf.bypass == HSV_BYPASS_MODE_OFF) {
+			pool_run(&(hsvc->pool), hsvc_inverse_task, hsvc, hsvc->n_workers);
+		}
+		pool_run(&(hsvc->pool), hsvc_synthesize_task, hsvc, n_ch);
+
+		hsvc->pending_bytes -= n_hops * hsvc->step_size_bs; processed += n_hops * hsvc->step_size_bs;
+		/* Учтём, что часть фрейма может лежать "в конце" кольцевого буфера, а часть "в начале". */
+		hsvc->idx_frame = (hsvc->idx_frame + n_hops * hsvc->step_size_bs) % rb_cap(&(hsvc->rb));
+	}
+
+	return processed;
+}
+
+int hsvc_push(hsvc_t hsvc, const char*data, unsigned data_len)
+{
+	enum HSV_CODE r;
+
+	enum RB_CODE rb_r;
+
+	rb_r = rb_push(&(hsvc->rb), data, data_len);
+	if (rb_r != RB_CODE_OK) {
 		r = switch_rb_code(rb_r);
 		goto err0;
 	}
@@ -379,21 +2434,137 @@ unsigned hsvc_get(hsvc_t hsvc, char*data, unsigned data_cap)
 	return rb_get(&(hsvc->rb), data, data_len);
 }
 
+unsigned hsvc_get_room(hsvc_t hsvc)
+{
+	return rb_cap(&(hsvc->rb)) - rb_len(&(hsvc->rb));
+}
+
+unsigned hsvc_get_latency(hsvc_t hsvc)
+{
+	if (hsvc->split != NULL) {
+		return (hsvc_get_latency(hsvc->split) << hsvc->split_stages) + hsvc->split_delay;
+	}
+
+	if (hsvc->conf.synthesis == HSV_SYNTHESIS_MODE_FIR) {
+		return hsvc->fir_half;
+	}
+
+	/* Отсчет выдается после прихода всех отсчетов фрейма, в котором синтез его завершает. */
+	if (hsvc->conf.window == HSV_WINDOW_MODE_LOW_DELAY) {
+		return hsvc->frame_size_smpls - hsvc->synth_offset_smpls;
+	}
+	return hsvc->frame_size_smpls;
+}
+
+unsigned hsvc_get_period(hsvc_t hsvc)
+{
+	if (hsvc->split != NULL) {
+		return hsvc_get_period(hsvc->split) << hsvc->split_stages;
+	}
+
+	return hsvc->step_size_smpls * hsvc->ctrl_period;
+}
+
 void hsvc_flush(hsvc_t hsvc)
 {
+	unsigned ch;
+
     hsvc->idx_frame = rb_idx_in(&(hsvc->rb));
     hsvc->pending_bytes = 0;
+
+	/* Копии входа относятся к позициям до сброса. */
+	if ((hsvc->split == NULL) && (hsvc->conf.synthesis == HSV_SYNTHESIS_MODE_FIR)) {
+		hsvc->raw_len = hsvc->frame_size_smpls - hsvc->fir_half;
+		for (ch = 0; ch < hsvc->conf.ch; ch++) {
+			memset(hsvc->chans[ch].raw, '\0', hsvc->raw_len * sizeof(hsv_numeric_t));
+		}
+		hsvc->fir_hops = 0;
+		hsvc->fir_hop = 0;
+		hsvc->fir_pos = 0;
+	} else if ((hsvc->split == NULL) && (hsvc->raw_cap > 0)) {
+		for (ch = 0; ch < hsvc->conf.ch; ch++) {
+			memset(hsvc->chans[ch].raw, '\0', hsvc->synth_offset_smpls * sizeof(hsv_numeric_t));
+		}
+	}
+
+	if (hsvc->split != NULL) {
+		hsvc_split_reset(hsvc);
+	}
+}
+
+void hsvc_reset_ch(hsvc_t hsvc, unsigned ch)
+{
+	struct HSV_CHAN*chan;
+	struct HSV_CHAN*ctrl;
+
+	unsigned lane = 0;
+
+	if (hsvc->split != NULL) {
+		/* Верхняя полоса нового потока пропускается без изменений, пока нижняя не обработана. */
+		if (hsvc->conf.split == HSV_SPLIT_MODE_TRACKED) {
+			hsvc->split_chans[ch].gain = 1.0;
+			hsvc->split_chans[ch].gain_target = 1.0;
+		}
+		hsvc_reset_ch(hsvc->split, ch);
+		return;
+	}
+
+	chan = hsvc->chans + ch;
+
+	/* В связанных режимах оценка и подавление шума общие: сбрасывается поток канала или общее состояние. */
+	ctrl = (hsvc->conf.link == HSV_LINK_MODE_OFF) ? chan : &(hsvc->link);
+	if (hsvc->conf.link == HSV_LINK_MODE_LANES) {
+		lane = ch;
+	}
+
+	estimator_reset_lane(&(ctrl->est), lane);
+	suppressor_reset_lane(&(ctrl->sup), lane);
+	if (hsvc->conf.link != HSV_LINK_MODE_LANES) {
+		ctrl->ctrl_hop = 0;
+		ctrl->ctrl_ready = 0;
+	}
+
+	memset(chan->overlap_buf, '\0', hsvc->synth_size_smpls * sizeof(hsv_numeric_t));
+
+	/* Копия входа окна с малой задержкой - вход до начала следующего фрейма, которого у нового потока нет. */
+	if ((hsvc->conf.synthesis != HSV_SYNTHESIS_MODE_FIR) && (hsvc->raw_cap > 0)) {
+		memset(chan->raw, '\0', hsvc->synth_offset_smpls * sizeof(hsv_numeric_t));
+	}
 }
 
 void hsvc_deconfig(hsvc_t hsvc)
 {
 	unsigned ch;
 
-	for (ch = 0; ch < hsvc->conf.ch; ch++) {
-		hsvc_deconfig_chan(hsvc->chans + ch);
-	}
+	if (hsvc->split != NULL) {
+		hsvc_deconfig_split(hsvc);
+	} else {
+		hsvc_deconfig_batch_buf(hsvc);
+
+		if (hsvc->conf.link != HSV_LINK_MODE_OFF) {
+			hsvc_deconfig_link_buf(hsvc, &(hsvc->link));
+			hsvc_deconfig_ctrl(hsvc, &(hsvc->link));
+		}
 
-	free(hsvc->window);
+		for (ch = 0; ch < hsvc->conf.ch; ch++) {
+			hsvc_deconfig_chan(hsvc, hsvc->chans + ch);
+		}
+		arena_free(hsvc->arena, hsvc->chans);
+
+		hsvc_deconfig_workers(hsvc);
+
+		if (hsvc->conf.mode == HSV_SUPPRESSOR_MODE_BARK) {
+			bands_deconfig(&(hsvc->bands));
+		}
+
+		if (hsvc->conf.filterbank == HSV_FILTERBANK_MODE_WOLA) {
+			wola_deconfig(&(hsvc->wola));
+		}
+		arena_free(hsvc->arena, hsvc->synthesis_window);
+		arena_free(hsvc->arena, hsvc->fir_window);
+
+		arena_free(hsvc->arena, hsvc->window);
+	}
 	rb_deconfig(&hsvc->rb);
 }
 
@@ -14,7 +14,7 @@
 extern "C" {
 #endif  /* __cplusplus */
 
-#define HSV_MAX_CHANS 4 /**< Максимальное число одновременно обрабатываемых каналов. */
+#include <stddef.h>
 
 #define HSV_DEFAULT 0 /**< Значение по умолчанию для всех параметром. */
 
@@ -22,8 +22,28 @@ extern "C" {
 
 #define HSV_DEFAULT_CAP 16384 /**< Вместимость кольцевого буфера по умолчанию в байтах. */
 
+#define HSV_FIXED_MAX_DFT_SIZE 8192 /**< Максимальный размер ДПФ при HSV_PRECISION_MODE_FIXED. */
+
 #define HSV_DEFAULT_OVERLAP_PERC 50 /**< Процент перекрытия фреймов по умолчанию. */
 
+#define HSV_DEFAULT_LOW_DELAY_OVERLAP_PERC 80 /**< Процент перекрытия фреймов по умолчанию для окон с малой задержкой. */
+
+#define HSV_DEFAULT_FIR_DELAY_MS 8 /**< Групповая задержка КИХ-фильтра по умолчанию в мс. */
+
+#define HSV_DEFAULT_WOLA_OVERLAP_PERC 75 /**< Процент перекрытия фреймов по умолчанию для банка фильтров WOLA (шаг - четверть ДПФ). */
+
+#define HSV_DEFAULT_BATCH_HOPS 8 /**< Число шагов, обрабатываемых одним пакетом, по умолчанию. */
+
+#define HSV_DEFAULT_BYPASS_SILENCE_DB 90 /**< Порог тишины по умолчанию в -dBFS.                                       */
+#define HSV_DEFAULT_BYPASS_SPP_PERC   15 /**< Порог средней вероятности наличия голоса по умолчанию в процентах.       */
+#define HSV_DEFAULT_BYPASS_GAIN_PERC   1 /**< Коэффициент ослабления фреймов без голоса по умолчанию в процентах. */
+
+#define HSV_DEFAULT_CTRL_PERIOD 1 /**< Период обновления оценки шума и коэффициентов усиления по умолчанию во фреймах. */
+
+#define HSV_DEFAULT_BANDS 24 /**< Число критических полос по умолчанию (HSV_SUPPRESSOR_MODE_BARK). */
+
+#define HSV_DEFAULT_SPLIT_GAIN_PERC 30 /**< Коэффициент усиления верхней полосы по умолчанию в процентах (HSV_SPLIT_MODE_FIXED). */
+
 /**
  * Режим работы алгоритма шумоподавления.
  * Копия enum'а из suppressor.h
@@ -40,6 +60,230 @@ enum HSV_SUPPRESSOR_MODE
 
 	HSV_SUPPRESSOR_MODE_RTSNR,   /**< Режим, основанный на двухшаговой фильтрации Шифенга.               */
 	HSV_SUPPRESSOR_MODE_RTSNR_G, /**< Режим, основанный на двухшаговой фильтрации Шифенга с "усилением". */
+
+	/**
+	 * Режим, основанный на винеровской фильтрации Скалара по критическим полосам (n_bands полос по шкале Барков).
+	 * Оценка и подавление шума выполняются по полосам, коэффициенты усиления интерполируются на частоты ДПФ,
+	 * поэтому их стоимость и состояние не зависят от размера ДПФ.
+	 */
+	HSV_SUPPRESSOR_MODE_BARK,
+};
+
+/**
+ * Режим пропуска обработки "пустых" фреймов.
+ */
+enum HSV_BYPASS_MODE
+{
+	HSV_BYPASS_MODE_OFF,     /**< Все фреймы проходят полную обработку. */
+	/**
+	 * Фреймы, средняя энергия которых ниже порога тишины, копируются без ДПФ, оценки и подавления шума.
+	 * Оценка шума при этом "замораживается".
+	 */
+	HSV_BYPASS_MODE_SILENCE,
+	/**
+	 * Дополнительно к HSV_BYPASS_MODE_SILENCE фреймы, в которых по оценке шума нет голоса,
+	 * ослабляются постоянным коэффициентом без подавления шума и обратного ДПФ.
+	 */
+	HSV_BYPASS_MODE_SPP,
+	/**
+	 * Как HSV_BYPASS_MODE_SPP, но фреймы, в которых по оценке шума нет голоса, заглушаются полностью
+	 * (bypass_gain_perc не используется).
+	 */
+	HSV_BYPASS_MODE_MUTE,
+};
+
+/**
+ * Режим пониженной частоты обновления оценки шума и коэффициентов усиления.
+ * Постоянные времени MCRA-2 много больше шага фрейма, поэтому оценку шума можно обновлять реже.
+ */
+enum HSV_CTRL_MODE
+{
+	/**
+	 * Оценка шума и коэффициенты усиления пересчитываются раз в ctrl_period фреймов,
+	 * в остальных фреймах коэффициенты удерживаются.
+	 */
+	HSV_CTRL_MODE_HOLD,
+	/**
+	 * Как HSV_CTRL_MODE_HOLD, но коэффициенты линейно интерполируются между двумя последними расчетами
+	 * (с запаздыванием на ctrl_period фреймов).
+	 */
+	HSV_CTRL_MODE_INTERP,
+	/**
+	 * Раз в ctrl_period фреймов пересчитывается только оценка шума, подавление шума выполняется в каждом фрейме.
+	 */
+	HSV_CTRL_MODE_ESTIMATOR,
+	/**
+	 * В каждом фрейме оценка шума обновляется на 1/ctrl_period частот, подавление шума выполняется в каждом фрейме.
+	 * Нагрузка распределяется по фреймам равномерно.
+	 */
+	HSV_CTRL_MODE_STAGGER,
+};
+
+/**
+ * Режим связанной обработки каналов.
+ * Для коррелированного многоканального звука (несколько микрофонов, один диктор) оценка и подавление шума
+ * выполняются один раз по объединенному спектру, а полученные коэффициенты усиления применяются ко всем каналам.
+ */
+enum HSV_LINK_MODE
+{
+	HSV_LINK_MODE_OFF, /**< Каналы обрабатываются независимо.                             */
+	HSV_LINK_MODE_MID, /**< Объединенный спектр - спектр среднего всех каналов ("mid").   */
+	HSV_LINK_MODE_MAX, /**< Объединенный спектр - максимум спектров мощности по каналам. */
+	/**
+	 * Каналы - независимые потоки (см. hsv_batch.h): состояния оценки и подавления шума всех каналов чередуются
+	 * по частотам и обновляются одним проходом векторизованных ядер. Результат каждого канала совпадает
+	 * с HSV_LINK_MODE_OFF. Только без обходов, пониженной частоты обновления, обработки в узкой полосе,
+	 * синтеза, кроме HSV_SYNTHESIS_MODE_OLA, режима HSV_SUPPRESSOR_MODE_BARK и хранения в binary16.
+	 */
+	HSV_LINK_MODE_LANES,
+};
+
+/**
+ * Режим обработки в узкой полосе для высоких частот дискретизации.
+ * Сигнал разделяется каскадом полуполосных фильтров: нижняя полоса (до 5.5-6 кГц при 44.1/48 кГц)
+ * после децимации обрабатывается полностью (оценка и подавление шума), а верхняя полоса только умножается
+ * на коэффициент усиления. Вносит дополнительную задержку на фильтры (около 3 мс при 48 кГц).
+ * Если частоту дискретизации нельзя понизить хотя бы до 11025 Гц, режим не действует.
+ */
+enum HSV_SPLIT_MODE
+{
+	HSV_SPLIT_MODE_OFF,     /**< Обработка во всей полосе.                                                    */
+	HSV_SPLIT_MODE_FIXED,   /**< Постоянный коэффициент усиления верхней полосы (split_gain_perc).           */
+	HSV_SPLIT_MODE_TRACKED, /**< Коэффициент усиления верхней полосы следует за усилением верхних частот нижней. */
+};
+
+/**
+ * Способ анализа и синтеза сигнала.
+ */
+enum HSV_FILTERBANK_MODE
+{
+	/**
+	 * Оконное преобразование Фурье: фрейм с окном Ханна дополняется нулями до размера ДПФ,
+	 * синтез - перекрытие-сложение dft_size_smpls отсчетов.
+	 */
+	HSV_FILTERBANK_MODE_STFT,
+	/**
+	 * Банк фильтров со взвешенным перекрытием-сложением (WOLA): фрейм длины 2 * dft_size_smpls с окном-прототипом
+	 * складывается до размера ДПФ, поэтому ДПФ вдвое меньше фрейма, а подполосы имеют крутые склоны и
+	 * сильное подавление вне полосы. Размер ДПФ по умолчанию - ближайшая к frame_size_smpls степень двойки,
+	 * шаг - dft_size_smpls * (100 - overlap_perc) / 100, округленный до делителя размера ДПФ.
+	 * Задержка - 2 * dft_size_smpls отсчетов.
+	 */
+	HSV_FILTERBANK_MODE_WOLA,
+};
+
+/**
+ * Оконные функции анализа и синтеза (для HSV_FILTERBANK_MODE_STFT).
+ * Кроме HSV_WINDOW_MODE_HANNING, окна анализа и синтеза одинаковы и комплементарны по мощности: подъем и спад
+ * длины перекрытия (не больше половины фрейма) и плоская вершина. Восстановление точное при любом перекрытии,
+ * поэтому можно уменьшить перекрытие (например, до 25%) и число фреймов в секунду.
+ */
+enum HSV_WINDOW_MODE
+{
+	/**
+	 * Окно Ханна при анализе, без окна синтеза; перекрытие-сложение нормируется только множителем.
+	 * Амплитуда восстанавливается точно только при перекрытии 50% и 75%.
+	 */
+	HSV_WINDOW_MODE_HANNING,
+	HSV_WINDOW_MODE_SQRT_HANNING, /**< Корень из окна Ханна (синусное окно).  */
+	HSV_WINDOW_MODE_VORBIS,       /**< Окно Vorbis.                           */
+	HSV_WINDOW_MODE_KBD,          /**< Окно Кайзера-Бесселя (KBD, alpha = 4). */
+	/**
+	 * Асимметричные окна с малой задержкой: длинное окно анализа (частотное разрешение фрейма сохраняется)
+	 * и окно синтеза длины двух шагов в конце фрейма. Задержка уменьшается с размера фрейма до двух шагов
+	 * (при перекрытии 80% по умолчанию - с 20 до 8 мс), но число фреймов в секунду растет.
+	 * Начало фрейма анализа лежит до еще не выданных отсчетов, поэтому хранится копией входа.
+	 * Перекрытие должно быть не меньше 50%.
+	 */
+	HSV_WINDOW_MODE_LOW_DELAY,
+};
+
+/**
+ * Способ применения коэффициентов усиления к сигналу.
+ */
+enum HSV_SYNTHESIS_MODE
+{
+	HSV_SYNTHESIS_MODE_OLA, /**< Умножение спектра фрейма, обратное ДПФ и перекрытие-сложение. */
+	/**
+	 * Анализ (ДПФ, оценка и подавление шума) выполняется в боковой цепи по фрейму, заканчивающемуся
+	 * fir_delay_smpls отсчетов после начала шага, а коэффициенты усиления шага переводятся в линейно-фазовый
+	 * КИХ-фильтр длины 2 * fir_delay_smpls + 1 (обратное ДПФ, окно Ханна), которым фильтруется вход
+	 * с коротким переходом от фильтра прошлого шага. Задержка - только групповая задержка фильтра,
+	 * частотное разрешение усиления - около sr / fir_delay_smpls. Шаг можно увеличить (уменьшить overlap_perc),
+	 * чтобы реже выполнять анализ.
+	 * Короткий фильтр не разделяет гармоники голоса и шум между ними, поэтому качество растет с задержкой.
+	 * SNR / сегментный SNR (дБ) для HSV_SUPPRESSOR_MODE_TSNR на data/noised.wav (16 кГц, фрейм 20 мс, вход - 3.5 / -0.5):
+	 *  - задержка 1 мс: 3.6 / 1.5 (подавление почти не улучшает SNR);
+	 *  - задержка 4 мс: 5.4 / 2.7;
+	 *  - задержка 8 мс (по умолчанию): 6.5 / 3.4;
+	 *  - задержка 10 мс (наибольшая для фрейма 20 мс): 7.1 / 3.7;
+	 *  - HSV_SYNTHESIS_MODE_OLA, задержка 20 мс: 8.4 / 4.2.
+	 */
+	HSV_SYNTHESIS_MODE_FIR,
+};
+
+/**
+ * Точность вычислений. Библиотека содержит обработку для каждой точности, выбор выполняется при конфигурации.
+ */
+enum HSV_PRECISION_MODE
+{
+	HSV_PRECISION_MODE_FLOAT,       /**< float: быстрая обработка в реальном времени.          */
+	HSV_PRECISION_MODE_DOUBLE,      /**< double: например, для повторной обработки записей.   */
+	HSV_PRECISION_MODE_LONG_DOUBLE, /**< long double: эталонная обработка.                     */
+	/**
+	 * Целочисленная обработка для процессоров без блока плавающей точки: ДПФ с блочной плавающей точкой,
+	 * оценка шума MCRA-2 в Q15 и винеровская фильтрация с делением через приближенное обратное значение.
+	 * Поддерживаются только HSV_SUPPRESSOR_MODE_WIENER и оконное преобразование Фурье с окном Ханна,
+	 * размер ДПФ - степень двойки (по умолчанию - наименьшая не меньше двух фреймов, не больше HSV_FIXED_MAX_DFT_SIZE).
+	 */
+	HSV_PRECISION_MODE_FIXED,
+};
+
+/**
+ * Способ вычисления элементарных функций при обработке с плавающей точкой.
+ */
+enum HSV_MATH_MODE
+{
+	HSV_MATH_MODE_LIBM, /**< Функции libm. */
+	/**
+	 * Полиномиальные приближения над массивами (см. fastmath.h): фаза и восстановление спектра по фазе,
+	 * степени и логарифм спектрального вычитания. Погрешность - порядка точности float,
+	 * результат не совпадает побитово с HSV_MATH_MODE_LIBM. Не влияет на HSV_PRECISION_MODE_FIXED.
+	 */
+	HSV_MATH_MODE_FAST,
+};
+
+/**
+ * Защита от денормализованных чисел и деления на ноль на тишине и затухающем сигнале.
+ */
+enum HSV_DENORMAL_MODE
+{
+	HSV_DENORMAL_MODE_OFF, /**< Без защиты. */
+	/**
+	 * На время hsvc_push и hsvc_flush включается сброс денормализованных чисел в ноль (FTZ и DAZ на x86,
+	 * FZ на AArch64), рекурсивные спектры мощности оценки шума и подавления ограничиваются снизу,
+	 * а затухающие рекуррентные спектры голоса и вероятности наличия голоса обнуляются.
+	 * Стоимость обработки фрейма не растет на тишине; для long double (x87) действуют только ограничения спектров.
+	 */
+	HSV_DENORMAL_MODE_PROTECT,
+};
+
+/**
+ * Формат хранения рекурсивных спектров оценки шума (P, P_min, вероятность наличия голоса, спектр мощности шума)
+ * и прошлого спектра амплитуд голоса подавления между фреймами. Вычисления выполняются в выбранной точности,
+ * а рабочие копии спектров размещаются в рабочей памяти (struct HSV_MEMORY_USAGE::scratch), поэтому
+ * 16-битное хранение уменьшает память состояния потока. Результат не совпадает побитово с HSV_STORAGE_MODE_NATIVE.
+ */
+enum HSV_STORAGE_MODE
+{
+	HSV_STORAGE_MODE_NATIVE, /**< В точности вычислений, без преобразований. */
+	/**
+	 * IEEE 754 binary16 с общим порядком (степенью двойки) на массив: относительная погрешность 2^-11,
+	 * значения на 117 дБ ниже наибольшего в массиве обнуляются, поэтому спектры ограничиваются снизу,
+	 * как при HSV_DENORMAL_MODE_PROTECT. Диапазон не зависит от уровня сигнала.
+	 */
+	HSV_STORAGE_MODE_FP16,
+	HSV_STORAGE_MODE_BF16, /**< bfloat16: относительная погрешность 2^-8 в диапазоне float. */
 };
 
 /**
@@ -67,7 +311,7 @@ struct HSV_CONFIG
 	unsigned sr;
 	/**
 	 * Число каналов.
-	 * Должно быть ненулевым и не превышать HSV_MAX_CHANS.
+	 * Должно быть ненулевым; состояния каналов выделяются по их числу.
 	 */
 	unsigned ch;
 	/**
@@ -99,8 +343,124 @@ struct HSV_CONFIG
 	/**
 	 * Вместимость кольцевого буфера в байтах.
 	 * Должна быть четной и достаточно большой для упреждения задержек.
+	 * Значение по умолчанию (HSV_DEFAULT_CAP) удваивается, пока в буфер не поместятся два фрейма.
 	 */
 	unsigned cap;
+	/**
+	 * Максимальное число шагов (фреймов), обрабатываемых одним пакетом.
+	 * Если за один вызов hsvc_push накопилось несколько фреймов, то сначала для всех
+	 * вычисляются ДПФ, затем по порядку выполняются оценка и подавление шума, затем синтез.
+	 */
+	unsigned batch_hops;
+
+	/**
+	 * Режим пропуска обработки "пустых" фреймов.
+	 */
+	enum HSV_BYPASS_MODE bypass;
+	/**
+	 * Порог тишины в -dBFS: фрейм считается тишиной, если его средняя мощность ниже -bypass_silence_db dBFS.
+	 */
+	unsigned bypass_silence_db;
+	/**
+	 * Порог средней вероятности наличия голоса в процентах для режимов HSV_BYPASS_MODE_SPP и HSV_BYPASS_MODE_MUTE.
+	 */
+	unsigned bypass_spp_perc;
+	/**
+	 * Коэффициент ослабления фреймов без голоса в процентах для режима HSV_BYPASS_MODE_SPP
+	 * (0 - значение по умолчанию HSV_DEFAULT_BYPASS_GAIN_PERC; полное заглушение - режим HSV_BYPASS_MODE_MUTE).
+	 */
+	unsigned bypass_gain_perc;
+
+	/**
+	 * Период обновления оценки шума (и коэффициентов усиления) во фреймах.
+	 * Значение 1 соответствует обновлению в каждом фрейме. Для многоканального звука
+	 * обновления разных каналов приходятся на разные фреймы.
+	 */
+	unsigned ctrl_period;
+	/**
+	 * Режим пониженной частоты обновления.
+	 */
+	enum HSV_CTRL_MODE ctrl_mode;
+
+	/**
+	 * Режим связанной обработки каналов.
+	 */
+	enum HSV_LINK_MODE link;
+
+	/**
+	 * Режим обработки в узкой полосе.
+	 */
+	enum HSV_SPLIT_MODE split;
+	/**
+	 * Коэффициент усиления верхней полосы в процентах для режима HSV_SPLIT_MODE_FIXED.
+	 */
+	unsigned split_gain_perc;
+
+	/**
+	 * Число критических полос для режима HSV_SUPPRESSOR_MODE_BARK (не меньше 2).
+	 * Если полосы получаются уже шага ДПФ, их число уменьшается.
+	 */
+	unsigned n_bands;
+
+	/**
+	 * Способ анализа и синтеза сигнала.
+	 */
+	enum HSV_FILTERBANK_MODE filterbank;
+
+	/**
+	 * Оконные функции анализа и синтеза (не используются при HSV_FILTERBANK_MODE_WOLA).
+	 */
+	enum HSV_WINDOW_MODE window;
+
+	/**
+	 * Способ применения коэффициентов усиления к сигналу.
+	 */
+	enum HSV_SYNTHESIS_MODE synthesis;
+	/**
+	 * Групповая задержка КИХ-фильтра в сэмплах для режима HSV_SYNTHESIS_MODE_FIR (по умолчанию HSV_DEFAULT_FIR_DELAY_MS,
+	 * но не больше наибольшей допустимой). Удвоенная задержка должна быть меньше размеров фрейма и ДПФ.
+	 */
+	unsigned fir_delay_smpls;
+
+	/**
+	 * Точность вычислений (по умолчанию HSV_PRECISION_MODE_FLOAT).
+	 */
+	enum HSV_PRECISION_MODE precision;
+
+	/**
+	 * Способ вычисления элементарных функций (по умолчанию HSV_MATH_MODE_LIBM).
+	 */
+	enum HSV_MATH_MODE math;
+
+	/**
+	 * Защита от денормализованных чисел (по умолчанию HSV_DENORMAL_MODE_OFF).
+	 */
+	enum HSV_DENORMAL_MODE denormal;
+
+	/**
+	 * Формат хранения состояния оценки и подавления шума (по умолчанию HSV_STORAGE_MODE_NATIVE).
+	 * Не поддерживается HSV_PRECISION_MODE_FIXED.
+	 */
+	enum HSV_STORAGE_MODE storage;
+
+	/**
+	 * Число потоков, между которыми делятся каналы контекста (по умолчанию HSV_DEFAULT - 1, обработка в вызывающем потоке).
+	 * Больше ch не используется: вызывающий hsvc_push поток обрабатывает каналы наравне с остальными,
+	 * потоки создаются при первой обработке и завершаются в hsvc_deconfig.
+	 * Не поддерживается HSV_PRECISION_MODE_FIXED.
+	 */
+	unsigned threads;
+};
+
+/**
+ * Память контекста \"HSV\" с заданной конфигурацией (см. hsvc_get_memory_usage).
+ * Без общей рабочей памяти поток занимает state + scratch байт, с общей (hsvc_config_shared) - только state,
+ * а scratch байт делятся всеми контекстами, которые обрабатываются по очереди в одном потоке.
+ */
+struct HSV_MEMORY_USAGE
+{
+	size_t state;   /**< Состояние потока: оценки шума, буферы перекрытия, кольцевой буфер, таблицы.   */
+	size_t scratch; /**< Рабочая память: спектры пакета фреймов и промежуточные буферы подавления шума. */
 };
 
 /**
@@ -118,17 +478,67 @@ hsvc_t create_hsvc();
 
 /**
  * Проверка корректности структуры конфигурации.
+ * При сборке со статической конфигурацией (make STATIC_CONFIG=..., см. README) некорректна и конфигурация
+ * с частотой дискретизации, числом каналов, режимом, размерами фрейма и ДПФ, отличными от заданных при сборке,
+ * или с разделением на полосы.
  * \return 0 при корректной конфигуации, номер первого некорректного поля (с 1) при некорректной.
  */
 int hsvc_validate_config(const struct HSV_CONFIG*conf);
 
 /**
  * Конфигурация \"HSV\".
+ * Все буферы контекста размещаются в одном блоке памяти размера hsvc_get_arena_size(conf), выделяемом malloc.
  * \param conf структура конфигурации \"HSV\".
  * \return результат конфигурирования.
  */
 enum HSV_CODE hsvc_config(hsvc_t hsvc, const struct HSV_CONFIG*conf);
 
+/**
+ * Размер памяти для всех буферов контекста с заданной конфигурацией (см. hsvc_config_arena):
+ * сумма state и scratch из hsvc_get_memory_usage.
+ * \param conf структура конфигурации \"HSV\".
+ * \return размер памяти в байтах (при некорректной конфигурации - 0).
+ */
+size_t hsvc_get_arena_size(const struct HSV_CONFIG*conf);
+
+/**
+ * Размеры памяти состояния и рабочей памяти контекста с заданной конфигурацией.
+ * Размеры рассчитываются по тем же параметрам, что и буферы при конфигурации, но без выделения памяти
+ * и расчета таблиц, поэтому вызов дешев и зависит от всех параметров, а не только от размеров.
+ * \param conf структура конфигурации \"HSV\".
+ * \param usage размеры памяти в байтах.
+ * \return HSV_CODE_OK или ошибка, с которой конфигурация будет отклонена.
+ */
+enum HSV_CODE hsvc_get_memory_usage(const struct HSV_CONFIG*conf, struct HSV_MEMORY_USAGE*usage);
+
+/**
+ * Конфигурация \"HSV\" в памяти пользователя: буферы выделяются из нее с выравниванием на 64 байта,
+ * а сама память не освобождается hsvc_deconfig и должна существовать, пока контекст сконфигурирован.
+ * Контекст обработки выбранной точности и контекст нижней полосы в режиме split также размещаются в mem,
+ * в куче остается только структура create_hsvc. Рабочая память (см. hsvc_config_shared) размещается в начале mem,
+ * граница рассчитывается так же, как в hsvc_get_memory_usage.
+ * \param conf структура конфигурации \"HSV\".
+ * \param mem память с любым выравниванием.
+ * \param mem_size размер памяти, не меньше hsvc_get_arena_size(conf).
+ * \return результат конфигурирования (HSV_CODE_ALLOC_ERR, если памяти не хватает).
+ */
+enum HSV_CODE hsvc_config_arena(hsvc_t hsvc, const struct HSV_CONFIG*conf, void*mem, size_t mem_size);
+
+/**
+ * Конфигурация \"HSV\" с общей рабочей памятью: состояние размещается в mem, как в hsvc_config_arena,
+ * а спектры и промежуточные буферы, содержимое которых не нужно между вызовами, - в scratch.
+ * Одну рабочую память можно передать всем контекстам, которые обрабатываются в одном потоке: hsvc_push и hsvc_flush
+ * таких контекстов не должны выполняться одновременно. Память не освобождается hsvc_deconfig.
+ * \param conf структура конфигурации \"HSV\".
+ * \param mem память состояния с любым выравниванием.
+ * \param mem_size размер памяти состояния, не меньше state из hsvc_get_memory_usage.
+ * \param scratch рабочая память с любым выравниванием.
+ * \param scratch_size размер рабочей памяти, не меньше scratch из hsvc_get_memory_usage
+ * (для нескольких конфигураций - наибольшего).
+ * \return результат конфигурирования (HSV_CODE_ALLOC_ERR, если памяти не хватает).
+ */
+enum HSV_CODE hsvc_config_shared(hsvc_t hsvc, const struct HSV_CONFIG*conf, void*mem, size_t mem_size, void*scratch, size_t scratch_size);
+
 /**
  * Запись данных и их шумоочистка.
  * \param data массив бинарных данных для чтения.
@@ -145,11 +555,52 @@ int hsvc_push(hsvc_t hsvc, const char*data, unsigned data_len);
  */
 unsigned hsvc_get(hsvc_t hsvc, char*data, unsigned data_cap);
 
+/**
+ * Свободное место кольцевого буфера: сколько байт можно передать hsvc_push без ошибки переполнения.
+ * Место занимают необработанные данные и обработанные, еще не считанные hsvc_get.
+ * \return число байт.
+ */
+unsigned hsvc_get_room(hsvc_t hsvc);
+
+/**
+ * Алгоритмическая задержка обработки: сколько отсчетов на канал нужно подать после отсчета,
+ * чтобы его обработанное значение можно было прочитать (без учета размера подаваемых блоков).
+ * Для обычных окон равна размеру фрейма, для HSV_WINDOW_MODE_LOW_DELAY - двум шагам фрейма,
+ * для HSV_SYNTHESIS_MODE_FIR - групповой задержке КИХ-фильтра,
+ * в режиме split к ней добавляется задержка фильтров.
+ * \return задержка в отсчетах исходной частоты дискретизации.
+ */
+unsigned hsvc_get_latency(hsvc_t hsvc);
+
+/**
+ * Период сетки обработки: шаг фрейма, умноженный на период обновления оценки шума
+ * (в режиме split - период контекста нижней полосы на исходной частоте дискретизации).
+ * Поток, начатый с отсчета, кратного периоду, делится на фреймы и обновления так же, как с начала записи.
+ * \return период в отсчетах исходной частоты дискретизации.
+ */
+unsigned hsvc_get_period(hsvc_t hsvc);
+
+/**
+ * Набор инструкций процессора, выбранный для вычислительных ядер при создании первого контекста: "scalar", "sse2",
+ * "avx2" или "avx512". Переменная окружения HSV_CPU_LEVEL ограничивает его сверху.
+ * Обработка с фиксированной точкой (HSV_PRECISION_MODE_FIXED) ядра не использует.
+ * \return имя набора инструкций.
+ */
+const char*hsvc_get_cpu_level(hsvc_t hsvc);
+
 /**
  * Сброс внутреннего счетчика фреймов для получения необработанных данных.
  */
 void hsvc_flush(hsvc_t hsvc);
 
+/**
+ * Сброс состояния канала ch: оценки и подавления шума (в режимах HSV_LINK_MODE_MID и HSV_LINK_MODE_MAX -
+ * общих для всех каналов) и буфера перекрытия. Фреймы, начинающиеся с текущей позиции входа, обрабатываются
+ * так же, как в только что сконфигурированном контексте. Коэффициенты КИХ-фильтра сохраняются.
+ * \param ch номер канала.
+ */
+void hsvc_reset_ch(hsvc_t hsvc, unsigned ch);
+
 /**
  * Удаление всех внутренних динамических структур.
  */
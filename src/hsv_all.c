@@ -0,0 +1,30 @@
+/**
+ * \file hsv_all.c
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Объединенная единица трансляции "HSV" одной точности.
+ */
+/**
+ * \ingroup hsv
+ * \{
+ */
+
+/*
+ * Модули, зависящие от hsv_numeric_t, и hsv.c включаются в одну единицу трансляции (см. hsv_all.a в Makefile),
+ * поэтому компилятор видит весь конвейер обработки фрейма и встраивает функции модулей в hsv.c без LTO.
+ * Файл компилируется для каждой точности, как и отдельные модули; вычислительные ядра (kernels) собираются отдельно
+ * с флагами наборов инструкций, а кольцевой буфер и фиксированная точка от точности не зависят.
+ */
+
+#include "fastmath/fastmath.c"
+#include "utils/utils.c"
+#include "dft/dft.c"
+#include "bands/bands.c"
+#include "wola/wola.c"
+#include "estimator/estimator.c"
+#include "suppressor/suppressor.c"
+#include "halfband/halfband.c"
+
+#include "hsv.c"
+/**
+ * /}
+ */
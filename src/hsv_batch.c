@@ -0,0 +1,604 @@
+/**
+ * \file hsv_batch.c
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Реализация API пакета "HSV".
+ */
+/**
+ * \ingroup hsv
+ * \{
+ */
+#include "hsv_batch.h"
+
+#include "arena.h"
+#include "rb.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HSV_BATCH_CHUNK_SMPLS 1024 /**< Наибольшее число сэмплов дорожки в одной подаче в контекст. */
+
+#define HSV_BATCH_NONE SIZE_MAX /**< Позиция, которая не наступит: поток не закончен или сброс не нужен. */
+
+/**
+ * Дорожка пакета. Позиции - номера сэмплов в каналах контекста, общие для всех дорожек: вход с позиции j
+ * выдается контекстом как выход с той же позиции. Поток дорожки занимает отрезок позиций [start, end),
+ * остальные позиции дорожки - нулевой вход, выход которого отбрасывается.
+ */
+struct HSV_BATCH_LANE
+{
+	struct RING_BUFFER in;  /**< Очередь входа.  */
+	struct RING_BUFFER out; /**< Очередь выхода. */
+
+	int attached; /**< Принимает ли дорожка данные (см. hsvb_attach, hsvb_detach). */
+	unsigned pad; /**< Число нулевых байт, дополняющих неполный последний сэмпл отсоединенного потока. */
+
+	size_t prev_start; /**< Начало прошлого потока.                                           */
+	size_t prev_end;   /**< Конец прошлого потока.                                            */
+	size_t start;      /**< Начало текущего потока.                                           */
+	size_t end;        /**< Конец текущего потока (HSV_BATCH_NONE, пока дорожка присоединена). */
+	size_t reset;      /**< Позиция входа, на которой сбрасываются каналы дорожки перед текущим потоком. */
+};
+
+/**
+ * Структура пакета \"HSV\".
+ */
+struct HSV_BATCH
+{
+	struct HSV_BATCH_CONFIG conf; /**< Параметры конфигурации.                  */
+	struct HSV_CONFIG hsvc_conf;  /**< Конфигурация контекста всех дорожек.     */
+	hsvc_t hsvc;                  /**< Контекст, каналы которого - каналы дорожек. */
+
+	struct ARENA arena; /**< Арена очередей и буферов пакета. */
+	void*mem;           /**< Память арены.                    */
+	size_t mem_size;    /**< Размер памяти арены.             */
+
+	unsigned smpl_bs; /**< Размер многоканального сэмпла дорожки в байтах. */
+
+	unsigned latency; /**< Задержка контекста в сэмплах (hsvc_get_latency). */
+	unsigned period;  /**< Период сетки обработки в сэмплах (hsvc_get_period). */
+
+	struct HSV_BATCH_LANE*lane; /**< Дорожки. */
+
+	size_t pos_in;  /**< Число сэмплов дорожки, поданных в контекст.     */
+	size_t pos_out; /**< Число сэмплов дорожки, полученных из контекста. */
+
+	char*buf;      /**< Перемежающиеся сэмплы всех дорожек (HSV_BATCH_CHUNK_SMPLS сэмплов).  */
+	char*lane_buf; /**< Сэмплы одной дорожки (HSV_BATCH_CHUNK_SMPLS сэмплов).                */
+};
+
+static unsigned hsvb_min(unsigned a, unsigned b)
+{
+	return (a < b) ? a : b;
+}
+
+static size_t hsvb_max_pos(size_t a, size_t b)
+{
+	return (a > b) ? a : b;
+}
+
+hsvb_t create_hsvb()
+{
+	hsvb_t hsvb;
+
+	hsvb = (hsvb_t) calloc(1, sizeof(struct HSV_BATCH));
+	return hsvb;
+}
+
+/**
+ * Конфигурация пакета с подставленными значениями по умолчанию и конфигурация контекста всех дорожек.
+ */
+static void hsvb_fill_config(const struct HSV_BATCH_CONFIG*conf, struct HSV_BATCH_CONFIG*tmp, struct HSV_CONFIG*hsvc_conf)
+{
+	*tmp = *conf;
+	if (tmp->lanes == HSV_DEFAULT) {
+		tmp->lanes = HSV_DEFAULT_BATCH_LANES;
+	}
+	if (tmp->queue_bs == HSV_DEFAULT) {
+		tmp->queue_bs = HSV_DEFAULT_BATCH_QUEUE;
+	}
+
+	*hsvc_conf = tmp->stream;
+	hsvc_conf->ch = tmp->stream.ch * tmp->lanes;
+	hsvc_conf->cap = tmp->stream.cap * tmp->lanes;
+	/* Рекурсии дорожек выполняются одним проходом, если режим HSV_LINK_MODE_LANES поддерживает конфигурацию,
+	   иначе каналы дорожек обрабатываются по отдельности. */
+	hsvc_conf->link = HSV_LINK_MODE_LANES;
+	if (hsvc_validate_config(hsvc_conf) != 0) {
+		hsvc_conf->link = HSV_LINK_MODE_OFF;
+	}
+}
+
+int hsvb_validate_config(const struct HSV_BATCH_CONFIG*conf)
+{
+	struct HSV_BATCH_CONFIG tmp;
+	struct HSV_CONFIG hsvc_conf;
+
+	hsvb_fill_config(conf, &tmp, &hsvc_conf);
+
+	if ((hsvc_validate_config(&(tmp.stream)) != HSV_CODE_OK) || (tmp.stream.link != HSV_LINK_MODE_OFF) ||
+		(hsvc_validate_config(&hsvc_conf) != HSV_CODE_OK)) {
+		return 1;
+	}
+
+	return HSV_CODE_OK;
+}
+
+/**
+ * Выделение дорожек и буферов пакета из арены (в режиме измерения - из кучи).
+ */
+static enum HSV_CODE hsvb_config_buf(hsvb_t hsvb)
+{
+	enum HSV_CODE r;
+
+	struct HSV_BATCH_LANE*lane;
+
+	unsigned l;
+
+	hsvb->lane = (struct HSV_BATCH_LANE*) arena_calloc(&(hsvb->arena), hsvb->conf.lanes, sizeof(struct HSV_BATCH_LANE));
+	if (hsvb->lane == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err0;
+	}
+
+	for (l = 0; l < hsvb->conf.lanes; l++) {
+		lane = hsvb->lane + l;
+		if (rb_config(&(lane->in), hsvb->conf.queue_bs, &(hsvb->arena)) != RB_CODE_OK) {
+			r = HSV_CODE_ALLOC_ERR;
+			goto err1;
+		}
+		if (rb_config(&(lane->out), hsvb->conf.queue_bs, &(hsvb->arena)) != RB_CODE_OK) {
+			rb_deconfig(&(lane->in));
+			r = HSV_CODE_ALLOC_ERR;
+			goto err1;
+		}
+
+		/* Потоки всех дорожек начинаются вместе с контекстом. */
+		lane->attached = 1;
+		lane->pad = 0;
+		lane->prev_start = 0;
+		lane->prev_end = 0;
+		lane->start = 0;
+		lane->end = HSV_BATCH_NONE;
+		lane->reset = HSV_BATCH_NONE;
+	}
+
+	hsvb->buf = (char*) arena_calloc(&(hsvb->arena), HSV_BATCH_CHUNK_SMPLS * hsvb->conf.lanes, hsvb->smpl_bs);
+	if (hsvb->buf == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err1;
+	}
+
+	hsvb->lane_buf = (char*) arena_calloc(&(hsvb->arena), HSV_BATCH_CHUNK_SMPLS, hsvb->smpl_bs);
+	if (hsvb->lane_buf == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err2;
+	}
+
+	return HSV_CODE_OK;
+
+ err2:
+	arena_free(&(hsvb->arena), hsvb->buf);
+ err1:
+	while (l-- > 0) {
+		rb_deconfig(&(hsvb->lane[l].out));
+		rb_deconfig(&(hsvb->lane[l].in));
+	}
+	arena_free(&(hsvb->arena), hsvb->lane);
+ err0:
+	return r;
+}
+
+static void hsvb_deconfig_buf(hsvb_t hsvb)
+{
+	unsigned l;
+
+	arena_free(&(hsvb->arena), hsvb->lane_buf);
+	arena_free(&(hsvb->arena), hsvb->buf);
+	for (l = hsvb->conf.lanes; l-- > 0;) {
+		rb_deconfig(&(hsvb->lane[l].out));
+		rb_deconfig(&(hsvb->lane[l].in));
+	}
+	arena_free(&(hsvb->arena), hsvb->lane);
+}
+
+enum HSV_CODE hsvb_config(hsvb_t hsvb, const struct HSV_BATCH_CONFIG*conf)
+{
+	enum HSV_CODE r;
+
+	if (hsvb_validate_config(conf) != 0) {
+		r = HSV_CODE_UNKNOWN_ERR;
+		goto err0;
+	}
+
+	hsvb_fill_config(conf, &(hsvb->conf), &(hsvb->hsvc_conf));
+	hsvb->smpl_bs = hsvb->conf.stream.ch * (HSV_SUPPORTED_BS / 8);
+
+	hsvb->hsvc = create_hsvc();
+	if (hsvb->hsvc == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err0;
+	}
+	r = hsvc_config(hsvb->hsvc, &(hsvb->hsvc_conf));
+	if (r != HSV_CODE_OK) {
+		goto err1;
+	}
+	hsvb->latency = hsvc_get_latency(hsvb->hsvc);
+	hsvb->period = hsvc_get_period(hsvb->hsvc);
+
+	/* Размер памяти определяется пробной конфигурацией в режиме измерения арены: она только выделяет буферы. */
+	arena_init(&(hsvb->arena), NULL, 0);
+	r = hsvb_config_buf(hsvb);
+	if (r != HSV_CODE_OK) {
+		goto err2;
+	}
+	hsvb_deconfig_buf(hsvb);
+	hsvb->mem_size = arena_mem_size(hsvb->arena.peak);
+
+	hsvb->mem = malloc(hsvb->mem_size);
+	if (hsvb->mem == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err2;
+	}
+	arena_init(&(hsvb->arena), hsvb->mem, hsvb->mem_size);
+	r = hsvb_config_buf(hsvb);
+	if (r != HSV_CODE_OK) {
+		goto err3;
+	}
+
+	hsvb->pos_in = 0;
+	hsvb->pos_out = 0;
+
+	return HSV_CODE_OK;
+
+ err3:
+	free(hsvb->mem);
+	hsvb->mem = NULL;
+ err2:
+	hsvc_deconfig(hsvb->hsvc);
+ err1:
+	hsvc_free(hsvb->hsvc);
+	hsvb->hsvc = NULL;
+ err0:
+	return r;
+}
+
+/**
+ * Нужен ли выход дорожки с позиции pos: выход промежутков между потоками отбрасывается.
+ */
+static int hsvb_lane_keeps(const struct HSV_BATCH_LANE*lane, size_t pos)
+{
+	return ((pos >= lane->prev_start) && (pos < lane->prev_end)) || ((pos >= lane->start) && (pos < lane->end));
+}
+
+/**
+ * Число байт очереди входа дорожки, которые можно подать в контекст: у присоединенной дорожки - целые сэмплы,
+ * у отсоединенной - все данные, дополненные нулями до целого сэмпла.
+ */
+static unsigned hsvb_lane_queued(hsvb_t hsvb, struct HSV_BATCH_LANE*lane)
+{
+	if (lane->attached) {
+		return rb_len(&(lane->in)) / hsvb->smpl_bs * hsvb->smpl_bs;
+	}
+	return rb_len(&(lane->in)) + lane->pad;
+}
+
+/**
+ * Нужно ли дорожке продвижение контекста, кроме подачи данных потока: она ждет начала потока с данными
+ * в очереди или выход ее отсоединенного потока еще не обработан полностью.
+ */
+static int hsvb_lane_pending(hsvb_t hsvb, struct HSV_BATCH_LANE*lane)
+{
+	size_t pos = hsvb->pos_in;
+
+	if ((pos < lane->start) && (rb_len(&(lane->in)) > 0)) {
+		return 1;
+	}
+	if ((lane->prev_end > lane->prev_start) && (pos < lane->prev_end + hsvb->latency)) {
+		return 1;
+	}
+	return (! lane->attached) && (lane->end > lane->start) && (pos < lane->end + hsvb->latency);
+}
+
+/**
+ * Число сэмплов, которые дорожка может подать в контекст с позиции pos_in одним отрезком одного вида
+ * (нули до начала потока, данные потока или нули после его конца).
+ * \param demand признак того, что дорожка подает данные потока.
+ */
+static size_t hsvb_lane_avail(hsvb_t hsvb, struct HSV_BATCH_LANE*lane, int*demand)
+{
+	size_t pos = hsvb->pos_in;
+	size_t n;
+
+	if (pos < lane->start) {
+		n = lane->start - pos;
+	} else if (pos < lane->end) {
+		n = hsvb_lane_queued(hsvb, lane) / hsvb->smpl_bs;
+		if (n > 0) {
+			*demand = 1;
+		}
+	} else {
+		n = HSV_BATCH_NONE;
+	}
+
+	/* Каналы дорожки сбрасываются ровно на позиции сброса. */
+	if (pos < lane->reset) {
+		n = (n < lane->reset - pos) ? n : lane->reset - pos;
+	}
+
+	return n;
+}
+
+/**
+ * Подача n сэмплов дорожки в буфер контекста с позиции pos_in (см. hsvb_lane_avail).
+ */
+static void hsvb_lane_feed(hsvb_t hsvb, unsigned l, unsigned n)
+{
+	struct HSV_BATCH_LANE*lane = hsvb->lane + l;
+
+	unsigned lanes = hsvb->conf.lanes;
+	unsigned smpl_bs = hsvb->smpl_bs;
+	unsigned len = 0;
+
+	unsigned k;
+
+	if ((hsvb->pos_in >= lane->start) && (hsvb->pos_in < lane->end)) {
+		len = rb_get(&(lane->in), hsvb->lane_buf, hsvb_min(n * smpl_bs, hsvb_lane_queued(hsvb, lane)));
+		if (! lane->attached) {
+			lane->pad -= hsvb_min(lane->pad, n * smpl_bs - len);
+		}
+	}
+	memset(hsvb->lane_buf + len, '\0', n * smpl_bs - len);
+
+	for (k = 0; k < n; k++) {
+		memcpy(hsvb->buf + (k * lanes + l) * smpl_bs, hsvb->lane_buf + k * smpl_bs, smpl_bs);
+	}
+}
+
+/**
+ * Перенос выхода контекста в очереди выхода дорожек и подача в контекст входа, пока его подают все дорожки.
+ * \return 0 или код ошибки hsvc_push.
+ */
+static int hsvb_process(hsvb_t hsvb)
+{
+	struct HSV_BATCH_LANE*lane;
+
+	unsigned lanes = hsvb->conf.lanes;
+	unsigned smpl_bs = hsvb->smpl_bs;
+	unsigned step_bs = lanes * smpl_bs;
+
+	unsigned l, k, ch;
+	unsigned n, len, keep;
+	size_t avail;
+
+	int demand;
+	int r;
+
+	for (;;) {
+		/* Выход контекста занимает место для входа, поэтому сначала переносится в очереди выхода. */
+		n = HSV_BATCH_CHUNK_SMPLS;
+		for (l = 0; l < lanes; l++) {
+			lane = hsvb->lane + l;
+			if ((hsvb->pos_out < lane->prev_end) || (hsvb->pos_out < lane->end)) {
+				n = hsvb_min(n, (rb_cap(&(lane->out)) - rb_len(&(lane->out))) / smpl_bs);
+			}
+		}
+
+		len = hsvc_get(hsvb->hsvc, hsvb->buf, n * step_bs);
+		if (len > 0) {
+			n = len / step_bs;
+			for (l = 0; l < lanes; l++) {
+				lane = hsvb->lane + l;
+				keep = 0;
+				for (k = 0; k < n; k++) {
+					if (hsvb_lane_keeps(lane, hsvb->pos_out + k)) {
+						memcpy(hsvb->lane_buf + keep * smpl_bs, hsvb->buf + (k * lanes + l) * smpl_bs, smpl_bs);
+						keep++;
+					}
+				}
+				rb_push(&(lane->out), hsvb->lane_buf, keep * smpl_bs);
+			}
+			hsvb->pos_out += n;
+			continue;
+		}
+
+		demand = 0;
+		for (l = 0; l < lanes; l++) {
+			demand = demand || hsvb_lane_pending(hsvb, hsvb->lane + l);
+		}
+
+		n = hsvb_min(HSV_BATCH_CHUNK_SMPLS, hsvc_get_room(hsvb->hsvc) / step_bs);
+		for (l = 0; l < lanes; l++) {
+			avail = hsvb_lane_avail(hsvb, hsvb->lane + l, &demand);
+			n = (avail < n) ? (unsigned) avail : n;
+		}
+
+		if ((n == 0) || ! demand) {
+			break;
+		}
+
+		for (l = 0; l < lanes; l++) {
+			hsvb_lane_feed(hsvb, l, n);
+		}
+
+		r = hsvc_push(hsvb->hsvc, hsvb->buf, n * step_bs);
+		if (r < 0) {
+			return r;
+		}
+		hsvb->pos_in += n;
+
+		/* Последний фрейм, перекрывающийся с прошлым потоком, обработан, а первый фрейм нового - еще нет. */
+		for (l = 0; l < lanes; l++) {
+			lane = hsvb->lane + l;
+			if (hsvb->pos_in == lane->reset) {
+				for (ch = 0; ch < hsvb->conf.stream.ch; ch++) {
+					hsvc_reset_ch(hsvb->hsvc, l * hsvb->conf.stream.ch + ch);
+				}
+				lane->reset = HSV_BATCH_NONE;
+			}
+		}
+	}
+
+	return 0;
+}
+
+int hsvb_push(hsvb_t hsvb, unsigned lane, const char*data, unsigned data_len)
+{
+	int r;
+
+	if (! hsvb->lane[lane].attached) {
+		return HSV_CODE_UNKNOWN_ERR;
+	}
+
+	if (rb_push(&(hsvb->lane[lane].in), data, data_len) != RB_CODE_OK) {
+		return HSV_CODE_OVERFLOW_ERR;
+	}
+
+	r = hsvb_process(hsvb);
+	if (r < 0) {
+		return r;
+	}
+
+	return (int) data_len;
+}
+
+unsigned hsvb_get(hsvb_t hsvb, unsigned lane, char*data, unsigned data_cap)
+{
+	unsigned data_len;
+
+	data_len = rb_get(&(hsvb->lane[lane].out), data, data_cap);
+	if (data_len > 0) {
+		/* Освободилось место в очереди выхода: можно продолжить обработку. */
+		hsvb_process(hsvb);
+	}
+
+	return data_len;
+}
+
+/**
+ * Конец потока дорожки после данных ее очереди входа (см. hsvb_detach).
+ */
+static void hsvb_lane_end(hsvb_t hsvb, struct HSV_BATCH_LANE*lane)
+{
+	unsigned len;
+
+	/* Неполный сэмпл дополняется нулями. */
+	len = rb_len(&(lane->in));
+	lane->pad = (hsvb->smpl_bs - len % hsvb->smpl_bs) % hsvb->smpl_bs;
+	lane->end = hsvb_max_pos(hsvb->pos_in, lane->start) + (len + lane->pad) / hsvb->smpl_bs;
+	lane->attached = 0;
+
+	/* Пустой поток, перед которым каналы еще не сброшены, отменяется: дорожка возвращается к прошлому потоку. */
+	if ((lane->end == lane->start) && (lane->reset != HSV_BATCH_NONE)) {
+		lane->start = lane->prev_start;
+		lane->end = lane->prev_end;
+		lane->prev_start = 0;
+		lane->prev_end = 0;
+		lane->reset = HSV_BATCH_NONE;
+	}
+}
+
+enum HSV_CODE hsvb_detach(hsvb_t hsvb, unsigned l)
+{
+	int r;
+
+	if (! hsvb->lane[l].attached) {
+		return HSV_CODE_UNKNOWN_ERR;
+	}
+
+	hsvb_lane_end(hsvb, hsvb->lane + l);
+
+	r = hsvb_process(hsvb);
+	if (r < 0) {
+		return (enum HSV_CODE) r;
+	}
+
+	return HSV_CODE_OK;
+}
+
+enum HSV_CODE hsvb_attach(hsvb_t hsvb, unsigned l)
+{
+	struct HSV_BATCH_LANE*lane = hsvb->lane + l;
+
+	size_t start;
+
+	int r;
+
+	if (lane->attached) {
+		return HSV_CODE_UNKNOWN_ERR;
+	}
+
+	r = hsvb_process(hsvb);
+	if (r < 0) {
+		return (enum HSV_CODE) r;
+	}
+
+	/*
+	 * Дорожка хранит два потока: выход позапрошлого должен быть выдан, каналы перед прошлым - сброшены,
+	 * а данные прошлого - поданы в контекст, чтобы очередь входа содержала только новый поток.
+	 */
+	if ((hsvb->pos_out < lane->prev_end) || (lane->reset != HSV_BATCH_NONE) || (hsvb->pos_in < lane->end)) {
+		return HSV_CODE_OVERFLOW_ERR;
+	}
+
+	/*
+	 * Новый поток начинается на сетке обработки не раньше, чем весь выход прошлого потока обработан, поэтому
+	 * фреймы, перекрывающиеся с новым потоком, содержат до его начала только нули. Каналы сбрасываются после
+	 * обработки последнего фрейма, начавшегося до нового потока.
+	 */
+	start = hsvb_max_pos(lane->end + hsvb->latency, hsvb->pos_in);
+	start = (start + hsvb->period - 1) / hsvb->period * hsvb->period;
+
+	lane->prev_start = lane->start;
+	lane->prev_end = lane->end;
+	lane->start = start;
+	lane->end = HSV_BATCH_NONE;
+	lane->reset = start + hsvb->latency - hsvb->period;
+	lane->pad = 0;
+	lane->attached = 1;
+
+	return HSV_CODE_OK;
+}
+
+void hsvb_flush(hsvb_t hsvb)
+{
+	unsigned l;
+
+	/* Все потоки заканчиваются до обработки, иначе дорожки без данных задерживали бы остальные. */
+	for (l = 0; l < hsvb->conf.lanes; l++) {
+		if (hsvb->lane[l].attached) {
+			hsvb_lane_end(hsvb, hsvb->lane + l);
+		}
+	}
+
+	hsvb_process(hsvb);
+}
+
+size_t hsvb_get_mem_size(hsvb_t hsvb)
+{
+	return hsvb->mem_size + hsvc_get_arena_size(&(hsvb->hsvc_conf));
+}
+
+void hsvb_deconfig(hsvb_t hsvb)
+{
+	hsvb_deconfig_buf(hsvb);
+	free(hsvb->mem);
+	hsvb->mem = NULL;
+
+	hsvc_deconfig(hsvb->hsvc);
+	hsvc_free(hsvb->hsvc);
+	hsvb->hsvc = NULL;
+}
+
+void hsvb_clean(hsvb_t hsvb)
+{
+	memset(hsvb, '\0', sizeof(*hsvb));
+}
+
+void hsvb_free(hsvb_t hsvb)
+{
+	free(hsvb);
+}
+/**
+ * /}
+ */
@@ -0,0 +1,156 @@
+/**
+ * \file hsv_batch.h
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Публичное API пакета "HSV": обработка нескольких потоков данных одной конфигурации одним контекстом.
+ */
+/**
+ * \ingroup hsv
+ * \{
+ */
+#ifndef HSV_BATCH_H_INCLUDED
+#define HSV_BATCH_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+#include "hsv.h"
+
+#define HSV_DEFAULT_BATCH_LANES 8     /**< Число дорожек пакета по умолчанию.                                 */
+#define HSV_DEFAULT_BATCH_QUEUE 16384 /**< Вместимость очередей входа и выхода дорожки по умолчанию в байтах. */
+
+/**
+ * Структура конфигурации пакета.
+ * Поля lanes и queue_bs в случае нулевых значений принимают значения по умолчанию.
+ */
+struct HSV_BATCH_CONFIG
+{
+	/**
+	 * Конфигурация каждого потока данных (дорожки). Каналы разных дорожек не объединяются,
+	 * поэтому link должен быть HSV_LINK_MODE_OFF.
+	 */
+	struct HSV_CONFIG stream;
+
+	/**
+	 * Число дорожек (по умолчанию HSV_DEFAULT_BATCH_LANES).
+	 */
+	unsigned lanes;
+
+	/**
+	 * Вместимость очередей входа и выхода каждой дорожки в байтах (по умолчанию HSV_DEFAULT_BATCH_QUEUE).
+	 */
+	unsigned queue_bs;
+};
+
+struct HSV_BATCH;
+
+typedef struct HSV_BATCH* hsvb_t;
+
+/**
+ * Создание структуры пакета.
+ * \return указатель на структуру пакета (при ошибке - NULL).
+ */
+hsvb_t create_hsvb();
+
+/**
+ * Проверка корректности структуры конфигурации пакета.
+ * \return 0 при корректной конфигуации, номер первого некорректного поля (с 1) при некорректной
+ * (1 - конфигурация дорожек некорректна или некорректен контекст с каналами всех дорожек).
+ */
+int hsvb_validate_config(const struct HSV_BATCH_CONFIG*conf);
+
+/**
+ * Конфигурация пакета. Дорожки обрабатываются одним контекстом, каналы которого - каналы всех дорожек
+ * (дорожка l занимает каналы l * stream.ch, ..., (l + 1) * stream.ch - 1): таблицы ДПФ и рабочая память общие,
+ * ДПФ и спектры всех дорожек пакета фреймов вычисляются одним вызовом ядра. Если конфигурацию поддерживает
+ * режим HSV_LINK_MODE_LANES, то состояния оценки и подавления шума всех дорожек чередуются по частотам
+ * и обновляются одним проходом, иначе каналы дорожек обрабатываются по отдельности (HSV_LINK_MODE_OFF).
+ * Все дорожки присоединены с начала. Выход потока дорожки совпадает с выходом отдельного контекста той же
+ * конфигурации, в который подан тот же вход, а после конца потока - hsvc_get_latency нулевых сэмплов.
+ * Исключение - ctrl_period > 1: пересчеты оценки шума сдвинуты по фреймам между всеми каналами пакета,
+ * а не только между каналами дорожки.
+ * \param conf структура конфигурации пакета.
+ * \return результат конфигурирования.
+ */
+enum HSV_CODE hsvb_config(hsvb_t hsvb, const struct HSV_BATCH_CONFIG*conf);
+
+/**
+ * Постановка данных дорожки в очередь и обработка общей для всех дорожек части очередей.
+ * Дорожки обрабатываются синхронно: данные дорожки обрабатываются, когда данные того же отрезка
+ * поступили во все присоединенные дорожки. Присоединенная дорожка без данных задерживает остальные,
+ * пока их очереди входа не переполнятся, поэтому простаивающую дорожку нужно отсоединить (hsvb_detach).
+ * \param lane номер присоединенной дорожки.
+ * \param data массив бинарных данных для чтения.
+ * \param data_len размер массива.
+ * \return если >= 0, то число принятых данных (все данные), иначе код ошибки
+ * (HSV_CODE_OVERFLOW_ERR - данные не помещаются в очередь входа дорожки, HSV_CODE_UNKNOWN_ERR - дорожка отсоединена).
+ */
+int hsvb_push(hsvb_t hsvb, unsigned lane, const char*data, unsigned data_len);
+
+/**
+ * Чтение обработанных данных дорожки.
+ * \param lane номер дорожки.
+ * \param data массив бинарных данных для записи.
+ * \param data_cap вместимость массива.
+ * \return число считанных байт.
+ */
+unsigned hsvb_get(hsvb_t hsvb, unsigned lane, char*data, unsigned data_cap);
+
+/**
+ * Отсоединение дорожки: поток дорожки заканчивается после данных ее очереди входа (неполный сэмпл
+ * дополняется нулями). Остальные дорожки продолжают обработку, а дорожка подает нули, пока выход
+ * ее потока не будет обработан полностью; выход после конца потока отбрасывается.
+ * \param lane номер присоединенной дорожки.
+ * \return результат отсоединения (HSV_CODE_UNKNOWN_ERR - дорожка уже отсоединена).
+ */
+enum HSV_CODE hsvb_detach(hsvb_t hsvb, unsigned lane);
+
+/**
+ * Присоединение дорожки: новый поток начинается с отсчета сетки обработки (hsvc_get_period) после того, как
+ * обработан весь выход прошлого потока, а перед первым фреймом нового потока состояния каналов дорожки
+ * сбрасываются (см. hsvc_reset_ch). Поэтому выход нового потока совпадает с выходом только что
+ * сконфигурированного отдельного контекста, а выход промежутка между потоками отбрасывается. При синтезе
+ * КИХ-фильтром (HSV_SYNTHESIS_MODE_FIR) фильтры не сбрасываются, поэтому начало нового потока отличается
+ * от отдельного контекста на переходе от фильтра промежутка.
+ * \param lane номер отсоединенной дорожки.
+ * \return результат присоединения (HSV_CODE_UNKNOWN_ERR - дорожка уже присоединена,
+ * HSV_CODE_OVERFLOW_ERR - позапрошлый поток дорожки еще не выдан, прошлый еще не начат или еще не подан
+ * в контекст целиком: нужно прочитать выход hsvb_get).
+ */
+enum HSV_CODE hsvb_attach(hsvb_t hsvb, unsigned lane);
+
+/**
+ * Отсоединение всех присоединенных дорожек (см. hsvb_detach) и обработка их данных.
+ * Выход каждой дорожки выдается полностью по мере чтения hsvb_get.
+ */
+void hsvb_flush(hsvb_t hsvb);
+
+/**
+ * Размер памяти пакета: память контекста (hsvc_get_arena_size) и очередей дорожек.
+ * \return размер памяти в байтах.
+ */
+size_t hsvb_get_mem_size(hsvb_t hsvb);
+
+/**
+ * Удаление всех внутренних динамических структур.
+ */
+void hsvb_deconfig(hsvb_t hsvb);
+
+/**
+ * Зануление структуры пакета.
+ */
+void hsvb_clean(hsvb_t hsvb);
+
+/**
+ * Удаление структуры пакета.
+ */
+void hsvb_free(hsvb_t hsvb);
+
+#ifdef __cplusplus
+}
+#endif  /* __cplusplus */
+
+#endif  /* HSV_BATCH_H_INCLUDED */
+/**
+ * /}
+ */
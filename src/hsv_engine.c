@@ -0,0 +1,637 @@
+/**
+ * \file hsv_engine.c
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Реализация API движка "HSV".
+ */
+/**
+ * \ingroup hsv
+ * \{
+ */
+#include "hsv_engine.h"
+
+#include "arena.h"
+#include "rb.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <fenv.h>
+#include <pthread.h>
+
+/**
+ * Поток данных движка: контекст и его очереди входа и выхода.
+ * Контекст в каждый момент обрабатывается не больше чем одним рабочим потоком: пока scheduled установлен,
+ * поток данных стоит в очереди ровно одного рабочего потока или обрабатывается им.
+ */
+struct HSV_ENGINE_STREAM
+{
+	hsvc_t hsvc; /**< Контекст потока данных. */
+
+	pthread_mutex_t mutex; /**< Защищает очереди и флаги потока данных. */
+
+	struct RING_BUFFER in;  /**< Данные, ожидающие подачи в контекст.  */
+	struct RING_BUFFER out; /**< Обработанные данные, ожидающие чтения. */
+
+	unsigned home; /**< Рабочий поток, в очередь которого ставится поток данных (последний обрабатывавший). */
+
+	int scheduled; /**< Поток данных стоит в очереди или обрабатывается.       */
+	int stalled;   /**< Обработка приостановлена: очередь выхода заполнена.    */
+	int flush;     /**< Запрошен hsvc_flush после подачи всех данных очереди.  */
+	int err;       /**< Код ошибки hsvc_push (0 - ошибок не было).             */
+};
+
+struct HSV_ENGINE;
+
+/**
+ * Рабочий поток движка со своей очередью готовых потоков данных.
+ * Владелец берет потоки данных с конца очереди (последний поставленный, его данные свежее в кэше),
+ * остальные рабочие потоки забирают их с начала.
+ */
+struct HSV_ENGINE_WORKER
+{
+	struct HSV_ENGINE*hsve; /**< Движок рабочего потока. */
+	unsigned worker;        /**< Номер рабочего потока.  */
+	pthread_t thread;       /**< Описатель потока.       */
+
+	pthread_mutex_t mutex; /**< Защищает очередь.                                    */
+	unsigned*deque;        /**< Номера готовых потоков данных (max_streams мест).    */
+	unsigned head;         /**< Индекс начала очереди.                               */
+	unsigned len;          /**< Число потоков данных в очереди.                      */
+
+	pthread_cond_t wake; /**< Появилась работа или движок останавливается (с mutex движка). */
+	int sleeping;        /**< Рабочий поток ждет wake.                                     */
+
+	char*buf; /**< Буфер обмена с контекстом (chunk_bs байт). */
+};
+
+/**
+ * Структура движка \"HSV\".
+ */
+struct HSV_ENGINE
+{
+	struct HSV_ENGINE_CONFIG conf; /**< Параметры конфигурации. */
+
+	struct ARENA arena; /**< Арена очередей и буферов движка. */
+	void*mem;           /**< Память арены.                    */
+
+	struct HSV_ENGINE_WORKER*workers; /**< Рабочие потоки (conf.threads).  */
+	unsigned n_threads;               /**< Число запущенных рабочих потоков (очереди остальных пусты). */
+
+	struct HSV_ENGINE_STREAM*streams; /**< Потоки данных (conf.max_streams). */
+	unsigned n_streams;               /**< Число зарегистрированных потоков данных. */
+
+	pthread_mutex_t mutex; /**< Защищает счетчики, сон рабочих потоков и регистрацию потоков данных. */
+	pthread_cond_t idle;   /**< Все поставленные в очередь данные обработаны.                        */
+
+	unsigned n_queued; /**< Число потоков данных в очередях рабочих потоков.        */
+	unsigned n_active; /**< Число потоков данных в очередях или в обработке.        */
+	int stop;          /**< Рабочие потоки должны завершиться.                      */
+
+	fenv_t fenv; /**< Окружение вычислений с плавающей точкой потока, вызвавшего hsve_config. */
+};
+
+static unsigned hsve_min(unsigned a, unsigned b)
+{
+	return (a < b) ? a : b;
+}
+
+hsve_t create_hsve()
+{
+	hsve_t hsve;
+
+	hsve = (hsve_t) calloc(1, sizeof(struct HSV_ENGINE));
+	return hsve;
+}
+
+int hsve_validate_config(const struct HSV_ENGINE_CONFIG*conf)
+{
+	if (conf->max_streams == 0) {
+		return 2;
+	}
+
+	return HSV_CODE_OK;
+}
+
+/**
+ * Выделение очередей и буферов движка из арены (в режиме измерения - из кучи).
+ */
+static enum HSV_CODE hsve_config_buf(hsve_t hsve)
+{
+	enum HSV_CODE r;
+
+	unsigned w, s;
+
+	hsve->workers = (struct HSV_ENGINE_WORKER*) arena_calloc(&(hsve->arena), hsve->conf.threads, sizeof(struct HSV_ENGINE_WORKER));
+	if (hsve->workers == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err0;
+	}
+	for (w = 0; w < hsve->conf.threads; w++) {
+		struct HSV_ENGINE_WORKER*worker = hsve->workers + w;
+
+		worker->hsve = hsve;
+		worker->worker = w;
+		worker->deque = (unsigned*) arena_calloc(&(hsve->arena), hsve->conf.max_streams, sizeof(unsigned));
+		worker->buf = (char*) arena_calloc(&(hsve->arena), hsve->conf.chunk_bs, sizeof(char));
+		if ((worker->deque == NULL) || (worker->buf == NULL)) {
+			arena_free(&(hsve->arena), worker->buf);
+			arena_free(&(hsve->arena), worker->deque);
+			r = HSV_CODE_ALLOC_ERR;
+			goto err1;
+		}
+	}
+
+	hsve->streams = (struct HSV_ENGINE_STREAM*) arena_calloc(&(hsve->arena), hsve->conf.max_streams, sizeof(struct HSV_ENGINE_STREAM));
+	if (hsve->streams == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err1;
+	}
+	for (s = 0; s < hsve->conf.max_streams; s++) {
+		struct HSV_ENGINE_STREAM*stream = hsve->streams + s;
+
+		if (rb_config(&(stream->in), hsve->conf.queue_bs, &(hsve->arena)) != RB_CODE_OK) {
+			r = HSV_CODE_ALLOC_ERR;
+			goto err2;
+		}
+		if (rb_config(&(stream->out), hsve->conf.queue_bs, &(hsve->arena)) != RB_CODE_OK) {
+			rb_deconfig(&(stream->in));
+			r = HSV_CODE_ALLOC_ERR;
+			goto err2;
+		}
+	}
+
+	return HSV_CODE_OK;
+
+ err2:
+	while (s-- > 0) {
+		rb_deconfig(&(hsve->streams[s].out));
+		rb_deconfig(&(hsve->streams[s].in));
+	}
+	arena_free(&(hsve->arena), hsve->streams);
+ err1:
+	while (w-- > 0) {
+		arena_free(&(hsve->arena), hsve->workers[w].buf);
+		arena_free(&(hsve->arena), hsve->workers[w].deque);
+	}
+	arena_free(&(hsve->arena), hsve->workers);
+ err0:
+	return r;
+}
+
+static void hsve_deconfig_buf(hsve_t hsve)
+{
+	unsigned w, s;
+
+	for (s = hsve->conf.max_streams; s-- > 0;) {
+		rb_deconfig(&(hsve->streams[s].out));
+		rb_deconfig(&(hsve->streams[s].in));
+	}
+	arena_free(&(hsve->arena), hsve->streams);
+
+	for (w = hsve->conf.threads; w-- > 0;) {
+		arena_free(&(hsve->arena), hsve->workers[w].buf);
+		arena_free(&(hsve->arena), hsve->workers[w].deque);
+	}
+	arena_free(&(hsve->arena), hsve->workers);
+}
+
+/**
+ * Постановка потока данных, для которого только что установлен scheduled, в очередь его рабочего потока.
+ */
+static void hsve_schedule(hsve_t hsve, unsigned s)
+{
+	struct HSV_ENGINE_WORKER*worker = hsve->workers + hsve->streams[s].home;
+
+	unsigned w;
+
+	pthread_mutex_lock(&(hsve->mutex));
+
+	pthread_mutex_lock(&(worker->mutex));
+	worker->deque[(worker->head + worker->len) % hsve->conf.max_streams] = s;
+	worker->len++;
+	pthread_mutex_unlock(&(worker->mutex));
+
+	hsve->n_queued++;
+	hsve->n_active++;
+
+	/* Если свой рабочий поток занят, будим любой спящий: он заберет поток данных себе. */
+	if (worker->sleeping) {
+		pthread_cond_signal(&(worker->wake));
+	} else {
+		for (w = 0; w < hsve->conf.threads; w++) {
+			if (hsve->workers[w].sleeping) {
+				pthread_cond_signal(&(hsve->workers[w].wake));
+				break;
+			}
+		}
+	}
+
+	pthread_mutex_unlock(&(hsve->mutex));
+}
+
+/**
+ * Выбор потока данных рабочим потоком: последний из своей очереди, иначе первый из очереди другого рабочего потока.
+ * \return 1, если поток данных s выбран, иначе 0.
+ */
+static int hsve_take(hsve_t hsve, struct HSV_ENGINE_WORKER*worker, unsigned*s)
+{
+	struct HSV_ENGINE_WORKER*victim;
+
+	unsigned k;
+
+	int found = 0;
+
+	pthread_mutex_lock(&(worker->mutex));
+	if (worker->len > 0) {
+		worker->len--;
+		*s = worker->deque[(worker->head + worker->len) % hsve->conf.max_streams];
+		found = 1;
+	}
+	pthread_mutex_unlock(&(worker->mutex));
+
+	for (k = 1; (! found) && (k < hsve->conf.threads); k++) {
+		victim = hsve->workers + (worker->worker + k) % hsve->conf.threads;
+
+		pthread_mutex_lock(&(victim->mutex));
+		if (victim->len > 0) {
+			*s = victim->deque[victim->head];
+			victim->head = (victim->head + 1) % hsve->conf.max_streams;
+			victim->len--;
+			found = 1;
+		}
+		pthread_mutex_unlock(&(victim->mutex));
+	}
+
+	if (found) {
+		pthread_mutex_lock(&(hsve->mutex));
+		hsve->n_queued--;
+		pthread_mutex_unlock(&(hsve->mutex));
+	}
+
+	return found;
+}
+
+/**
+ * Обработка потока данных рабочим потоком: подача очереди входа в контекст порциями до chunk_bs байт
+ * и перенос результатов в очередь выхода, пока вход не кончится или не заполнится очередь выхода.
+ */
+static void hsve_process(hsve_t hsve, struct HSV_ENGINE_WORKER*worker, struct HSV_ENGINE_STREAM*stream)
+{
+	unsigned chunk = hsve->conf.chunk_bs;
+
+	unsigned room, n;
+
+	int r;
+
+	for (;;) {
+		/* Обработанные данные контекста занимают место для входа, поэтому сначала переносятся в очередь выхода.
+		   Пока поток данных обрабатывается, место в очереди выхода может только освобождаться. */
+		pthread_mutex_lock(&(stream->mutex));
+		room = rb_cap(&(stream->out)) - rb_len(&(stream->out));
+		pthread_mutex_unlock(&(stream->mutex));
+
+		n = hsvc_get(stream->hsvc, worker->buf, hsve_min(room, chunk));
+		if (n > 0) {
+			pthread_mutex_lock(&(stream->mutex));
+			rb_push(&(stream->out), worker->buf, n);
+			pthread_mutex_unlock(&(stream->mutex));
+			continue;
+		}
+
+		pthread_mutex_lock(&(stream->mutex));
+		if (room == 0) {
+			/* hsve_get мог освободить место после проверки без блокировки, еще не видя остановки. */
+			if (rb_len(&(stream->out)) < rb_cap(&(stream->out))) {
+				pthread_mutex_unlock(&(stream->mutex));
+				continue;
+			}
+			/* Обработка продолжится, когда hsve_get освободит место. */
+			stream->stalled = 1;
+			break;
+		}
+
+		n = hsve_min(hsve_min(rb_len(&(stream->in)), hsvc_get_room(stream->hsvc)), chunk);
+		if (n == 0) {
+			if (rb_len(&(stream->in)) > 0) {
+				/* Контекст не вмещает даже одной подачи после чтения всех результатов. */
+				stream->err = HSV_CODE_OVERFLOW_ERR;
+				break;
+			}
+			if (! stream->flush) {
+				break;
+			}
+			stream->flush = 0;
+			pthread_mutex_unlock(&(stream->mutex));
+
+			hsvc_flush(stream->hsvc);
+			continue;
+		}
+		rb_get(&(stream->in), worker->buf, n);
+		pthread_mutex_unlock(&(stream->mutex));
+
+		r = hsvc_push(stream->hsvc, worker->buf, n);
+		if (r < 0) {
+			pthread_mutex_lock(&(stream->mutex));
+			stream->err = r;
+			break;
+		}
+	}
+
+	/* После ошибки поставленные данные не обрабатываются. */
+	if (stream->err != 0) {
+		while (rb_get(&(stream->in), worker->buf, chunk) != 0) {
+		}
+		stream->flush = 0;
+	}
+	stream->scheduled = 0;
+	pthread_mutex_unlock(&(stream->mutex));
+
+	pthread_mutex_lock(&(hsve->mutex));
+	hsve->n_active--;
+	if (hsve->n_active == 0) {
+		pthread_cond_broadcast(&(hsve->idle));
+	}
+	pthread_mutex_unlock(&(hsve->mutex));
+}
+
+static void*hsve_thread(void*arg)
+{
+	struct HSV_ENGINE_WORKER*worker = (struct HSV_ENGINE_WORKER*) arg;
+	hsve_t hsve = worker->hsve;
+
+	unsigned s;
+
+	fesetenv(&(hsve->fenv));
+
+	for (;;) {
+		if (hsve_take(hsve, worker, &s)) {
+			/* Следующие данные потока данных ставятся в очередь рабочего потока, в кэше которого его состояние. */
+			hsve->streams[s].home = worker->worker;
+			hsve_process(hsve, worker, hsve->streams + s);
+			continue;
+		}
+
+		pthread_mutex_lock(&(hsve->mutex));
+		if (hsve->stop) {
+			pthread_mutex_unlock(&(hsve->mutex));
+			break;
+		}
+		if (hsve->n_queued == 0) {
+			worker->sleeping = 1;
+			pthread_cond_wait(&(worker->wake), &(hsve->mutex));
+			worker->sleeping = 0;
+		}
+		pthread_mutex_unlock(&(hsve->mutex));
+	}
+
+	return NULL;
+}
+
+/**
+ * Остановка рабочих потоков и удаление объектов синхронизации.
+ */
+static void hsve_stop(hsve_t hsve)
+{
+	unsigned w, s;
+
+	pthread_mutex_lock(&(hsve->mutex));
+	hsve->stop = 1;
+	for (w = 0; w < hsve->conf.threads; w++) {
+		pthread_cond_signal(&(hsve->workers[w].wake));
+	}
+	pthread_mutex_unlock(&(hsve->mutex));
+
+	for (w = 0; w < hsve->n_threads; w++) {
+		pthread_join(hsve->workers[w].thread, NULL);
+	}
+	hsve->n_threads = 0;
+
+	for (s = 0; s < hsve->conf.max_streams; s++) {
+		pthread_mutex_destroy(&(hsve->streams[s].mutex));
+	}
+	for (w = 0; w < hsve->conf.threads; w++) {
+		pthread_cond_destroy(&(hsve->workers[w].wake));
+		pthread_mutex_destroy(&(hsve->workers[w].mutex));
+	}
+	pthread_cond_destroy(&(hsve->idle));
+	pthread_mutex_destroy(&(hsve->mutex));
+}
+
+enum HSV_CODE hsve_config(hsve_t hsve, const struct HSV_ENGINE_CONFIG*conf)
+{
+	enum HSV_CODE r;
+
+	size_t mem_size;
+
+	unsigned w, s;
+
+	if (hsve_validate_config(conf) != 0) {
+		r = HSV_CODE_UNKNOWN_ERR;
+		goto err0;
+	}
+
+	hsve->conf = *conf;
+	if (hsve->conf.threads == HSV_DEFAULT) {
+		hsve->conf.threads = 1;
+	}
+	if (hsve->conf.queue_bs == HSV_DEFAULT) {
+		hsve->conf.queue_bs = HSV_DEFAULT_ENGINE_QUEUE;
+	}
+	if (hsve->conf.chunk_bs == HSV_DEFAULT) {
+		hsve->conf.chunk_bs = HSV_DEFAULT_ENGINE_CHUNK;
+	}
+
+	/* Размер памяти определяется пробной конфигурацией в режиме измерения арены: она только выделяет буферы. */
+	arena_init(&(hsve->arena), NULL, 0);
+	r = hsve_config_buf(hsve);
+	if (r != HSV_CODE_OK) {
+		goto err0;
+	}
+	hsve_deconfig_buf(hsve);
+	mem_size = arena_mem_size(hsve->arena.peak);
+
+	hsve->mem = malloc(mem_size);
+	if (hsve->mem == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err0;
+	}
+	arena_init(&(hsve->arena), hsve->mem, mem_size);
+	r = hsve_config_buf(hsve);
+	if (r != HSV_CODE_OK) {
+		goto err1;
+	}
+
+	pthread_mutex_init(&(hsve->mutex), NULL);
+	pthread_cond_init(&(hsve->idle), NULL);
+	for (w = 0; w < hsve->conf.threads; w++) {
+		pthread_mutex_init(&(hsve->workers[w].mutex), NULL);
+		pthread_cond_init(&(hsve->workers[w].wake), NULL);
+	}
+	for (s = 0; s < hsve->conf.max_streams; s++) {
+		pthread_mutex_init(&(hsve->streams[s].mutex), NULL);
+	}
+
+	hsve->n_streams = 0;
+	hsve->n_queued = 0;
+	hsve->n_active = 0;
+	hsve->stop = 0;
+
+	fegetenv(&(hsve->fenv));
+
+	/* Если рабочий поток создать не удалось, движок работает с уже созданными. */
+	hsve->n_threads = 0;
+	for (w = 0; w < hsve->conf.threads; w++) {
+		if (pthread_create(&(hsve->workers[w].thread), NULL, hsve_thread, hsve->workers + w) != 0) {
+			break;
+		}
+		hsve->n_threads++;
+	}
+	if (hsve->n_threads == 0) {
+		r = HSV_CODE_UNKNOWN_ERR;
+		goto err2;
+	}
+
+	return HSV_CODE_OK;
+
+ err2:
+	hsve_stop(hsve);
+	hsve_deconfig_buf(hsve);
+ err1:
+	free(hsve->mem);
+	hsve->mem = NULL;
+ err0:
+	return r;
+}
+
+int hsve_add(hsve_t hsve, hsvc_t hsvc)
+{
+	int s;
+
+	pthread_mutex_lock(&(hsve->mutex));
+	if (hsve->n_streams == hsve->conf.max_streams) {
+		pthread_mutex_unlock(&(hsve->mutex));
+		return HSV_CODE_OVERFLOW_ERR;
+	}
+	s = (int) hsve->n_streams++;
+	pthread_mutex_unlock(&(hsve->mutex));
+
+	pthread_mutex_lock(&(hsve->streams[s].mutex));
+	hsve->streams[s].hsvc = hsvc;
+	/* Пока поток данных не обрабатывался, рабочие потоки назначаются по кругу. */
+	hsve->streams[s].home = ((unsigned) s) % hsve->n_threads;
+	pthread_mutex_unlock(&(hsve->streams[s].mutex));
+
+	return s;
+}
+
+int hsve_push(hsve_t hsve, unsigned s, const char*data, unsigned data_len)
+{
+	struct HSV_ENGINE_STREAM*stream = hsve->streams + s;
+
+	int r;
+
+	int schedule = 0;
+
+	pthread_mutex_lock(&(stream->mutex));
+	if (stream->err != 0) {
+		r = stream->err;
+		goto err0;
+	}
+	if (rb_push(&(stream->in), data, data_len) != RB_CODE_OK) {
+		r = HSV_CODE_OVERFLOW_ERR;
+		goto err0;
+	}
+	if (! stream->scheduled) {
+		stream->scheduled = 1;
+		stream->stalled = 0;
+		schedule = 1;
+	}
+	pthread_mutex_unlock(&(stream->mutex));
+
+	if (schedule) {
+		hsve_schedule(hsve, s);
+	}
+
+	return (int) data_len;
+
+ err0:
+	pthread_mutex_unlock(&(stream->mutex));
+	return r;
+}
+
+unsigned hsve_get(hsve_t hsve, unsigned s, char*data, unsigned data_cap)
+{
+	struct HSV_ENGINE_STREAM*stream = hsve->streams + s;
+
+	unsigned data_len;
+
+	int schedule = 0;
+
+	pthread_mutex_lock(&(stream->mutex));
+	data_len = rb_get(&(stream->out), data, data_cap);
+	if (stream->stalled && (data_len > 0)) {
+		stream->stalled = 0;
+		stream->scheduled = 1;
+		schedule = 1;
+	}
+	pthread_mutex_unlock(&(stream->mutex));
+
+	if (schedule) {
+		hsve_schedule(hsve, s);
+	}
+
+	return data_len;
+}
+
+void hsve_flush(hsve_t hsve, unsigned s)
+{
+	struct HSV_ENGINE_STREAM*stream = hsve->streams + s;
+
+	int schedule = 0;
+
+	pthread_mutex_lock(&(stream->mutex));
+	if (stream->err == 0) {
+		stream->flush = 1;
+		if (! stream->scheduled) {
+			stream->scheduled = 1;
+			stream->stalled = 0;
+			schedule = 1;
+		}
+	}
+	pthread_mutex_unlock(&(stream->mutex));
+
+	if (schedule) {
+		hsve_schedule(hsve, s);
+	}
+}
+
+void hsve_wait(hsve_t hsve)
+{
+	pthread_mutex_lock(&(hsve->mutex));
+	while (hsve->n_active > 0) {
+		pthread_cond_wait(&(hsve->idle), &(hsve->mutex));
+	}
+	pthread_mutex_unlock(&(hsve->mutex));
+}
+
+void hsve_deconfig(hsve_t hsve)
+{
+	hsve_stop(hsve);
+	hsve_deconfig_buf(hsve);
+
+	free(hsve->mem);
+	hsve->mem = NULL;
+}
+
+void hsve_clean(hsve_t hsve)
+{
+	memset(hsve, '\0', sizeof(*hsve));
+}
+
+void hsve_free(hsve_t hsve)
+{
+	free(hsve);
+}
+/**
+ * /}
+ */
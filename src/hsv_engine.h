@@ -0,0 +1,139 @@
+/**
+ * \file hsv_engine.h
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Публичное API движка "HSV": обработка многих потоков данных общим пулом рабочих потоков.
+ */
+/**
+ * \ingroup hsv
+ * \{
+ */
+#ifndef HSV_ENGINE_H_INCLUDED
+#define HSV_ENGINE_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+#include "hsv.h"
+
+#define HSV_DEFAULT_ENGINE_QUEUE 65536 /**< Вместимость очередей входа и выхода потока данных по умолчанию в байтах. */
+#define HSV_DEFAULT_ENGINE_CHUNK 4096  /**< Наибольшая подача в контекст по умолчанию в байтах.                      */
+
+/**
+ * Структура конфигурации движка.
+ * Значение max_streams должно быть ненулевым, остальные в случае нулевых значений принимают значения по умолчанию.
+ */
+struct HSV_ENGINE_CONFIG
+{
+	/**
+	 * Число рабочих потоков (по умолчанию HSV_DEFAULT - 1).
+	 */
+	unsigned threads;
+
+	/**
+	 * Наибольшее число потоков данных (контекстов), зарегистрированных hsve_add.
+	 */
+	unsigned max_streams;
+
+	/**
+	 * Вместимость очередей входа и выхода каждого потока данных в байтах (по умолчанию HSV_DEFAULT_ENGINE_QUEUE).
+	 * hsve_push не принимает данные, которые не помещаются в очередь входа, а обработка потока данных
+	 * приостанавливается, пока очередь выхода заполнена.
+	 */
+	unsigned queue_bs;
+
+	/**
+	 * Наибольшая подача в контекст в байтах (по умолчанию HSV_DEFAULT_ENGINE_CHUNK).
+	 */
+	unsigned chunk_bs;
+};
+
+struct HSV_ENGINE;
+
+typedef struct HSV_ENGINE* hsve_t;
+
+/**
+ * Создание структуры движка.
+ * \return указатель на структуру движка (при ошибке - NULL).
+ */
+hsve_t create_hsve();
+
+/**
+ * Проверка корректности структуры конфигурации движка.
+ * \return 0 при корректной конфигуации, номер первого некорректного поля (с 1) при некорректной.
+ */
+int hsve_validate_config(const struct HSV_ENGINE_CONFIG*conf);
+
+/**
+ * Конфигурация движка: все очереди выделяются одним блоком, рабочие потоки запускаются сразу.
+ * Каждый рабочий поток разбирает свою очередь готовых потоков данных, а опустев - забирает самые старые
+ * задачи из очередей других рабочих потоков. Поток данных ставится в очередь рабочего потока,
+ * который обрабатывал его последним, поэтому состояние контекста остается в кэше этого ядра.
+ * \param conf структура конфигурации движка.
+ * \return результат конфигурирования.
+ */
+enum HSV_CODE hsve_config(hsve_t hsve, const struct HSV_ENGINE_CONFIG*conf);
+
+/**
+ * Регистрация сконфигурированного контекста как потока данных движка.
+ * После регистрации контекст используется только рабочими потоками движка: hsvc_push, hsvc_get и hsvc_flush
+ * контекста вызывать нельзя, пока движок сконфигурирован. Контекст не деконфигурируется hsve_deconfig.
+ * \return если >= 0, то номер потока данных, иначе код ошибки (HSV_CODE_OVERFLOW_ERR - зарегистрировано max_streams).
+ */
+int hsve_add(hsve_t hsve, hsvc_t hsvc);
+
+/**
+ * Постановка данных потока данных в очередь на обработку без ожидания обработки.
+ * \param stream номер потока данных.
+ * \param data массив бинарных данных для чтения.
+ * \param data_len размер массива.
+ * \return если >= 0, то число принятых данных (все данные), иначе код ошибки: HSV_CODE_OVERFLOW_ERR,
+ * если данные не помещаются в очередь входа, или код ошибки hsvc_push, после которой поток данных не обрабатывается.
+ */
+int hsve_push(hsve_t hsve, unsigned stream, const char*data, unsigned data_len);
+
+/**
+ * Чтение обработанных данных потока данных из его очереди выхода.
+ * \param stream номер потока данных.
+ * \param data массив бинарных данных для записи.
+ * \param data_cap вместимость массива.
+ * \return число считанных байт.
+ */
+unsigned hsve_get(hsve_t hsve, unsigned stream, char*data, unsigned data_cap);
+
+/**
+ * Вызов hsvc_flush контекста потока данных после обработки всех поставленных в очередь данных.
+ * \param stream номер потока данных.
+ */
+void hsve_flush(hsve_t hsve, unsigned stream);
+
+/**
+ * Ожидание, пока все поставленные в очередь данные не будут обработаны
+ * (или обработка потока данных не будет приостановлена заполненной очередью выхода).
+ */
+void hsve_wait(hsve_t hsve);
+
+/**
+ * Остановка рабочих потоков и удаление всех внутренних динамических структур.
+ * Необработанные данные очередей теряются, поэтому перед деконфигурацией нужно вызвать hsve_wait.
+ */
+void hsve_deconfig(hsve_t hsve);
+
+/**
+ * Зануление структуры движка.
+ */
+void hsve_clean(hsve_t hsve);
+
+/**
+ * Удаление структуры движка.
+ */
+void hsve_free(hsve_t hsve);
+
+#ifdef __cplusplus
+}
+#endif  /* __cplusplus */
+
+#endif  /* HSV_ENGINE_H_INCLUDED */
+/**
+ * /}
+ */
@@ -0,0 +1,411 @@
+/**
+ * \file hsv_fixed.c
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Реализация обработки "HSV" с фиксированной точкой (HSV_PRECISION_MODE_FIXED).
+ */
+/**
+ * \ingroup hsv
+ * \{
+ */
+#include "hsv_fixed.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif	/* M_PI */
+
+struct HSV_CONTEXT_q*create_hsvc_q()
+{
+	struct HSV_CONTEXT_q*hsvc;
+
+	hsvc = (struct HSV_CONTEXT_q*) calloc(1, sizeof(struct HSV_CONTEXT_q));
+	return hsvc;
+}
+
+struct HSV_CONTEXT_q*create_hsvc_arena_q(arena_t arena)
+{
+	return (struct HSV_CONTEXT_q*) arena_calloc(arena, 1, sizeof(struct HSV_CONTEXT_q));
+}
+
+static enum HSV_CODE switch_rb_code(enum RB_CODE r)
+{
+	switch (r) {
+	case RB_CODE_OK:
+		return HSV_CODE_OK;
+	case RB_CODE_ALLOC_ERR:
+		return HSV_CODE_ALLOC_ERR;
+	case RB_CODE_OVERFLOW_ERR:
+		return HSV_CODE_OVERFLOW_ERR;
+	default:
+		return HSV_CODE_UNKNOWN_ERR;
+	}
+}
+
+static enum HSV_CODE hsvc_config_chan(struct HSV_CONTEXT_q*hsvc, struct HSV_FIXED_CHAN*chan)
+{
+	enum HSV_CODE r;
+
+	unsigned dft_size_smpls = hsvc->dft_size_smpls;
+
+	if (fxp_estimator_config(&(chan->est), hsvc->conf.sr, dft_size_smpls, hsvc->arena) != FXP_CODE_OK) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err0;
+	}
+	if (fxp_wiener_config(&(chan->wiener), dft_size_smpls, hsvc->arena) != FXP_CODE_OK) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err1;
+	}
+
+	chan->real = (int32_t*) arena_calloc(hsvc->scratch, dft_size_smpls, sizeof(int32_t));
+	if (chan->real == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err2;
+	}
+	chan->imag = (int32_t*) arena_calloc(hsvc->scratch, dft_size_smpls, sizeof(int32_t));
+	if (chan->imag == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err3;
+	}
+	chan->power_spec = (uint64_t*) arena_calloc(hsvc->scratch, dft_size_smpls / 2 + 1, sizeof(uint64_t));
+	if (chan->power_spec == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err4;
+	}
+	chan->overlap_buf = (int32_t*) arena_calloc(hsvc->arena, dft_size_smpls, sizeof(int32_t));
+	if (chan->overlap_buf == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err5;
+	}
+
+	return HSV_CODE_OK;
+
+ err5:
+	arena_free(hsvc->scratch, chan->power_spec);
+ err4:
+	arena_free(hsvc->scratch, chan->imag);
+ err3:
+	arena_free(hsvc->scratch, chan->real);
+ err2:
+	fxp_wiener_deconfig(&(chan->wiener));
+ err1:
+	fxp_estimator_deconfig(&(chan->est));
+ err0:
+	return r;
+}
+
+static void hsvc_deconfig_chan(struct HSV_CONTEXT_q*hsvc, struct HSV_FIXED_CHAN*chan)
+{
+	arena_free(hsvc->arena, chan->overlap_buf);
+	arena_free(hsvc->scratch, chan->power_spec);
+	arena_free(hsvc->scratch, chan->imag);
+	arena_free(hsvc->scratch, chan->real);
+
+	fxp_wiener_deconfig(&(chan->wiener));
+	fxp_estimator_deconfig(&(chan->est));
+}
+
+/**
+ * Значения параметров по умолчанию и производные от них размеры.
+ */
+static void hsvc_config_params(struct HSV_CONTEXT_q*hsvc, const struct HSV_CONFIG*conf)
+{
+	hsvc->conf = *conf;
+
+	if (hsvc->conf.frame_size_smpls == HSV_DEFAULT) {
+		hsvc->conf.frame_size_smpls = 2 * hsvc->conf.sr / 100;
+	}
+	hsvc->frame_size_smpls = hsvc->conf.frame_size_smpls;
+	if (hsvc->frame_size_smpls % 2 == 1) {
+		hsvc->frame_size_smpls++;
+	}
+	if (hsvc->conf.overlap_perc == HSV_DEFAULT) {
+		hsvc->conf.overlap_perc = HSV_DEFAULT_OVERLAP_PERC;
+	}
+	hsvc->step_size_smpls = hsvc->frame_size_smpls - hsvc->frame_size_smpls * hsvc->conf.overlap_perc / 100;
+
+	/* Тот же множитель 1 / norm_factor, что и при обработке с плавающей точкой. */
+	hsvc->norm_factor = (int32_t) ((100 - hsvc->conf.overlap_perc) * FXP_Q15_ONE / 100);
+
+	/* Как и для плавающей точки, ДПФ хотя бы вдвое длиннее фрейма, но его размер - степень двойки. */
+	if (hsvc->conf.dft_size_smpls == HSV_DEFAULT) {
+		hsvc->conf.dft_size_smpls = 1;
+		while (hsvc->conf.dft_size_smpls < 2 * hsvc->frame_size_smpls) {
+			hsvc->conf.dft_size_smpls *= 2;
+		}
+	}
+	hsvc->dft_size_smpls = hsvc->conf.dft_size_smpls;
+
+	hsvc->frame_size_bs = hsvc->frame_size_smpls * 2 * hsvc->conf.ch;
+	hsvc->step_size_bs = hsvc->step_size_smpls * 2 * hsvc->conf.ch;
+
+	if (hsvc->conf.cap == HSV_DEFAULT) {
+		hsvc->conf.cap = HSV_DEFAULT_CAP;
+		while (hsvc->conf.cap < 2 * hsvc->frame_size_bs) {
+			hsvc->conf.cap *= 2;
+		}
+	}
+}
+
+enum HSV_CODE hsvc_config_impl_q(struct HSV_CONTEXT_q*hsvc, const struct HSV_CONFIG*conf, arena_t arena, arena_t scratch)
+{
+	enum HSV_CODE r;
+
+	enum RB_CODE rb_r;
+
+	size_t mark;
+
+	unsigned ch, k;
+
+	hsvc->arena = arena;
+	hsvc->scratch = scratch;
+
+	hsvc_config_params(hsvc, conf);
+
+	rb_r = rb_config(&(hsvc->rb), hsvc->conf.cap, hsvc->arena);
+	if (rb_r != RB_CODE_OK) {
+		r = switch_rb_code(rb_r);
+		goto err0;
+	}
+
+	hsvc->window = (int16_t*) arena_calloc(hsvc->arena, hsvc->frame_size_smpls, sizeof(int16_t));
+	if (hsvc->window == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err1;
+	}
+	/* Окно рассчитывается один раз при конфигурации, поэтому плавающая точка здесь допустима. */
+	for (k = 0; k < hsvc->frame_size_smpls; k++) {
+		double w = floor((0.5 - 0.5 * cos(2.0 * M_PI * k / hsvc->frame_size_smpls)) * FXP_Q15_ONE + 0.5);
+		hsvc->window[k] = (int16_t) ((w > INT16_MAX) ? INT16_MAX : w);
+	}
+
+	if (fxp_dft_config(&(hsvc->dft), hsvc->dft_size_smpls, hsvc->arena) != FXP_CODE_OK) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err2;
+	}
+
+	hsvc->chans = (struct HSV_FIXED_CHAN*) arena_calloc(hsvc->arena, hsvc->conf.ch, sizeof(struct HSV_FIXED_CHAN));
+	if (hsvc->chans == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err3;
+	}
+
+	/* Каналы обрабатываются по одному фрейму целиком, поэтому их фреймы занимают одну и ту же память. */
+	mark = arena_mark(hsvc->scratch);
+	for (ch = 0; ch < hsvc->conf.ch; ch++) {
+		arena_rewind(hsvc->scratch, mark);
+		r = hsvc_config_chan(hsvc, hsvc->chans + ch);
+		if (r != HSV_CODE_OK) {
+			goto err4;
+		}
+	}
+
+	return HSV_CODE_OK;
+
+ err4:
+	for (k = 0; k < ch; k++) {
+		hsvc_deconfig_chan(hsvc, hsvc->chans + k);
+	}
+	arena_free(hsvc->arena, hsvc->chans);
+ err3:
+	fxp_dft_deconfig(&(hsvc->dft));
+ err2:
+	arena_free(hsvc->arena, hsvc->window);
+ err1:
+	rb_deconfig(&(hsvc->rb));
+ err0:
+	return r;
+}
+
+enum HSV_CODE hsvc_reserve_impl_q(const struct HSV_CONFIG*conf, arena_t arena, arena_t scratch)
+{
+	struct HSV_CONTEXT_q hsvc;
+
+	size_t mark;
+
+	unsigned ch;
+
+	arena_reserve(arena, 1, sizeof(struct HSV_CONTEXT_q));
+
+	hsvc_config_params(&hsvc, conf);
+
+	rb_reserve(hsvc.conf.cap, arena);
+	arena_reserve(arena, hsvc.frame_size_smpls, sizeof(int16_t));
+	fxp_dft_reserve(hsvc.dft_size_smpls, arena);
+	arena_reserve(arena, hsvc.conf.ch, sizeof(struct HSV_FIXED_CHAN));
+
+	mark = arena_mark(scratch);
+	for (ch = 0; ch < hsvc.conf.ch; ch++) {
+		arena_rewind(scratch, mark);
+		fxp_estimator_reserve(hsvc.dft_size_smpls, arena);
+		fxp_wiener_reserve(hsvc.dft_size_smpls, arena);
+		arena_reserve(scratch, hsvc.dft_size_smpls, sizeof(int32_t));
+		arena_reserve(scratch, hsvc.dft_size_smpls, sizeof(int32_t));
+		arena_reserve(scratch, hsvc.dft_size_smpls / 2 + 1, sizeof(uint64_t));
+		arena_reserve(arena, hsvc.dft_size_smpls, sizeof(int32_t));
+	}
+
+	return HSV_CODE_OK;
+}
+
+/**
+ * Индекс k-го сэмпла канала ch во фрейме, начинающемся с байта idx_frame кольцевого буфера.
+ */
+static unsigned hsvc_smpl_idx(struct HSV_CONTEXT_q*hsvc, unsigned k, unsigned ch)
+{
+	return ((hsvc->idx_frame / 2) + k * hsvc->conf.ch + ch) % (rb_cap(&(hsvc->rb)) / 2);
+}
+
+static int16_t hsvc_saturate(int32_t v)
+{
+	return (int16_t) ((v > INT16_MAX) ? INT16_MAX : ((v < INT16_MIN) ? INT16_MIN : v));
+}
+
+/**
+ * Обработка одного фрейма одного канала.
+ */
+static void hsvc_process(struct HSV_CONTEXT_q*hsvc, unsigned ch)
+{
+	struct HSV_FIXED_CHAN*chan = hsvc->chans + ch;
+
+	unsigned dft_size = hsvc->dft_size_smpls;
+	unsigned shift;
+
+	int16_t*data = (int16_t*) hsvc->rb.data;
+
+	unsigned k;
+
+	/* Фрейм с окном Ханна, дополненный нулями до размера ДПФ: модуль отсчетов не больше 2^15. */
+	for (k = 0; k < hsvc->frame_size_smpls; k++) {
+		chan->real[k] = (((int32_t) data[hsvc_smpl_idx(hsvc, k, ch)]) * hsvc->window[k] + (1 << 14)) >> 15;
+	}
+	memset(chan->real + hsvc->frame_size_smpls, '\0', (dft_size - hsvc->frame_size_smpls) * sizeof(int32_t));
+	memset(chan->imag, '\0', dft_size * sizeof(int32_t));
+
+	shift = fxp_dft_normalize(&(hsvc->dft), chan->real);
+	fxp_dft_run_dft(&(hsvc->dft), chan->real, chan->imag);
+	fxp_dft_power_spec(&(hsvc->dft), chan->real, chan->imag, shift, chan->power_spec);
+
+	fxp_estimator_run(&(chan->est), chan->power_spec);
+	fxp_wiener_run(&(chan->wiener), chan->power_spec, chan->est.noise_spec);
+	fxp_wiener_apply(&(chan->wiener), chan->real, chan->imag);
+
+	fxp_dft_run_i_dft(&(hsvc->dft), chan->real, chan->imag);
+
+	/* Возврат к масштабу входа (порядок блока) вместе с нормировкой перекрытия. */
+	for (k = 0; k < dft_size; k++) {
+		chan->real[k] = (int32_t) ((((int64_t) chan->real[k]) * hsvc->norm_factor + (((int64_t) 1) << (14 + shift))) >> (15 + shift));
+	}
+
+	for (k = 0; k < hsvc->step_size_smpls; k++) {
+		data[hsvc_smpl_idx(hsvc, k, ch)] = hsvc_saturate(chan->real[k] + chan->overlap_buf[k]);
+	}
+
+	for (k = 0; k < dft_size; k++) {
+		chan->overlap_buf[k] += chan->real[k];
+	}
+	memmove(chan->overlap_buf, chan->overlap_buf + hsvc->step_size_smpls, (dft_size - hsvc->step_size_smpls) * sizeof(int32_t));
+	memset(chan->overlap_buf + (dft_size - hsvc->step_size_smpls), '\0', hsvc->step_size_smpls * sizeof(int32_t));
+}
+
+static int hsvc_denoise(struct HSV_CONTEXT_q*hsvc)
+{
+	unsigned ch;
+
+	unsigned processed = 0;
+
+	while (hsvc->pending_bytes >= hsvc->frame_size_bs) {
+		for (ch = 0; ch < hsvc->conf.ch; ch++) {
+			hsvc_process(hsvc, ch);
+		}
+
+		hsvc->pending_bytes -= hsvc->step_size_bs; processed += hsvc->step_size_bs;
+		hsvc->idx_frame = (hsvc->idx_frame + hsvc->step_size_bs) % rb_cap(&(hsvc->rb));
+	}
+
+	return processed;
+}
+
+int hsvc_push_q(struct HSV_CONTEXT_q*hsvc, const char*data, unsigned data_len)
+{
+	enum HSV_CODE r;
+
+	enum RB_CODE rb_r;
+
+	rb_r = rb_push(&(hsvc->rb), data, data_len);
+	if (rb_r != RB_CODE_OK) {
+		r = switch_rb_code(rb_r);
+		goto err0;
+	}
+
+	hsvc->pending_bytes += data_len;
+
+	return hsvc_denoise(hsvc);
+ err0:
+	return r;
+}
+
+unsigned hsvc_get_q(struct HSV_CONTEXT_q*hsvc, char*data, unsigned data_cap)
+{
+	unsigned data_len = rb_len(&(hsvc->rb)) - hsvc->pending_bytes;
+	if (data_cap < data_len) {
+		data_len = data_cap;
+	}
+	return rb_get(&(hsvc->rb), data, data_len);
+}
+
+unsigned hsvc_get_room_q(struct HSV_CONTEXT_q*hsvc)
+{
+	return rb_cap(&(hsvc->rb)) - rb_len(&(hsvc->rb));
+}
+
+unsigned hsvc_get_latency_q(struct HSV_CONTEXT_q*hsvc)
+{
+	return hsvc->frame_size_smpls;
+}
+
+unsigned hsvc_get_period_q(struct HSV_CONTEXT_q*hsvc)
+{
+	return hsvc->step_size_smpls;
+}
+
+void hsvc_flush_q(struct HSV_CONTEXT_q*hsvc)
+{
+	hsvc->idx_frame = rb_idx_in(&(hsvc->rb));
+	hsvc->pending_bytes = 0;
+}
+
+void hsvc_reset_ch_q(struct HSV_CONTEXT_q*hsvc, unsigned ch)
+{
+	struct HSV_FIXED_CHAN*chan = hsvc->chans + ch;
+
+	chan->est.got_first = 0;
+	memset(chan->est.spp_k, '\0', chan->est.size * sizeof(int32_t));
+	memset(chan->wiener.speech_spec_prev, '\0', chan->wiener.size * sizeof(uint64_t));
+	memset(chan->wiener.gain, '\0', chan->wiener.size * sizeof(int32_t));
+	memset(chan->overlap_buf, '\0', hsvc->dft_size_smpls * sizeof(int32_t));
+}
+
+void hsvc_deconfig_q(struct HSV_CONTEXT_q*hsvc)
+{
+	unsigned ch;
+
+	for (ch = 0; ch < hsvc->conf.ch; ch++) {
+		hsvc_deconfig_chan(hsvc, hsvc->chans + ch);
+	}
+	arena_free(hsvc->arena, hsvc->chans);
+	fxp_dft_deconfig(&(hsvc->dft));
+	arena_free(hsvc->arena, hsvc->window);
+	rb_deconfig(&(hsvc->rb));
+}
+
+void hsvc_free_q(struct HSV_CONTEXT_q*hsvc)
+{
+	free(hsvc);
+}
+/**
+ * /}
+ */
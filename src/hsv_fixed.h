@@ -0,0 +1,95 @@
+/**
+ * \file hsv_fixed.h
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Внутреннее API обработки "HSV" с фиксированной точкой (HSV_PRECISION_MODE_FIXED).
+ */
+/**
+ * \ingroup hsv
+ * \{
+ */
+#ifndef HSV_FIXED_H_INCLUDED
+#define HSV_FIXED_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+#include "hsv.h"
+
+#include <inttypes.h>
+
+#include "arena.h"
+#include "rb.h"
+#include "fxp.h"
+
+/**
+ * Структура канала обработки с фиксированной точкой.
+ */
+struct HSV_FIXED_CHAN
+{
+	struct FXP_ESTIMATOR est; /**< Оценка шума.              */
+	struct FXP_WIENER wiener; /**< Винеровская фильтрация.   */
+
+	/* Фрейм и его спектр нужны только во время обработки фрейма: у всех каналов это одна и та же память рабочей арены. */
+	int32_t*real;         /**< Действительная часть фрейма (dft_size).            */
+	int32_t*imag;         /**< Мнимая часть фрейма (dft_size).                    */
+	uint64_t*power_spec;  /**< Спектр мощности (dft_size / 2 + 1).               */
+	int32_t*overlap_buf;  /**< Буфер перекрытия-сложения (dft_size).              */
+};
+
+/**
+ * Структура контекста "HSV" с фиксированной точкой.
+ * Поддерживается подмножество параметров: винеровская фильтрация (HSV_SUPPRESSOR_MODE_WIENER), оконное
+ * преобразование Фурье с окном Ханна и размером ДПФ - степенью двойки, без обходов, связанного режима
+ * и обработки в узкой полосе (см. hsvc_validate_config).
+ */
+struct HSV_CONTEXT_q
+{
+	struct HSV_CONFIG conf; /**< Параметры конфигурации. */
+
+	arena_t arena;   /**< Арена, из которой выделены состояния контекста. */
+	arena_t scratch; /**< Рабочая арена фреймов каналов.                 */
+
+	struct RING_BUFFER rb; /**< Кольцевой буфер. */
+
+	unsigned frame_size_smpls; /**< Размер обрабатываемого фрейма в сэмплах. */
+	unsigned step_size_smpls;  /**< Размер шага фрейма в сэмплах.            */
+	unsigned dft_size_smpls;   /**< Размер ДПФ.                              */
+
+	unsigned frame_size_bs; /**< Размер обрабатываемого фрейма в байтах с учетом числа каналов. */
+	unsigned step_size_bs;  /**< Размер шага фрейма в байтах с учетом числа каналов.            */
+
+	int32_t norm_factor; /**< Величина, обратная фактору нормализации при перекрытии, Q15. */
+
+	int16_t*window; /**< Окно Ханна, Q15. */
+
+	struct FXP_DFT dft; /**< ДПФ, общее для всех каналов. */
+
+	struct HSV_FIXED_CHAN*chans; /**< Обрабатываемые каналы звука (conf.ch). */
+
+	unsigned idx_frame;     /**< Индекс начала необработанного фрейма в кольцевом буфере. */
+	unsigned pending_bytes; /**< Число необработанных байт.                                */
+};
+
+struct HSV_CONTEXT_q*create_hsvc_q();
+struct HSV_CONTEXT_q*create_hsvc_arena_q(arena_t arena);
+enum HSV_CODE hsvc_config_impl_q(struct HSV_CONTEXT_q*hsvc, const struct HSV_CONFIG*conf, arena_t arena, arena_t scratch);
+enum HSV_CODE hsvc_reserve_impl_q(const struct HSV_CONFIG*conf, arena_t arena, arena_t scratch);
+int hsvc_push_q(struct HSV_CONTEXT_q*hsvc, const char*data, unsigned data_len);
+unsigned hsvc_get_q(struct HSV_CONTEXT_q*hsvc, char*data, unsigned data_cap);
+unsigned hsvc_get_room_q(struct HSV_CONTEXT_q*hsvc);
+unsigned hsvc_get_latency_q(struct HSV_CONTEXT_q*hsvc);
+unsigned hsvc_get_period_q(struct HSV_CONTEXT_q*hsvc);
+void hsvc_flush_q(struct HSV_CONTEXT_q*hsvc);
+void hsvc_reset_ch_q(struct HSV_CONTEXT_q*hsvc, unsigned ch);
+void hsvc_deconfig_q(struct HSV_CONTEXT_q*hsvc);
+void hsvc_free_q(struct HSV_CONTEXT_q*hsvc);
+
+#ifdef __cplusplus
+}
+#endif  /* __cplusplus */
+
+#endif  /* HSV_FIXED_H_INCLUDED */
+/**
+ * /}
+ */
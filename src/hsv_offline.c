@@ -0,0 +1,373 @@
+/**
+ * \file hsv_offline.c
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Реализация API офлайн-обработки "HSV".
+ */
+/**
+ * \ingroup hsv
+ * \{
+ */
+#include "hsv_offline.h"
+
+#include "arena.h"
+#include "pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <stdint.h>
+
+#define HSV_OFFLINE_BUF_BS 8192 /**< Размер буфера чтения результата контекста в байтах. */
+
+/**
+ * Часть записи [begin, end) в байтах. Контекст части начинает за warmup_bs до begin с отсчета, кратного
+ * периоду сетки обработки (hsvc_get_period), и обрабатывает запись, пока результат не покроет need;
+ * результат до begin (разогрев) отбрасывается. Начало [begin, begin + xfade) и хвост
+ * [end, end + xfade) пишутся в свои буферы, остальное - сразу в выходной массив, поэтому части не пишут в общую память.
+ */
+struct HSV_OFFLINE_PART
+{
+	size_t begin; /**< Начало части.                               */
+	size_t end;   /**< Конец части.                                */
+	size_t need;  /**< Конец результата, нужного части.            */
+
+	hsvc_t hsvc; /**< Контекст части (создается вызывающим потоком, конфигурируется задачей). */
+
+	char*head; /**< Результат начала части (кроме первой части). */
+	char*tail; /**< Результат хвоста части (кроме последней).     */
+
+	enum HSV_CODE r; /**< Результат обработки части. */
+};
+
+/**
+ * Аргумент задач пула.
+ */
+struct HSV_OFFLINE
+{
+	const struct HSV_CONFIG*conf; /**< Конфигурация контекстов частей. */
+
+	const char*data; /**< Запись.                  */
+	size_t data_len; /**< Размер записи в байтах.  */
+	char*out;        /**< Выходной массив.         */
+
+	size_t warmup_bs; /**< Размер разогрева в байтах.                */
+	size_t xfade_bs;  /**< Размер перекрестного затухания в байтах. */
+
+	struct HSV_OFFLINE_PART*parts; /**< Части записи. */
+	unsigned n_parts;              /**< Число частей. */
+
+	char*bufs; /**< Буферы чтения исполнителей (HSV_OFFLINE_BUF_BS байт на исполнителя). */
+};
+
+static size_t hsvo_min(size_t a, size_t b)
+{
+	return (a < b) ? a : b;
+}
+
+static size_t hsvo_max(size_t a, size_t b)
+{
+	return (a > b) ? a : b;
+}
+
+/**
+ * Копирование пересечения результата [pos, pos + len) с отрезком [from, to) в dst (dst соответствует from).
+ */
+static void hsvo_copy(char*dst, size_t from, size_t to, const char*src, size_t pos, size_t len)
+{
+	size_t l, r;
+
+	l = hsvo_max(from, pos);
+	r = hsvo_min(to, pos + len);
+	if (l < r) {
+		memcpy(dst + (l - from), src + (l - pos), r - l);
+	}
+}
+
+/**
+ * Задача пула: обработка одной части записи своим контекстом.
+ */
+static void hsvo_task(void*arg, unsigned task, unsigned worker)
+{
+	struct HSV_OFFLINE*hsvo;
+	struct HSV_OFFLINE_PART*part;
+
+	hsvc_t hsvc;
+
+	char*buf;
+	size_t smpl_bs;
+	size_t period_bs;
+	size_t pos, out_pos, len;
+	size_t x_begin;
+	unsigned got, room;
+	int flushed;
+	int r;
+
+	hsvo = (struct HSV_OFFLINE*) arg;
+	part = hsvo->parts + task;
+	buf = hsvo->bufs + (size_t) worker * HSV_OFFLINE_BUF_BS;
+	smpl_bs = (size_t) hsvo->conf->ch * (HSV_SUPPORTED_BS / 8);
+
+	hsvc = part->hsvc;
+	r = hsvc_config(hsvc, hsvo->conf);
+	if (r != HSV_CODE_OK) {
+		part->r = (enum HSV_CODE) r;
+		goto err0;
+	}
+
+	x_begin = (task > 0) ? part->begin + hsvo->xfade_bs : part->begin;
+
+	/* Начало на сетке периода: фреймы и обновления оценки шума совпадают с обработкой с начала записи. */
+	period_bs = (size_t) hsvc_get_period(hsvc) * smpl_bs;
+	pos = part->begin - hsvo_min(part->begin, hsvo->warmup_bs);
+	pos -= pos % period_bs;
+	out_pos = pos;
+	flushed = 0;
+	for (;;) {
+		while ((got = hsvc_get(hsvc, buf, HSV_OFFLINE_BUF_BS)) != 0) {
+			hsvo_copy(hsvo->out + x_begin, x_begin, part->end, buf, out_pos, got);
+			if (task > 0) {
+				hsvo_copy(part->head, part->begin, x_begin, buf, out_pos, got);
+			}
+			if (task + 1 < hsvo->n_parts) {
+				hsvo_copy(part->tail, part->end, part->need, buf, out_pos, got);
+			}
+			out_pos += got;
+		}
+		if (out_pos >= part->need) {
+			break;
+		}
+
+		if (pos < hsvo->data_len) {
+			/* Подачи кратны сэмплу, кроме остатка в конце записи. */
+			room = hsvc_get_room(hsvc);
+			len = hsvo_min(hsvo->data_len - pos, room - room % smpl_bs);
+			r = hsvc_push(hsvc, hsvo->data + pos, (unsigned) len);
+			if (r < 0) {
+				part->r = (enum HSV_CODE) r;
+				goto err1;
+			}
+			pos += len;
+		} else if (!flushed) {
+			hsvc_flush(hsvc);
+			flushed = 1;
+		} else {
+			break;
+		}
+	}
+
+	part->r = HSV_CODE_OK;
+
+ err1:
+	hsvc_deconfig(hsvc);
+ err0:
+	return;
+}
+
+/**
+ * Сшивание хвоста части tail и начала следующей head: веса нарастают линейно по серединам сэмплов,
+ * поэтому совпадающие результаты частей дают тот же результат.
+ */
+static void hsvo_xfade(char*dst, const char*tail, const char*head, size_t xfade_smpls, unsigned ch)
+{
+	size_t i;
+	unsigned c;
+	int16_t a, b;
+	int64_t v, d;
+
+	d = 2 * (int64_t) xfade_smpls;
+	for (i = 0; i < xfade_smpls; i++) {
+		for (c = 0; c < ch; c++) {
+			memcpy(&a, tail + (i * ch + c) * sizeof(int16_t), sizeof(int16_t));
+			memcpy(&b, head + (i * ch + c) * sizeof(int16_t), sizeof(int16_t));
+			v = (int64_t) a * (d - 2 * (int64_t) i - 1) + (int64_t) b * (2 * (int64_t) i + 1);
+			v = (v >= 0) ? (v + d / 2) / d : -((-v + d / 2) / d);
+			a = (int16_t) v;
+			memcpy(dst + (i * ch + c) * sizeof(int16_t), &a, sizeof(int16_t));
+		}
+	}
+}
+
+/**
+ * Выделение частей и буферов из арены (в режиме измерения - из кучи).
+ */
+static enum HSV_CODE hsvo_config_buf(struct HSV_OFFLINE*hsvo, struct POOL*pool, unsigned threads, arena_t arena)
+{
+	enum HSV_CODE r;
+
+	unsigned k;
+
+	hsvo->parts = (struct HSV_OFFLINE_PART*) arena_calloc(arena, hsvo->n_parts, sizeof(struct HSV_OFFLINE_PART));
+	if (hsvo->parts == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err0;
+	}
+	for (k = 0; k < hsvo->n_parts; k++) {
+		hsvo->parts[k].head = (char*) arena_calloc(arena, hsvo->xfade_bs, sizeof(char));
+		hsvo->parts[k].tail = (char*) arena_calloc(arena, hsvo->xfade_bs, sizeof(char));
+		if ((hsvo->parts[k].head == NULL) || (hsvo->parts[k].tail == NULL)) {
+			arena_free(arena, hsvo->parts[k].tail);
+			arena_free(arena, hsvo->parts[k].head);
+			r = HSV_CODE_ALLOC_ERR;
+			goto err1;
+		}
+	}
+	hsvo->bufs = (char*) arena_calloc(arena, (size_t) threads * HSV_OFFLINE_BUF_BS, sizeof(char));
+	if (hsvo->bufs == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err1;
+	}
+	if (pool_config(pool, threads, arena) != POOL_CODE_OK) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err2;
+	}
+
+	return HSV_CODE_OK;
+
+ err2:
+	arena_free(arena, hsvo->bufs);
+ err1:
+	while (k-- > 0) {
+		arena_free(arena, hsvo->parts[k].tail);
+		arena_free(arena, hsvo->parts[k].head);
+	}
+	arena_free(arena, hsvo->parts);
+ err0:
+	return r;
+}
+
+static void hsvo_deconfig_buf(struct HSV_OFFLINE*hsvo, struct POOL*pool, arena_t arena)
+{
+	unsigned k;
+
+	pool_deconfig(pool);
+	arena_free(arena, hsvo->bufs);
+	for (k = hsvo->n_parts; k-- > 0; ) {
+		arena_free(arena, hsvo->parts[k].tail);
+		arena_free(arena, hsvo->parts[k].head);
+	}
+	arena_free(arena, hsvo->parts);
+}
+
+enum HSV_CODE hsvo_process(const struct HSV_CONFIG*conf, const struct HSV_OFFLINE_CONFIG*offline, const char*data, size_t data_len, char*out)
+{
+	enum HSV_CODE r;
+
+	struct HSV_OFFLINE hsvo;
+	struct HSV_OFFLINE_PART*part;
+	struct POOL pool;
+	struct ARENA arena;
+	void*mem;
+	size_t mem_size;
+
+	unsigned threads, parts;
+	size_t smpl_bs, n_smpls;
+	size_t warmup_bs, xfade_smpls;
+	unsigned k;
+
+	if (hsvc_validate_config(conf) != 0) {
+		r = HSV_CODE_UNKNOWN_ERR;
+		goto err0;
+	}
+
+	threads = (offline->threads == HSV_DEFAULT) ? 1 : offline->threads;
+	parts = (offline->parts == HSV_DEFAULT) ? threads : offline->parts;
+	smpl_bs = (size_t) conf->ch * (HSV_SUPPORTED_BS / 8);
+	n_smpls = data_len / smpl_bs;
+	warmup_bs = (size_t) conf->sr * ((offline->warmup_ms == HSV_DEFAULT) ? HSV_DEFAULT_OFFLINE_WARMUP_MS : offline->warmup_ms) / 1000 * smpl_bs;
+	xfade_smpls = (size_t) conf->sr * ((offline->xfade_ms == HSV_DEFAULT) ? HSV_DEFAULT_OFFLINE_XFADE_MS : offline->xfade_ms) / 1000;
+	if (xfade_smpls == 0) {
+		xfade_smpls = 1;
+	}
+
+	/* Каждая часть длиннее перекрестного затухания: тогда начало и хвост части не пересекаются. */
+	if (parts > n_smpls / (xfade_smpls + 1)) {
+		parts = (unsigned) (n_smpls / (xfade_smpls + 1));
+	}
+	if (parts == 0) {
+		parts = 1;
+	}
+	if (threads > parts) {
+		threads = parts;
+	}
+
+	hsvo.conf = conf;
+	hsvo.data = data;
+	hsvo.data_len = data_len;
+	hsvo.out = out;
+	hsvo.warmup_bs = warmup_bs;
+	hsvo.xfade_bs = xfade_smpls * smpl_bs;
+	hsvo.n_parts = parts;
+
+	/* Размер памяти определяется пробной конфигурацией в режиме измерения арены: она только выделяет буферы. */
+	pool_clean(&pool);
+	arena_init(&arena, NULL, 0);
+	r = hsvo_config_buf(&hsvo, &pool, threads, &arena);
+	if (r != HSV_CODE_OK) {
+		goto err0;
+	}
+	hsvo_deconfig_buf(&hsvo, &pool, &arena);
+	mem_size = arena_mem_size(arena.peak);
+
+	mem = malloc(mem_size);
+	if (mem == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err0;
+	}
+	arena_init(&arena, mem, mem_size);
+	r = hsvo_config_buf(&hsvo, &pool, threads, &arena);
+	if (r != HSV_CODE_OK) {
+		goto err1;
+	}
+
+	/* Границы частей кратны сэмплу, остаток записи входит в последнюю часть. */
+	for (k = 0; k < parts; k++) {
+		part = hsvo.parts + k;
+		part->begin = (size_t) ((unsigned long long) n_smpls * k / parts) * smpl_bs;
+		part->end = (k + 1 < parts) ? (size_t) ((unsigned long long) n_smpls * (k + 1) / parts) * smpl_bs : data_len;
+		part->need = (k + 1 < parts) ? part->end + hsvo.xfade_bs : data_len;
+		part->r = HSV_CODE_UNKNOWN_ERR;
+	}
+
+	for (k = 0; k < parts; k++) {
+		hsvo.parts[k].hsvc = create_hsvc();
+		if (hsvo.parts[k].hsvc == NULL) {
+			r = HSV_CODE_ALLOC_ERR;
+			goto err2;
+		}
+	}
+
+	pool_run(&pool, hsvo_task, &hsvo, parts);
+
+	for (k = 0; k < parts; k++) {
+		if (hsvo.parts[k].r != HSV_CODE_OK) {
+			r = hsvo.parts[k].r;
+			goto err2;
+		}
+	}
+	for (k = 1; k < parts; k++) {
+		hsvo_xfade(out + hsvo.parts[k].begin, hsvo.parts[k - 1].tail, hsvo.parts[k].head, xfade_smpls, conf->ch);
+	}
+
+	for (k = parts; k-- > 0; ) {
+		hsvc_free(hsvo.parts[k].hsvc);
+	}
+	hsvo_deconfig_buf(&hsvo, &pool, &arena);
+	free(mem);
+
+	return HSV_CODE_OK;
+
+ err2:
+	for (k = parts; k-- > 0; ) {
+		if (hsvo.parts[k].hsvc != NULL) {
+			hsvc_free(hsvo.parts[k].hsvc);
+		}
+	}
+	hsvo_deconfig_buf(&hsvo, &pool, &arena);
+ err1:
+	free(mem);
+ err0:
+	return r;
+}
+/**
+ * /}
+ */
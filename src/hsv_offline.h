@@ -0,0 +1,77 @@
+/**
+ * \file hsv_offline.h
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Публичное API офлайн-обработки "HSV": параллельная обработка частей записи целиком в памяти.
+ */
+/**
+ * \ingroup hsv
+ * \{
+ */
+#ifndef HSV_OFFLINE_H_INCLUDED
+#define HSV_OFFLINE_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+#include <stddef.h>
+
+#include "hsv.h"
+
+#define HSV_DEFAULT_OFFLINE_WARMUP_MS 5000 /**< Длительность разогрева части по умолчанию в миллисекундах.    */
+#define HSV_DEFAULT_OFFLINE_XFADE_MS  20   /**< Длительность перекрестного затухания по умолчанию в миллисекундах. */
+
+/**
+ * Структура конфигурации офлайн-обработки.
+ * В случае нулевых значений поля принимают значения по умолчанию.
+ */
+struct HSV_OFFLINE_CONFIG
+{
+	/**
+	 * Число потоков, включая вызывающий (по умолчанию HSV_DEFAULT - 1).
+	 */
+	unsigned threads;
+
+	/**
+	 * Число частей записи (по умолчанию - threads). Части короче перекрестного затухания не создаются.
+	 */
+	unsigned parts;
+
+	/**
+	 * Длительность разогрева в миллисекундах (по умолчанию HSV_DEFAULT_OFFLINE_WARMUP_MS): контекст части
+	 * сначала обрабатывает столько предшествующей записи, чтобы оценки шума и подавления сошлись к ее началу.
+	 * При ctrl_period > 1 оценка шума обновляется реже и сходится пропорционально дольше.
+	 */
+	unsigned warmup_ms;
+
+	/**
+	 * Длительность перекрестного затухания на стыке частей в миллисекундах (по умолчанию HSV_DEFAULT_OFFLINE_XFADE_MS).
+	 */
+	unsigned xfade_ms;
+};
+
+/**
+ * Обработка записи целиком: запись делится на части, каждая часть обрабатывается своим контекстом
+ * в пуле потоков, результаты частей сшиваются линейным перекрестным затуханием.
+ * Контекст части начинает за warmup_ms до начала части с отсчета, кратного hsvc_get_period (фреймы частей
+ * совпадают с фреймами обработки с начала записи), и продолжает обработку на xfade_ms после конца части,
+ * поэтому на стыке смешиваются два результата после разогрева. Если разогрев покрывает всю предшествующую
+ * запись, то результат совпадает с обработкой одним контекстом бит в бит (кроме HSV_SPLIT_MODE_TRACKED,
+ * где результат зависит от размеров подач).
+ * \param conf структура конфигурации \"HSV\" контекстов частей.
+ * \param offline структура конфигурации офлайн-обработки.
+ * \param data массив бинарных данных для чтения.
+ * \param data_len размер массива.
+ * \param out массив размера data_len для записи результата.
+ * \return результат обработки.
+ */
+enum HSV_CODE hsvo_process(const struct HSV_CONFIG*conf, const struct HSV_OFFLINE_CONFIG*offline, const char*data, size_t data_len, char*out);
+
+#ifdef __cplusplus
+}
+#endif  /* __cplusplus */
+
+#endif  /* HSV_OFFLINE_H_INCLUDED */
+/**
+ * /}
+ */
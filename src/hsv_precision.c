@@ -0,0 +1,421 @@
+/**
+ * \file hsv_precision.c
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Реализация открытого API "HSV": выбор обработки нужной точности.
+ */
+/**
+ * \ingroup hsv
+ * \{
+ */
+#include "hsv.h"
+
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#endif  /* __SSE__ || _M_X64 */
+
+/**
+ * Объявления API "HSV" одной точности (hsv.c, собранный с суффиксом символов SUFFIX, см. hsv_symbols.h).
+ */
+#define HSV_DECLARE_PRECISION(SUFFIX) \
+	struct HSV_CONTEXT##SUFFIX; \
+	struct HSV_CONTEXT##SUFFIX*create_hsvc_arena##SUFFIX(arena_t arena); \
+	int hsvc_validate_config##SUFFIX(const struct HSV_CONFIG*conf); \
+	enum HSV_CODE hsvc_config_impl##SUFFIX(struct HSV_CONTEXT##SUFFIX*hsvc, const struct HSV_CONFIG*conf, arena_t arena, arena_t scratch); \
+	enum HSV_CODE hsvc_reserve_impl##SUFFIX(const struct HSV_CONFIG*conf, arena_t arena, arena_t scratch); \
+	int hsvc_push##SUFFIX(struct HSV_CONTEXT##SUFFIX*hsvc, const char*data, unsigned data_len); \
+	unsigned hsvc_get##SUFFIX(struct HSV_CONTEXT##SUFFIX*hsvc, char*data, unsigned data_cap); \
+	unsigned hsvc_get_room##SUFFIX(struct HSV_CONTEXT##SUFFIX*hsvc); \
+	unsigned hsvc_get_latency##SUFFIX(struct HSV_CONTEXT##SUFFIX*hsvc); \
+	unsigned hsvc_get_period##SUFFIX(struct HSV_CONTEXT##SUFFIX*hsvc); \
+	void hsvc_flush##SUFFIX(struct HSV_CONTEXT##SUFFIX*hsvc); \
+	void hsvc_reset_ch##SUFFIX(struct HSV_CONTEXT##SUFFIX*hsvc, unsigned ch); \
+	void hsvc_deconfig##SUFFIX(struct HSV_CONTEXT##SUFFIX*hsvc);
+
+HSV_DECLARE_PRECISION(_f)
+HSV_DECLARE_PRECISION(_d)
+HSV_DECLARE_PRECISION(_l)
+/* Целочисленная обработка (hsv_fixed.c) имеет тот же интерфейс; проверка параметров общая, поэтому hsvc_validate_config_q нет. */
+HSV_DECLARE_PRECISION(_q)
+
+/**
+ * Таблица функций API "HSV" одной точности. Контекст точности передается как void*.
+ */
+struct HSV_PRECISION_API
+{
+	void*(*create_arena)(arena_t arena);
+	enum HSV_CODE (*config_impl)(void*impl, const struct HSV_CONFIG*conf, arena_t arena, arena_t scratch);
+	enum HSV_CODE (*reserve_impl)(const struct HSV_CONFIG*conf, arena_t arena, arena_t scratch);
+	int (*push)(void*impl, const char*data, unsigned data_len);
+	unsigned (*get)(void*impl, char*data, unsigned data_cap);
+	unsigned (*get_room)(void*impl);
+	unsigned (*get_latency)(void*impl);
+	unsigned (*get_period)(void*impl);
+	void (*flush)(void*impl);
+	void (*reset_ch)(void*impl, unsigned ch);
+	void (*deconfig)(void*impl);
+};
+
+/**
+ * Таблица функций одной точности: обертки приводят void* к типу контекста этой точности.
+ */
+#define HSV_DEFINE_PRECISION_API(SUFFIX) \
+	static void*create_arena##SUFFIX(arena_t arena) { return create_hsvc_arena##SUFFIX(arena); } \
+	static enum HSV_CODE config_impl##SUFFIX(void*impl, const struct HSV_CONFIG*conf, arena_t arena, arena_t scratch) \
+	{ return hsvc_config_impl##SUFFIX(impl, conf, arena, scratch); } \
+	static int push##SUFFIX(void*impl, const char*data, unsigned data_len) { return hsvc_push##SUFFIX(impl, data, data_len); } \
+	static unsigned get##SUFFIX(void*impl, char*data, unsigned data_cap) { return hsvc_get##SUFFIX(impl, data, data_cap); } \
+	static unsigned get_room##SUFFIX(void*impl) { return hsvc_get_room##SUFFIX(impl); } \
+	static unsigned get_latency##SUFFIX(void*impl) { return hsvc_get_latency##SUFFIX(impl); } \
+	static unsigned get_period##SUFFIX(void*impl) { return hsvc_get_period##SUFFIX(impl); } \
+	static void flush##SUFFIX(void*impl) { hsvc_flush##SUFFIX(impl); } \
+	static void reset_ch##SUFFIX(void*impl, unsigned ch) { hsvc_reset_ch##SUFFIX(impl, ch); } \
+	static void deconfig##SUFFIX(void*impl) { hsvc_deconfig##SUFFIX(impl); } \
+	static const struct HSV_PRECISION_API hsv_api##SUFFIX = { \
+		create_arena##SUFFIX, config_impl##SUFFIX, hsvc_reserve_impl##SUFFIX, push##SUFFIX, get##SUFFIX, get_room##SUFFIX, \
+		get_latency##SUFFIX, get_period##SUFFIX, flush##SUFFIX, reset_ch##SUFFIX, deconfig##SUFFIX \
+	};
+
+HSV_DEFINE_PRECISION_API(_f)
+HSV_DEFINE_PRECISION_API(_d)
+HSV_DEFINE_PRECISION_API(_l)
+HSV_DEFINE_PRECISION_API(_q)
+
+/**
+ * Выбор таблицы функций по точности.
+ */
+static const struct HSV_PRECISION_API*hsv_precision_api(enum HSV_PRECISION_MODE precision)
+{
+	switch (precision) {
+	case HSV_PRECISION_MODE_DOUBLE:
+		return &hsv_api_d;
+	case HSV_PRECISION_MODE_LONG_DOUBLE:
+		return &hsv_api_l;
+	case HSV_PRECISION_MODE_FIXED:
+		return &hsv_api_q;
+	default:
+		return &hsv_api_f;
+	}
+}
+
+/**
+ * Выбор таблиц вычислительных ядер точностей (kernels.c, см. kernels.h).
+ */
+const char*kernels_init_f();
+const char*kernels_init_d();
+const char*kernels_init_l();
+
+/**
+ * Структура контекста \"HSV\": контекст обработки выбранной точности.
+ */
+struct HSV_CONTEXT
+{
+	const struct HSV_PRECISION_API*api; /**< Функции выбранной точности (выбираются hsvc_config).          */
+	void*impl;                          /**< Контекст этой точности в арене arena (NULL до конфигурации). */
+
+	struct ARENA arena;   /**< Арена состояния контекста этой точности.                                  */
+	struct ARENA scratch; /**< Рабочая арена контекста этой точности.                                    */
+	void*mem;             /**< Память обеих арен, выделенная hsvc_config (NULL - память пользователя). */
+
+	int protect; /**< Сброс денормализованных чисел в ноль на время обработки (HSV_DENORMAL_MODE_PROTECT). */
+};
+
+/**
+ * Включение сброса денормализованных результатов и операндов в ноль.
+ * \return прежнее состояние регистра управления вычислениями с плавающей точкой.
+ */
+static unsigned long long hsvc_denormals_off()
+{
+#if defined(__SSE__) || defined(_M_X64)
+	/* FTZ (бит 15) и DAZ (бит 6) регистра MXCSR. */
+	unsigned csr = _mm_getcsr();
+	_mm_setcsr(csr | 0x8040);
+	return csr;
+#elif defined(__aarch64__)
+	/* FZ (бит 24) регистра FPCR сбрасывает в ноль и результаты, и операнды. */
+	unsigned long long fpcr;
+	__asm__ __volatile__ ("mrs %0, fpcr" : "=r" (fpcr));
+	__asm__ __volatile__ ("msr fpcr, %0" : : "r" (fpcr | (1ULL << 24)));
+	return fpcr;
+#else
+	return 0;
+#endif
+}
+
+/**
+ * Восстановление состояния, сохраненного hsvc_denormals_off.
+ */
+static void hsvc_denormals_restore(unsigned long long state)
+{
+#if defined(__SSE__) || defined(_M_X64)
+	_mm_setcsr((unsigned) state);
+#elif defined(__aarch64__)
+	__asm__ __volatile__ ("msr fpcr, %0" : : "r" (state));
+#else
+	(void) state;
+#endif
+}
+
+hsvc_t create_hsvc()
+{
+	hsvc_t hsvc;
+
+	hsvc = (hsvc_t) calloc(1, sizeof(struct HSV_CONTEXT));
+	if (hsvc == NULL) {
+		return NULL;
+	}
+
+	/* Таблицы ядер заполняются по процессору один раз, при создании первого контекста. */
+	kernels_init_f();
+	kernels_init_d();
+	kernels_init_l();
+
+	return hsvc;
+}
+
+int hsvc_validate_config(const struct HSV_CONFIG*conf)
+{
+	/* Проверки параметров не зависят от точности. */
+	return hsvc_validate_config_f(conf);
+}
+
+/**
+ * Создание и конфигурация контекста выбранной точности в аренах hsvc->arena и hsvc->scratch.
+ * Сам контекст этой точности тоже выделяется в hsvc->arena.
+ */
+static enum HSV_CODE hsvc_config_precision(hsvc_t hsvc, const struct HSV_CONFIG*conf)
+{
+	enum HSV_CODE r;
+
+	hsvc->api = hsv_precision_api(conf->precision);
+	hsvc->protect = (conf->denormal == HSV_DENORMAL_MODE_PROTECT);
+
+	hsvc->impl = hsvc->api->create_arena(&(hsvc->arena));
+	if (hsvc->impl == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err0;
+	}
+
+	r = hsvc->api->config_impl(hsvc->impl, conf, &(hsvc->arena), &(hsvc->scratch));
+	if (r != HSV_CODE_OK) {
+		goto err1;
+	}
+
+	return HSV_CODE_OK;
+
+ err1:
+	/* Память контекста этой точности принадлежит арене. */
+	hsvc->impl = NULL;
+ err0:
+	return r;
+}
+
+/**
+ * Расчет размеров арен без конфигурации: буферы не выделяются, а таблицы и окна не рассчитываются.
+ * \param usage размеры памяти арен состояния и рабочей арены.
+ * \return результат расчета (ошибка, если конфигурация будет отклонена).
+ */
+static enum HSV_CODE hsvc_measure_arena(const struct HSV_CONFIG*conf, struct HSV_MEMORY_USAGE*usage)
+{
+	enum HSV_CODE r;
+
+	struct ARENA arena;
+	struct ARENA scratch;
+
+	arena_init(&arena, NULL, 0);
+	arena_init(&scratch, NULL, 0);
+
+	r = hsv_precision_api(conf->precision)->reserve_impl(conf, &arena, &scratch);
+	if (r != HSV_CODE_OK) {
+		return r;
+	}
+
+	/* Буферы рабочей арены частично занимают одну и ту же память, поэтому нужен наибольший занятый объем. */
+	usage->state = arena_mem_size(arena.peak);
+	usage->scratch = arena_mem_size(scratch.peak);
+
+	return HSV_CODE_OK;
+}
+
+size_t hsvc_get_arena_size(const struct HSV_CONFIG*conf)
+{
+	struct HSV_MEMORY_USAGE usage;
+
+	if (hsvc_measure_arena(conf, &usage) != HSV_CODE_OK) {
+		return 0;
+	}
+
+	return usage.state + usage.scratch;
+}
+
+enum HSV_CODE hsvc_get_memory_usage(const struct HSV_CONFIG*conf, struct HSV_MEMORY_USAGE*usage)
+{
+	return hsvc_measure_arena(conf, usage);
+}
+
+enum HSV_CODE hsvc_config_shared(hsvc_t hsvc, const struct HSV_CONFIG*conf, void*mem, size_t mem_size, void*scratch, size_t scratch_size)
+{
+	hsvc->mem = NULL;
+
+	arena_init(&(hsvc->arena), mem, mem_size);
+	arena_init(&(hsvc->scratch), scratch, scratch_size);
+	if ((hsvc->arena.data == NULL) || (hsvc->scratch.data == NULL)) {
+		return HSV_CODE_ALLOC_ERR;
+	}
+
+	return hsvc_config_precision(hsvc, conf);
+}
+
+/**
+ * Конфигурация с рабочей памятью в начале памяти контекста.
+ * \param usage размеры памяти, измеренные hsvc_measure_arena.
+ */
+static enum HSV_CODE hsvc_config_block(hsvc_t hsvc, const struct HSV_CONFIG*conf, void*mem, size_t mem_size, const struct HSV_MEMORY_USAGE*usage)
+{
+	if (mem_size < usage->state + usage->scratch) {
+		return HSV_CODE_ALLOC_ERR;
+	}
+
+	return hsvc_config_shared(hsvc, conf, (char*) mem + usage->scratch, mem_size - usage->scratch, mem, usage->scratch);
+}
+
+enum HSV_CODE hsvc_config_arena(hsvc_t hsvc, const struct HSV_CONFIG*conf, void*mem, size_t mem_size)
+{
+	enum HSV_CODE r;
+
+	struct HSV_MEMORY_USAGE usage;
+
+	/* Граница между рабочей памятью и состоянием рассчитывается без конфигурации. */
+	r = hsvc_measure_arena(conf, &usage);
+	if (r != HSV_CODE_OK) {
+		return r;
+	}
+
+	return hsvc_config_block(hsvc, conf, mem, mem_size, &usage);
+}
+
+enum HSV_CODE hsvc_config(hsvc_t hsvc, const struct HSV_CONFIG*conf)
+{
+	enum HSV_CODE r;
+
+	struct HSV_MEMORY_USAGE usage;
+
+	void*mem;
+
+	r = hsvc_measure_arena(conf, &usage);
+	if (r != HSV_CODE_OK) {
+		goto err0;
+	}
+
+	mem = malloc(usage.state + usage.scratch);
+	if (mem == NULL) {
+		r = HSV_CODE_ALLOC_ERR;
+		goto err0;
+	}
+
+	r = hsvc_config_block(hsvc, conf, mem, usage.state + usage.scratch, &usage);
+	if (r != HSV_CODE_OK) {
+		goto err1;
+	}
+
+	hsvc->mem = mem;
+
+	return HSV_CODE_OK;
+
+ err1:
+	free(mem);
+ err0:
+	return r;
+}
+
+int hsvc_push(hsvc_t hsvc, const char*data, unsigned data_len)
+{
+	int r;
+
+	unsigned long long fp_state = 0;
+
+	if (hsvc->protect) {
+		fp_state = hsvc_denormals_off();
+	}
+
+	r = hsvc->api->push(hsvc->impl, data, data_len);
+
+	if (hsvc->protect) {
+		hsvc_denormals_restore(fp_state);
+	}
+
+	return r;
+}
+
+unsigned hsvc_get(hsvc_t hsvc, char*data, unsigned data_cap)
+{
+	return hsvc->api->get(hsvc->impl, data, data_cap);
+}
+
+unsigned hsvc_get_room(hsvc_t hsvc)
+{
+	return hsvc->api->get_room(hsvc->impl);
+}
+
+unsigned hsvc_get_latency(hsvc_t hsvc)
+{
+	return hsvc->api->get_latency(hsvc->impl);
+}
+
+unsigned hsvc_get_period(hsvc_t hsvc)
+{
+	return hsvc->api->get_period(hsvc->impl);
+}
+
+const char*hsvc_get_cpu_level(hsvc_t hsvc)
+{
+	/* Выбор один для всех точностей и контекстов. */
+	(void) hsvc;
+	return kernels_init_f();
+}
+
+void hsvc_flush(hsvc_t hsvc)
+{
+	unsigned long long fp_state = 0;
+
+	if (hsvc->protect) {
+		fp_state = hsvc_denormals_off();
+	}
+
+	hsvc->api->flush(hsvc->impl);
+
+	if (hsvc->protect) {
+		hsvc_denormals_restore(fp_state);
+	}
+}
+
+void hsvc_reset_ch(hsvc_t hsvc, unsigned ch)
+{
+	hsvc->api->reset_ch(hsvc->impl, ch);
+}
+
+void hsvc_deconfig(hsvc_t hsvc)
+{
+	hsvc->api->deconfig(hsvc->impl);
+	hsvc->impl = NULL;
+
+	free(hsvc->mem);
+	hsvc->mem = NULL;
+}
+
+void hsvc_clean(hsvc_t hsvc)
+{
+	memset(hsvc, '\0', sizeof(*hsvc));
+}
+
+void hsvc_free(hsvc_t hsvc)
+{
+	free(hsvc);
+}
+/**
+ * /}
+ */
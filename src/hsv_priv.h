@@ -14,26 +14,58 @@
 extern "C" {
 #endif  /* __cplusplus */
 
+#include "hsv_types.h"
+
 #include "hsv.h"
 
-#include "hsv_types.h"
+#include <inttypes.h>
 
+#include "arena.h"
 #include "rb.h"
 #include "utils.h"
 #include "dft.h"
 #include "estimator.h"
 #include "suppressor.h"
+#include "halfband.h"
+#include "bands.h"
+#include "wola.h"
+#include "kernels.h"
+#include "pool.h"
+
+#define HSV_SPLIT_MAX_STAGES 3     /**< Максимальное число ступеней децимации в 2 раза.          */
+#define HSV_SPLIT_MIN_SR     11025 /**< Минимальная частота дискретизации нижней полосы.         */
+#define HSV_SPLIT_HALF       12    /**< Полуполосные фильтры длины 4 * 12 - 1 = 47.              */
+#define HSV_SPLIT_CHUNK      256   /**< Максимальное число отсчетов нижней полосы за одну подачу. */
+
+#define HSV_WOLA_TAPS 2 /**< Длина прототипа банка фильтров WOLA в размерах ДПФ. */
+
+#define HSV_DENORMAL_EPS 1e-30 /**< Минимальный спектр мощности при HSV_DENORMAL_MODE_PROTECT (-300 дБ полной шкалы). */
+
+/**
+ * Способ обработки фрейма в пакете.
+ */
+enum HSV_HOP_STATE
+{
+	HSV_HOP_STATE_FULL,    /**< Полная обработка.                              */
+	HSV_HOP_STATE_SILENCE, /**< Тишина: копирование без ДПФ и оценки шума.     */
+	HSV_HOP_STATE_NOISE,   /**< Нет голоса: ослабление без подавления шума.    */
+};
 
 /**
  * Структура одного канала звука.
  */
 struct HSV_CHAN
 {
-	struct DISCRETE_FOURIER_TRANSFORM dft; /**< Структура ДПФ. */
+	/* Спектры канала - срезы общих спектров пакета контекста: h-й фрейм начинается со смещения h * batch_stride.
+	   Спектры и состояния фреймов не нужны между пакетами и выделяются из рабочей арены. */
+	hsv_numeric_t*real; /**< Действительные части ДПФ пакета фреймов. */
+	hsv_numeric_t*imag; /**< Мнимые части ДПФ пакета фреймов.         */
+
+	hsv_numeric_t*amp_spec;   /**< Спектры амплитуд пакета фреймов. */
+	hsv_numeric_t*power_spec; /**< Спектры мощности пакета фреймов. */
+	hsv_numeric_t*phase_spec; /**< Спектры фаз пакета фреймов.      */
 
-	hsv_numeric_t*amp_spec;   /**< Текущий спектр амплитуд. */
-	hsv_numeric_t*power_spec; /**< Текущий спектр мощности. */
-	hsv_numeric_t*phase_spec; /**< Текущий спектр фаз.      */
+	unsigned char*hop_state; /**< Способы обработки фреймов пакета (enum HSV_HOP_STATE). */
 
 	struct ESTIMATOR est; /**< Структура оценки шума. */
 
@@ -44,9 +76,48 @@ struct HSV_CHAN
 	 * полученных при обработке предыдущих фреймов.
 	 */
 	hsv_numeric_t*overlap_buf;
+
+	unsigned ctrl_hop; /**< Счетчик фреймов для пониженной частоты обновления оценок.    */
+	int ctrl_ready;    /**< Были ли хотя бы раз вычислены коэффициенты усиления.        */
+
+	hsv_numeric_t*gain;      /**< Интерполированные коэффициенты усиления (HSV_CTRL_MODE_INTERP). */
+	hsv_numeric_t*gain_prev; /**< Предпоследние вычисленные коэффициенты усиления.                */
+	hsv_numeric_t*gain_next; /**< Последние вычисленные коэффициенты усиления.                    */
+
+	/**
+	 * Копия входа, начиная с отсчета frame_size - fir_half перед idx_frame (HSV_SYNTHESIS_MODE_FIR)
+	 * или synth_offset_smpls перед idx_frame (HSV_WINDOW_MODE_LOW_DELAY), иначе NULL.
+	 */
+	hsv_numeric_t*raw;
+	hsv_numeric_t*fir_taps; /**< КИХ-фильтры прошлого шага и шагов пакета, по fir_len отсчетов. */
 };
 
 
+/**
+ * Исполнитель пула контекста: буферы, которые нужны потоку на время обработки одного канала.
+ */
+struct HSV_WORKER
+{
+	struct DISCRETE_FOURIER_TRANSFORM dft; /**< ДПФ: таблицы исполнителя 0, у остальных - общие с ним.          */
+	hsv_numeric_t*wola_buf;                /**< Фрейм до свертки при анализе и после развертки при синтезе (WOLA). */
+};
+
+/**
+ * Состояние канала при обработке в узкой полосе.
+ */
+struct HSV_SPLIT_CHAN
+{
+	struct HALFBAND decim[HSV_SPLIT_MAX_STAGES];  /**< Каскад децимации (0 - на исходной частоте).    */
+	struct HALFBAND interp[HSV_SPLIT_MAX_STAGES]; /**< Каскад интерполяции (0 - на исходной частоте). */
+
+	int16_t*fifo;       /**< Необработанные отсчеты нижней полосы, ожидающие результата обработки. */
+	unsigned fifo_head; /**< Индекс первого отсчета в очереди.                                      */
+	unsigned fifo_len;  /**< Число отсчетов в очереди.                                              */
+
+	hsv_numeric_t gain;        /**< Текущий коэффициент усиления верхней полосы.  */
+	hsv_numeric_t gain_target; /**< Целевой коэффициент усиления верхней полосы. */
+};
+
 /**
  * Структура контекста \"HSV\"
  */
@@ -54,6 +125,9 @@ struct HSV_CONTEXT
 {
 	struct HSV_CONFIG conf; /**< Параметры конфигурации. */
 
+	arena_t arena;   /**< Арена, из которой выделены состояния контекста (и контекста нижней полосы).           */
+	arena_t scratch; /**< Рабочая арена: буферы, содержимое которых не сохраняется между вызовами hsvc_push. */
+
 	struct RING_BUFFER rb; /**< Кольцевой буфер. */
 
 	unsigned frame_size_smpls;   /**< Размер обрабатываемого фрейма в сэмплах. */
@@ -66,16 +140,111 @@ struct HSV_CONTEXT
 
 	hsv_numeric_t norm_factor; /**< Фактор нормализации данных при перекрытии. */
 
-	unsigned dft_size_smpls; /**< Размер ДПФ. */
+	unsigned dft_size_smpls;     /**< Размер ДПФ.                                                     */
+	unsigned synth_size_smpls;   /**< Число отсчетов синтезированного фрейма для перекрытия-сложения. */
+	unsigned synth_offset_smpls; /**< Начало перекрываемой части синтезированного фрейма.             */
 
-	hsv_numeric_t*window; /**< Оконная функция. */
+	unsigned batch_hops;   /**< Максимальное число фреймов в пакете.                          */
+	unsigned batch_stride; /**< Шаг фреймов в спектрах пакета: dft_size * ch (фрейм всех каналов). */
 
-	struct HSV_CHAN chans[HSV_MAX_CHANS]; /**< Обрабатываемые каналы звука. */
+	/* Каналы пакета обрабатываются исполнителями пула по одному, между этапами пакета - барьер pool_run.
+	   Исполнитель 0 - поток, вызвавший hsvc_push. */
+	struct POOL pool;           /**< Пул потоков (conf.threads).                         */
+	struct HSV_WORKER*workers;  /**< Исполнители пула (n_workers).                       */
+	unsigned n_workers;         /**< Число исполнителей: conf.threads, но не больше ch.  */
+	unsigned pool_hops;         /**< Число фреймов обрабатываемого пакета (для задач).   */
+	unsigned pool_smpls;        /**< Число отсчетов шага, выдаваемых КИХ-фильтрами.      */
+
+	/* Спектры пакета всех каналов лежат одним блоком [фрейм][канал][частота], поэтому ДПФ и ядра спектров
+	   выполняются один раз для batch_hops * ch преобразований подряд с шагом dft_size. */
+	hsv_numeric_t*real;       /**< Действительные части ДПФ пакета фреймов всех каналов. */
+	hsv_numeric_t*imag;       /**< Мнимые части ДПФ пакета фреймов всех каналов.         */
+	hsv_numeric_t*amp_spec;   /**< Спектры амплитуд пакета фреймов всех каналов.         */
+	hsv_numeric_t*power_spec; /**< Спектры мощности пакета фреймов всех каналов.         */
+	hsv_numeric_t*phase_spec; /**< Спектры фаз пакета фреймов всех каналов.              */
+
+	unsigned char*hop_state; /**< Способы обработки фреймов пакета всех каналов (по batch_hops на канал). */
+
+	hsv_numeric_t bypass_silence; /**< Порог средней мощности фрейма тишины.         */
+	hsv_numeric_t bypass_spp;     /**< Порог средней вероятности наличия голоса.     */
+	hsv_numeric_t bypass_gain;    /**< Коэффициент ослабления фреймов без голоса.    */
+
+	unsigned ctrl_period; /**< Период обновления оценки шума и коэффициентов усиления во фреймах. */
+
+	hsv_numeric_t*window;           /**< Оконная функция (для банка фильтров WOLA - окно анализа). */
+	hsv_numeric_t*synthesis_window; /**< Окно синтеза (NULL для HSV_WINDOW_MODE_HANNING).          */
+
+	struct WOLA wola; /**< Банк фильтров WOLA (HSV_FILTERBANK_MODE_WOLA). */
+
+	struct BANDS bands; /**< Критические полосы, общие для всех каналов (HSV_SUPPRESSOR_MODE_BARK). */
+
+	unsigned fir_half;    /**< Групповая задержка КИХ-фильтра.                                      */
+	unsigned fir_len;     /**< Длина КИХ-фильтра (2 * fir_half + 1).                                */
+	unsigned raw_len;     /**< Число отсчетов в копиях входа каналов (HSV_SYNTHESIS_MODE_FIR).      */
+	unsigned raw_cap;     /**< Вместимость копий входа каналов (0 - без копий).                     */
+	unsigned fir_hops;    /**< Число шагов пакета с рассчитанными фильтрами.                        */
+	unsigned fir_hop;     /**< Текущий шаг пакета.                                                  */
+	unsigned fir_pos;     /**< Число выданных отсчетов текущего шага.                               */
+
+	hsv_numeric_t*fir_window; /**< Окно для усечения импульсных характеристик (fir_len отсчетов). */
+
+	struct HSV_CHAN*chans; /**< Обрабатываемые каналы звука (conf.ch). */
+
+	/**
+	 * Общие оценка и подавление шума в связанном режиме (HSV_LINK_MODE_MID, HSV_LINK_MODE_MAX).
+	 * Используются только спектры одного фрейма, счетчики и коэффициенты усиления.
+	 */
+	struct HSV_CHAN link;
+
+	/**
+	 * Контекст обработки нижней полосы (HSV_SPLIT_MODE_FIXED, HSV_SPLIT_MODE_TRACKED).
+	 * Если не NULL, то каналы chans, link и оконная функция не используются.
+	 */
+	struct HSV_CONTEXT*split;
+
+	unsigned split_stages;   /**< Число ступеней децимации.                                             */
+	unsigned split_delay;    /**< Задержка фильтров в отсчетах исходной частоты.                        */
+	unsigned split_skip;     /**< Число начальных отсчетов интерполятора, которые нужно пропустить.     */
+	unsigned split_ahead_bs; /**< Число байт после idx_frame, уже поданных на вход каскада децимации.   */
+	unsigned split_fifo_cap; /**< Вместимость очередей нижней полосы в отсчетах одного канала.          */
+
+	int16_t*split_buf; /**< Буфер обмена данными с контекстом нижней полосы. */
+
+	hsv_numeric_t split_alpha; /**< Коэффициент сглаживания коэффициента усиления верхней полосы. */
+
+	struct HSV_SPLIT_CHAN*split_chans; /**< Состояния каналов при обработке в узкой полосе (conf.ch). */
+	hsv_numeric_t*split_out;           /**< Выход интерполяторов каналов для одного отсчета нижней полосы. */
 
 	unsigned idx_frame;     /**< Индекс начала фрейма в кольцевом буфере.            */
 	unsigned pending_bytes; /**< Число байт в кольцевом буфере, ожидающих обработки. */
 };
 
+/**
+ * Конфигурация \"HSV\" этой точности: все буферы контекста выделяются из двух арен
+ * (открытые hsvc_config, hsvc_config_arena и hsvc_config_shared, см. hsv_precision.c).
+ * \param conf структура конфигурации \"HSV\".
+ * \param arena арена, из которой выделяются состояния.
+ * \param scratch рабочая арена, которая может быть общей для контекстов, обрабатываемых по очереди.
+ * \return результат конфигурирования.
+ */
+enum HSV_CODE hsvc_config_impl(hsvc_t hsvc, const struct HSV_CONFIG*conf, arena_t arena, arena_t scratch);
+
+/**
+ * Создание контекста этой точности в арене: память освобождается вместе с ареной, hsvc_free не нужен.
+ * \return указатель на контекст (при нехватке памяти арены - NULL).
+ */
+hsvc_t create_hsvc_arena(arena_t arena);
+
+/**
+ * Расчет памяти create_hsvc_arena и hsvc_config_impl в аренах без выделения буферов и расчета таблиц:
+ * те же размеры и возвраты рабочей арены передаются arena_reserve (см. hsvc_get_memory_usage).
+ * \param conf структура конфигурации \"HSV\".
+ * \param arena арена состояний в режиме измерения.
+ * \param scratch рабочая арена в режиме измерения.
+ * \return HSV_CODE_OK или ошибка, с которой hsvc_config_impl отклонит конфигурацию.
+ */
+enum HSV_CODE hsvc_reserve_impl(const struct HSV_CONFIG*conf, arena_t arena, arena_t scratch);
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
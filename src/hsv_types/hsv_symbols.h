@@ -0,0 +1,150 @@
+/**
+ * \file hsv_symbols.h
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Переименование внешних символов модулей, зависящих от hsv_numeric_t, для сборки с несколькими точностями.
+ */
+/**
+ * \ingroup hsv_types
+ * \{
+ */
+#ifndef HSV_SYMBOLS_H_INCLUDED
+#define HSV_SYMBOLS_H_INCLUDED
+
+/*
+ * Модули с hsv_numeric_t компилируются по разу для каждой точности (см. Makefile), и одноименные функции
+ * разных точностей получают суффикс HSV_SUFFIX. Переименовывается и тег контекста "HSV",
+ * чтобы hsvc_t разных точностей были разными типами. Открытое API "HSV" без суффиксов
+ * реализовано в hsv_precision.c и выбирает точность по HSV_CONFIG::precision.
+ */
+
+/* KERNELS. */
+#define kernels_scalar HSV_SYM(kernels_scalar)
+#define kernels_sse2   HSV_SYM(kernels_sse2)
+#define kernels_avx2   HSV_SYM(kernels_avx2)
+#define kernels_avx512 HSV_SYM(kernels_avx512)
+#define hsv_kernels    HSV_SYM(hsv_kernels)
+#define kernels_init   HSV_SYM(kernels_init)
+#define kernels_store  HSV_SYM(kernels_store)
+#define kernels_load   HSV_SYM(kernels_load)
+
+/* UTILS. */
+#define init_window                  HSV_SYM(init_window)
+#define init_window_taper            HSV_SYM(init_window_taper)
+#define init_synthesis_window        HSV_SYM(init_synthesis_window)
+#define init_window_low_delay        HSV_SYM(init_window_low_delay)
+#define calculate_phase_spec         HSV_SYM(calculate_phase_spec)
+#define calculate_phase_spec_fast    HSV_SYM(calculate_phase_spec_fast)
+#define calculate_complex_spec_fast  HSV_SYM(calculate_complex_spec_fast)
+#define bessel_i0                    HSV_SYM(bessel_i0)
+
+/* FASTMATH. */
+#define fastmath_atan2  HSV_SYM(fastmath_atan2)
+#define fastmath_sincos HSV_SYM(fastmath_sincos)
+#define fastmath_log10  HSV_SYM(fastmath_log10)
+#define fastmath_pow    HSV_SYM(fastmath_pow)
+#define fastmath_sqrt   HSV_SYM(fastmath_sqrt)
+
+/* DFT. */
+#define create_dft          HSV_SYM(create_dft)
+#define dft_config          HSV_SYM(dft_config)
+#define dft_config_shared   HSV_SYM(dft_config_shared)
+#define dft_reserve         HSV_SYM(dft_reserve)
+#define dft_reserve_shared  HSV_SYM(dft_reserve_shared)
+#define dft_run_dft         HSV_SYM(dft_run_dft)
+#define dft_run_i_dft       HSV_SYM(dft_run_i_dft)
+#define dft_run_dft_batch   HSV_SYM(dft_run_dft_batch)
+#define dft_run_i_dft_batch HSV_SYM(dft_run_i_dft_batch)
+#define dft_deconfig        HSV_SYM(dft_deconfig)
+#define dft_clean           HSV_SYM(dft_clean)
+#define dft_free            HSV_SYM(dft_free)
+
+/* BANDS. */
+#define create_bands        HSV_SYM(create_bands)
+#define bands_config        HSV_SYM(bands_config)
+#define bands_reserve       HSV_SYM(bands_reserve)
+#define bands_aggregate     HSV_SYM(bands_aggregate)
+#define bands_aggregate_amp HSV_SYM(bands_aggregate_amp)
+#define bands_expand        HSV_SYM(bands_expand)
+#define bands_deconfig      HSV_SYM(bands_deconfig)
+#define bands_clean         HSV_SYM(bands_clean)
+#define bands_free          HSV_SYM(bands_free)
+
+/* WOLA. */
+#define create_wola   HSV_SYM(create_wola)
+#define wola_config   HSV_SYM(wola_config)
+#define wola_reserve  HSV_SYM(wola_reserve)
+#define wola_fold     HSV_SYM(wola_fold)
+#define wola_unfold   HSV_SYM(wola_unfold)
+#define wola_deconfig HSV_SYM(wola_deconfig)
+#define wola_clean    HSV_SYM(wola_clean)
+#define wola_free     HSV_SYM(wola_free)
+
+/* ESTIMATOR. */
+#define create_estimator        HSV_SYM(create_estimator)
+#define estimator_config        HSV_SYM(estimator_config)
+#define estimator_config_bands  HSV_SYM(estimator_config_bands)
+#define estimator_config_lanes  HSV_SYM(estimator_config_lanes)
+#define estimator_reserve       HSV_SYM(estimator_reserve)
+#define estimator_reserve_bands HSV_SYM(estimator_reserve_bands)
+#define estimator_reserve_lanes HSV_SYM(estimator_reserve_lanes)
+#define estimator_set_eps       HSV_SYM(estimator_set_eps)
+#define estimator_run           HSV_SYM(estimator_run)
+#define estimator_run_part      HSV_SYM(estimator_run_part)
+#define estimator_reset_lane    HSV_SYM(estimator_reset_lane)
+#define estimator_mean_spp      HSV_SYM(estimator_mean_spp)
+#define estimator_deconfig      HSV_SYM(estimator_deconfig)
+#define estimator_clean         HSV_SYM(estimator_clean)
+#define estimator_free          HSV_SYM(estimator_free)
+
+/* SUPPRESSOR. */
+#define create_suppressor        HSV_SYM(create_suppressor)
+#define suppressor_config        HSV_SYM(suppressor_config)
+#define suppressor_config_bands  HSV_SYM(suppressor_config_bands)
+#define suppressor_config_lanes  HSV_SYM(suppressor_config_lanes)
+#define suppressor_reserve       HSV_SYM(suppressor_reserve)
+#define suppressor_reserve_bands HSV_SYM(suppressor_reserve_bands)
+#define suppressor_reserve_lanes HSV_SYM(suppressor_reserve_lanes)
+#define suppressor_set_fast_math HSV_SYM(suppressor_set_fast_math)
+#define suppressor_set_eps       HSV_SYM(suppressor_set_eps)
+#define suppressor_run           HSV_SYM(suppressor_run)
+#define suppressor_bypass        HSV_SYM(suppressor_bypass)
+#define suppressor_apply_gain    HSV_SYM(suppressor_apply_gain)
+#define suppressor_reset_lane    HSV_SYM(suppressor_reset_lane)
+#define suppressor_deconfig      HSV_SYM(suppressor_deconfig)
+#define suppressor_clean         HSV_SYM(suppressor_clean)
+#define suppressor_free          HSV_SYM(suppressor_free)
+
+/* HALFBAND. */
+#define create_halfband      HSV_SYM(create_halfband)
+#define halfband_config      HSV_SYM(halfband_config)
+#define halfband_reserve     HSV_SYM(halfband_reserve)
+#define halfband_reset       HSV_SYM(halfband_reset)
+#define halfband_decimate    HSV_SYM(halfband_decimate)
+#define halfband_interpolate HSV_SYM(halfband_interpolate)
+#define halfband_deconfig    HSV_SYM(halfband_deconfig)
+#define halfband_clean       HSV_SYM(halfband_clean)
+#define halfband_free        HSV_SYM(halfband_free)
+
+/* HSV. */
+#define HSV_CONTEXT          HSV_SYM(HSV_CONTEXT)
+#define create_hsvc          HSV_SYM(create_hsvc)
+#define create_hsvc_arena    HSV_SYM(create_hsvc_arena)
+#define hsvc_validate_config HSV_SYM(hsvc_validate_config)
+#define hsvc_config          HSV_SYM(hsvc_config)
+#define hsvc_config_impl     HSV_SYM(hsvc_config_impl)
+#define hsvc_reserve_impl    HSV_SYM(hsvc_reserve_impl)
+#define hsvc_push            HSV_SYM(hsvc_push)
+#define hsvc_get             HSV_SYM(hsvc_get)
+#define hsvc_get_room        HSV_SYM(hsvc_get_room)
+#define hsvc_get_latency     HSV_SYM(hsvc_get_latency)
+#define hsvc_get_period      HSV_SYM(hsvc_get_period)
+#define hsvc_flush           HSV_SYM(hsvc_flush)
+#define hsvc_reset_ch        HSV_SYM(hsvc_reset_ch)
+#define hsvc_deconfig        HSV_SYM(hsvc_deconfig)
+#define hsvc_clean           HSV_SYM(hsvc_clean)
+#define hsvc_free            HSV_SYM(hsvc_free)
+
+#endif  /* HSV_SYMBOLS_H_INCLUDED */
+/**
+ * /}
+ */
@@ -17,12 +17,15 @@ extern "C" {
 #define PREFIX_UNUSED(VAR) ((void) VAR) /**< Макрос подавления неиспользуемых переменных. */
 
 /**
- * Выбор режима точности вычислений с плавающей точкой.
- * LOW_ACC  - низкая точность  (float);
+ * Выбор режима точности вычислений с плавающей точкой (задается при компиляции единицы трансляции, см. Makefile):
+ * LOW_ACC  - низкая точность  (float, по умолчанию);
  * MED_ACC  - средняя точность (double);
  * HIGH_ACC - высокая точность (long double);
+ * Библиотека собирается для всех трех точностей, а нужная выбирается при конфигурации (HSV_CONFIG::precision).
  */
-#define LOW_ACC 
+#if !defined(LOW_ACC) && !defined(MED_ACC) && !defined(HIGH_ACC)
+#define LOW_ACC
+#endif  /* !LOW_ACC && !MED_ACC && !HIGH_ACC */
 
 #ifdef LOW_ACC
 
@@ -36,6 +39,9 @@ typedef float hsv_numeric_t;
 #define HSV_ROUND(VAR) roundf(VAR)
 #define HSV_LOG10(VAR) log10f(VAR)
 #define HSV_FLOOR(VAR) floorf(VAR)
+#define HSV_FREXP(VAR, EXP) frexpf(VAR, EXP)
+
+#define HSV_SUFFIX _f /**< Суффикс символов модулей этой точности. */
 	
 #endif  /* LOW_ACC */
 
@@ -51,6 +57,9 @@ typedef double hsv_numeric_t;
 #define HSV_ROUND(VAR) round(VAR)
 #define HSV_LOG10(VAR) log10(VAR)
 #define HSV_FLOOR(VAR) floor(VAR)
+#define HSV_FREXP(VAR, EXP) frexp(VAR, EXP)
+
+#define HSV_SUFFIX _d /**< Суффикс символов модулей этой точности. */
 	
 #endif  /* MED_ACC */
 
@@ -66,9 +75,53 @@ typedef long double hsv_numeric_t;
 #define HSV_ROUND(VAR) roundl(VAR)
 #define HSV_LOG10(VAR) log10l(VAR)
 #define HSV_FLOOR(VAR) floorl(VAR)
+#define HSV_FREXP(VAR, EXP) frexpl(VAR, EXP)
+
+#define HSV_SUFFIX _l /**< Суффикс символов модулей этой точности. */
 
 #endif  /* HIGH_ACC */
 
+#define HSV_SYM_CAT_(NAME, SUFFIX) NAME##SUFFIX
+#define HSV_SYM_CAT(NAME, SUFFIX) HSV_SYM_CAT_(NAME, SUFFIX)
+#define HSV_SYM(NAME) HSV_SYM_CAT(NAME, HSV_SUFFIX) /**< Имя символа с суффиксом текущей точности. */
+
+#ifdef HSV_SUFFIXED_SYMBOLS
+#include "hsv_symbols.h"
+#endif  /* HSV_SUFFIXED_SYMBOLS */
+
+/**
+ * Статическая конфигурация (make STATIC_CONFIG="sr=16000 ch=1 frame=256 dft=512 mode=tsnr", см. Makefile).
+ * Makefile создает hsv_static_config.h с заданными параметрами:
+ * HSV_STATIC_SR         - частота дискретизации;
+ * HSV_STATIC_CH         - число каналов;
+ * HSV_STATIC_FRAME_SIZE - размер фрейма в отсчетах (после округления до четного);
+ * HSV_STATIC_DFT_SIZE   - размер ДПФ;
+ * HSV_STATIC_MODE       - режим подавления шума (суффикс HSV_SUPPRESSOR_MODE_, например, TSNR).
+ * Любой параметр может быть не задан. Конфигурация с другими значениями отклоняется hsvc_validate_config,
+ * а горячие циклы и ядра компилируются с постоянными размерами (HSV_CONST_*).
+ */
+#ifdef HSV_STATIC_CONFIG
+#include "hsv_static_config.h"
+#endif  /* HSV_STATIC_CONFIG */
+
+#ifdef HSV_STATIC_CH
+#define HSV_CONST_CH(VAR) ((unsigned) HSV_STATIC_CH)
+#else
+#define HSV_CONST_CH(VAR) (VAR)
+#endif  /* HSV_STATIC_CH */
+
+#ifdef HSV_STATIC_FRAME_SIZE
+#define HSV_CONST_FRAME_SIZE(VAR) ((unsigned) HSV_STATIC_FRAME_SIZE)
+#else
+#define HSV_CONST_FRAME_SIZE(VAR) (VAR)
+#endif  /* HSV_STATIC_FRAME_SIZE */
+
+#ifdef HSV_STATIC_DFT_SIZE
+#define HSV_CONST_DFT_SIZE(VAR) ((unsigned) HSV_STATIC_DFT_SIZE)
+#else
+#define HSV_CONST_DFT_SIZE(VAR) (VAR)
+#endif  /* HSV_STATIC_DFT_SIZE */
+
 #ifndef M_PI
 #define M_PI ((hsv_numeric_t) 3.14159265358979323846)
 #endif	/* M_PI */
@@ -0,0 +1,169 @@
+/**
+ * \file kernels.c
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Реализация выбора таблицы вычислительных ядер по набору инструкций процессора.
+ */
+/**
+ * \ingroup kernels
+ * \{
+ */
+#include "kernels.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Таблицы наборов инструкций (kernels_impl.c). Для x86-64 собираются все четыре, для остальных архитектур - только
+ * скалярная (см. KERNEL_ISAS в Makefile).
+ */
+extern const struct KERNELS kernels_scalar;
+#if defined(__x86_64__)
+extern const struct KERNELS kernels_sse2;
+extern const struct KERNELS kernels_avx2;
+extern const struct KERNELS kernels_avx512;
+#endif  /* __x86_64__ */
+
+/**
+ * Уровни наборов инструкций по возрастанию.
+ */
+enum KERNELS_LEVEL
+{
+	KERNELS_LEVEL_SCALAR = 0,
+	KERNELS_LEVEL_SSE2 = 1,
+	KERNELS_LEVEL_AVX2 = 2,
+	KERNELS_LEVEL_AVX512 = 3,
+};
+
+static const struct KERNELS*kernels_tables[] = {
+	&kernels_scalar,
+#if defined(__x86_64__)
+	&kernels_sse2,
+	&kernels_avx2,
+	&kernels_avx512,
+#endif  /* __x86_64__ */
+};
+
+#if defined(__x86_64__)
+const struct KERNELS*hsv_kernels = &kernels_sse2;
+#else
+const struct KERNELS*hsv_kernels = &kernels_scalar;
+#endif  /* __x86_64__ */
+
+static pthread_once_t kernels_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Старший набор инструкций, поддерживаемый процессором и операционной системой.
+ */
+static enum KERNELS_LEVEL kernels_cpu_level()
+{
+#if defined(__x86_64__) && defined(__GNUC__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) {
+		return KERNELS_LEVEL_AVX512;
+	}
+	if (__builtin_cpu_supports("avx2")) {
+		return KERNELS_LEVEL_AVX2;
+	}
+	return KERNELS_LEVEL_SSE2;
+#elif defined(__x86_64__)
+	return KERNELS_LEVEL_SSE2;
+#else
+	return KERNELS_LEVEL_SCALAR;
+#endif  /* __x86_64__ && __GNUC__ */
+}
+
+/**
+ * Выбор таблицы ядер (выполняется один раз через kernels_once).
+ */
+static void kernels_select()
+{
+	enum KERNELS_LEVEL level;
+
+	unsigned i;
+
+	const char*env;
+
+	level = kernels_cpu_level();
+
+	env = getenv("HSV_CPU_LEVEL");
+	if (env != NULL) {
+		for (i = 0; i < sizeof(kernels_tables) / sizeof(kernels_tables[0]); i++) {
+			if ((strcmp(env, kernels_tables[i]->name) == 0) && (i < (unsigned) level)) {
+				level = (enum KERNELS_LEVEL) i;
+			}
+		}
+	}
+
+	hsv_kernels = kernels_tables[level];
+}
+
+const char*kernels_init()
+{
+	/* Контексты могут создаваться одновременно из разных потоков. */
+	pthread_once(&kernels_once, kernels_select);
+
+	return hsv_kernels->name;
+}
+
+/**
+ * Порядок массива для KERNELS_STORAGE_FP16: наибольший модуль, деленный на 2^exp, меньше 2^15.
+ * Для нулевого массива (и бесконечностей, которые все равно ограничиваются 65504) порядок нулевой.
+ */
+static int kernels_fp16_exp(const hsv_numeric_t*in, unsigned n)
+{
+	unsigned i;
+
+	double max = 0.0;
+	int exp;
+
+	for (i = 0; i < n; i++) {
+		double v = (double) in[i];
+		v = (v < 0.0) ? -v : v;
+		max = (v > max) ? v : max;
+	}
+
+	if ((max == 0.0) || (max > 1e300)) {
+		return 0;
+	}
+
+	frexp(max, &exp);
+	return exp - 15;
+}
+
+int kernels_store(enum KERNELS_STORAGE storage, const hsv_numeric_t*in, uint16_t*out, unsigned n)
+{
+	int exp = 0;
+
+	switch (storage) {
+	case KERNELS_STORAGE_FP16:
+		exp = kernels_fp16_exp(in, n);
+		hsv_kernels->numeric_to_fp16(in, out, n, (hsv_numeric_t) ldexp(1.0, -exp));
+		break;
+	case KERNELS_STORAGE_BF16:
+		hsv_kernels->numeric_to_bf16(in, out, n);
+		break;
+	default:
+		break;
+	}
+
+	return exp;
+}
+
+void kernels_load(enum KERNELS_STORAGE storage, const uint16_t*in, hsv_numeric_t*out, unsigned n, int exp)
+{
+	switch (storage) {
+	case KERNELS_STORAGE_FP16:
+		hsv_kernels->fp16_to_numeric(in, out, n, (hsv_numeric_t) ldexp(1.0, exp));
+		break;
+	case KERNELS_STORAGE_BF16:
+		hsv_kernels->bf16_to_numeric(in, out, n);
+		break;
+	default:
+		break;
+	}
+}
+/**
+ * /}
+ */
@@ -0,0 +1,189 @@
+/**
+ * \file kernels.h
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief API таблицы вычислительных ядер с выбором набора инструкций процессора во время выполнения.
+ */
+/**
+ * \defgroup kernels Модуль вычислительных ядер.
+ * \{
+ */
+#ifndef KERNELS_H_INCLUDED
+#define KERNELS_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+#include "hsv_types.h"
+
+#include <inttypes.h>
+
+/**
+ * Формат хранения долгоживущих массивов состояния: вычисления выполняются в hsv_numeric_t, а между фреймами
+ * массивы хранятся в 16-битном формате (см. kernels_store и kernels_load).
+ */
+enum KERNELS_STORAGE
+{
+	KERNELS_STORAGE_NATIVE = 0, /**< hsv_numeric_t без преобразований.                                */
+	KERNELS_STORAGE_FP16 = 1,   /**< IEEE 754 binary16: 11 бит мантиссы, модуль не больше 65504.       */
+	KERNELS_STORAGE_BF16 = 2,   /**< bfloat16: 8 бит мантиссы, диапазон float.                         */
+};
+
+/**
+ * Параметры и состояние обновления оценки шума MCRA-2 (см. estimator.c).
+ */
+struct KERNELS_MCRA
+{
+	hsv_numeric_t alpha_smooth; /**< Коэффициент сглаживания зашумленного сигнала во времени.      */
+	hsv_numeric_t beta;         /**< Коэффициент прогнозирования.                                 */
+	hsv_numeric_t gamma;        /**< Коэффициент сглаживания.                                     */
+	hsv_numeric_t alpha_spp;    /**< Коэффициент сглаживания вероятности наличия голоса во времени. */
+	hsv_numeric_t alpha;        /**< Коэффициент сглаживания шума.                                */
+	hsv_numeric_t eps;          /**< Минимальное значение спектров мощности (0 - без ограничения).  */
+
+	const hsv_numeric_t*delta_k; /**< Частотно-зависимые пороги присутствия голоса. */
+
+	hsv_numeric_t*P;                /**< Оценка мощности спектра зашумленного сигнала.        */
+	hsv_numeric_t*P_prev;           /**< Прошлая оценка мощности спектра зашумленного сигнала. */
+	hsv_numeric_t*P_min;            /**< Оценка шума методом Доблингера.                      */
+	hsv_numeric_t*P_min_prev;       /**< Прошлая оценка шума методом Доблингера.              */
+	hsv_numeric_t*spp_k;            /**< Вероятность наличия голоса.                          */
+	hsv_numeric_t*noise_power_spec; /**< Спектр мощности шума.                                */
+};
+
+/**
+ * Параметры и состояние вычисления коэффициентов фильтра Винера методом принятия решений (см. suppressor.c).
+ */
+struct KERNELS_DD
+{
+	hsv_numeric_t beta;  /**< Коэффициент метода принятия решений.                        */
+	hsv_numeric_t floor; /**< Минимальный мгновенный SNR.                                 */
+	hsv_numeric_t eps;   /**< Минимальное значение спектра мощности шума (0 - без ограничения). */
+
+	const hsv_numeric_t*speech_amp_spec_prev; /**< Прошлый спектр амплитуд голоса. */
+
+	hsv_numeric_t*noise_power_spec; /**< Спектр мощности шума.                               */
+	hsv_numeric_t*SNR_inst;         /**< Мгновенный SNR.                                     */
+	hsv_numeric_t*SNR_prio_dd;      /**< Априорный SNR, полученный методом принятия решений. */
+	hsv_numeric_t*G_dd;             /**< Фильтр Винера.                                      */
+};
+
+/**
+ * Таблица вычислительных ядер одного набора инструкций.
+ * Ядра всех наборов собираются из одного исходного текста (kernels_impl.c) с флагами набора инструкций и векторизуются
+ * компилятором, поэтому их результаты совпадают побитово: операции выполняются поэлементно в одном порядке,
+ * без сверток и без слияния умножения со сложением.
+ */
+struct KERNELS
+{
+	const char*name; /**< Набор инструкций: "scalar", "sse2", "avx2" или "avx512". */
+
+	/**
+	 * Перестановка Кули-Тьюки по таблице бит-реверсивных индексов rev_tab размера n.
+	 */
+	void (*ct_permute)(hsv_numeric_t*real, hsv_numeric_t*imag, const unsigned*rev_tab, unsigned n);
+	/**
+	 * Бабочки Кули-Тьюки над переставленными массивами размера n, таблицы sin и cos размера n / 2.
+	 */
+	void (*ct_butterflies)(hsv_numeric_t*real, hsv_numeric_t*imag, const hsv_numeric_t*cos_tab, const hsv_numeric_t*sin_tab, unsigned n);
+	/**
+	 * Умножение на сопряженный ЛЧМ-сигнал Блюштейна: out = (real + i * imag) * (cos_tab - i * sin_tab).
+	 */
+	void (*chirp)(const hsv_numeric_t*real, const hsv_numeric_t*imag, const hsv_numeric_t*cos_tab, const hsv_numeric_t*sin_tab,
+		hsv_numeric_t*out_real, hsv_numeric_t*out_imag, unsigned n);
+	/**
+	 * Поэлементное комплексное умножение на месте: a = a * b.
+	 */
+	void (*complex_mul)(hsv_numeric_t*a_real, hsv_numeric_t*a_imag, const hsv_numeric_t*b_real, const hsv_numeric_t*b_imag, unsigned n);
+	/**
+	 * Деление на число: out[i] = in[i] / d. Массивы могут совпадать.
+	 */
+	void (*scale_div)(const hsv_numeric_t*in, hsv_numeric_t d, hsv_numeric_t*out, unsigned n);
+
+	/**
+	 * Применение оконной функции: out[i] = in[i] * window[i]. Массивы in и out могут совпадать.
+	 */
+	void (*windowing)(const hsv_numeric_t*window, const hsv_numeric_t*in, hsv_numeric_t*out, unsigned n);
+	/**
+	 * Спектр амплитуд.
+	 */
+	void (*amp_spec)(const hsv_numeric_t*real, const hsv_numeric_t*imag, hsv_numeric_t*amp_spec, unsigned n);
+	/**
+	 * Спектр мощности.
+	 */
+	void (*power_spec)(const hsv_numeric_t*real, const hsv_numeric_t*imag, hsv_numeric_t*power_spec, unsigned n);
+
+	/**
+	 * Обновление оценки шума MCRA-2 на всех n частотах по спектру мощности P.
+	 */
+	void (*mcra_update)(const struct KERNELS_MCRA*mcra, const hsv_numeric_t*P, unsigned n);
+	/**
+	 * Спектр мощности шума, мгновенный и априорный SNR и коэффициенты фильтра Винера на n частотах.
+	 */
+	void (*dd_gain)(const struct KERNELS_DD*dd, const hsv_numeric_t*noisy_speech_amp_spec, const hsv_numeric_t*noise_amp_spec, unsigned n);
+
+	/**
+	 * Чтение n сэмплов int16 с шагом stride (чередование каналов) в отсчеты из [-1, 1].
+	 */
+	void (*int16_to_numeric)(const int16_t*in, unsigned stride, hsv_numeric_t*out, unsigned n);
+	/**
+	 * Запись n отсчетов в сэмплы int16 с шагом stride с насыщением.
+	 */
+	void (*numeric_to_int16)(const hsv_numeric_t*in, int16_t*out, unsigned stride, unsigned n);
+
+	/**
+	 * Запись n значений, умноженных на scale, в binary16 через float с округлением к ближайшему четному,
+	 * модуль ограничивается 65504. Результат совпадает с VCVTPS2PH (F16C), но вычисляется целочисленными
+	 * операциями и векторизуется на любом наборе.
+	 */
+	void (*numeric_to_fp16)(const hsv_numeric_t*in, uint16_t*out, unsigned n, hsv_numeric_t scale);
+	/**
+	 * Чтение n значений binary16, умноженных на scale (точное при scale - степени двойки, совпадает с VCVTPH2PS).
+	 */
+	void (*fp16_to_numeric)(const uint16_t*in, hsv_numeric_t*out, unsigned n, hsv_numeric_t scale);
+	/**
+	 * Запись n значений в bfloat16 через float с округлением к ближайшему четному.
+	 */
+	void (*numeric_to_bf16)(const hsv_numeric_t*in, uint16_t*out, unsigned n);
+	/**
+	 * Чтение n значений bfloat16 (точное).
+	 */
+	void (*bf16_to_numeric)(const uint16_t*in, hsv_numeric_t*out, unsigned n);
+};
+
+/**
+ * Активная таблица ядер. До kernels_init - базовый набор инструкций архитектуры (SSE2 для x86-64).
+ */
+extern const struct KERNELS*hsv_kernels;
+
+/**
+ * Выбор таблицы ядер по набору инструкций процессора (CPUID). Выполняется один раз, повторные вызовы
+ * только возвращают выбранный набор; вызовы из разных потоков безопасны. Переменная окружения HSV_CPU_LEVEL (scalar, sse2, avx2 или avx512)
+ * ограничивает набор сверху, например, для проверки и сравнения ядер.
+ * \return имя выбранного набора инструкций.
+ */
+const char*kernels_init();
+
+/**
+ * Запись n значений в 16-битный формат storage активными ядрами (KERNELS_STORAGE_NATIVE - без действия).
+ * Диапазон binary16 (от 2^-24 до 65504) уже диапазона спектров тихого сигнала, поэтому для KERNELS_STORAGE_FP16
+ * массив хранится с общим порядком: значения делятся на 2^exp, где exp выбран так, чтобы наибольший модуль
+ * был меньше 2^15. Тогда относительный диапазон массива - около 117 дБ независимо от уровня сигнала.
+ * \return порядок exp для kernels_load (0 для остальных форматов).
+ */
+int kernels_store(enum KERNELS_STORAGE storage, const hsv_numeric_t*in, uint16_t*out, unsigned n);
+
+/**
+ * Чтение n значений 16-битного формата storage активными ядрами (KERNELS_STORAGE_NATIVE - без действия).
+ * \param exp порядок, возвращенный kernels_store.
+ */
+void kernels_load(enum KERNELS_STORAGE storage, const uint16_t*in, hsv_numeric_t*out, unsigned n, int exp);
+
+#ifdef __cplusplus
+}
+#endif  /* __cplusplus */
+
+#endif  /* KERNELS_H_INCLUDED */
+/**
+ * /}
+ */
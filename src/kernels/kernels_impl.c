@@ -0,0 +1,460 @@
+/**
+ * \file kernels_impl.c
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Реализация вычислительных ядер для набора инструкций KERNELS_ISA.
+ */
+/**
+ * \ingroup kernels
+ * \{
+ */
+#include "kernels.h"
+
+#include <math.h>
+#include <string.h>
+
+/*
+ * Файл компилируется для каждого набора инструкций (см. Makefile) с -DKERNELS_ISA=<набор> и флагами набора,
+ * а таблица получает имя kernels_<набор> с суффиксом точности (см. hsv_symbols.h).
+ */
+#ifndef KERNELS_ISA
+#define KERNELS_ISA scalar
+#endif  /* KERNELS_ISA */
+
+#define KERNELS_CAT_(A, B) A##B
+#define KERNELS_CAT(A, B) KERNELS_CAT_(A, B)
+#define KERNELS_STR_(A) #A
+#define KERNELS_STR(A) KERNELS_STR_(A)
+
+#define KERNELS_TABLE KERNELS_CAT(kernels_, KERNELS_ISA)
+
+#ifdef __GNUC__
+#define KERNELS_INLINE static inline __attribute__((always_inline))
+#else
+#define KERNELS_INLINE static inline
+#endif  /* __GNUC__ */
+
+/*
+ * При статической конфигурации (см. hsv_types.h) ядра дополнительно компилируются для размеров фрейма и ДПФ
+ * и числа каналов конфигурации: с постоянным числом итераций и шагом компилятор разворачивает циклы
+ * и векторизует их без остатка. KERNELS_SIZED(N, CALL) выполняет CALL, где размер N обозначен KN.
+ */
+#ifdef HSV_STATIC_DFT_SIZE
+#define KERNELS_IF_DFT_SIZE(N, CALL) if ((N) == HSV_STATIC_DFT_SIZE) { enum { KN = HSV_STATIC_DFT_SIZE }; CALL; } else
+#else
+#define KERNELS_IF_DFT_SIZE(N, CALL)
+#endif  /* HSV_STATIC_DFT_SIZE */
+
+#ifdef HSV_STATIC_FRAME_SIZE
+#define KERNELS_IF_FRAME_SIZE(N, CALL) if ((N) == HSV_STATIC_FRAME_SIZE) { enum { KN = HSV_STATIC_FRAME_SIZE }; CALL; } else
+#else
+#define KERNELS_IF_FRAME_SIZE(N, CALL)
+#endif  /* HSV_STATIC_FRAME_SIZE */
+
+#define KERNELS_SIZED(N, CALL) \
+	do { \
+		KERNELS_IF_DFT_SIZE(N, CALL) \
+		KERNELS_IF_FRAME_SIZE(N, CALL) \
+		{ unsigned KN = (N); CALL; } \
+	} while (0)
+
+/*
+ * Шаг сэмплов int16 - число каналов: KERNELS_STRIDED(STRIDE, CALL) выполняет CALL, где шаг обозначен KS.
+ */
+#ifdef HSV_STATIC_CH
+#define KERNELS_STRIDED(STRIDE, CALL) \
+	do { \
+		if ((STRIDE) == HSV_STATIC_CH) { enum { KS = HSV_STATIC_CH }; CALL; } else { unsigned KS = (STRIDE); CALL; } \
+	} while (0)
+#else
+#define KERNELS_STRIDED(STRIDE, CALL) do { unsigned KS = (STRIDE); CALL; } while (0)
+#endif  /* HSV_STATIC_CH */
+
+KERNELS_INLINE void ct_permute_n(hsv_numeric_t*real, hsv_numeric_t*imag, const unsigned*rev_tab, unsigned n)
+{
+	unsigned i, j;
+
+	hsv_numeric_t tmp;
+
+	for (i = 0; i < n; i++) {
+		j = rev_tab[i];
+		if (j > i) {
+			tmp = real[i];
+			real[i] = real[j];
+			real[j] = tmp;
+
+			tmp = imag[i];
+			imag[i] = imag[j];
+			imag[j] = tmp;
+		}
+	}
+}
+
+KERNELS_INLINE void ct_butterflies_n(hsv_numeric_t*real, hsv_numeric_t*imag, const hsv_numeric_t*cos_tab, const hsv_numeric_t*sin_tab, unsigned n)
+{
+	unsigned i, j, k;
+
+	unsigned n2;
+
+	for (n2 = 2; n2 <= n; n2 *= 2) {
+		unsigned half = n2 / 2;
+		unsigned tab_step = n / n2;
+
+		for (i = 0; i < n; i += n2) {
+			for (j = i, k = 0; j < i + half; j++, k += tab_step) {
+				unsigned ind = j + half;
+				hsv_numeric_t tmp_real = real[ind] * cos_tab[k] +
+					imag[ind] * sin_tab[k];
+				hsv_numeric_t tmp_imag = -real[ind] * sin_tab[k] +
+					imag[ind] * cos_tab[k];
+
+				real[ind] = real[j] - tmp_real;
+				imag[ind] = imag[j] - tmp_imag;
+
+				real[j] += tmp_real;
+				imag[j] += tmp_imag;
+			}
+		}
+	}
+}
+
+KERNELS_INLINE void chirp_n(const hsv_numeric_t*real, const hsv_numeric_t*imag, const hsv_numeric_t*cos_tab, const hsv_numeric_t*sin_tab,
+	hsv_numeric_t*out_real, hsv_numeric_t*out_imag, unsigned n)
+{
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		out_real[i] = real[i] * cos_tab[i] +
+			imag[i] * sin_tab[i];
+		out_imag[i] = -real[i] * sin_tab[i] +
+			imag[i] * cos_tab[i];
+	}
+}
+
+KERNELS_INLINE void complex_mul_n(hsv_numeric_t*a_real, hsv_numeric_t*a_imag, const hsv_numeric_t*b_real, const hsv_numeric_t*b_imag, unsigned n)
+{
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		hsv_numeric_t tmp = a_real[i] * b_real[i] -
+			a_imag[i] * b_imag[i];
+		a_imag[i] = a_imag[i] * b_real[i] +
+			a_real[i] * b_imag[i];
+		a_real[i] = tmp;
+	}
+}
+
+KERNELS_INLINE void scale_div_n(const hsv_numeric_t*in, hsv_numeric_t d, hsv_numeric_t*out, unsigned n)
+{
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		out[i] = in[i] / d;
+	}
+}
+
+KERNELS_INLINE void windowing_n(const hsv_numeric_t*window, const hsv_numeric_t*in, hsv_numeric_t*out, unsigned n)
+{
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		out[i] = in[i] * window[i];
+	}
+}
+
+KERNELS_INLINE void amp_spec_n(const hsv_numeric_t*real, const hsv_numeric_t*imag, hsv_numeric_t*amp_spec, unsigned n)
+{
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		amp_spec[i] = HSV_SQRT(real[i] * real[i] + imag[i] * imag[i]);
+	}
+}
+
+KERNELS_INLINE void power_spec_n(const hsv_numeric_t*real, const hsv_numeric_t*imag, hsv_numeric_t*power_spec, unsigned n)
+{
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		power_spec[i] = real[i] * real[i] + imag[i] * imag[i];
+	}
+}
+
+KERNELS_INLINE void mcra_update_n(const struct KERNELS_MCRA*m, const hsv_numeric_t*P, unsigned n)
+{
+	unsigned k;
+
+	/* Рекурсии по частотам независимы, поэтому шаги estimator_process объединены в один проход. */
+	for (k = 0; k < n; k++) {
+		hsv_numeric_t ak;
+		hsv_numeric_t Sr_k;
+		hsv_numeric_t spp_k = 0.0;
+
+		/* Сглаживание спектра входного зашумленного сигнала. */
+		m->P[k] = m->alpha_smooth * m->P_prev[k] + (1.0 - m->alpha_smooth) * P[k];
+		if (m->eps > 0.0) {
+			m->P[k] = HSV_MAX(m->P[k], m->eps);
+		}
+		m->P_prev[k] = m->P[k];
+
+		/* Непрерывное отслеживание спектральных минимумов по Доблингеру. */
+		if (m->P_min_prev[k] < m->P[k]) {
+			m->P_min[k] = m->gamma * m->P_min_prev[k] + ((1.0 - m->gamma) / (1.0 - m->beta)) * (m->P[k] - m->beta * m->P_prev[k]);
+		} else {
+			m->P_min[k] = m->P[k];
+		}
+		if (m->eps > 0.0) {
+			m->P_min[k] = HSV_MAX(m->P_min[k], m->eps);
+		}
+		m->P_min_prev[k] = m->P_min[k];
+
+		/* Оценка спектра шума методом MCRA-2. */
+		Sr_k = m->P[k] / m->P_min[k];
+		if (Sr_k > m->delta_k[k]) {
+			spp_k = 1.0;
+		}
+		m->spp_k[k] = m->alpha_spp * m->spp_k[k] + (1.0 - m->alpha_spp) * spp_k;
+		ak = m->alpha + (1.0 - m->alpha) * m->spp_k[k];
+		m->noise_power_spec[k] = ak * m->noise_power_spec[k] + (1.0 - ak) * m->P[k];
+		if (m->eps > 0.0) {
+			m->noise_power_spec[k] = HSV_MAX(m->noise_power_spec[k], m->eps);
+			m->spp_k[k] = (m->spp_k[k] < m->eps) ? 0.0 : m->spp_k[k];
+		}
+	}
+}
+
+KERNELS_INLINE void dd_gain_n(const struct KERNELS_DD*dd, const hsv_numeric_t*noisy_speech_amp_spec, const hsv_numeric_t*noise_amp_spec, unsigned n)
+{
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		hsv_numeric_t noisy_speech_power_spec = noisy_speech_amp_spec[i] * noisy_speech_amp_spec[i];
+		hsv_numeric_t SNR_post;
+
+		/* Вычисление спектра мощности шума. */
+		dd->noise_power_spec[i] = HSV_MAX(noise_amp_spec[i] * noise_amp_spec[i], dd->eps);
+		/* Мгновенный SNR по Скалару-Филхо: апостериорный SNR - 1, ограниченный снизу. */
+		SNR_post = noisy_speech_power_spec / dd->noise_power_spec[i];
+		dd->SNR_inst[i] = HSV_MAX(SNR_post - 1.0, dd->floor);
+		/* Априорный SNR по методу принятия решений Эфраима-Малаха. */
+		dd->SNR_prio_dd[i] = dd->beta * ((dd->speech_amp_spec_prev[i] * dd->speech_amp_spec_prev[i]) / dd->noise_power_spec[i]) +
+			(1.0 - dd->beta) * dd->SNR_inst[i];
+		/* Коэффициенты фильтра Винера. */
+		dd->G_dd[i] = dd->SNR_prio_dd[i] / (dd->SNR_prio_dd[i] + 1.0);
+	}
+}
+
+KERNELS_INLINE void int16_to_numeric_n(const int16_t*in, unsigned stride, hsv_numeric_t*out, unsigned n)
+{
+	static const hsv_numeric_t one = 1.0;
+	static const hsv_numeric_t max_int16_inv = one / INT16_MAX;
+	static const hsv_numeric_t min_int16_inv = one / INT16_MIN;
+
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		int16_t v = in[i * stride];
+		out[i] = v * ((v > 0) ? max_int16_inv : -min_int16_inv);
+	}
+}
+
+KERNELS_INLINE void numeric_to_int16_n(const hsv_numeric_t*in, int16_t*out, unsigned stride, unsigned n)
+{
+	static const hsv_numeric_t half = 0.5;
+
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		hsv_numeric_t v = in[i];
+		if (v > 0) {
+			out[i * stride] = (v >= 1) ? INT16_MAX : ((int16_t) (v * INT16_MAX + half));
+		} else {
+			out[i * stride] = (v <= -1) ? INT16_MIN : ((int16_t) (-v * INT16_MIN - half));
+		}
+	}
+}
+
+/*
+ * 16-битные форматы хранения (см. enum KERNELS_STORAGE) преобразуются через float целочисленными операциями:
+ * ветви вычисляются обе и выбираются сравнением, поэтому циклы векторизуются на любом наборе инструкций,
+ * а результат совпадает с инструкциями F16C и не зависит от набора.
+ */
+KERNELS_INLINE uint32_t float_bits(float f)
+{
+	uint32_t u;
+
+	memcpy(&u, &f, sizeof(u));
+	return u;
+}
+
+KERNELS_INLINE float bits_float(uint32_t u)
+{
+	float f;
+
+	memcpy(&f, &u, sizeof(f));
+	return f;
+}
+
+KERNELS_INLINE void numeric_to_fp16_n(const hsv_numeric_t*in, uint16_t*out, unsigned n, hsv_numeric_t scale)
+{
+	static const float fp16_max = 65504.0f;
+	static const float half = 0.5f;
+
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		float v = (float) (in[i] * scale);
+		uint32_t u, a, sub, norm;
+
+		v = (v > fp16_max) ? fp16_max : v;
+		v = (v < -fp16_max) ? -fp16_max : v;
+
+		u = float_bits(v);
+		a = u & 0x7FFFFFFFu;
+		/* Меньше 2^-14 - денормализованное binary16: округление выполняет сложение с 0.5 (мантисса 0.5 - шаг 2^-24). */
+		sub = float_bits(bits_float(a) + half) - float_bits(half);
+		/* Нормализованное: смещение порядка 127 - 15 и округление 13 младших бит мантиссы к четному. */
+		norm = (a + 0xC8000FFFu + ((a >> 13) & 1u)) >> 13;
+
+		out[i] = (uint16_t) (((u >> 16) & 0x8000u) | ((a < 0x38800000u) ? sub : norm));
+	}
+}
+
+KERNELS_INLINE void fp16_to_numeric_n(const uint16_t*in, hsv_numeric_t*out, unsigned n, hsv_numeric_t scale)
+{
+	static const float fp16_sub_step = 5.9604644775390625e-8f; /* 2^-24 */
+
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		uint32_t h = in[i];
+		uint32_t e = (h >> 10) & 0x1Fu;
+		uint32_t m = h & 0x3FFu;
+		uint32_t sub = float_bits((float) m * fp16_sub_step);
+		uint32_t norm = ((e + 112u) << 23) | (m << 13);
+
+		out[i] = (hsv_numeric_t) bits_float(((h & 0x8000u) << 16) | ((e == 0) ? sub : norm)) * scale;
+	}
+}
+
+KERNELS_INLINE void numeric_to_bf16_n(const hsv_numeric_t*in, uint16_t*out, unsigned n)
+{
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		uint32_t u = float_bits((float) in[i]);
+		out[i] = (uint16_t) ((u + 0x7FFFu + ((u >> 16) & 1u)) >> 16);
+	}
+}
+
+KERNELS_INLINE void bf16_to_numeric_n(const uint16_t*in, hsv_numeric_t*out, unsigned n)
+{
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		out[i] = (hsv_numeric_t) bits_float(((uint32_t) in[i]) << 16);
+	}
+}
+
+static void ct_permute(hsv_numeric_t*real, hsv_numeric_t*imag, const unsigned*rev_tab, unsigned n)
+{
+	KERNELS_SIZED(n, ct_permute_n(real, imag, rev_tab, KN));
+}
+
+static void ct_butterflies(hsv_numeric_t*real, hsv_numeric_t*imag, const hsv_numeric_t*cos_tab, const hsv_numeric_t*sin_tab, unsigned n)
+{
+	KERNELS_SIZED(n, ct_butterflies_n(real, imag, cos_tab, sin_tab, KN));
+}
+
+static void chirp(const hsv_numeric_t*real, const hsv_numeric_t*imag, const hsv_numeric_t*cos_tab, const hsv_numeric_t*sin_tab,
+	hsv_numeric_t*out_real, hsv_numeric_t*out_imag, unsigned n)
+{
+	KERNELS_SIZED(n, chirp_n(real, imag, cos_tab, sin_tab, out_real, out_imag, KN));
+}
+
+static void complex_mul(hsv_numeric_t*a_real, hsv_numeric_t*a_imag, const hsv_numeric_t*b_real, const hsv_numeric_t*b_imag, unsigned n)
+{
+	KERNELS_SIZED(n, complex_mul_n(a_real, a_imag, b_real, b_imag, KN));
+}
+
+static void scale_div(const hsv_numeric_t*in, hsv_numeric_t d, hsv_numeric_t*out, unsigned n)
+{
+	KERNELS_SIZED(n, scale_div_n(in, d, out, KN));
+}
+
+static void windowing(const hsv_numeric_t*window, const hsv_numeric_t*in, hsv_numeric_t*out, unsigned n)
+{
+	KERNELS_SIZED(n, windowing_n(window, in, out, KN));
+}
+
+static void amp_spec(const hsv_numeric_t*real, const hsv_numeric_t*imag, hsv_numeric_t*amp_spec, unsigned n)
+{
+	KERNELS_SIZED(n, amp_spec_n(real, imag, amp_spec, KN));
+}
+
+static void power_spec(const hsv_numeric_t*real, const hsv_numeric_t*imag, hsv_numeric_t*power_spec, unsigned n)
+{
+	KERNELS_SIZED(n, power_spec_n(real, imag, power_spec, KN));
+}
+
+static void mcra_update(const struct KERNELS_MCRA*m, const hsv_numeric_t*P, unsigned n)
+{
+	KERNELS_SIZED(n, mcra_update_n(m, P, KN));
+}
+
+static void dd_gain(const struct KERNELS_DD*dd, const hsv_numeric_t*noisy_speech_amp_spec, const hsv_numeric_t*noise_amp_spec, unsigned n)
+{
+	KERNELS_SIZED(n, dd_gain_n(dd, noisy_speech_amp_spec, noise_amp_spec, KN));
+}
+
+static void int16_to_numeric(const int16_t*in, unsigned stride, hsv_numeric_t*out, unsigned n)
+{
+	KERNELS_STRIDED(stride, KERNELS_SIZED(n, int16_to_numeric_n(in, KS, out, KN)));
+}
+
+static void numeric_to_int16(const hsv_numeric_t*in, int16_t*out, unsigned stride, unsigned n)
+{
+	KERNELS_STRIDED(stride, numeric_to_int16_n(in, out, KS, n));
+}
+
+static void numeric_to_fp16(const hsv_numeric_t*in, uint16_t*out, unsigned n, hsv_numeric_t scale)
+{
+	KERNELS_SIZED(n, numeric_to_fp16_n(in, out, KN, scale));
+}
+
+static void fp16_to_numeric(const uint16_t*in, hsv_numeric_t*out, unsigned n, hsv_numeric_t scale)
+{
+	KERNELS_SIZED(n, fp16_to_numeric_n(in, out, KN, scale));
+}
+
+static void numeric_to_bf16(const hsv_numeric_t*in, uint16_t*out, unsigned n)
+{
+	KERNELS_SIZED(n, numeric_to_bf16_n(in, out, KN));
+}
+
+static void bf16_to_numeric(const uint16_t*in, hsv_numeric_t*out, unsigned n)
+{
+	KERNELS_SIZED(n, bf16_to_numeric_n(in, out, KN));
+}
+
+const struct KERNELS KERNELS_TABLE = {
+	KERNELS_STR(KERNELS_ISA),
+	ct_permute,
+	ct_butterflies,
+	chirp,
+	complex_mul,
+	scale_div,
+	windowing,
+	amp_spec,
+	power_spec,
+	mcra_update,
+	dd_gain,
+	int16_to_numeric,
+	numeric_to_int16,
+	numeric_to_fp16,
+	fp16_to_numeric,
+	numeric_to_bf16,
+	bf16_to_numeric,
+};
+/**
+ * /}
+ */
@@ -0,0 +1,205 @@
+/**
+ * \file pool.c
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Реализация API пула потоков.
+ */
+/**
+ * \ingroup pool
+ * \{
+ */
+#include "pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+pool_t create_pool()
+{
+	pool_t pool;
+
+	pool = (pool_t) calloc(1, sizeof(struct POOL));
+	return pool;
+}
+
+enum POOL_CODE pool_config(pool_t pool, unsigned n_workers, arena_t arena)
+{
+	enum POOL_CODE r;
+
+	pool->arena = arena;
+	pool->n_workers = (n_workers > 0) ? n_workers : 1;
+	pool->n_threads = 0;
+	pool->started = 0;
+
+	pool->workers = NULL;
+	if (pool->n_workers > 1) {
+		pool->workers = (struct POOL_WORKER*) arena_calloc(pool->arena, pool->n_workers - 1, sizeof(struct POOL_WORKER));
+		if (pool->workers == NULL) {
+			r = POOL_CODE_ALLOC_ERR;
+			goto err0;
+		}
+	}
+
+	pthread_mutex_init(&(pool->mutex), NULL);
+	pthread_cond_init(&(pool->start), NULL);
+	pthread_cond_init(&(pool->done), NULL);
+
+	pool->task = NULL;
+	pool->arg = NULL;
+	pool->n_tasks = 0;
+	pool->next = 0;
+	pool->n_done = 0;
+	pool->gen = 0;
+	pool->stop = 0;
+
+	return POOL_CODE_OK;
+
+ err0:
+	return r;
+}
+
+void pool_reserve(unsigned n_workers, arena_t arena)
+{
+	if (n_workers > 1) {
+		arena_reserve(arena, n_workers - 1, sizeof(struct POOL_WORKER));
+	}
+}
+
+/**
+ * Выполнение невыданных задач текущего запуска исполнителем worker (вызывается с захваченным mutex).
+ */
+static void pool_work(pool_t pool, unsigned worker)
+{
+	unsigned task;
+
+	while (pool->next < pool->n_tasks) {
+		task = pool->next++;
+
+		pthread_mutex_unlock(&(pool->mutex));
+		pool->task(pool->arg, task, worker);
+		pthread_mutex_lock(&(pool->mutex));
+
+		pool->n_done++;
+	}
+}
+
+static void*pool_thread(void*arg)
+{
+	struct POOL_WORKER*w = (struct POOL_WORKER*) arg;
+	pool_t pool = w->pool;
+
+	/* Потоки создаются до первого запуска, номер которого - 1. */
+	unsigned gen = 0;
+
+	pthread_mutex_lock(&(pool->mutex));
+	for (;;) {
+		while ((! pool->stop) && (pool->gen == gen)) {
+			pthread_cond_wait(&(pool->start), &(pool->mutex));
+		}
+		if (pool->stop) {
+			break;
+		}
+		gen = pool->gen;
+
+		fesetenv(&(pool->fenv));
+
+		pool_work(pool, w->worker);
+		if (pool->n_done == pool->n_tasks) {
+			pthread_cond_signal(&(pool->done));
+		}
+	}
+	pthread_mutex_unlock(&(pool->mutex));
+
+	return NULL;
+}
+
+/**
+ * Создание потоков исполнителей. Если поток создать не удалось, пул работает с уже созданными.
+ */
+static void pool_start(pool_t pool)
+{
+	unsigned k;
+
+	pool->started = 1;
+
+	for (k = 0; k + 1 < pool->n_workers; k++) {
+		pool->workers[k].pool = pool;
+		pool->workers[k].worker = k + 1;
+		if (pthread_create(&(pool->workers[k].thread), NULL, pool_thread, pool->workers + k) != 0) {
+			break;
+		}
+		pool->n_threads++;
+	}
+}
+
+void pool_run(pool_t pool, pool_task_t task, void*arg, unsigned n_tasks)
+{
+	unsigned k;
+
+	if ((pool->n_workers > 1) && (n_tasks > 1)) {
+		pthread_mutex_lock(&(pool->mutex));
+		if (! pool->started) {
+			pool_start(pool);
+		}
+		if (pool->n_threads == 0) {
+			pthread_mutex_unlock(&(pool->mutex));
+		}
+	}
+
+	/* Одну задачу быстрее выполнить самому, чем будить потоки. */
+	if ((pool->n_threads == 0) || (n_tasks <= 1)) {
+		for (k = 0; k < n_tasks; k++) {
+			task(arg, k, 0);
+		}
+		return;
+	}
+
+	fegetenv(&(pool->fenv));
+
+	pool->task = task;
+	pool->arg = arg;
+	pool->n_tasks = n_tasks;
+	pool->next = 0;
+	pool->n_done = 0;
+	pool->gen++;
+	pthread_cond_broadcast(&(pool->start));
+
+	pool_work(pool, 0);
+	while (pool->n_done < pool->n_tasks) {
+		pthread_cond_wait(&(pool->done), &(pool->mutex));
+	}
+
+	pthread_mutex_unlock(&(pool->mutex));
+}
+
+void pool_deconfig(pool_t pool)
+{
+	unsigned k;
+
+	pthread_mutex_lock(&(pool->mutex));
+	pool->stop = 1;
+	pthread_cond_broadcast(&(pool->start));
+	pthread_mutex_unlock(&(pool->mutex));
+
+	for (k = 0; k < pool->n_threads; k++) {
+		pthread_join(pool->workers[k].thread, NULL);
+	}
+	pool->n_threads = 0;
+
+	pthread_cond_destroy(&(pool->done));
+	pthread_cond_destroy(&(pool->start));
+	pthread_mutex_destroy(&(pool->mutex));
+
+	arena_free(pool->arena, pool->workers);
+}
+
+void pool_clean(pool_t pool)
+{
+	memset(pool, '\0', sizeof(*pool));
+}
+
+void pool_free(pool_t pool)
+{
+	free(pool);
+}
+/**
+ * /}
+ */
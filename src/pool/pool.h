@@ -0,0 +1,132 @@
+/**
+ * \file pool.h
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief API пула потоков.
+ */
+/**
+ * \defgroup pool Модуль пула потоков.
+ * \{
+ */
+#ifndef POOL_H_INCLUDED
+#define POOL_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+#include <fenv.h>
+#include <pthread.h>
+
+#include "arena.h"
+
+/**
+ * Коды, возвращаемые методами pool_...
+ */
+enum POOL_CODE
+{
+	POOL_CODE_OK = 0,         /**< Метод успешно отработал. */
+	POOL_CODE_ALLOC_ERR = -1, /**< Ошибка выделения памяти. */
+};
+
+/**
+ * Задача пула.
+ * \param arg аргумент pool_run.
+ * \param task номер задачи (от 0 до n_tasks - 1).
+ * \param worker номер исполнителя (0 - поток, вызвавший pool_run): задачи одного исполнителя выполняются по очереди.
+ */
+typedef void (*pool_task_t)(void*arg, unsigned task, unsigned worker);
+
+struct POOL;
+
+/**
+ * Поток исполнителя пула.
+ */
+struct POOL_WORKER
+{
+	struct POOL*pool; /**< Пул потока.          */
+	unsigned worker;  /**< Номер исполнителя.   */
+	pthread_t thread; /**< Описатель потока.    */
+};
+
+/**
+ * Структура пула: n_workers - 1 потоков и поток, вызвавший pool_run, разбирают задачи по одной.
+ * Потоки создаются при первом вызове pool_run, поэтому пул, который ни разу не запускался
+ * (например, при измерении арены), потоков не создает. Если поток создать не удалось, задачи выполняются
+ * оставшимися исполнителями.
+ */
+struct POOL
+{
+	unsigned n_workers; /**< Число исполнителей вместе с вызывающим потоком.  */
+	unsigned n_threads; /**< Число созданных потоков.                         */
+	int started;        /**< Потоки уже создавались (при первом pool_run).    */
+
+	struct POOL_WORKER*workers; /**< Потоки исполнителей 1, ..., n_workers - 1. */
+
+	pthread_mutex_t mutex;
+	pthread_cond_t start; /**< Новый запуск или остановка пула. */
+	pthread_cond_t done;  /**< Все задачи запуска выполнены.    */
+
+	pool_task_t task;  /**< Задача текущего запуска.                                  */
+	void*arg;          /**< Аргумент задачи.                                          */
+	unsigned n_tasks;  /**< Число задач запуска.                                      */
+	unsigned next;     /**< Номер следующей невыданной задачи.                        */
+	unsigned n_done;   /**< Число выполненных задач.                                  */
+	unsigned gen;      /**< Номер запуска: потоки ждут его изменения.                 */
+	int stop;          /**< Потоки должны завершиться.                                */
+
+	fenv_t fenv; /**< Окружение вычислений с плавающей точкой вызывающего потока (см. pool_run). */
+
+	arena_t arena; /**< Арена, из которой выделены описатели потоков. */
+};
+
+typedef struct POOL* pool_t;
+
+/**
+ * Создание структуры пула.
+ * \return указатель на структуру пула (при ошибке - NULL).
+ */
+pool_t create_pool();
+
+/**
+ * Конфигурация пула.
+ * \param n_workers число исполнителей вместе с вызывающим потоком (1 - задачи выполняются вызывающим потоком).
+ * \param arena арена, из которой выделяются описатели потоков.
+ * \return результат конфигурирования.
+ */
+enum POOL_CODE pool_config(pool_t pool, unsigned n_workers, arena_t arena);
+
+/**
+ * Учет памяти pool_config в арене без конфигурации (см. arena_reserve).
+ */
+void pool_reserve(unsigned n_workers, arena_t arena);
+
+/**
+ * Выполнение задач 0, ..., n_tasks - 1 и ожидание их завершения (барьер).
+ * Исполнители работают в окружении вычислений с плавающей точкой вызывающего потока
+ * (режим округления, сброс денормализованных чисел в ноль).
+ */
+void pool_run(pool_t pool, pool_task_t task, void*arg, unsigned n_tasks);
+
+/**
+ * Остановка потоков и удаление всех внутренних динамических структур.
+ */
+void pool_deconfig(pool_t pool);
+
+/**
+ * Зануление структуры пула.
+ */
+void pool_clean(pool_t pool);
+
+/**
+ * Удаление структуры пула.
+ */
+void pool_free(pool_t pool);
+
+#ifdef __cplusplus
+}
+#endif  /* __cplusplus */
+
+#endif  /* POOL_H_INCLUDED */
+/**
+ * /}
+ */
@@ -20,11 +20,13 @@ rb_t create_rb()
 	return rb;
 }
 
-enum RB_CODE rb_config(rb_t rb, unsigned cap)
+enum RB_CODE rb_config(rb_t rb, unsigned cap, arena_t arena)
 {
 	enum RB_CODE r;
 
-	rb->data = (char*) calloc(cap, sizeof(char));
+	rb->arena = arena;
+
+	rb->data = (char*) arena_calloc(rb->arena, cap, sizeof(char));
 	if (rb->data == NULL) {
 		r = RB_CODE_ALLOC_ERR;
 		goto err0;
@@ -38,24 +40,9 @@ enum RB_CODE rb_config(rb_t rb, unsigned cap)
 	return r;
 }
 
-unsigned rb_len(const rb_t rb)
-{
-	return rb->len;
-}
-
-unsigned rb_cap(const rb_t rb)
-{
-	return rb->cap;
-}
-
-unsigned rb_idx_in(const rb_t rb)
-{
-	return rb->idx_in;
-}
-
-unsigned rb_idx_out(const rb_t rb)
+void rb_reserve(unsigned cap, arena_t arena)
 {
-	return rb->idx_out;
+	arena_reserve(arena, cap, sizeof(char));
 }
 
 enum RB_CODE rb_push(rb_t rb, const char*data, unsigned data_len)
@@ -103,7 +90,7 @@ unsigned rb_get(rb_t rb, char*data, unsigned data_cap)
 
 void rb_deconfig(rb_t rb)
 {
-	free(rb->data);
+	arena_free(rb->arena, rb->data);
 }
 
 void rb_clean(rb_t rb)
@@ -14,6 +14,8 @@
 extern "C" {
 #endif  /* __cplusplus */
 
+#include "arena.h"
+
 /**
  * Коды, возвращаемые методами rb_...
  */
@@ -36,6 +38,8 @@ struct RING_BUFFER
 
 	unsigned idx_in;  /**< Указатель на текущее место записи. */
 	unsigned idx_out; /**< Указатель на текущее место чтения. */
+
+	arena_t arena; /**< Арена, из которой выделены буферы. */
 };
 
 typedef struct RING_BUFFER* rb_t;
@@ -49,29 +53,48 @@ rb_t create_rb();
 /**
  * Конфигурация кольцевого буфера.
  * \param cap вместимость кольцевого буфера.
+ * \param arena арена, из которой выделяются буферы.
  * \return результат конфигурирования.
  */
-enum RB_CODE rb_config(rb_t rb, unsigned cap);
+enum RB_CODE rb_config(rb_t rb, unsigned cap, arena_t arena);
 
 /**
+ * Учет памяти rb_config в арене без конфигурации (см. arena_reserve).
+ */
+void rb_reserve(unsigned cap, arena_t arena);
+
+/**
+ * Методы доступа определены в заголовке, чтобы встраиваться в вычисления индексов сэмплов без LTO.
  * \return размер данных в буфере.
  */
-unsigned rb_len(const rb_t rb);
+static inline unsigned rb_len(const rb_t rb)
+{
+	return rb->len;
+}
 
 /**
  * \return вместимость данных в буфере.
  */
-unsigned rb_cap(const rb_t rb);
+static inline unsigned rb_cap(const rb_t rb)
+{
+	return rb->cap;
+}
 
 /**
  * \return индекс массива буфера, в который будут добавляться элементы.
  */
-unsigned rb_idx_in(const rb_t rb);
+static inline unsigned rb_idx_in(const rb_t rb)
+{
+	return rb->idx_in;
+}
 
 /**
  * \return индекс массива буфера, из которого будут браться элементы.
  */
-unsigned rb_idx_out(const rb_t rb);
+static inline unsigned rb_idx_out(const rb_t rb)
+{
+	return rb->idx_out;
+}
 
 /**
  * Запись данных в кольцевой буфер.
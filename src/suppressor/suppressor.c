@@ -14,6 +14,19 @@
 
 #include <math.h>
 
+#include "fastmath.h"
+#include "kernels.h"
+
+/*
+ * Режим подавления шума. При статической конфигурации (см. hsv_types.h) - постоянная,
+ * и компилятор оставляет только ветви заданного режима.
+ */
+#ifdef HSV_STATIC_MODE
+#define SUPPRESSOR_CONST_MODE(VAR) HSV_SYM_CAT(SUPPRESSOR_MODE_, HSV_STATIC_MODE)
+#else
+#define SUPPRESSOR_CONST_MODE(VAR) (VAR)
+#endif  /* HSV_STATIC_MODE */
+
 suppressor_t create_suppressor()
 {
 	suppressor_t sup;
@@ -22,98 +35,177 @@ suppressor_t create_suppressor()
 	return sup;
 }
 
-static enum SUPPRESSOR_CODE specsub_config(struct SUPPRESSOR_SPECSUB*specsub, unsigned sr, unsigned size)
+static enum SUPPRESSOR_CODE specsub_config(struct SUPPRESSOR_SPECSUB*specsub, unsigned sr, unsigned size, unsigned lanes, arena_t arena, arena_t scratch)
 {
 	const hsv_numeric_t power_exponent = 2.0;
 
+	enum SUPPRESSOR_CODE r;
+
+	PREFIX_UNUSED(arena);
+
 	specsub->sr = sr;
 	specsub->size = size;
+	specsub->lanes = lanes;
 
 	specsub->power_exponent = power_exponent;
 
+	specsub->noisy_speech_power_spec = (hsv_numeric_t*) arena_calloc(scratch, size, sizeof(hsv_numeric_t));
+	if (specsub->noisy_speech_power_spec == NULL) {
+		r = SUPPRESSOR_CODE_ALLOC_ERR;
+		goto err0;
+	}
+	specsub->noise_power_spec = (hsv_numeric_t*) arena_calloc(scratch, size, sizeof(hsv_numeric_t));
+	if (specsub->noise_power_spec == NULL) {
+		r = SUPPRESSOR_CODE_ALLOC_ERR;
+		goto err1;
+	}
+
+	specsub->lane_buf = NULL;
+	if (lanes > 1) {
+		specsub->lane_buf = (hsv_numeric_t*) arena_calloc(scratch, 3 * size, sizeof(hsv_numeric_t));
+		if (specsub->lane_buf == NULL) {
+			r = SUPPRESSOR_CODE_ALLOC_ERR;
+			goto err2;
+		}
+	}
+
 	return SUPPRESSOR_CODE_OK;
+
+ err2:
+	arena_free(scratch, specsub->noise_power_spec);
+ err1:
+	arena_free(scratch, specsub->noisy_speech_power_spec);
+ err0:
+	return r;
 }
 
-static void specsub_deconfig(struct SUPPRESSOR_SPECSUB*specsub)
+static void specsub_deconfig(struct SUPPRESSOR_SPECSUB*specsub, arena_t arena, arena_t scratch)
 {
-	PREFIX_UNUSED(specsub);
+	PREFIX_UNUSED(arena);
+
+	arena_free(scratch, specsub->lane_buf);
+	arena_free(scratch, specsub->noise_power_spec);
+	arena_free(scratch, specsub->noisy_speech_power_spec);
 }
 
-static enum SUPPRESSOR_CODE wiener_config(struct SUPPRESSOR_WIENER*wiener, unsigned sr, unsigned size)
+static void specsub_reserve(unsigned size, unsigned lanes, arena_t scratch)
+{
+	arena_reserve(scratch, size, sizeof(hsv_numeric_t));
+	arena_reserve(scratch, size, sizeof(hsv_numeric_t));
+	if (lanes > 1) {
+		arena_reserve(scratch, 3 * size, sizeof(hsv_numeric_t));
+	}
+}
+
+static enum SUPPRESSOR_CODE wiener_config(struct SUPPRESSOR_WIENER*wiener, unsigned sr, unsigned size, unsigned lanes, enum KERNELS_STORAGE storage,
+	arena_t arena, arena_t scratch)
 {
 	static const hsv_numeric_t beta = 0.98;
 	static const hsv_numeric_t floor = 0.01;
 
 	enum SUPPRESSOR_CODE r;
 
+	unsigned n = size * lanes;
+
 	wiener->sr = sr;
 	wiener->size = size;
+	wiener->lanes = lanes;
 
 	wiener->beta = beta;
 	wiener->floor = floor;
 
-	wiener->noise_power_spec = (hsv_numeric_t*) calloc(size, sizeof(hsv_numeric_t));
+	wiener->storage = storage;
+	wiener->speech_amp_spec_prev_half = NULL;
+
+	wiener->noise_power_spec = (hsv_numeric_t*) arena_calloc(scratch, n, sizeof(hsv_numeric_t));
 	if (wiener->noise_power_spec == NULL) {
 		r = SUPPRESSOR_CODE_ALLOC_ERR;
 		goto err0;
 	}
 
-	wiener->SNR_inst = (hsv_numeric_t*) calloc(size, sizeof(hsv_numeric_t));
+	wiener->SNR_inst = (hsv_numeric_t*) arena_calloc(scratch, n, sizeof(hsv_numeric_t));
 	if (wiener->SNR_inst == NULL) {
 		r = SUPPRESSOR_CODE_ALLOC_ERR;
 		goto err1;
 	}
-	wiener->SNR_prio_dd = (hsv_numeric_t*) calloc(size, sizeof(hsv_numeric_t));
+	wiener->SNR_prio_dd = (hsv_numeric_t*) arena_calloc(scratch, n, sizeof(hsv_numeric_t));
 	if (wiener->SNR_prio_dd == NULL) {
 		r = SUPPRESSOR_CODE_ALLOC_ERR;
 		goto err2;
 	}
-	wiener->G_dd = (hsv_numeric_t*) calloc(size, sizeof(hsv_numeric_t));
+	wiener->G_dd = (hsv_numeric_t*) arena_calloc(scratch, n, sizeof(hsv_numeric_t));
 	if (wiener->G_dd == NULL) {
 		r = SUPPRESSOR_CODE_ALLOC_ERR;
 		goto err3;
 	}
 	
-	wiener->speech_amp_spec = (hsv_numeric_t*) calloc(size, sizeof(hsv_numeric_t));
+	wiener->speech_amp_spec = (hsv_numeric_t*) arena_calloc(scratch, n, sizeof(hsv_numeric_t));
 	if (wiener->speech_amp_spec == NULL) {
 		r = SUPPRESSOR_CODE_ALLOC_ERR;
 		goto err4;
 	}
-	wiener->speech_amp_spec_prev = (hsv_numeric_t*) calloc(size, sizeof(hsv_numeric_t));
+	/* При 16-битном хранении прошлый спектр в hsv_numeric_t нужен только на время фрейма. */
+	wiener->speech_amp_spec_prev = (hsv_numeric_t*) arena_calloc((storage == KERNELS_STORAGE_NATIVE) ? arena : scratch, n, sizeof(hsv_numeric_t));
 	if (wiener->speech_amp_spec_prev == NULL) {
 		r = SUPPRESSOR_CODE_ALLOC_ERR;
 		goto err5;
 	}
+	wiener->speech_amp_spec_prev_exp = 0;
+	if (storage != KERNELS_STORAGE_NATIVE) {
+		wiener->speech_amp_spec_prev_half = (uint16_t*) arena_calloc(arena, n, sizeof(uint16_t));
+		if (wiener->speech_amp_spec_prev_half == NULL) {
+			r = SUPPRESSOR_CODE_ALLOC_ERR;
+			goto err6;
+		}
+	}
 
 	return SUPPRESSOR_CODE_OK;
 
+ err6:
+	arena_free(scratch, wiener->speech_amp_spec_prev);
  err5:
-	free(wiener->speech_amp_spec);
+	arena_free(scratch, wiener->speech_amp_spec);
  err4:
-	free(wiener->G_dd);
+	arena_free(scratch, wiener->G_dd);
  err3:
-	free(wiener->SNR_prio_dd);
+	arena_free(scratch, wiener->SNR_prio_dd);
  err2:
-	free(wiener->SNR_inst);
+	arena_free(scratch, wiener->SNR_inst);
  err1:
-	free(wiener->noise_power_spec);
+	arena_free(scratch, wiener->noise_power_spec);
  err0:
 	return r;
 }
 
-static void wiener_deconfig(struct SUPPRESSOR_WIENER*wiener)
+static void wiener_deconfig(struct SUPPRESSOR_WIENER*wiener, arena_t arena, arena_t scratch)
 {
-	free(wiener->speech_amp_spec_prev);
-	free(wiener->speech_amp_spec);
+	arena_free(arena, wiener->speech_amp_spec_prev_half);
+	arena_free((wiener->storage == KERNELS_STORAGE_NATIVE) ? arena : scratch, wiener->speech_amp_spec_prev);
+	arena_free(scratch, wiener->speech_amp_spec);
+
+	arena_free(scratch, wiener->G_dd);
+	arena_free(scratch, wiener->SNR_prio_dd);
+	arena_free(scratch, wiener->SNR_inst);
 
-	free(wiener->G_dd);
-	free(wiener->SNR_prio_dd);
-	free(wiener->SNR_inst);
+	arena_free(scratch, wiener->noise_power_spec);
+}
 
-	free(wiener->noise_power_spec);
+static void wiener_reserve(unsigned size, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch)
+{
+	/* noise_power_spec, SNR_inst, SNR_prio_dd, G_dd, speech_amp_spec. */
+	arena_reserve(scratch, size, sizeof(hsv_numeric_t));
+	arena_reserve(scratch, size, sizeof(hsv_numeric_t));
+	arena_reserve(scratch, size, sizeof(hsv_numeric_t));
+	arena_reserve(scratch, size, sizeof(hsv_numeric_t));
+	arena_reserve(scratch, size, sizeof(hsv_numeric_t));
+
+	arena_reserve((storage == KERNELS_STORAGE_NATIVE) ? arena : scratch, size, sizeof(hsv_numeric_t));
+	if (storage != KERNELS_STORAGE_NATIVE) {
+		arena_reserve(arena, size, sizeof(uint16_t));
+	}
 }
 
-static enum SUPPRESSOR_CODE gain_config(struct SUPPRESSOR_GAIN*gain, unsigned sr, unsigned size)
+static enum SUPPRESSOR_CODE gain_config(struct SUPPRESSOR_GAIN*gain, unsigned sr, unsigned size, unsigned lanes, arena_t arena, arena_t scratch)
 {
 	enum DFT_CODE dft_r;
 	
@@ -124,72 +216,95 @@ static enum SUPPRESSOR_CODE gain_config(struct SUPPRESSOR_GAIN*gain, unsigned sr
 	gain->L1 = size;
 	gain->L2 = gain->L1 / 2;
 	
-	dft_r = dft_config(&(gain->dft), size);
+	dft_r = dft_config(&(gain->dft), size, arena, scratch);
 	if (dft_r != DFT_CODE_OK) {
 		r = SUPPRESSOR_CODE_ALLOC_ERR;
 		goto err0;
 	}
-	gain->window = (hsv_numeric_t*) calloc(gain->L2, sizeof(hsv_numeric_t));
+	gain->window = (hsv_numeric_t*) arena_calloc(arena, gain->L2, sizeof(hsv_numeric_t));
 	if (gain->window == NULL) {
 		r = SUPPRESSOR_CODE_ALLOC_ERR;
 		goto err1;
 	}
 	init_window(gain->window, gain->L2, WINDOW_TYPE_HAMMING);
-	gain->impulse_response_before = (hsv_numeric_t*) calloc(size, sizeof(hsv_numeric_t));
+	gain->impulse_response_before = (hsv_numeric_t*) arena_calloc(scratch, size, sizeof(hsv_numeric_t));
 	if (gain->impulse_response_before == NULL) {
 		r = SUPPRESSOR_CODE_ALLOC_ERR;
 		goto err2;
 	}
-	gain->impulse_response_after = (hsv_numeric_t*) calloc(size, sizeof(hsv_numeric_t));
+	gain->impulse_response_after = (hsv_numeric_t*) arena_calloc(scratch, size, sizeof(hsv_numeric_t));
 	if (gain->impulse_response_after == NULL) {
 		r = SUPPRESSOR_CODE_ALLOC_ERR;
 		goto err3;
 	}
+	gain->lane_gain = NULL;
+	if (lanes > 1) {
+		gain->lane_gain = (hsv_numeric_t*) arena_calloc(scratch, size, sizeof(hsv_numeric_t));
+		if (gain->lane_gain == NULL) {
+			r = SUPPRESSOR_CODE_ALLOC_ERR;
+			goto err4;
+		}
+	}
 
 	return SUPPRESSOR_CODE_OK;
 
+ err4:
+	arena_free(scratch, gain->impulse_response_after);
  err3:
-	free(gain->impulse_response_before);
+	arena_free(scratch, gain->impulse_response_before);
  err2:
-	free(gain->window);
+	arena_free(arena, gain->window);
  err1:
 	dft_deconfig(&(gain->dft));
  err0:
 	return r;
 }
 
-static void gain_deconfig(struct SUPPRESSOR_GAIN*gain)
+static void gain_deconfig(struct SUPPRESSOR_GAIN*gain, arena_t arena, arena_t scratch)
 {
-	free(gain->impulse_response_after);
-	free(gain->impulse_response_before);
-	free(gain->window);
+	arena_free(scratch, gain->lane_gain);
+	arena_free(scratch, gain->impulse_response_after);
+	arena_free(scratch, gain->impulse_response_before);
+	arena_free(arena, gain->window);
 	dft_deconfig(&(gain->dft));
 }
 
-static enum SUPPRESSOR_CODE tsnr_config(struct SUPPRESSOR_TSNR*tsnr, unsigned sr, unsigned size, enum SUPPRESSOR_MODE mode)
+static void gain_reserve(unsigned size, unsigned lanes, arena_t arena, arena_t scratch)
+{
+	dft_reserve(size, arena, scratch);
+	arena_reserve(arena, size / 2, sizeof(hsv_numeric_t));
+	arena_reserve(scratch, size, sizeof(hsv_numeric_t));
+	arena_reserve(scratch, size, sizeof(hsv_numeric_t));
+	if (lanes > 1) {
+		arena_reserve(scratch, size, sizeof(hsv_numeric_t));
+	}
+}
+
+static enum SUPPRESSOR_CODE tsnr_config(struct SUPPRESSOR_TSNR*tsnr, unsigned sr, unsigned size, unsigned lanes, enum SUPPRESSOR_MODE mode,
+	enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch)
 {
 	enum SUPPRESSOR_CODE r;
 
 	tsnr->mode = mode;
 
-	r = wiener_config(&(tsnr->wiener), sr, size);
+	r = wiener_config(&(tsnr->wiener), sr, size, lanes, storage, arena, scratch);
 	if (r != SUPPRESSOR_CODE_OK) {
 		goto err0;
 	}
 
-	tsnr->SNR_prio_2_step = (hsv_numeric_t*) calloc(size, sizeof(hsv_numeric_t));
+	tsnr->SNR_prio_2_step = (hsv_numeric_t*) arena_calloc(scratch, size * lanes, sizeof(hsv_numeric_t));
 	if (tsnr->SNR_prio_2_step == NULL) {
 		r = SUPPRESSOR_CODE_ALLOC_ERR;
 		goto err1;
 	}
-	tsnr->G_2_step = (hsv_numeric_t*) calloc(size, sizeof(hsv_numeric_t));
+	tsnr->G_2_step = (hsv_numeric_t*) arena_calloc(scratch, size * lanes, sizeof(hsv_numeric_t));
 	if (tsnr->G_2_step == NULL) {
 		r = SUPPRESSOR_CODE_ALLOC_ERR;
 		goto err2;
 	}
 
 	if ((mode == SUPPRESSOR_MODE_TSNR_G) || (mode == SUPPRESSOR_MODE_RTSNR_G)) {
-		r = gain_config(&(tsnr->gain), sr, size);
+		r = gain_config(&(tsnr->gain), sr, size, lanes, arena, scratch);
 		if (r != SUPPRESSOR_CODE_OK) {
 			goto err3;
 		}
@@ -198,48 +313,120 @@ static enum SUPPRESSOR_CODE tsnr_config(struct SUPPRESSOR_TSNR*tsnr, unsigned sr
 	return SUPPRESSOR_CODE_OK;
 
  err3:
-	free(tsnr->G_2_step);
+	arena_free(scratch, tsnr->G_2_step);
  err2:
-	free(tsnr->SNR_prio_2_step);
+	arena_free(scratch, tsnr->SNR_prio_2_step);
  err1:
-	wiener_deconfig(&(tsnr->wiener));
+	wiener_deconfig(&(tsnr->wiener), arena, scratch);
  err0:
 	return r;
 }
 
-static void tsnr_deconfig(struct SUPPRESSOR_TSNR*tsnr)
+static void tsnr_deconfig(struct SUPPRESSOR_TSNR*tsnr, arena_t arena, arena_t scratch)
 {
 	if ((tsnr->mode == SUPPRESSOR_MODE_TSNR_G) || (tsnr->mode == SUPPRESSOR_MODE_RTSNR_G)) {
-		gain_deconfig(&(tsnr->gain));
+		gain_deconfig(&(tsnr->gain), arena, scratch);
 	}
 
-	free(tsnr->G_2_step);
-	free(tsnr->SNR_prio_2_step);
+	arena_free(scratch, tsnr->G_2_step);
+	arena_free(scratch, tsnr->SNR_prio_2_step);
 
-	wiener_deconfig(&(tsnr->wiener));
+	wiener_deconfig(&(tsnr->wiener), arena, scratch);
 }
 
-enum SUPPRESSOR_CODE suppressor_config(suppressor_t sup, unsigned sr, unsigned size, enum SUPPRESSOR_MODE mode)
+static void tsnr_reserve(unsigned size, unsigned lanes, enum SUPPRESSOR_MODE mode, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch)
+{
+	wiener_reserve(size * lanes, storage, arena, scratch);
+
+	arena_reserve(scratch, size * lanes, sizeof(hsv_numeric_t));
+	arena_reserve(scratch, size * lanes, sizeof(hsv_numeric_t));
+
+	if ((mode == SUPPRESSOR_MODE_TSNR_G) || (mode == SUPPRESSOR_MODE_RTSNR_G)) {
+		gain_reserve(size, lanes, arena, scratch);
+	}
+}
+
+static enum SUPPRESSOR_CODE bark_config(struct SUPPRESSOR_BARK*bark, unsigned sr, const struct BANDS*bands, enum KERNELS_STORAGE storage,
+	arena_t arena, arena_t scratch)
+{
+	enum SUPPRESSOR_CODE r;
+
+	bark->bands = bands;
+
+	r = wiener_config(&(bark->wiener), sr, bands->n_bands, 1, storage, arena, scratch);
+	if (r != SUPPRESSOR_CODE_OK) {
+		goto err0;
+	}
+
+	bark->noisy_speech_amp_spec = (hsv_numeric_t*) arena_calloc(scratch, bands->n_bands, sizeof(hsv_numeric_t));
+	if (bark->noisy_speech_amp_spec == NULL) {
+		r = SUPPRESSOR_CODE_ALLOC_ERR;
+		goto err1;
+	}
+	bark->speech_amp_spec = (hsv_numeric_t*) arena_calloc(scratch, bands->n_bands, sizeof(hsv_numeric_t));
+	if (bark->speech_amp_spec == NULL) {
+		r = SUPPRESSOR_CODE_ALLOC_ERR;
+		goto err2;
+	}
+
+	return SUPPRESSOR_CODE_OK;
+
+ err2:
+	arena_free(scratch, bark->noisy_speech_amp_spec);
+ err1:
+	wiener_deconfig(&(bark->wiener), arena, scratch);
+ err0:
+	return r;
+}
+
+static void bark_deconfig(struct SUPPRESSOR_BARK*bark, arena_t arena, arena_t scratch)
+{
+	arena_free(scratch, bark->speech_amp_spec);
+	arena_free(scratch, bark->noisy_speech_amp_spec);
+
+	wiener_deconfig(&(bark->wiener), arena, scratch);
+}
+
+static void bark_reserve(unsigned n_bands, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch)
+{
+	wiener_reserve(n_bands, storage, arena, scratch);
+
+	arena_reserve(scratch, n_bands, sizeof(hsv_numeric_t));
+	arena_reserve(scratch, n_bands, sizeof(hsv_numeric_t));
+}
+
+static enum SUPPRESSOR_CODE suppressor_config_impl(suppressor_t sup, unsigned sr, unsigned size, unsigned lanes, enum SUPPRESSOR_MODE mode,
+	const struct BANDS*bands, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch)
 {
 	enum SUPPRESSOR_CODE r;
 
 	sup->sr = sr;
 	sup->size = size;
+	sup->lanes = lanes;
+	sup->arena = arena;
+	sup->scratch = scratch;
 
 	sup->mode = mode;
 
 	switch (mode) {
 	case SUPPRESSOR_MODE_SPECSUB:
-		r = specsub_config(&(sup->specsub), sr, size);
+		r = specsub_config(&(sup->specsub), sr, size, lanes, arena, scratch);
 		break;
 	case SUPPRESSOR_MODE_WIENER:
-		r = wiener_config(&(sup->wiener), sr, size);
+		r = wiener_config(&(sup->wiener), sr, size, lanes, storage, arena, scratch);
 		break;
 	case SUPPRESSOR_MODE_TSNR:
 	case SUPPRESSOR_MODE_TSNR_G:
 	case SUPPRESSOR_MODE_RTSNR:
 	case SUPPRESSOR_MODE_RTSNR_G:
-		r = tsnr_config(&(sup->tsnr), sr, size, mode);
+		r = tsnr_config(&(sup->tsnr), sr, size, lanes, mode, storage, arena, scratch);
+		break;
+	case SUPPRESSOR_MODE_BARK:
+		/* Полосы потоков не чередуются. */
+		if ((bands == NULL) || (lanes > 1)) {
+			return SUPPRESSOR_CODE_INVALID_MODE;
+		}
+		r = bark_config(&(sup->bark), sr, bands, storage, arena, scratch);
 		break;
 	default:
 		return SUPPRESSOR_CODE_INVALID_MODE;
@@ -249,34 +436,103 @@ enum SUPPRESSOR_CODE suppressor_config(suppressor_t sup, unsigned sr, unsigned s
 		goto err0;
 	}
 
-	sup->speech_amp_spec = (hsv_numeric_t*) calloc(size, sizeof(hsv_numeric_t));
+	sup->speech_amp_spec = (hsv_numeric_t*) arena_calloc(scratch, size * lanes, sizeof(hsv_numeric_t));
 	if (sup->speech_amp_spec == NULL) {
 		r = SUPPRESSOR_CODE_ALLOC_ERR;
 		goto err1;
 	}
 
+	sup->gain = (hsv_numeric_t*) arena_calloc(arena, size * lanes, sizeof(hsv_numeric_t));
+	if (sup->gain == NULL) {
+		r = SUPPRESSOR_CODE_ALLOC_ERR;
+		goto err2;
+	}
+
 	return SUPPRESSOR_CODE_OK;
 
+ err2:
+	arena_free(scratch, sup->speech_amp_spec);
  err1:
 	switch (sup->mode) {
 	case SUPPRESSOR_MODE_SPECSUB:
-		specsub_deconfig(&(sup->specsub));
+		specsub_deconfig(&(sup->specsub), arena, scratch);
 		break;
 	case SUPPRESSOR_MODE_WIENER:
-		wiener_deconfig(&(sup->wiener));
+		wiener_deconfig(&(sup->wiener), arena, scratch);
 		break;
 	case SUPPRESSOR_MODE_TSNR:
 	case SUPPRESSOR_MODE_TSNR_G:
 	case SUPPRESSOR_MODE_RTSNR:
 	case SUPPRESSOR_MODE_RTSNR_G:
-		tsnr_deconfig(&(sup->tsnr));
+		tsnr_deconfig(&(sup->tsnr), arena, scratch);
+		break;
+	case SUPPRESSOR_MODE_BARK:
+		bark_deconfig(&(sup->bark), arena, scratch);
 		break;
 	}
  err0:
 	return r;
 }
 
-static hsv_numeric_t specsub_calculate_SNR_post(const hsv_numeric_t*noisy_speech_amp_spec, const hsv_numeric_t*noise_amp_spec, unsigned size)
+enum SUPPRESSOR_CODE suppressor_config(suppressor_t sup, unsigned sr, unsigned size, enum SUPPRESSOR_MODE mode, enum KERNELS_STORAGE storage,
+	arena_t arena, arena_t scratch)
+{
+	return suppressor_config_impl(sup, sr, size, 1, mode, NULL, storage, arena, scratch);
+}
+
+enum SUPPRESSOR_CODE suppressor_config_lanes(suppressor_t sup, unsigned sr, unsigned size, unsigned lanes, enum SUPPRESSOR_MODE mode,
+	enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch)
+{
+	return suppressor_config_impl(sup, sr, size, lanes, mode, NULL, storage, arena, scratch);
+}
+
+enum SUPPRESSOR_CODE suppressor_config_bands(suppressor_t sup, unsigned sr, unsigned size, const struct BANDS*bands, enum KERNELS_STORAGE storage,
+	arena_t arena, arena_t scratch)
+{
+	return suppressor_config_impl(sup, sr, size, 1, SUPPRESSOR_MODE_BARK, bands, storage, arena, scratch);
+}
+
+enum SUPPRESSOR_CODE suppressor_reserve_lanes(unsigned size, unsigned lanes, enum SUPPRESSOR_MODE mode, enum KERNELS_STORAGE storage,
+	arena_t arena, arena_t scratch)
+{
+	switch (mode) {
+	case SUPPRESSOR_MODE_SPECSUB:
+		specsub_reserve(size, lanes, scratch);
+		break;
+	case SUPPRESSOR_MODE_WIENER:
+		wiener_reserve(size * lanes, storage, arena, scratch);
+		break;
+	case SUPPRESSOR_MODE_TSNR:
+	case SUPPRESSOR_MODE_TSNR_G:
+	case SUPPRESSOR_MODE_RTSNR:
+	case SUPPRESSOR_MODE_RTSNR_G:
+		tsnr_reserve(size, lanes, mode, storage, arena, scratch);
+		break;
+	default:
+		/* SUPPRESSOR_MODE_BARK требует полос (suppressor_reserve_bands). */
+		return SUPPRESSOR_CODE_INVALID_MODE;
+	}
+
+	arena_reserve(scratch, size * lanes, sizeof(hsv_numeric_t));
+	arena_reserve(arena, size * lanes, sizeof(hsv_numeric_t));
+
+	return SUPPRESSOR_CODE_OK;
+}
+
+enum SUPPRESSOR_CODE suppressor_reserve(unsigned size, enum SUPPRESSOR_MODE mode, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch)
+{
+	return suppressor_reserve_lanes(size, 1, mode, storage, arena, scratch);
+}
+
+void suppressor_reserve_bands(unsigned size, unsigned n_bands, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch)
+{
+	bark_reserve(n_bands, storage, arena, scratch);
+
+	arena_reserve(scratch, size, sizeof(hsv_numeric_t));
+	arena_reserve(arena, size, sizeof(hsv_numeric_t));
+}
+
+static hsv_numeric_t specsub_calculate_SNR_post(const hsv_numeric_t*noisy_speech_amp_spec, const hsv_numeric_t*noise_amp_spec, unsigned size, int fast_math, hsv_numeric_t eps)
 {
 	unsigned k;
 
@@ -288,7 +544,11 @@ static hsv_numeric_t specsub_calculate_SNR_post(const hsv_numeric_t*noisy_speech
 		noise_power += noise_amp_spec[k] * noise_amp_spec[k];
 	}
 
-	return 10.0 * HSV_LOG10(noisy_speech_power / noise_power);
+	/* На цифровой тишине обе мощности нулевые. */
+	noisy_speech_power = HSV_MAX(noisy_speech_power, eps);
+	noise_power = HSV_MAX(noise_power, eps);
+
+	return 10.0 * (fast_math ? fastmath_log10(noisy_speech_power / noise_power) : HSV_LOG10(noisy_speech_power / noise_power));
 }
 
 static hsv_numeric_t specsub_calculate_alpha(hsv_numeric_t snr_post)
@@ -325,17 +585,33 @@ static hsv_numeric_t specsub_calculate_beta(hsv_numeric_t snr_post)
 	return beta;
 }
 
-static void specsub_run(struct SUPPRESSOR_SPECSUB*specsub, const hsv_numeric_t*noisy_speech_amp_spec, const hsv_numeric_t*noise_amp_spec, hsv_numeric_t*out)
+/**
+ * Спектральное вычитание одного потока (непрерывные спектры размера size).
+ */
+static void specsub_run_lane(struct SUPPRESSOR_SPECSUB*specsub, const hsv_numeric_t*noisy_speech_amp_spec, const hsv_numeric_t*noise_amp_spec, hsv_numeric_t*out, int fast_math, hsv_numeric_t eps)
 {
 	unsigned k;
 
 	/* Апостериорный SNR. */
-	unsigned SNR_post = specsub_calculate_SNR_post(noisy_speech_amp_spec, noise_amp_spec, specsub->size);
+	unsigned SNR_post = specsub_calculate_SNR_post(noisy_speech_amp_spec, noise_amp_spec, specsub->size, fast_math, eps);
 	/* alpha является основным параметром вычитания. */
 	hsv_numeric_t alpha = specsub_calculate_alpha(SNR_post);
 	/* beta маскиррует "музыкальный шум" с помощью остаточного шума. */
 	hsv_numeric_t beta = specsub_calculate_beta(SNR_post);
 
+	if (fast_math) {
+		/* Степени вычисляются над массивами целиком, цикл вычитания остается без вызовов функций. */
+		fastmath_pow(noisy_speech_amp_spec, specsub->power_exponent, specsub->noisy_speech_power_spec, specsub->size);
+		fastmath_pow(noise_amp_spec, specsub->power_exponent, specsub->noise_power_spec, specsub->size);
+		for (k = 0; k < specsub->size; k++) {
+			hsv_numeric_t Y = specsub->noisy_speech_power_spec[k];
+			hsv_numeric_t N = specsub->noise_power_spec[k];
+			specsub->noisy_speech_power_spec[k] = (Y > (alpha + beta) * N) ? (Y - alpha * N) : (beta * N);
+		}
+		fastmath_pow(specsub->noisy_speech_power_spec, 1.0 / specsub->power_exponent, out, specsub->size);
+		return;
+	}
+
 	for (k = 0; k < specsub->size; k++) {
 		hsv_numeric_t tmp;
 		if (HSV_POW(noisy_speech_amp_spec[k], specsub->power_exponent) > (alpha + beta) * HSV_POW(noise_amp_spec[k], specsub->power_exponent)) {
@@ -350,37 +626,72 @@ static void specsub_run(struct SUPPRESSOR_SPECSUB*specsub, const hsv_numeric_t*n
 	}
 }
 
-static void wiener_run(struct SUPPRESSOR_WIENER*wiener, const hsv_numeric_t*noisy_speech_amp_spec, const hsv_numeric_t*noise_amp_spec, hsv_numeric_t*out)
+/**
+ * Спектральное вычитание: параметры вычитания зависят от SNR всего фрейма, поэтому при нескольких потоках
+ * спектры каждого потока собираются в непрерывные буферы и обрабатываются так же, как один поток.
+ */
+static void specsub_run(struct SUPPRESSOR_SPECSUB*specsub, const hsv_numeric_t*noisy_speech_amp_spec, const hsv_numeric_t*noise_amp_spec, hsv_numeric_t*out, int fast_math, hsv_numeric_t eps)
 {
-	unsigned i;
+	unsigned size = specsub->size;
+	unsigned lanes = specsub->lanes;
 
-	/* Вычисление спектра мощности шума. */
-	for (i = 0; i < wiener->size; i++) {
-		wiener->noise_power_spec[i] = noise_amp_spec[i] * noise_amp_spec[i];
-	}
-	/* Вычисление мгновенного SNR по Скалару-Филхо: мгновенный SNR_inst = апостериорный SNR - 1.
-	   Минимальное значение используется для уменьшения искажения сигнала. */
-	for (i = 0; i < wiener->size; i++) {
-		hsv_numeric_t noisy_speech_power_spec = noisy_speech_amp_spec[i] * noisy_speech_amp_spec[i];
-		hsv_numeric_t SNR_post = noisy_speech_power_spec / wiener->noise_power_spec[i];
-		wiener->SNR_inst[i] = HSV_MAX(SNR_post - 1.0, wiener->floor);
-	}
-	/* Вычисление априорного SNR по методу принятия решений Эфраима-Малаха. */
-	for (i = 0; i < wiener->size; i++) {
-		wiener->SNR_prio_dd[i] = wiener->beta * ((wiener->speech_amp_spec_prev[i] * wiener->speech_amp_spec_prev[i]) / wiener->noise_power_spec[i]) +
-			(1.0 - wiener->beta) * wiener->SNR_inst[i];
+	hsv_numeric_t*lane_noisy = specsub->lane_buf;
+	hsv_numeric_t*lane_noise = specsub->lane_buf + size;
+	hsv_numeric_t*lane_out = specsub->lane_buf + 2 * size;
+
+	unsigned k, l;
+
+	if (lanes == 1) {
+		specsub_run_lane(specsub, noisy_speech_amp_spec, noise_amp_spec, out, fast_math, eps);
+		return;
 	}
-	/* Вычисление коэффициентов фильтра Винера. */
-	for (i = 0; i < wiener->size; i++) {
-		wiener->G_dd[i] = wiener->SNR_prio_dd[i] / (wiener->SNR_prio_dd[i] + 1.0);
+
+	for (l = 0; l < lanes; l++) {
+		for (k = 0; k < size; k++) {
+			lane_noisy[k] = noisy_speech_amp_spec[k * lanes + l];
+			lane_noise[k] = noise_amp_spec[k * lanes + l];
+		}
+		specsub_run_lane(specsub, lane_noisy, lane_noise, lane_out, fast_math, eps);
+		for (k = 0; k < size; k++) {
+			out[k * lanes + l] = lane_out[k];
+		}
 	}
+}
+
+/**
+ * Коэффициенты фильтра Винера методом принятия решений (см. struct KERNELS_DD).
+ */
+static void wiener_dd_gain(struct SUPPRESSOR_WIENER*wiener, const hsv_numeric_t*noisy_speech_amp_spec, const hsv_numeric_t*noise_amp_spec, hsv_numeric_t eps)
+{
+	struct KERNELS_DD dd;
+
+	dd.beta = wiener->beta;
+	dd.floor = wiener->floor;
+	dd.eps = eps;
+	dd.speech_amp_spec_prev = wiener->speech_amp_spec_prev;
+	dd.noise_power_spec = wiener->noise_power_spec;
+	dd.SNR_inst = wiener->SNR_inst;
+	dd.SNR_prio_dd = wiener->SNR_prio_dd;
+	dd.G_dd = wiener->G_dd;
+	hsv_kernels->dd_gain(&dd, noisy_speech_amp_spec, noise_amp_spec, wiener->size * wiener->lanes);
+}
+
+static void wiener_run(struct SUPPRESSOR_WIENER*wiener, const hsv_numeric_t*noisy_speech_amp_spec, const hsv_numeric_t*noise_amp_spec, hsv_numeric_t*out, hsv_numeric_t eps)
+{
+	unsigned n = wiener->size * wiener->lanes;
+
+	unsigned i;
+
+	/* Спектр мощности шума, мгновенный SNR по Скалару-Филхо, априорный SNR по методу принятия решений
+	   Эфраима-Малаха и коэффициенты фильтра Винера. */
+	wiener_dd_gain(wiener, noisy_speech_amp_spec, noise_amp_spec, eps);
 	/* Винеровская фильтрация. */
-	for (i = 0; i < wiener->size; i++) {
+	for (i = 0; i < n; i++) {
 		wiener->speech_amp_spec[i] = wiener->G_dd[i] * noisy_speech_amp_spec[i];
 	}
 
-	memcpy(wiener->speech_amp_spec_prev, wiener->speech_amp_spec, wiener->size * sizeof(hsv_numeric_t));
-	memcpy(out, wiener->speech_amp_spec, wiener->size * sizeof(hsv_numeric_t));
+	memcpy(wiener->speech_amp_spec_prev, wiener->speech_amp_spec, n * sizeof(hsv_numeric_t));
+	memcpy(out, wiener->speech_amp_spec, n * sizeof(hsv_numeric_t));
 }
 
 static void suppressor_gain(struct SUPPRESSOR_GAIN*gain, hsv_numeric_t*G_2_step)
@@ -425,39 +736,51 @@ static void suppressor_gain(struct SUPPRESSOR_GAIN*gain, hsv_numeric_t*G_2_step)
 		mean_gain_after += G_2_step[i] * G_2_step[i];
 	}
 	mean_gain_after /= gain->L1;
-	/* Нормализуем полученный фильтр. */
-	for (i = 0; i < gain->L1; i++) {
-		G_2_step[i] = G_2_step[i] * HSV_SQRT(mean_gain_before / mean_gain_after);
+	/* Нормализуем полученный фильтр. Нулевой фильтр (фрейм цифровой тишины) остается нулевым. */
+	if (mean_gain_after > 0.0) {
+		for (i = 0; i < gain->L1; i++) {
+			G_2_step[i] = G_2_step[i] * HSV_SQRT(mean_gain_before / mean_gain_after);
+		}
 	}
 }
 
-static void tsnr_run(struct SUPPRESSOR_TSNR*tsnr, const hsv_numeric_t*noisy_speech_amp_spec, const hsv_numeric_t*noise_amp_spec, hsv_numeric_t*out)
+/**
+ * Функция "усиления" для каждого из lanes потоков: фильтр потока собирается в непрерывный буфер.
+ */
+static void suppressor_gain_lanes(struct SUPPRESSOR_GAIN*gain, hsv_numeric_t*G_2_step, unsigned lanes)
 {
-	unsigned i;
+	unsigned i, l;
 
-	/* Вычисление спектра мощности шума. */
-	for (i = 0; i < tsnr->wiener.size; i++) {
-		tsnr->wiener.noise_power_spec[i] = noise_amp_spec[i] * noise_amp_spec[i];
+	if (lanes == 1) {
+		suppressor_gain(gain, G_2_step);
+		return;
 	}
-	/* Вычисление мгновенного SNR по Скалару-Филхо: мгновенный SNR_inst = апостериорный SNR - 1.
-	   Минимальное значение используется для уменьшения искажения сигнала. */
-	for (i = 0; i < tsnr->wiener.size; i++) {
-		hsv_numeric_t noisy_speech_power_spec = noisy_speech_amp_spec[i] * noisy_speech_amp_spec[i];
-		hsv_numeric_t SNR_post = noisy_speech_power_spec / tsnr->wiener.noise_power_spec[i];
-		tsnr->wiener.SNR_inst[i] = HSV_MAX(SNR_post - 1.0, tsnr->wiener.floor);
-	}
-	/* Вычисление априорного SNR по методу принятия решений Эфраима-Малаха. */
-	for (i = 0; i < tsnr->wiener.size; i++) {
-		tsnr->wiener.SNR_prio_dd[i] = tsnr->wiener.beta * ((tsnr->wiener.speech_amp_spec_prev[i] * tsnr->wiener.speech_amp_spec_prev[i]) / tsnr->wiener.noise_power_spec[i]) +
-			(1.0 - tsnr->wiener.beta) * tsnr->wiener.SNR_inst[i];
-	}
-	/* Вычисление коэффициентов фильтра Винера. */
-	for (i = 0; i < tsnr->wiener.size; i++) {
-		tsnr->wiener.G_dd[i] = tsnr->wiener.SNR_prio_dd[i] / (tsnr->wiener.SNR_prio_dd[i] + 1.0);
+
+	for (l = 0; l < lanes; l++) {
+		for (i = 0; i < gain->L1; i++) {
+			gain->lane_gain[i] = G_2_step[i * lanes + l];
+		}
+		suppressor_gain(gain, gain->lane_gain);
+		for (i = 0; i < gain->L1; i++) {
+			G_2_step[i * lanes + l] = gain->lane_gain[i];
+		}
 	}
+}
+
+static void tsnr_run(struct SUPPRESSOR_TSNR*tsnr, const hsv_numeric_t*noisy_speech_amp_spec, const hsv_numeric_t*noise_amp_spec, hsv_numeric_t*out, hsv_numeric_t eps)
+{
+	enum SUPPRESSOR_MODE mode = SUPPRESSOR_CONST_MODE(tsnr->mode);
+
+	unsigned lanes = tsnr->wiener.lanes;
+	unsigned size = HSV_CONST_DFT_SIZE(tsnr->wiener.size) * lanes;
+
+	unsigned i;
+
+	/* Спектр мощности шума, мгновенный SNR, априорный SNR и коэффициенты фильтра Винера, как в wiener_run. */
+	wiener_dd_gain(&(tsnr->wiener), noisy_speech_amp_spec, noise_amp_spec, eps);
 	/*  Винеровская фильтрация. Получили результат аналогичный алгоритму Скалара-Филхо 96-го. */
-	for (i = 0; i < tsnr->wiener.size; i++) {
-		if ((tsnr->mode == SUPPRESSOR_MODE_TSNR) || (tsnr->mode == SUPPRESSOR_MODE_TSNR_G)) {
+	for (i = 0; i < size; i++) {
+		if ((mode == SUPPRESSOR_MODE_TSNR) || (mode == SUPPRESSOR_MODE_TSNR_G)) {
 			tsnr->wiener.speech_amp_spec[i] = tsnr->wiener.G_dd[i] * noisy_speech_amp_spec[i];
 		} else {
 			tsnr->wiener.speech_amp_spec[i] = (2.0 - tsnr->wiener.G_dd[i]) * tsnr->wiener.G_dd[i] * noisy_speech_amp_spec[i];
@@ -466,66 +789,256 @@ static void tsnr_run(struct SUPPRESSOR_TSNR*tsnr, const hsv_numeric_t*noisy_spee
 	/* Скалар предложил итеративно повторять процедуру 96-го, для борьбы с запаздыванием априорного SNR на 1 фрейм.
 	   Эксперименты показали, что 1 дополнительная итерация значительно влияет на качестве шумоочистки.
 	   Остальные незначительно. Вычисление априорного SNR очищенного сигнала. */
-	for (i = 0; i < tsnr->wiener.size; i++) {
+	for (i = 0; i < size; i++) {
 		tsnr->SNR_prio_2_step[i] = (tsnr->wiener.speech_amp_spec[i] * tsnr->wiener.speech_amp_spec[i]) / tsnr->wiener.noise_power_spec[i];
 	}
 	/* Вычисление коэффициентов фильтра Винера. */
-	for (i = 0; i < tsnr->wiener.size; i++) {
+	for (i = 0; i < size; i++) {
 		tsnr->G_2_step[i] = tsnr->SNR_prio_2_step[i] / (tsnr->SNR_prio_2_step[i] + 1.0);
 	}
 
-	if ((tsnr->mode == SUPPRESSOR_MODE_TSNR) || (tsnr->mode == SUPPRESSOR_MODE_RTSNR)) {
-		for (i = 0; i < tsnr->wiener.size; i++) {
+	if ((mode == SUPPRESSOR_MODE_TSNR) || (mode == SUPPRESSOR_MODE_RTSNR)) {
+		for (i = 0; i < size; i++) {
 			tsnr->G_2_step[i] = HSV_MAX(tsnr->G_2_step[i], tsnr->wiener.floor);
 		}
 	} else {
 		/* Дополнительная функция "усиления", предложенная Скаларом-Плапусом. */
-		suppressor_gain(&(tsnr->gain), tsnr->G_2_step);		
+		suppressor_gain_lanes(&(tsnr->gain), tsnr->G_2_step, lanes);
 	}
 
 	/* Применение Винеровского фильтра. */
-	for (i = 0; i < tsnr->wiener.size; i++) {
+	for (i = 0; i < size; i++) {
 		tsnr->wiener.speech_amp_spec[i] = tsnr->G_2_step[i] * noisy_speech_amp_spec[i];
 	}
 
-	memcpy(tsnr->wiener.speech_amp_spec_prev, tsnr->wiener.speech_amp_spec, tsnr->wiener.size * sizeof(hsv_numeric_t));
-	memcpy(out, tsnr->wiener.speech_amp_spec, tsnr->wiener.size * sizeof(hsv_numeric_t));
+	memcpy(tsnr->wiener.speech_amp_spec_prev, tsnr->wiener.speech_amp_spec, size * sizeof(hsv_numeric_t));
+	memcpy(out, tsnr->wiener.speech_amp_spec, size * sizeof(hsv_numeric_t));
+}
+
+static void bark_run(struct SUPPRESSOR_BARK*bark, const hsv_numeric_t*noisy_speech_amp_spec, const hsv_numeric_t*noise_amp_spec, hsv_numeric_t*gain, hsv_numeric_t eps)
+{
+	/* Спектр шума уже задан по полосам, спектр зашумленного голоса агрегируется по мощности. */
+	bands_aggregate_amp(bark->bands, noisy_speech_amp_spec, bark->noisy_speech_amp_spec);
+
+	wiener_run(&(bark->wiener), bark->noisy_speech_amp_spec, noise_amp_spec, bark->speech_amp_spec, eps);
+
+	bands_expand(bark->bands, bark->wiener.G_dd, gain);
+}
+
+/**
+ * \return винеровская фильтрация режима подавления шума (NULL - спектральное вычитание).
+ */
+static struct SUPPRESSOR_WIENER*suppressor_wiener(suppressor_t sup)
+{
+	switch (SUPPRESSOR_CONST_MODE(sup->mode)) {
+	case SUPPRESSOR_MODE_WIENER:
+		return &(sup->wiener);
+	case SUPPRESSOR_MODE_TSNR:
+	case SUPPRESSOR_MODE_TSNR_G:
+	case SUPPRESSOR_MODE_RTSNR:
+	case SUPPRESSOR_MODE_RTSNR_G:
+		return &(sup->tsnr.wiener);
+	case SUPPRESSOR_MODE_BARK:
+		return &(sup->bark.wiener);
+	default:
+		return NULL;
+	}
+}
+
+/**
+ * Обнуление спектра голоса прошлого фрейма ниже eps_amp: при затухании сигнала рекуррентный
+ * спектр не переходит в денормализованные числа.
+ */
+static void suppressor_flush_prev(suppressor_t sup)
+{
+	unsigned k;
+
+	struct SUPPRESSOR_WIENER*wiener = suppressor_wiener(sup);
+
+	if (wiener == NULL) {
+		return;
+	}
+
+	for (k = 0; k < wiener->size * wiener->lanes; k++) {
+		wiener->speech_amp_spec_prev[k] = (wiener->speech_amp_spec_prev[k] < sup->eps_amp) ? 0.0 : wiener->speech_amp_spec_prev[k];
+	}
+}
+
+/**
+ * Чтение спектра голоса прошлого фрейма из 16-битного формата (см. SUPPRESSOR_WIENER::storage).
+ */
+static void suppressor_load_prev(suppressor_t sup)
+{
+	struct SUPPRESSOR_WIENER*wiener = suppressor_wiener(sup);
+
+	if ((wiener != NULL) && (wiener->storage != KERNELS_STORAGE_NATIVE)) {
+		kernels_load(wiener->storage, wiener->speech_amp_spec_prev_half, wiener->speech_amp_spec_prev, wiener->size * wiener->lanes,
+			wiener->speech_amp_spec_prev_exp);
+	}
+}
+
+/**
+ * Запись спектра голоса прошлого фрейма в 16-битный формат.
+ */
+static void suppressor_store_prev(suppressor_t sup)
+{
+	struct SUPPRESSOR_WIENER*wiener = suppressor_wiener(sup);
+
+	if ((wiener != NULL) && (wiener->storage != KERNELS_STORAGE_NATIVE)) {
+		wiener->speech_amp_spec_prev_exp = kernels_store(wiener->storage, wiener->speech_amp_spec_prev, wiener->speech_amp_spec_prev_half,
+			wiener->size * wiener->lanes);
+	}
+}
+
+void suppressor_set_fast_math(suppressor_t sup, int fast_math)
+{
+	sup->fast_math = fast_math;
+}
+
+void suppressor_set_eps(suppressor_t sup, hsv_numeric_t eps)
+{
+	sup->eps = eps;
+	sup->eps_amp = HSV_SQRT(eps);
 }
 
 void suppressor_run(suppressor_t sup, const hsv_numeric_t*noisy_speech_amp_spec, const hsv_numeric_t*noise_amp_spec)
 {
-	switch (sup->mode) {
+	unsigned size = HSV_CONST_DFT_SIZE(sup->size) * sup->lanes;
+
+	unsigned k;
+
+	suppressor_load_prev(sup);
+
+	switch (SUPPRESSOR_CONST_MODE(sup->mode)) {
+	case SUPPRESSOR_MODE_SPECSUB:
+		specsub_run(&(sup->specsub), noisy_speech_amp_spec, noise_amp_spec, sup->speech_amp_spec, sup->fast_math, sup->eps);
+		/* Спектральное вычитание не является мультипликативным фильтром, поэтому коэффициенты восстанавливаются по результату. */
+		for (k = 0; k < size; k++) {
+			sup->gain[k] = (noisy_speech_amp_spec[k] > 0.0) ? (sup->speech_amp_spec[k] / noisy_speech_amp_spec[k]) : 0.0;
+		}
+		break;
+	case SUPPRESSOR_MODE_WIENER:
+		wiener_run(&(sup->wiener), noisy_speech_amp_spec, noise_amp_spec, sup->speech_amp_spec, sup->eps);
+		memcpy(sup->gain, sup->wiener.G_dd, size * sizeof(hsv_numeric_t));
+		break;
+	case SUPPRESSOR_MODE_TSNR:
+	case SUPPRESSOR_MODE_TSNR_G:
+	case SUPPRESSOR_MODE_RTSNR:
+	case SUPPRESSOR_MODE_RTSNR_G:
+		tsnr_run(&(sup->tsnr), noisy_speech_amp_spec, noise_amp_spec, sup->speech_amp_spec, sup->eps);
+		memcpy(sup->gain, sup->tsnr.G_2_step, size * sizeof(hsv_numeric_t));
+		break;
+	case SUPPRESSOR_MODE_BARK:
+		bark_run(&(sup->bark), noisy_speech_amp_spec, noise_amp_spec, sup->gain, sup->eps);
+		for (k = 0; k < size; k++) {
+			sup->speech_amp_spec[k] = sup->gain[k] * noisy_speech_amp_spec[k];
+		}
+		break;
+	}
+
+	if (sup->eps > 0.0) {
+		suppressor_flush_prev(sup);
+	}
+
+	suppressor_store_prev(sup);
+}
+
+/**
+ * Обновление спектра голоса прошлого фрейма, используемого методом принятия решений,
+ * после вычисления speech_amp_spec в обход фильтра.
+ */
+static void suppressor_update_prev(suppressor_t sup)
+{
+	switch (SUPPRESSOR_CONST_MODE(sup->mode)) {
 	case SUPPRESSOR_MODE_SPECSUB:
-		specsub_run(&(sup->specsub), noisy_speech_amp_spec, noise_amp_spec, sup->speech_amp_spec);
 		break;
 	case SUPPRESSOR_MODE_WIENER:
-		wiener_run(&(sup->wiener), noisy_speech_amp_spec, noise_amp_spec, sup->speech_amp_spec);
+		memcpy(sup->wiener.speech_amp_spec_prev, sup->speech_amp_spec, sup->size * sup->lanes * sizeof(hsv_numeric_t));
 		break;
 	case SUPPRESSOR_MODE_TSNR:
 	case SUPPRESSOR_MODE_TSNR_G:
 	case SUPPRESSOR_MODE_RTSNR:
 	case SUPPRESSOR_MODE_RTSNR_G:
-		tsnr_run(&(sup->tsnr), noisy_speech_amp_spec, noise_amp_spec, sup->speech_amp_spec);
+		memcpy(sup->tsnr.wiener.speech_amp_spec_prev, sup->speech_amp_spec, sup->size * sup->lanes * sizeof(hsv_numeric_t));
+		break;
+	case SUPPRESSOR_MODE_BARK:
+		bands_aggregate_amp(sup->bark.bands, sup->speech_amp_spec, sup->bark.wiener.speech_amp_spec_prev);
 		break;
 	}
+
+	if (sup->eps > 0.0) {
+		suppressor_flush_prev(sup);
+	}
+
+	suppressor_store_prev(sup);
+}
+
+void suppressor_bypass(suppressor_t sup, const hsv_numeric_t*noisy_speech_amp_spec, hsv_numeric_t gain)
+{
+	unsigned k;
+
+	for (k = 0; k < sup->size * sup->lanes; k++) {
+		sup->speech_amp_spec[k] = gain * noisy_speech_amp_spec[k];
+	}
+
+	suppressor_update_prev(sup);
+}
+
+void suppressor_apply_gain(suppressor_t sup, const hsv_numeric_t*noisy_speech_amp_spec, const hsv_numeric_t*gain)
+{
+	unsigned k;
+
+	for (k = 0; k < sup->size * sup->lanes; k++) {
+		sup->speech_amp_spec[k] = gain[k] * noisy_speech_amp_spec[k];
+	}
+
+	suppressor_update_prev(sup);
+}
+
+void suppressor_reset_lane(suppressor_t sup, unsigned lane)
+{
+	struct SUPPRESSOR_WIENER*wiener = suppressor_wiener(sup);
+
+	unsigned k;
+
+	for (k = 0; k < sup->size; k++) {
+		sup->gain[k * sup->lanes + lane] = 0.0;
+	}
+
+	if (wiener == NULL) {
+		return;
+	}
+
+	/* Нулевое 16-битное значение читается нулем при любом порядке массива. */
+	for (k = 0; k < wiener->size; k++) {
+		if (wiener->storage == KERNELS_STORAGE_NATIVE) {
+			wiener->speech_amp_spec_prev[k * wiener->lanes + lane] = 0.0;
+		} else {
+			wiener->speech_amp_spec_prev_half[k * wiener->lanes + lane] = 0;
+		}
+	}
 }
 
 void suppressor_deconfig(suppressor_t sup)
 {
-	free(sup->speech_amp_spec);
+	arena_free(sup->arena, sup->gain);
+	arena_free(sup->scratch, sup->speech_amp_spec);
 
 	switch (sup->mode) {
 	case SUPPRESSOR_MODE_SPECSUB:
-		specsub_deconfig(&(sup->specsub));
+		specsub_deconfig(&(sup->specsub), sup->arena, sup->scratch);
 		break;
 	case SUPPRESSOR_MODE_WIENER:
-		wiener_deconfig(&(sup->wiener));
+		wiener_deconfig(&(sup->wiener), sup->arena, sup->scratch);
 		break;
 	case SUPPRESSOR_MODE_TSNR:
 	case SUPPRESSOR_MODE_TSNR_G:
 	case SUPPRESSOR_MODE_RTSNR:
 	case SUPPRESSOR_MODE_RTSNR_G:
-		tsnr_deconfig(&(sup->tsnr));
+		tsnr_deconfig(&(sup->tsnr), sup->arena, sup->scratch);
+		break;
+	case SUPPRESSOR_MODE_BARK:
+		bark_deconfig(&(sup->bark), sup->arena, sup->scratch);
 		break;
 	}
 }
@@ -16,8 +16,12 @@ extern "C" {
 
 #include "hsv_types.h"
 
+#include "arena.h"
+
 #include "dft.h"
 #include "utils.h"
+#include "bands.h"
+#include "kernels.h"
 
 /**
  * Коды, возвращаемые методами suppressor_...
@@ -43,6 +47,8 @@ enum SUPPRESSOR_MODE
 
 	SUPPRESSOR_MODE_RTSNR,   /**< Режим, основанный на двухшаговой фильтрации Шифенга.               */
 	SUPPRESSOR_MODE_RTSNR_G, /**< Режим, основанный на двухшаговой фильтрации Шифенга с "усилением". */
+
+	SUPPRESSOR_MODE_BARK,    /**< Режим, основанный на винеровской фильтрации Скалара по критическим полосам. */
 };
 
 /**
@@ -54,14 +60,20 @@ enum SUPPRESSOR_MODE
  */
 struct SUPPRESSOR_SPECSUB
 {
-	unsigned sr;   /**< Частота дискретизации. */
-	unsigned size; /**< Размер фрейма.         */
+	unsigned sr;    /**< Частота дискретизации.                    */
+	unsigned size;  /**< Размер фрейма.                            */
+	unsigned lanes; /**< Число потоков (см. suppressor_config_lanes). */
 	/**
 	 * Степень, в которую возводятся спектры амплитуд и шума при вычитании.
 	 * 1.0 - вычитание спектров амплитуд по Боллу.
 	 * 2.0 - вычитание спектров мощности по Берути.
 	 */
 	hsv_numeric_t power_exponent;
+
+	hsv_numeric_t*noisy_speech_power_spec; /**< Спектр зашумленного голоса в степени power_exponent (для fastmath). */
+	hsv_numeric_t*noise_power_spec;        /**< Спектр шума в степени power_exponent (для fastmath).                */
+
+	hsv_numeric_t*lane_buf; /**< Спектры одного потока: вход, шум и результат (3 * size, только при lanes > 1). */
 };
 
 /**
@@ -76,8 +88,9 @@ struct SUPPRESSOR_SPECSUB
  */
 struct SUPPRESSOR_WIENER
 {
-	unsigned sr;   /**< Частота дискретизации. */
-	unsigned size; /**< Размер фрейма.         */
+	unsigned sr;    /**< Частота дискретизации.                    */
+	unsigned size;  /**< Размер фрейма.                            */
+	unsigned lanes; /**< Число потоков (см. suppressor_config_lanes). */
 
 	hsv_numeric_t beta;  /**< Коэффициент метода принятия решений.                  */
 	hsv_numeric_t floor; /**< Коэффициент сглаживания для предотвращения искажений. */
@@ -90,6 +103,14 @@ struct SUPPRESSOR_WIENER
 
 	hsv_numeric_t*speech_amp_spec;      /**< Текущий спектр амплитуд голоса. */
 	hsv_numeric_t*speech_amp_spec_prev; /**< Прошлый спектр амплитуд голоса. */
+
+	/**
+	 * Формат хранения прошлого спектра амплитуд голоса между фреймами. При 16-битном формате speech_amp_spec_prev
+	 * выделяется из рабочей арены, а между фреймами хранится в speech_amp_spec_prev_half.
+	 */
+	enum KERNELS_STORAGE storage;
+	uint16_t*speech_amp_spec_prev_half;
+	int speech_amp_spec_prev_exp; /**< Порядок speech_amp_spec_prev_half (см. kernels_store). */
 };
 
 /**
@@ -106,6 +127,8 @@ struct SUPPRESSOR_GAIN
 
 	hsv_numeric_t*impulse_response_before; /**< Импульсный отклик до усиления.    */
 	hsv_numeric_t*impulse_response_after;  /**< Импульсный отклик после усиления. */
+
+	hsv_numeric_t*lane_gain; /**< Фильтр одного потока (L1, только при нескольких потоках). */
 };
 
 /**
@@ -130,6 +153,21 @@ struct SUPPRESSOR_TSNR
 	struct SUPPRESSOR_GAIN gain; /**< Улучшенный фильтр усилениея. */
 };
 
+/**
+ * Структура винеровской фильтрации по критическим полосам.
+ * Априорный SNR и коэффициенты фильтра вычисляются для полос, а затем интерполируются на частоты ДПФ
+ * треугольными весами. Состояние и вычисления фильтра не зависят от размера ДПФ.
+ */
+struct SUPPRESSOR_BARK
+{
+	const struct BANDS*bands; /**< Критические полосы. */
+
+	struct SUPPRESSOR_WIENER wiener; /**< Структура винеровской фильтрации Скалара по полосам. */
+
+	hsv_numeric_t*noisy_speech_amp_spec; /**< Спектр амплитуд зашумленного голоса по полосам. */
+	hsv_numeric_t*speech_amp_spec;       /**< Спектр амплитуд голоса по полосам.              */
+};
+
 /**
  * Структура шумоподавления.
  */
@@ -140,13 +178,30 @@ struct SUPPRESSOR
 	unsigned sr;   /**< Частота дискретизации. */
 	unsigned size; /**< Размер фрейма.         */
 
+	/**
+	 * Число независимых потоков (см. suppressor_config_lanes). Спектры и коэффициенты усиления потоков
+	 * чередуются по частотам, как в ESTIMATOR::lanes.
+	 */
+	unsigned lanes;
+
 	union {
 		struct SUPPRESSOR_SPECSUB specsub; /**< Структура алгоритма спектрального вычитания Берути-Шварца.           */
 		struct SUPPRESSOR_WIENER  wiener;  /**< Структура алгоритма винеровской фильтрации Скалара.                  */
 		struct SUPPRESSOR_TSNR    tsnr;    /**< Общая структура алгоритмов двухшаговой фильтрации Скалара и Шифенга. */
+		struct SUPPRESSOR_BARK    bark;    /**< Структура винеровской фильтрации по критическим полосам.             */
 	};
 
 	hsv_numeric_t*speech_amp_spec; /**< Спектр амплитуд очищенного голоса. */
+
+	hsv_numeric_t*gain; /**< Коэффициенты усиления последнего фрейма: speech_amp_spec = gain * noisy_speech_amp_spec. */
+
+	int fast_math; /**< Использование приближений fastmath.h вместо libm. */
+
+	hsv_numeric_t eps;     /**< Минимальное значение спектров мощности шума (0 - без ограничения). */
+	hsv_numeric_t eps_amp; /**< Порог обнуления рекуррентного спектра амплитуд голоса, sqrt(eps).   */
+
+	arena_t arena;   /**< Арена, из которой выделены состояния и коэффициенты усиления. */
+	arena_t scratch; /**< Арена промежуточных буферов одного фрейма.                    */
 };
 
 typedef struct SUPPRESSOR* suppressor_t;
@@ -161,15 +216,100 @@ suppressor_t create_suppressor();
  * Конфигурация подавления шума.
  * \param sr частота дискретизации.
  * \param size размер анализируемого фрейма.
+ * \param storage формат хранения прошлого спектра амплитуд голоса между фреймами.
+ * \param arena арена, из которой выделяются буферы.
+ * \param scratch арена промежуточных буферов (SNR, фильтры, speech_amp_spec), содержимое которых
+ * не сохраняется между вызовами suppressor_run.
+ * \return результат конфигурирования.
+ */
+enum SUPPRESSOR_CODE suppressor_config(suppressor_t sup, unsigned sr, unsigned size, enum SUPPRESSOR_MODE mode, enum KERNELS_STORAGE storage,
+	arena_t arena, arena_t scratch);
+
+/**
+ * Конфигурация подавления шума по критическим полосам (SUPPRESSOR_MODE_BARK).
+ * Спектр шума в suppressor_run при этом задается по полосам (см. estimator_config_bands).
+ * \param sr частота дискретизации.
+ * \param size размер анализируемого фрейма.
+ * \param bands критические полосы (должны существовать, пока существует подавление шума).
+ * \param storage формат хранения прошлого спектра амплитуд голоса между фреймами.
+ * \param arena арена, из которой выделяются буферы.
+ * \param scratch арена промежуточных буферов (см. suppressor_config).
+ * \return результат конфигурирования.
+ */
+enum SUPPRESSOR_CODE suppressor_config_bands(suppressor_t sup, unsigned sr, unsigned size, const struct BANDS*bands, enum KERNELS_STORAGE storage,
+	arena_t arena, arena_t scratch);
+
+/**
+ * Конфигурация подавления шума lanes независимых потоков с чередующимися по частотам спектрами
+ * (см. estimator_config_lanes). Поэлементные вычисления всех потоков выполняются одним проходом
+ * (спектральное вычитание, параметры которого зависят от всего фрейма, и функция "усиления" - по потокам),
+ * а результат каждого потока совпадает с подавлением шума, сконфигурированным suppressor_config.
+ * \param sr частота дискретизации.
+ * \param size размер анализируемого фрейма.
+ * \param lanes число потоков.
+ * \param mode режим (кроме SUPPRESSOR_MODE_BARK).
+ * \param storage формат хранения прошлого спектра амплитуд голоса между фреймами.
+ * \param arena арена, из которой выделяются буферы.
+ * \param scratch арена промежуточных буферов (см. suppressor_config).
  * \return результат конфигурирования.
  */
-enum SUPPRESSOR_CODE suppressor_config(suppressor_t sup, unsigned sr, unsigned size, enum SUPPRESSOR_MODE mode);
+enum SUPPRESSOR_CODE suppressor_config_lanes(suppressor_t sup, unsigned sr, unsigned size, unsigned lanes, enum SUPPRESSOR_MODE mode,
+	enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch);
+
+/**
+ * Учет памяти suppressor_config в аренах без конфигурации (см. arena_reserve).
+ * \return SUPPRESSOR_CODE_INVALID_MODE, если suppressor_config не примет режим mode.
+ */
+enum SUPPRESSOR_CODE suppressor_reserve(unsigned size, enum SUPPRESSOR_MODE mode, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch);
+
+/**
+ * Учет памяти suppressor_config_bands для n_bands полос (см. bands_reserve).
+ */
+void suppressor_reserve_bands(unsigned size, unsigned n_bands, enum KERNELS_STORAGE storage, arena_t arena, arena_t scratch);
+
+/**
+ * Учет памяти suppressor_config_lanes.
+ * \return SUPPRESSOR_CODE_INVALID_MODE, если suppressor_config_lanes не примет режим mode.
+ */
+enum SUPPRESSOR_CODE suppressor_reserve_lanes(unsigned size, unsigned lanes, enum SUPPRESSOR_MODE mode, enum KERNELS_STORAGE storage,
+	arena_t arena, arena_t scratch);
+
+/**
+ * Выбор приближений fastmath.h вместо libm (по умолчанию - libm).
+ * \param fast_math 0 - libm, иначе - fastmath.h.
+ */
+void suppressor_set_fast_math(suppressor_t sup, int fast_math);
+
+/**
+ * Защита от деления на ноль и денормализованных чисел на тишине: спектры мощности шума ограничиваются
+ * снизу значением eps, а спектр голоса прошлого фрейма обнуляется ниже sqrt(eps).
+ * \param eps минимальное значение (0 - без ограничения, по умолчанию).
+ */
+void suppressor_set_eps(suppressor_t sup, hsv_numeric_t eps);
 
 /**
  * Выполнение подавления шума.
  */
 void suppressor_run(suppressor_t sup, const hsv_numeric_t*noisy_speech_amp_spec, const hsv_numeric_t*noise_amp_spec);
 
+/**
+ * Пропуск подавления шума: спектр голоса вычисляется как noisy_speech_amp_spec * gain.
+ * Внутренние рекуррентные состояния обновляются так, как если бы фильтр дал тот же результат.
+ */
+void suppressor_bypass(suppressor_t sup, const hsv_numeric_t*noisy_speech_amp_spec, hsv_numeric_t gain);
+
+/**
+ * Применение заданных коэффициентов усиления без их пересчета: спектр голоса вычисляется как noisy_speech_amp_spec * gain.
+ * Внутренние рекуррентные состояния обновляются так, как если бы фильтр дал тот же результат.
+ */
+void suppressor_apply_gain(suppressor_t sup, const hsv_numeric_t*noisy_speech_amp_spec, const hsv_numeric_t*gain);
+
+/**
+ * Сброс подавления шума потока lane: следующий фрейм потока обрабатывается как первый.
+ * \param lane номер потока (0 при suppressor_config).
+ */
+void suppressor_reset_lane(suppressor_t sup, unsigned lane);
+
 /**
  * Удаление всех внутренних динамических структур.
  */
@@ -8,6 +8,10 @@
  * \{
  */
 #include "utils.h"
+#include "fastmath.h"
+#include "kernels.h"
+
+#include <string.h>
 
 #include <math.h>
 
@@ -45,6 +49,83 @@ static void init_hanning_window(hsv_numeric_t*window, unsigned n)
 	}
 }
 
+static hsv_numeric_t sqrt_hanning(unsigned i, unsigned n)
+{
+	return HSV_SIN(((hsv_numeric_t) M_PI) * ((i + ((hsv_numeric_t) 0.5)) / ((hsv_numeric_t) n)));
+}
+
+static void init_sqrt_hanning_window(hsv_numeric_t*window, unsigned n)
+{
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		window[i] = sqrt_hanning(i, n);
+	}
+}
+
+static hsv_numeric_t vorbis(unsigned i, unsigned n)
+{
+	hsv_numeric_t s = sqrt_hanning(i, n);
+
+	return HSV_SIN(((hsv_numeric_t) M_PI) / ((hsv_numeric_t) 2.0) * s * s);
+}
+
+static void init_vorbis_window(hsv_numeric_t*window, unsigned n)
+{
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		window[i] = vorbis(i, n);
+	}
+}
+
+double bessel_i0(double x)
+{
+	double sum = 1.0;
+	double term = 1.0;
+
+	unsigned k;
+
+	for (k = 1; k < 64; k++) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+		if (term < sum * 1e-12) {
+			break;
+		}
+	}
+
+	return sum;
+}
+
+static double kaiser(unsigned j, unsigned n)
+{
+	static const double alpha = 4.0;
+
+	double x = 2.0 * j / n - 1.0;
+
+	return bessel_i0(M_PI * alpha * sqrt(1.0 - x * x));
+}
+
+static void init_kbd_window(hsv_numeric_t*window, unsigned n)
+{
+	unsigned half = n / 2;
+
+	double total = 0.0;
+	double sum = 0.0;
+
+	unsigned i;
+
+	for (i = 0; i <= half; i++) {
+		total += kaiser(i, half);
+	}
+
+	for (i = 0; i < half; i++) {
+		sum += kaiser(i, half);
+		window[i] = (hsv_numeric_t) sqrt(sum / total);
+		window[n - 1 - i] = window[i];
+	}
+}
+
 void init_window(hsv_numeric_t*window, unsigned n, enum WINDOW_TYPE wt)
 {
 	switch (wt) {
@@ -54,36 +135,70 @@ void init_window(hsv_numeric_t*window, unsigned n, enum WINDOW_TYPE wt)
 	case WINDOW_TYPE_HANNING:
 		init_hanning_window(window, n);
 		break;
+	case WINDOW_TYPE_SQRT_HANNING:
+		init_sqrt_hanning_window(window, n);
+		break;
+	case WINDOW_TYPE_VORBIS:
+		init_vorbis_window(window, n);
+		break;
+	case WINDOW_TYPE_KBD:
+		init_kbd_window(window, n);
+		break;
 	default:
 		init_hamming_window(window, n);
 		break;
 	}
 }
 
-void calculate_windowing(const hsv_numeric_t*window, const hsv_numeric_t*in, hsv_numeric_t*out, unsigned n)
+void init_window_taper(hsv_numeric_t*window, unsigned n, unsigned taper, enum WINDOW_TYPE wt)
 {
 	unsigned i;
 
-	for (i = 0; i < n; i++) {
-		out[i] = in[i] * window[i];
+	/* Окно длины 2 * taper строится в начале массива, затем его спад переносится в конец. */
+	init_window(window, 2 * taper, wt);
+	memmove(window + n - taper, window + taper, taper * sizeof(hsv_numeric_t));
+	for (i = taper; i < n - taper; i++) {
+		window[i] = 1.0;
 	}
 }
 
-void calculate_amp_spec(const hsv_numeric_t*real, const hsv_numeric_t*imag, hsv_numeric_t*amp_spec, unsigned n)
+void init_synthesis_window(const hsv_numeric_t*analysis, hsv_numeric_t*synthesis, unsigned n, unsigned step)
 {
-	unsigned i;
+	hsv_numeric_t sum;
+
+	unsigned i, j;
 
 	for (i = 0; i < n; i++) {
-		amp_spec[i] = HSV_SQRT(real[i] * real[i] + imag[i] * imag[i]);
+		sum = 0.0;
+		for (j = i % step; j < n; j += step) {
+			sum += analysis[j] * analysis[j];
+		}
+		synthesis[i] = (sum > 0.0) ? analysis[i] / sum : 0.0;
 	}
 }
 
-void calculate_power_spec(const hsv_numeric_t*real, const hsv_numeric_t*imag, hsv_numeric_t*power_spec, unsigned n)
+void init_window_low_delay(hsv_numeric_t*analysis, hsv_numeric_t*synthesis, unsigned n, unsigned step)
 {
+	unsigned rise = n - step;
+	unsigned start = n - 2 * step;
+
+	hsv_numeric_t w;
+
 	unsigned i;
 
-	for (i = 0; i < n; i++) {
-		power_spec[i] = real[i] * real[i] + imag[i] * imag[i];
+	for (i = 0; i < rise; i++) {
+		analysis[i] = sqrt_hanning(i, 2 * rise);
+	}
+	for (i = rise; i < n; i++) {
+		analysis[i] = sqrt_hanning(i - rise + step, 2 * step);
+	}
+
+	for (i = 0; i < start; i++) {
+		synthesis[i] = 0.0;
+	}
+	for (i = start; i < n; i++) {
+		w = sqrt_hanning(i - start, 2 * step);
+		synthesis[i] = w * w / analysis[i];
 	}
 }
 
@@ -95,6 +210,22 @@ void calculate_phase_spec(const hsv_numeric_t*real, const hsv_numeric_t*imag, hs
 		phase_spec[i] = HSV_ATAN2(imag[i], real[i]);
 	}
 }
+
+void calculate_phase_spec_fast(const hsv_numeric_t*real, const hsv_numeric_t*imag, hsv_numeric_t*phase_spec, unsigned n)
+{
+	fastmath_atan2(imag, real, phase_spec, n);
+}
+
+void calculate_complex_spec_fast(const hsv_numeric_t*amp_spec, const hsv_numeric_t*phase_spec, hsv_numeric_t*real, hsv_numeric_t*imag, unsigned n)
+{
+	unsigned i;
+
+	fastmath_sincos(phase_spec, imag, real, n);
+	for (i = 0; i < n; i++) {
+		real[i] *= amp_spec[i];
+		imag[i] *= amp_spec[i];
+	}
+}
 /**
  * /}
  */
@@ -15,6 +15,7 @@
 #endif  /* __cplusplus */
 
 #include "hsv_types.h"
+#include "kernels.h"
 
 enum WINDOW_TYPE
 {
@@ -28,6 +29,21 @@ enum WINDOW_TYPE
 	 * w(n) = 0.5 * (1 - cos(2 * Pi * n / (N - 1)))
 	 */
 	WINDOW_TYPE_HANNING,
+	/**
+	 * Корень из оконной функции Ханна (синусное окно).
+	 * w(n) = sin(Pi * (n + 0.5) / N)
+	 */
+	WINDOW_TYPE_SQRT_HANNING,
+	/**
+	 * Оконная функция Vorbis.
+	 * w(n) = sin(Pi / 2 * sin^2(Pi * (n + 0.5) / N))
+	 */
+	WINDOW_TYPE_VORBIS,
+	/**
+	 * Оконная функция Кайзера-Бесселя (KBD, alpha = 4).
+	 * w(n) = sqrt(sum_{j <= n} k(j) / sum_{j <= N / 2} k(j)), где k - окно Кайзера длины N / 2 + 1.
+	 */
+	WINDOW_TYPE_KBD,
 };
 
 /**
@@ -37,26 +53,80 @@ enum WINDOW_TYPE
  */
 void init_window(hsv_numeric_t*window, unsigned n, enum WINDOW_TYPE wt);
 
+/**
+ * Инициализация оконной функции с плоской вершиной: подъем и спад длины taper берутся из оконной функции длины 2 * taper.
+ * Окна WINDOW_TYPE_SQRT_HANNING, WINDOW_TYPE_VORBIS и WINDOW_TYPE_KBD комплементарны по мощности (w^2(n) + w^2(n + taper) = 1),
+ * поэтому при шаге n - taper сумма квадратов перекрывающихся окон постоянна.
+ * \param n размер массива (четный).
+ * \param taper длина подъема и спада (не больше n / 2).
+ * \param wt тип окна.
+ */
+void init_window_taper(hsv_numeric_t*window, unsigned n, unsigned taper, enum WINDOW_TYPE wt);
+
+/**
+ * Инициализация окна синтеза, обеспечивающего полное восстановление при перекрытии-сложении с шагом step
+ * для заданного окна анализа: s(n) = w(n) / sum_m w^2(n + m * step).
+ * \param n размер массивов.
+ */
+void init_synthesis_window(const hsv_numeric_t*analysis, hsv_numeric_t*synthesis, unsigned n, unsigned step);
+
+/**
+ * Инициализация асимметричных окон анализа и синтеза с малой задержкой.
+ * Окно анализа - подъем корня из окна Ханна длины n - step и спад длины step, окно синтеза отлично от нуля только
+ * на последних 2 * step отсчетах, где произведение окон равно окну Ханна длины 2 * step.
+ *
+ * Mauler D., Martin R. A low delay, variable resolution, perfect reconstruction spectral analysis-synthesis system
+ * for speech enhancement, 2007 г.
+ * \param n размер массивов (не меньше 2 * step).
+ * \param step шаг фрейма.
+ */
+void init_window_low_delay(hsv_numeric_t*analysis, hsv_numeric_t*synthesis, unsigned n, unsigned step);
+
+/**
+ * Модифицированная функция Бесселя первого рода нулевого порядка (для окон Кайзера).
+ */
+double bessel_i0(double x);
+
 /**
  * Перемножение с оконной функцией.
+ * Функции-обертки над ядрами определены в заголовке, чтобы встраиваться в циклы обработки без LTO.
  */
-void calculate_windowing(const hsv_numeric_t*window, const hsv_numeric_t*in, hsv_numeric_t*out, unsigned n);
+static inline void calculate_windowing(const hsv_numeric_t*window, const hsv_numeric_t*in, hsv_numeric_t*out, unsigned n)
+{
+	hsv_kernels->windowing(window, in, out, n);
+}
 
 /**
  * Вычисление спектра амплитуд сигнала.
  */
-void calculate_amp_spec(const hsv_numeric_t*real, const hsv_numeric_t*imag, hsv_numeric_t*amp_spec, unsigned n);
+static inline void calculate_amp_spec(const hsv_numeric_t*real, const hsv_numeric_t*imag, hsv_numeric_t*amp_spec, unsigned n)
+{
+	hsv_kernels->amp_spec(real, imag, amp_spec, n);
+}
 
 /**
  * Вычисление спектра мощности сигнала.
  */
-void calculate_power_spec(const hsv_numeric_t*real, const hsv_numeric_t*imag, hsv_numeric_t*power_spec, unsigned n);
+static inline void calculate_power_spec(const hsv_numeric_t*real, const hsv_numeric_t*imag, hsv_numeric_t*power_spec, unsigned n)
+{
+	hsv_kernels->power_spec(real, imag, power_spec, n);
+}
 
 /**
  * Вычисление спектра фаз сигнала.
  */
 void calculate_phase_spec(const hsv_numeric_t*real, const hsv_numeric_t*imag, hsv_numeric_t*phase_spec, unsigned n);
 
+/**
+ * Вычисление спектра фаз сигнала приближением fastmath_atan2.
+ */
+void calculate_phase_spec_fast(const hsv_numeric_t*real, const hsv_numeric_t*imag, hsv_numeric_t*phase_spec, unsigned n);
+
+/**
+ * Вычисление комплексного спектра по спектрам амплитуд и фаз приближением fastmath_sincos.
+ */
+void calculate_complex_spec_fast(const hsv_numeric_t*amp_spec, const hsv_numeric_t*phase_spec, hsv_numeric_t*real, hsv_numeric_t*imag, unsigned n);
+
 #ifdef __cplusplus
 // }
 #endif  /* __cplusplus */
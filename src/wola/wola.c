@@ -0,0 +1,251 @@
+/**
+ * \file wola.c
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief Реализация API банка фильтров со взвешенным перекрытием-сложением (WOLA).
+ */
+/**
+ * \ingroup wola
+ * \{
+ */
+#include "wola.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <math.h>
+
+#include "utils.h"
+
+wola_t create_wola()
+{
+	wola_t wola;
+
+	wola = (wola_t) calloc(1, sizeof(struct WOLA));
+	return wola;
+}
+
+/**
+ * Окно анализа: sinc с частотой среза cutoff / size (в долях частоты дискретизации), умноженный на окно Кайзера.
+ */
+static void init_analysis(double*h, unsigned size, unsigned len)
+{
+	/* Параметры подобраны так, чтобы перекрестные искажения при шаге size / 4 были малы
+	   и окно синтеза (см. init_synthesis) получалось почти гладким. */
+	static const double beta = 8.0;
+	static const double cutoff = 1.2;
+
+	double c, x, s;
+
+	unsigned n;
+
+	for (n = 0; n < len; n++) {
+		c = n - (len - 1) / 2.0;
+		x = c * cutoff / size;
+		s = (c == 0.0) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+		h[n] = s * bessel_i0(beta * sqrt(HSV_MAX(1.0 - (2.0 * c / (len - 1)) * (2.0 * c / (len - 1)), 0.0))) / bessel_i0(beta);
+	}
+}
+
+/**
+ * Решение системы линейных уравнений n x n методом Гаусса с выбором главного элемента.
+ * Матрица a хранится по строкам, решение записывается в b.
+ */
+static void solve(double*a, double*b, int n)
+{
+	int i, j, k, p;
+
+	double t;
+
+	for (k = 0; k < n; k++) {
+		p = k;
+		for (i = k + 1; i < n; i++) {
+			if (fabs(a[i * n + k]) > fabs(a[p * n + k])) {
+				p = i;
+			}
+		}
+		if (p != k) {
+			for (j = 0; j < n; j++) {
+				t = a[k * n + j]; a[k * n + j] = a[p * n + j]; a[p * n + j] = t;
+			}
+			t = b[k]; b[k] = b[p]; b[p] = t;
+		}
+
+		for (i = 0; i < n; i++) {
+			if ((i == k) || (a[k * n + k] == 0.0)) {
+				continue;
+			}
+			t = a[i * n + k] / a[k * n + k];
+			for (j = k; j < n; j++) {
+				a[i * n + j] -= t * a[k * n + j];
+			}
+			b[i] -= t * b[k];
+		}
+	}
+
+	for (k = 0; k < n; k++) {
+		b[k] = (a[k * n + k] == 0.0) ? 0.0 : b[k] / a[k * n + k];
+	}
+}
+
+/**
+ * Окно синтеза для заданного окна анализа.
+ * Если выходной отсчет находится на позиции d фрейма, то этот фрейм добавляет к нему отсчеты входа, сдвинутые
+ * на q * size, с весом f(d) * h(d + q * size). Суммы весов по всем фреймам (d = t, t + hop, ...) должны быть равны 1
+ * при q = 0 и 0 иначе, поэтому для каждой фазы t условия полного восстановления образуют отдельную систему.
+ * Из всех решений выбирается ближайшее к отмасштабированному окну анализа.
+ */
+static void init_synthesis(const double*h, double*f, unsigned size, unsigned taps, unsigned hop)
+{
+	double a[(2 * WOLA_MAX_TAPS - 1) * (2 * WOLA_MAX_TAPS - 1)];
+	double y[2 * WOLA_MAX_TAPS - 1];
+
+	int len = (int) (taps * size);
+	int n_q = 2 * (int) taps - 1;
+	int q_min = 1 - (int) taps;
+
+	double scale = 0.0;
+
+	int t, d, i, j, di, dj;
+
+	for (d = 0; d < len; d++) {
+		scale += h[d] * h[d];
+	}
+	scale = hop / scale;
+
+	for (t = 0; t < (int) hop; t++) {
+		/* Система (A * A^T) * y = e - A * g, f = g + A^T * y, где A(q, d) = h(d + q * size), g = scale * h. */
+		for (i = 0; i < n_q; i++) {
+			y[i] = (i + q_min == 0) ? 1.0 : 0.0;
+			for (j = 0; j < n_q; j++) {
+				a[i * n_q + j] = 0.0;
+			}
+			for (d = t; d < len; d += hop) {
+				di = d + (i + q_min) * (int) size;
+				if ((di < 0) || (di >= len)) {
+					continue;
+				}
+				y[i] -= h[di] * scale * h[d];
+				for (j = 0; j < n_q; j++) {
+					dj = d + (j + q_min) * (int) size;
+					if ((dj >= 0) && (dj < len)) {
+						a[i * n_q + j] += h[di] * h[dj];
+					}
+				}
+			}
+		}
+
+		solve(a, y, n_q);
+
+		for (d = t; d < len; d += hop) {
+			f[d] = scale * h[d];
+			for (i = 0; i < n_q; i++) {
+				di = d + (i + q_min) * (int) size;
+				if ((di >= 0) && (di < len)) {
+					f[d] += h[di] * y[i];
+				}
+			}
+		}
+	}
+}
+
+enum WOLA_CODE wola_config(wola_t wola, unsigned size, unsigned taps, unsigned hop, arena_t arena)
+{
+	enum WOLA_CODE r;
+
+	double*h;
+	double*f;
+
+	unsigned n;
+
+	wola->size = size;
+	wola->taps = taps;
+	wola->len = taps * size;
+	wola->hop = hop;
+	wola->arena = arena;
+
+	wola->analysis = (hsv_numeric_t*) arena_calloc(wola->arena, wola->len, sizeof(hsv_numeric_t));
+	if (wola->analysis == NULL) {
+		r = WOLA_CODE_ALLOC_ERR;
+		goto err0;
+	}
+	wola->synthesis = (hsv_numeric_t*) arena_calloc(wola->arena, wola->len, sizeof(hsv_numeric_t));
+	if (wola->synthesis == NULL) {
+		r = WOLA_CODE_ALLOC_ERR;
+		goto err1;
+	}
+
+	/* Окна рассчитываются в двойной точности независимо от hsv_numeric_t. */
+	h = (double*) calloc(2 * wola->len, sizeof(double));
+	if (h == NULL) {
+		r = WOLA_CODE_ALLOC_ERR;
+		goto err2;
+	}
+	f = h + wola->len;
+
+	init_analysis(h, size, wola->len);
+	init_synthesis(h, f, size, taps, hop);
+
+	for (n = 0; n < wola->len; n++) {
+		wola->analysis[n] = (hsv_numeric_t) h[n];
+		wola->synthesis[n] = (hsv_numeric_t) f[n];
+	}
+
+	free(h);
+
+	return WOLA_CODE_OK;
+
+ err2:
+	arena_free(wola->arena, wola->synthesis);
+ err1:
+	arena_free(wola->arena, wola->analysis);
+ err0:
+	return r;
+}
+
+void wola_reserve(unsigned size, unsigned taps, arena_t arena)
+{
+	arena_reserve(arena, taps * size, sizeof(hsv_numeric_t));
+	arena_reserve(arena, taps * size, sizeof(hsv_numeric_t));
+}
+
+void wola_fold(const struct WOLA*wola, const hsv_numeric_t*in, hsv_numeric_t*out)
+{
+	unsigned p, k;
+
+	memcpy(out, in, wola->size * sizeof(hsv_numeric_t));
+	for (p = 1; p < wola->taps; p++) {
+		for (k = 0; k < wola->size; k++) {
+			out[k] += in[p * wola->size + k];
+		}
+	}
+}
+
+void wola_unfold(const struct WOLA*wola, const hsv_numeric_t*in, hsv_numeric_t*out)
+{
+	unsigned p, k;
+
+	for (p = 0; p < wola->taps; p++) {
+		for (k = 0; k < wola->size; k++) {
+			out[p * wola->size + k] = in[k] * wola->synthesis[p * wola->size + k];
+		}
+	}
+}
+
+void wola_deconfig(wola_t wola)
+{
+	arena_free(wola->arena, wola->synthesis);
+	arena_free(wola->arena, wola->analysis);
+}
+
+void wola_clean(wola_t wola)
+{
+	memset(wola, '\0', sizeof(*wola));
+}
+
+void wola_free(wola_t wola)
+{
+	free(wola);
+}
+/**
+ * /}
+ */
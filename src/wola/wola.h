@@ -0,0 +1,114 @@
+/**
+ * \file wola.h
+ * \author Masyagin M.M., masyagin1998@yandex.ru
+ * \brief API банка фильтров со взвешенным перекрытием-сложением (WOLA).
+ */
+/**
+ * \defgroup wola Модуль банка фильтров WOLA.
+ * \{
+ */
+#ifndef WOLA_H_INCLUDED
+#define WOLA_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+#include "hsv_types.h"
+
+#include "arena.h"
+
+#define WOLA_MAX_TAPS 4 /**< Максимальная длина прототипа в размерах ДПФ. */
+
+/**
+ * Коды, возвращаемые методами wola_...
+ */
+enum WOLA_CODE
+{
+	WOLA_CODE_OK = 0,         /**< Метод успешно отработал. */
+	WOLA_CODE_ALLOC_ERR = -1, /**< Ошибка выделения памяти. */
+};
+
+/**
+ * Структура банка фильтров WOLA с size подполосами и передискретизацией size / hop.
+ * Фрейм длины len = taps * size умножается на окно анализа (прототип - ФНЧ с частотой среза около size / 2 частот ДПФ),
+ * складывается с шагом size в size отсчетов и подается на ДПФ размера size. При синтезе результат обратного ДПФ
+ * периодически продолжается до len отсчетов и умножается на окно синтеза перед перекрытием-сложением с шагом hop.
+ * Окно синтеза вычисляется по окну анализа из условий полного восстановления, поэтому нормировка
+ * при перекрытии не нужна.
+ *
+ * Crochiere R.E. A weighted overlap-add method of short-time Fourier analysis/synthesis, 1980 г.
+ */
+struct WOLA
+{
+	unsigned size; /**< Размер ДПФ (число подполос).           */
+	unsigned taps; /**< Длина прототипа в размерах ДПФ.         */
+	unsigned len;  /**< Длина фрейма (taps * size).             */
+	unsigned hop;  /**< Шаг фрейма (делитель size).             */
+
+	hsv_numeric_t*analysis;  /**< Окно анализа (len отсчетов).  */
+	hsv_numeric_t*synthesis; /**< Окно синтеза (len отсчетов).  */
+
+	arena_t arena; /**< Арена, из которой выделены буферы. */
+};
+
+typedef struct WOLA* wola_t;
+
+/**
+ * Создание структуры банка фильтров WOLA.
+ * \return указатель на структуру банка фильтров WOLA (при ошибке - NULL).
+ */
+wola_t create_wola();
+
+/**
+ * Конфигурация банка фильтров WOLA.
+ * \param size размер ДПФ.
+ * \param taps длина прототипа в размерах ДПФ (от 1 до WOLA_MAX_TAPS).
+ * \param hop шаг фрейма; должен делить size, а size / hop должно быть не меньше 2 (при taps > 1).
+ * \param arena арена, из которой выделяются буферы.
+ * \return результат конфигурирования.
+ */
+enum WOLA_CODE wola_config(wola_t wola, unsigned size, unsigned taps, unsigned hop, arena_t arena);
+
+/**
+ * Учет памяти wola_config в арене без конфигурации (см. arena_reserve).
+ */
+void wola_reserve(unsigned size, unsigned taps, arena_t arena);
+
+/**
+ * Свертка фрейма, уже умноженного на окно анализа, до размера ДПФ.
+ * \param in фрейм (len отсчетов).
+ * \param out вход ДПФ (size отсчетов).
+ */
+void wola_fold(const struct WOLA*wola, const hsv_numeric_t*in, hsv_numeric_t*out);
+
+/**
+ * Периодическое продолжение выхода обратного ДПФ до длины фрейма с умножением на окно синтеза.
+ * \param in выход обратного ДПФ (size отсчетов).
+ * \param out фрейм для перекрытия-сложения (len отсчетов).
+ */
+void wola_unfold(const struct WOLA*wola, const hsv_numeric_t*in, hsv_numeric_t*out);
+
+/**
+ * Удаление всех внутренних динамических структур.
+ */
+void wola_deconfig(wola_t wola);
+
+/**
+ * Зануление структуры банка фильтров WOLA.
+ */
+void wola_clean(wola_t wola);
+
+/**
+ * Удаление структуры банка фильтров WOLA.
+ */
+void wola_free(wola_t wola);
+
+#ifdef __cplusplus
+}
+#endif  /* __cplusplus */
+
+#endif  /* WOLA_H_INCLUDED */
+/**
+ * /}
+ */